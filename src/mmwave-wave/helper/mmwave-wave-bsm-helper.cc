@@ -21,6 +21,7 @@
 
 #include "ns3/mmwave-wave-bsm-helper.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("MmWaveWaveBsmHelper");
 
@@ -93,14 +94,20 @@ MmWaveWaveBsmHelper::Install (Ipv4InterfaceContainer & i,
                         Time txMaxDelay)         // max delay prior to transmit
 {
   int size = ranges.size ();
+  double maxRange = 0;
   m_txSafetyRangesSq.clear ();
   m_txSafetyRangesSq.resize (size, 0);
   for (int index = 0; index < size; index++)
     {
       // stored as square of value, for optimization
       m_txSafetyRangesSq[index] = ranges[index] * ranges[index];
+      maxRange = std::max (maxRange, ranges[index]);
     }
 
+  // a single neighbor index serves all the apps
+  Ptr<MmWaveWaveBsmNeighborIndex> neighborIndex = CreateObject<MmWaveWaveBsmNeighborIndex> ();
+  neighborIndex->Setup (i, maxRange);
+
   // install a BsmApplication on each node
   ApplicationContainer bsmApps = Install (i);
   // start BSM app immediately (BsmApplication will
@@ -125,6 +132,7 @@ MmWaveWaveBsmHelper::Install (Ipv4InterfaceContainer & i,
                      &nodesMoving,
                      chAccessMode,
                      txMaxDelay);
+      bsmApp->SetNeighborIndex (neighborIndex);
       nodeId++;
     }
 }
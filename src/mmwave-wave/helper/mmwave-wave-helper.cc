@@ -316,6 +316,12 @@ MmWaveWaveHelper::SetFrequency (uint16_t freq)
   m_freq = freq;
 }
 
+void
+MmWaveWaveHelper::SetSharedChannelCoordinator (Ptr<MmWaveWaveChannelCoordinator> coordinator)
+{
+  m_sharedCoordinator = coordinator;
+}
+
 void
 MmWaveWaveHelper::CreatePhys (uint32_t phys)
 {
@@ -424,7 +430,14 @@ MmWaveWaveHelper::Install (NodeContainer c) const
       Ptr<MmWaveWaveNetDevice> device = CreateObject<MmWaveWaveNetDevice> ();
 
       device->SetMmWaveWaveChannelManager (CreateObject<MmWaveWaveChannelManager> ());
-      device->SetMmWaveWaveChannelCoordinator (CreateObject<MmWaveWaveChannelCoordinator> ());
+      if (m_sharedCoordinator != 0)
+        {
+          device->SetMmWaveWaveChannelCoordinator (m_sharedCoordinator);
+        }
+      else
+        {
+          device->SetMmWaveWaveChannelCoordinator (CreateObject<MmWaveWaveChannelCoordinator> ());
+        }
       device->SetMmWaveWaveVsaManager (CreateObject<MmWaveWaveVsaManager> ());
       device->SetMmWaveWaveChannelScheduler (m_channelScheduler.Create<MmWaveWaveChannelScheduler> ());
 
@@ -28,6 +28,7 @@
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/spectrum-wifi-helper.h"
 #include <ns3/antenna-array-model.h>
+#include "ns3/mmwave-wave-channel-coordinator.h"
 
 namespace ns3 {
 
@@ -210,6 +211,19 @@ public:
                             std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
                             std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
 
+  /**
+   * \param coordinator the channel coordinator shared by all the devices
+   * installed afterwards, or 0 to give each device its own coordinator (the default)
+   *
+   * Since all the devices are synchronized to UTC, a single coordinator
+   * can schedule the CCH, SCH and guard slot events once for the whole
+   * fleet, instead of one identical stream of events per device. The
+   * coordination starts with the first device that is initialized, and the
+   * devices initialized later are notified of the current slot. The
+   * coordinator is disposed with the last device that uses it.
+   */
+  void SetSharedChannelCoordinator (Ptr<MmWaveWaveChannelCoordinator> coordinator);
+
   void SetSpectrumChannel (std::string type);
   void SetPropagationLossModel (std::string type);
 
@@ -271,6 +285,7 @@ private:
   std::string m_pathlossModelType;
   ObjectFactory m_pathlossModelFactory;
   ObjectFactory m_channelFactory;
+  Ptr<MmWaveWaveChannelCoordinator> m_sharedCoordinator; ///< coordinator shared by the devices, if any
 };
 }
 #endif /* WAVE_HELPER_H */
@@ -26,6 +26,9 @@
 #include "ns3/mmwave-wave-helper.h"
 #include "ns3/mobility-model.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/mobility-snapshot.h"
+#include <algorithm>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("MmWaveWaveBsmApplication");
 
@@ -50,6 +53,7 @@ MmWaveWaveBsmApplication::GetTypeId (void)
 MmWaveWaveBsmApplication::MmWaveWaveBsmApplication ()
   : m_waveBsmStats (0),
     m_txSafetyRangesSq (),
+    m_maxSafetyRange (0),
     m_TotalSimTime (Seconds (10)),
     m_wavePacketSize (200),
     m_numWavePackets (1),
@@ -57,6 +61,7 @@ MmWaveWaveBsmApplication::MmWaveWaveBsmApplication ()
     m_gpsAccuracyNs (10000),
     m_adhocTxInterfaces (0),
     m_nodesMoving (0),
+    m_neighborIndex (0),
     m_unirv (0),
     m_nodeId (0),
     m_chAccessMode (0),
@@ -76,6 +81,8 @@ MmWaveWaveBsmApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
+  m_neighborIndex = 0;
+
   // chain up
   Application::DoDispose ();
 }
@@ -85,6 +92,12 @@ void MmWaveWaveBsmApplication::StartApplication () // Called at time specified b
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_neighborIndex == 0)
+    {
+      m_neighborIndex = CreateObject<MmWaveWaveBsmNeighborIndex> ();
+      m_neighborIndex->Setup (*m_adhocTxInterfaces, m_maxSafetyRange);
+    }
+
   // setup generation of WAVE BSM messages
   Time waveInterPacketInterval = m_waveInterval;
 
@@ -207,11 +220,13 @@ MmWaveWaveBsmApplication::Setup (Ipv4InterfaceContainer & i,
   m_chAccessMode = chAccessMode;
   m_txSafetyRangesSq.clear ();
   m_txSafetyRangesSq.resize (size, 0);
+  m_maxSafetyRange = 0;
 
   for (int index = 0; index < size; index++)
     {
       // stored as square of value, for optimization
       m_txSafetyRangesSq[index] = rangesSq[index];
+      m_maxSafetyRange = std::max (m_maxSafetyRange, std::sqrt (rangesSq[index]));
     }
 
   m_adhocTxInterfaces = &i;
@@ -219,6 +234,13 @@ MmWaveWaveBsmApplication::Setup (Ipv4InterfaceContainer & i,
   m_txMaxDelay = txMaxDelay;
 }
 
+void
+MmWaveWaveBsmApplication::SetNeighborIndex (Ptr<MmWaveWaveBsmNeighborIndex> neighborIndex)
+{
+  NS_LOG_FUNCTION (this << neighborIndex);
+  m_neighborIndex = neighborIndex;
+}
+
 void
 MmWaveWaveBsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
                                      uint32_t pktCount, Time pktInterval,
@@ -253,17 +275,16 @@ MmWaveWaveBsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktS
             }
 
           // find other nodes within range that would be
-          // expected to receive this broadbast
-          int nRxNodes = m_adhocTxInterfaces->GetN ();
-          for (int i = 0; i < nRxNodes; i++)
+          // expected to receive this broadbast. the index returns
+          // a superset of the nodes within the largest range
+          m_neighborIndex->GetCandidates (MobilitySnapshot::GetPosition (txNodeId), m_maxSafetyRange, m_candidates);
+          for (std::vector<uint32_t>::const_iterator it = m_candidates.begin (); it != m_candidates.end (); ++it)
             {
-              Ptr<Node> rxNode = GetNode (i);
+              Ptr<Node> rxNode = GetNode (*it);
               int rxNodeId = rxNode->GetId ();
 
               if (rxNodeId != txNodeId)
                 {
-                  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
-                  NS_ASSERT (rxPosition != 0);
                   // confirm that the receiving node
                   // has also started moving in the scenario
                   // if it has not started moving, then
@@ -271,7 +292,7 @@ MmWaveWaveBsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktS
                   int receiverMoving = m_nodesMoving->at (rxNodeId);
                   if (receiverMoving == 1)
                     {
-                      double distSq = MobilityHelper::GetDistanceSquaredBetween (txNode, rxNode);
+                      double distSq = MobilitySnapshot::GetDistanceSquaredBetween (txNodeId, rxNodeId);
                       if (distSq > 0.0)
                         {
                           // dest node within range?
@@ -327,14 +348,11 @@ void MmWaveWaveBsmApplication::ReceiveWavePacket (Ptr<Socket> socket)
       if (InetSocketAddress::IsMatchingType (senderAddr))
         {
           InetSocketAddress addr = InetSocketAddress::ConvertFrom (senderAddr);
-          int nodes = m_adhocTxInterfaces->GetN ();
-          for (int i = 0; i < nodes; i++)
+          uint32_t i;
+          if (m_neighborIndex->LookupAddress (addr.GetIpv4 (), i))
             {
-              if (addr.GetIpv4 () == m_adhocTxInterfaces->GetAddress (i) )
-                {
-                  Ptr<Node> txNode = GetNode (i);
-                  HandleReceivedBsmPacket (txNode, rxNode);
-                }
+              Ptr<Node> txNode = GetNode (i);
+              HandleReceivedBsmPacket (txNode, rxNode);
             }
         }
     }
@@ -347,8 +365,6 @@ void MmWaveWaveBsmApplication::HandleReceivedBsmPacket (Ptr<Node> txNode,
 
   m_waveBsmStats->IncRxPktCount ();
 
-  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
-  NS_ASSERT (rxPosition != 0);
   // confirm that the receiving node
   // has also started moving in the scenario
   // if it has not started moving, then
@@ -357,7 +373,7 @@ void MmWaveWaveBsmApplication::HandleReceivedBsmPacket (Ptr<Node> txNode,
   int receiverMoving = m_nodesMoving->at (rxNodeId);
   if (receiverMoving == 1)
     {
-      double rxDistSq = MobilityHelper::GetDistanceSquaredBetween (rxNode, txNode);
+      double rxDistSq = MobilitySnapshot::GetDistanceSquaredBetween (rxNodeId, txNode->GetId ());
       if (rxDistSq > 0.0)
         {
           int rangeCount = m_txSafetyRangesSq.size ();
@@ -26,6 +26,7 @@
 #include "ns3/mmwave-wave-bsm-stats.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/mmwave-wave-bsm-neighbor-index.h"
 
 namespace ns3 {
 /**
@@ -95,6 +96,15 @@ public:
   */
   int64_t AssignStreams (int64_t streamIndex);
 
+  /**
+   * \brief Set the index used to find the nodes within the safety ranges
+   * of a sender and the sender of a received BSM. The index is usually
+   * shared by all the applications of the same interface container; if
+   * none is set, the application builds its own index at start.
+   * \param neighborIndex the index, set up with the same interface container
+   */
+  void SetNeighborIndex (Ptr<MmWaveWaveBsmNeighborIndex> neighborIndex);
+
   /**
   * (Arbitrary) port number that is used to create a socket for transmitting WAVE BSMs.
   */
@@ -155,6 +165,7 @@ private:
   Ptr<MmWaveWaveBsmStats> m_waveBsmStats; ///< BSM stats
   /// tx safety range squared, for optimization
   std::vector <double> m_txSafetyRangesSq;
+  double m_maxSafetyRange; ///< largest tx safety range, in m
   Time m_TotalSimTime; ///< total sim time
   uint32_t m_wavePacketSize; ///< bytes
   uint32_t m_numWavePackets; ///< number of wave packets
@@ -162,6 +173,8 @@ private:
   double m_gpsAccuracyNs; ///< GPS accuracy
   Ipv4InterfaceContainer * m_adhocTxInterfaces; ///< transmit interfaces
   std::vector<int> * m_nodesMoving; ///< nodes moving
+  Ptr<MmWaveWaveBsmNeighborIndex> m_neighborIndex; ///< index of the nodes of m_adhocTxInterfaces
+  std::vector<uint32_t> m_candidates; ///< candidate receivers of the BSM being sent
   Ptr<UniformRandomVariable> m_unirv; ///< random variable
   int m_nodeId; ///< node ID
   /// WAVE channel access mode.  0=continuous PHY; 1=channel-switching
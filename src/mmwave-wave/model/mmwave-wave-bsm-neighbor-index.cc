@@ -0,0 +1,181 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/mmwave-wave-bsm-neighbor-index.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mobility-model.h"
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveWaveBsmNeighborIndex");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveWaveBsmNeighborIndex);
+
+TypeId
+MmWaveWaveBsmNeighborIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveWaveBsmNeighborIndex")
+    .SetParent<Object> ()
+    .SetGroupName ("MmWave-Wave")
+    .AddConstructor<MmWaveWaveBsmNeighborIndex> ()
+    .AddAttribute ("RebuildPeriod",
+                   "The grid is rebuilt with the current positions of the nodes when it is older than this",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&MmWaveWaveBsmNeighborIndex::m_rebuildPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxSpeed",
+                   "Upper bound of the speed of the nodes, in m/s. Between two rebuilds the search "
+                   "radius is enlarged by the distance that two nodes can cover at this speed",
+                   DoubleValue (70.0),
+                   MakeDoubleAccessor (&MmWaveWaveBsmNeighborIndex::m_maxSpeed),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+MmWaveWaveBsmNeighborIndex::MmWaveWaveBsmNeighborIndex ()
+  : m_cellSize (1.0),
+    m_built (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MmWaveWaveBsmNeighborIndex::~MmWaveWaveBsmNeighborIndex ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MmWaveWaveBsmNeighborIndex::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  DisconnectCourseChanges ();
+  m_mobility.clear ();
+  m_addresses.clear ();
+  m_cells.clear ();
+  Object::DoDispose ();
+}
+
+void
+MmWaveWaveBsmNeighborIndex::Setup (const Ipv4InterfaceContainer & i, double maxRange)
+{
+  NS_LOG_FUNCTION (this << i.GetN () << maxRange);
+  m_cellSize = std::max (maxRange, 1.0);
+  DisconnectCourseChanges ();
+  m_mobility.clear ();
+  m_addresses.clear ();
+  for (uint32_t index = 0; index < i.GetN (); ++index)
+    {
+      Ptr<Node> node = i.Get (index).first->GetObject<Node> ();
+      Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      mobility->TraceConnectWithoutContext ("CourseChange",
+                                            MakeCallback (&MmWaveWaveBsmNeighborIndex::CourseChanged, this));
+      m_mobility.push_back (mobility);
+      m_addresses[i.GetAddress (index)] = index;
+    }
+  m_built = false;
+}
+
+void
+MmWaveWaveBsmNeighborIndex::DisconnectCourseChanges (void)
+{
+  for (uint32_t index = 0; index < m_mobility.size (); ++index)
+    {
+      m_mobility[index]->TraceDisconnectWithoutContext ("CourseChange",
+                                                        MakeCallback (&MmWaveWaveBsmNeighborIndex::CourseChanged, this));
+    }
+}
+
+void
+MmWaveWaveBsmNeighborIndex::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  // the node may have been moved farther than MaxSpeed allows
+  m_built = false;
+}
+
+int32_t
+MmWaveWaveBsmNeighborIndex::GetCell (double x) const
+{
+  return static_cast<int32_t> (std::floor (x / m_cellSize));
+}
+
+void
+MmWaveWaveBsmNeighborIndex::Rebuild (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cells.clear ();
+  for (uint32_t index = 0; index < m_mobility.size (); ++index)
+    {
+      Vector position = m_mobility[index]->GetPosition ();
+      m_cells[std::make_pair (GetCell (position.x), GetCell (position.y))].push_back (index);
+    }
+  m_lastRebuild = Simulator::Now ();
+  m_built = true;
+}
+
+void
+MmWaveWaveBsmNeighborIndex::GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  if (!m_built || Simulator::Now () - m_lastRebuild >= m_rebuildPeriod)
+    {
+      Rebuild ();
+    }
+
+  // a candidate may have moved towards the position since the rebuild. The
+  // grid is two-dimensional, and the distance along z only adds to the
+  // exact distance, so it cannot exclude a node within range
+  double radius = range + m_maxSpeed * (Simulator::Now () - m_lastRebuild).GetSeconds ();
+  int32_t xBegin = GetCell (position.x - radius);
+  int32_t xEnd = GetCell (position.x + radius);
+  int32_t yBegin = GetCell (position.y - radius);
+  int32_t yEnd = GetCell (position.y + radius);
+
+  candidates.clear ();
+  for (int32_t x = xBegin; x <= xEnd; ++x)
+    {
+      for (int32_t y = yBegin; y <= yEnd; ++y)
+        {
+          std::map<std::pair<int32_t, int32_t>, std::vector<uint32_t> >::const_iterator it =
+            m_cells.find (std::make_pair (x, y));
+          if (it != m_cells.end ())
+            {
+              candidates.insert (candidates.end (), it->second.begin (), it->second.end ());
+            }
+        }
+    }
+  NS_LOG_LOGIC (candidates.size () << " candidates out of " << m_mobility.size () << " nodes");
+}
+
+bool
+MmWaveWaveBsmNeighborIndex::LookupAddress (Ipv4Address address, uint32_t &index) const
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator it = m_addresses.find (address);
+  if (it == m_addresses.end ())
+    {
+      return false;
+    }
+  index = it->second;
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MMWAVE_WAVE_BSM_NEIGHBOR_INDEX_H
+#define MMWAVE_WAVE_BSM_NEIGHBOR_INDEX_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/internet-stack-helper.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup wave
+ * \brief A uniform grid over the positions of the nodes of an
+ * Ipv4InterfaceContainer, shared by the MmWaveWaveBsmApplication instances
+ * to find the nodes that may be within the safety ranges of a sender
+ * without scanning all the nodes.
+ *
+ * The grid is rebuilt at most every RebuildPeriod. Between two rebuilds
+ * the nodes are assumed not to move faster than MaxSpeed, and the search
+ * radius is enlarged accordingly, so that the candidates are a superset of
+ * the nodes actually within the radius. A node that changes course, e.g.
+ * because its position is set, may break this bound, so any CourseChange
+ * of the indexed nodes marks the grid to be rebuilt at the next query.
+ * The callers compute the exact distances of the candidates.
+ */
+class MmWaveWaveBsmNeighborIndex : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MmWaveWaveBsmNeighborIndex ();
+  virtual ~MmWaveWaveBsmNeighborIndex ();
+
+  /**
+   * \brief Index the nodes of the interfaces
+   * \param i IPv4 interface container, the index of a node is its index in the container
+   * \param maxRange the largest radius that will be queried, in m, used as the cell size
+   */
+  void Setup (const Ipv4InterfaceContainer & i, double maxRange);
+
+  /**
+   * \brief Find the nodes that may be within a radius from a position
+   * \param position the center of the search
+   * \param range the radius, in m, at most the maxRange given to Setup
+   * \param candidates filled with the indices of the nodes that may be within range
+   */
+  void GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates);
+
+  /**
+   * \brief Find the node of an address
+   * \param address the address of an interface
+   * \param index set to the index of the node, if found
+   * \return true if the address belongs to one of the interfaces
+   */
+  bool LookupAddress (Ipv4Address address, uint32_t &index) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Put the nodes in the cells of their current positions
+   */
+  void Rebuild (void);
+
+  /**
+   * \brief Mark the grid to be rebuilt, when a node changes course
+   * \param mobility the mobility model of the node
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  /**
+   * \brief Disconnect from the CourseChange traces of the indexed nodes
+   */
+  void DisconnectCourseChanges (void);
+
+  /**
+   * \param x the coordinate, in m
+   * \return the index of the cell along the axis
+   */
+  int32_t GetCell (double x) const;
+
+  Time m_rebuildPeriod; ///< time between two rebuilds of the grid
+  double m_maxSpeed; ///< upper bound of the speed of the nodes, in m/s
+  double m_cellSize; ///< side of the square cells, in m
+  Time m_lastRebuild; ///< time of the last rebuild
+  bool m_built; ///< true if the grid is up to date, within the MaxSpeed bound
+  std::vector<Ptr<MobilityModel> > m_mobility; ///< mobility of each node
+  std::map<Ipv4Address, uint32_t> m_addresses; ///< index of the node of each address
+  std::map<std::pair<int32_t, int32_t>, std::vector<uint32_t> > m_cells; ///< the nodes of each non-empty cell
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_WAVE_BSM_NEIGHBOR_INDEX_H */
@@ -59,7 +59,8 @@ MmWaveWaveChannelCoordinator::GetTypeId (void)
 }
 
 MmWaveWaveChannelCoordinator::MmWaveWaveChannelCoordinator ()
-  : m_guardCount (0)
+  : m_devices (0),
+    m_guardCount (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -301,6 +302,11 @@ MmWaveWaveChannelCoordinator::RegisterListener (Ptr<MmWaveWaveChannelCoordinatio
   NS_LOG_FUNCTION (this << listener);
   NS_ASSERT (listener != 0);
   m_listeners.push_back (listener);
+  if (m_coordination.IsRunning ())
+    {
+      // the slot has already been notified to the other listeners
+      m_newListeners.push_back (listener);
+    }
 }
 
 void
@@ -308,6 +314,14 @@ MmWaveWaveChannelCoordinator::UnregisterListener (Ptr<MmWaveWaveChannelCoordinat
 {
   NS_LOG_FUNCTION (this << listener);
   NS_ASSERT (listener != 0);
+  for (ListenersI i = m_newListeners.begin (); i != m_newListeners.end (); ++i)
+    {
+      if ((*i) == listener)
+        {
+          m_newListeners.erase (i);
+          break;
+        }
+    }
   for (ListenersI i = m_listeners.begin (); i != m_listeners.end (); ++i)
     {
       if ((*i) == listener)
@@ -323,6 +337,61 @@ MmWaveWaveChannelCoordinator::UnregisterAllListeners (void)
 {
   NS_LOG_FUNCTION (this);
   m_listeners.clear ();
+  m_newListeners.clear ();
+}
+
+void
+MmWaveWaveChannelCoordinator::NotifyNewListeners (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_coordination.IsRunning ())
+    {
+      m_newListeners.clear ();
+      return;
+    }
+  // the pending event ends the current slot. If it is due now, it will
+  // notify the next slot to all the listeners
+  Time left = Simulator::GetDelayLeft (m_coordination);
+  if (left.IsZero ())
+    {
+      m_newListeners.clear ();
+      return;
+    }
+  Listeners listeners;
+  listeners.swap (m_newListeners);
+  for (ListenersI i = listeners.begin (); i != listeners.end (); ++i)
+    {
+      if (IsGuardInterval ())
+        {
+          (*i)->NotifyGuardSlotStart (left, IsCchInterval ());
+        }
+      else if (IsCchInterval ())
+        {
+          (*i)->NotifyCchSlotStart (left);
+        }
+      else
+        {
+          (*i)->NotifySchSlotStart (left);
+        }
+    }
+}
+
+void
+MmWaveWaveChannelCoordinator::AddDevice (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_devices++;
+}
+
+void
+MmWaveWaveChannelCoordinator::RemoveDevice (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_devices > 0);
+  if (--m_devices == 0)
+    {
+      Dispose ();
+    }
 }
 
 void
@@ -340,6 +409,7 @@ MmWaveWaveChannelCoordinator::StartChannelCoordination (void)
       NS_FATAL_ERROR ("the channel intervals configured for channel coordination events are invalid");
     }
   m_guardCount = 0;
+  m_newListeners.clear ();
   NotifyGuardSlot ();
 }
 
@@ -357,10 +427,11 @@ void
 MmWaveWaveChannelCoordinator::NotifySchSlot (void)
 {
   NS_LOG_FUNCTION (this);
-  m_coordination = Simulator::Schedule (GetSchSlot (), &MmWaveWaveChannelCoordinator::NotifyGuardSlot, this);
+  Time schSlot = GetSchSlot ();
+  m_coordination = Simulator::Schedule (schSlot, &MmWaveWaveChannelCoordinator::NotifyGuardSlot, this);
   for (ListenersI i = m_listeners.begin (); i != m_listeners.end (); ++i)
     {
-      (*i)->NotifySchSlotStart (GetSchSlot ());
+      (*i)->NotifySchSlotStart (schSlot);
     }
 }
 
@@ -368,10 +439,11 @@ void
 MmWaveWaveChannelCoordinator::NotifyCchSlot (void)
 {
   NS_LOG_FUNCTION (this);
-  m_coordination = Simulator::Schedule (GetCchSlot (), &MmWaveWaveChannelCoordinator::NotifyGuardSlot, this);
+  Time cchSlot = GetCchSlot ();
+  m_coordination = Simulator::Schedule (cchSlot, &MmWaveWaveChannelCoordinator::NotifyGuardSlot, this);
   for (ListenersI i = m_listeners.begin (); i != m_listeners.end (); ++i)
     {
-      (*i)->NotifyCchSlotStart (GetCchSlot ());
+      (*i)->NotifyCchSlotStart (cchSlot);
     }
 }
 
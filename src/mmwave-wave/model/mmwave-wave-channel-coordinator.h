@@ -67,6 +67,15 @@ public:
  *  4. Although the real channel switch time of wifi PHY layer is very fast, and the "ChannelSwitchDelay"
  *  of YansWifiPhy is 250 microseconds, here in 4ms guard interval WAVE devices
  *  cannot transmit packets while may receive packets.
+ *
+ *  Since the coordination events only depend on the simulation time, a single
+ *  coordinator can be shared by all the devices (see
+ *  MmWaveWaveHelper::SetSharedChannelCoordinator): each slot start is then one
+ *  event notifying the listeners of all the devices, in the order they registered,
+ *  instead of one event per device. The coordination starts with the first
+ *  device that is initialized; the listeners of the devices initialized later
+ *  are notified of the current slot by NotifyNewListeners. The coordinator
+ *  counts the devices that use it, and it is disposed with the last one.
  */
 class MmWaveWaveChannelCoordinator : public Object
 {
@@ -202,6 +211,23 @@ public:
    * Remove all listeners.
    */
   void UnregisterAllListeners (void);
+  /**
+   * Notify the listeners registered since the coordination started of the
+   * current slot, with the time left until its end. It is called when a
+   * device sharing an already started coordinator is initialized, so that
+   * its listeners get the slot notification they missed.
+   */
+  void NotifyNewListeners (void);
+
+  /**
+   * Count a device that uses this coordinator.
+   */
+  void AddDevice (void);
+  /**
+   * Release a device that uses this coordinator, and dispose the
+   * coordinator if no device uses it any more.
+   */
+  void RemoveDevice (void);
 
 private:
   virtual void DoDispose (void);
@@ -245,6 +271,8 @@ private:
   /// Listeners iterator typedef
   typedef std::vector<Ptr<MmWaveWaveChannelCoordinationListener> >::iterator ListenersI;
   Listeners m_listeners; ///< listeners
+  Listeners m_newListeners; ///< listeners registered since the coordination started, not notified yet
+  uint32_t m_devices; ///< number of devices using this coordinator
 
   uint32_t m_guardCount; ///< guard count
   EventId m_coordination; ///< coordination event
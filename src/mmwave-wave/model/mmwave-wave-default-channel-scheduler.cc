@@ -98,11 +98,13 @@ void
 MmWaveWaveDefaultChannelScheduler::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  m_coordinator = 0;
   if (m_coordinationListener != 0)
     {
+      // the coordinator may be shared with other devices, which keep their listeners
+      m_coordinator->UnregisterListener (m_coordinationListener);
       m_coordinationListener = 0;
     }
+  m_coordinator = 0;
   if (!m_waitEvent.IsExpired ())
     {
       m_waitEvent.Cancel ();
@@ -117,9 +117,11 @@ MmWaveWaveNetDevice::DoDispose (void)
       mac->Dispose ();
     }
   m_macEntities.clear ();
-  m_channelCoordinator->Dispose ();
-  m_channelManager->Dispose ();
+  // the scheduler unregisters its own listener, and the coordinator,
+  // which may be shared with other devices, is disposed with the last one
   m_channelScheduler->Dispose ();
+  m_channelCoordinator->RemoveDevice ();
+  m_channelManager->Dispose ();
   m_vsaManager->Dispose ();
   m_channelCoordinator = 0;
   m_channelManager = 0;
@@ -166,7 +168,10 @@ MmWaveWaveNetDevice::DoInitialize (void)
   m_channelScheduler->SetMmWaveWaveNetDevice (this);
   m_vsaManager->SetMmWaveWaveNetDevice (this);
   m_channelScheduler->Initialize ();
+  // a coordinator shared with the devices initialized before is already
+  // started, and only notifies the listeners of this device of the current slot
   m_channelCoordinator->Initialize ();
+  m_channelCoordinator->NotifyNewListeners ();
   m_channelManager->Initialize ();
   m_vsaManager->Initialize ();
   NetDevice::DoInitialize ();
@@ -484,7 +489,15 @@ MmWaveWaveNetDevice::GetMmWaveWaveChannelScheduler (void) const
 void
 MmWaveWaveNetDevice::SetMmWaveWaveChannelCoordinator (Ptr<MmWaveWaveChannelCoordinator> channelCoordinator)
 {
+  if (m_channelCoordinator != 0)
+    {
+      m_channelCoordinator->RemoveDevice ();
+    }
   m_channelCoordinator = channelCoordinator;
+  if (m_channelCoordinator != 0)
+    {
+      m_channelCoordinator->AddDevice ();
+    }
 }
 Ptr<MmWaveWaveChannelCoordinator>
 MmWaveWaveNetDevice::GetMmWaveWaveChannelCoordinator (void) const
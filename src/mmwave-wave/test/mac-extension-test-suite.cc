@@ -29,6 +29,10 @@
 
 using namespace ns3;
 
+// the test classes have the same names as those of the wave module, whose
+// test library is loaded in the same test runner
+namespace {
+
 /**
  * \ingroup wave
  * \defgroup wave-test wave module tests
@@ -88,7 +92,7 @@ private:
  *
  * \brief CoordinationTestListener is used to test channel coordination events
  */
-class CoordinationTestListener : public ChannelCoordinationListener
+class CoordinationTestListener : public MmWaveWaveChannelCoordinationListener
 {
 public:
   /**
@@ -203,7 +207,7 @@ void
 ChannelCoordinationTestCase::DoRun ()
 {
   // first test configure method
-  m_coordinator = CreateObject<ChannelCoordinator> ();
+  m_coordinator = CreateObject<MmWaveWaveChannelCoordinator> ();
   NS_TEST_EXPECT_MSG_EQ (m_coordinator->GetCchInterval (), MilliSeconds (50), "normally CCH interval is 50ms");
   NS_TEST_EXPECT_MSG_EQ (m_coordinator->GetSchInterval (), MilliSeconds (50), "normally SCH interval is 50ms");
   NS_TEST_EXPECT_MSG_EQ (m_coordinator->GetSyncInterval (), MilliSeconds (100), "normally Sync interval is 50ms");
@@ -220,7 +224,7 @@ ChannelCoordinationTestCase::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (m_coordinator->IsValidConfig (), false, "invalid configuration of channel intervals");
 
   // second test member method
-  m_coordinator = CreateObject<ChannelCoordinator> ();
+  m_coordinator = CreateObject<MmWaveWaveChannelCoordinator> ();
   Simulator::Schedule (MilliSeconds (0), &ChannelCoordinationTestCase::TestIntervalAfter, this, true, false, true);
   Simulator::Schedule (MilliSeconds (1), &ChannelCoordinationTestCase::TestIntervalAfter, this, true, false, true);
   Simulator::Schedule (MilliSeconds (3), &ChannelCoordinationTestCase::TestIntervalAfter, this, true, false, true);
@@ -256,6 +260,217 @@ ChannelCoordinationTestCase::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief SlotRecordListener records the last channel coordination event
+ */
+class SlotRecordListener : public MmWaveWaveChannelCoordinationListener
+{
+public:
+  SlotRecordListener (void)
+    : m_count (0),
+      m_cch (false),
+      m_guard (false)
+  {
+  }
+  virtual ~SlotRecordListener (void)
+  {
+  }
+  virtual void NotifyCchSlotStart (Time duration)
+  {
+    Record (duration, true, false);
+  }
+  virtual void NotifySchSlotStart (Time duration)
+  {
+    Record (duration, false, false);
+  }
+  virtual void NotifyGuardSlotStart (Time duration, bool cchi)
+  {
+    Record (duration, cchi, true);
+  }
+  /**
+   * Record an event
+   * \param duration the duration of the slot
+   * \param cch whether the slot is in the CCH interval
+   * \param guard whether the slot is a guard slot
+   */
+  void Record (Time duration, bool cch, bool guard)
+  {
+    m_count++;
+    m_time = Now ();
+    m_duration = duration;
+    m_cch = cch;
+    m_guard = guard;
+  }
+  uint32_t m_count; ///< number of events
+  Time m_time; ///< time of the last event
+  Time m_duration; ///< duration of the slot of the last event
+  bool m_cch; ///< whether the slot of the last event is in the CCH interval
+  bool m_guard; ///< whether the last event is a guard slot
+};
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief This test case tests a channel coordinator shared by two devices.
+ * In particular, it checks the following:
+ * - the device initialized after the coordination started notifies the
+ *   listeners registered since then of the current slot
+ * - disposing the first device keeps the coordination, and the listener
+ *   of the second device that switches its channel
+ * - the coordinator is disposed with the last device
+ */
+class SharedChannelCoordinationTestCase : public TestCase
+{
+public:
+  SharedChannelCoordinationTestCase (void);
+  virtual ~SharedChannelCoordinationTestCase (void);
+
+private:
+  /**
+   * Create a node with a device using the shared coordinator
+   * \returns the device
+   */
+  Ptr<MmWaveWaveNetDevice> InstallDevice (void);
+  /**
+   * Install the second device and register a listener, after the
+   * coordination started
+   */
+  void InstallLateDevice (void);
+  /**
+   * Dispose the second device
+   */
+  void DisposeLateDevice (void);
+  /**
+   * Test the notification of the current slot to the listener
+   * registered with the second device
+   */
+  void TestLateNotification (void);
+  /**
+   * Assign alternating access to the second device
+   */
+  void StartAlternatingAccess (void);
+  /**
+   * Test the channel of the second device
+   * \param channelNumber the expected channel
+   */
+  void TestChannel (uint32_t channelNumber);
+  /**
+   * Test the number of events notified to the listener
+   * \param count the expected number of events
+   */
+  void TestCount (uint32_t count);
+  virtual void DoRun (void);
+
+  Ptr<MmWaveWaveChannelCoordinator> m_coordinator; ///< shared coordinator
+  Ptr<MmWaveWaveNetDevice> m_first; ///< device initialized at the start
+  Ptr<MmWaveWaveNetDevice> m_second; ///< device initialized later
+  Ptr<SlotRecordListener> m_listener; ///< listener registered with the second device
+};
+
+SharedChannelCoordinationTestCase::SharedChannelCoordinationTestCase (void)
+  : TestCase ("shared-channel-coordination")
+{
+}
+SharedChannelCoordinationTestCase::~SharedChannelCoordinationTestCase (void)
+{
+}
+
+Ptr<MmWaveWaveNetDevice>
+SharedChannelCoordinationTestCase::InstallDevice (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (node);
+  MmWaveWaveHelper waveHelper = MmWaveWaveHelper::Default ();
+  waveHelper.SetPropagationLossModel ("ns3::MmWaveV2VPropagationLossModel");
+  waveHelper.SetSharedChannelCoordinator (m_coordinator);
+  return DynamicCast<MmWaveWaveNetDevice> (waveHelper.Install (node).Get (0));
+}
+
+void
+SharedChannelCoordinationTestCase::InstallLateDevice (void)
+{
+  // the node, and so the device, is initialized after this event
+  m_second = InstallDevice ();
+  m_listener = Create<SlotRecordListener> ();
+  m_coordinator->RegisterListener (m_listener);
+  NS_TEST_EXPECT_MSG_EQ (m_listener->m_count, 0, "the listener shall be notified by the initialization of the device");
+}
+
+void
+SharedChannelCoordinationTestCase::DisposeLateDevice (void)
+{
+  m_second->Dispose ();
+}
+
+void
+SharedChannelCoordinationTestCase::TestLateNotification (void)
+{
+  // the device is initialized at 120ms, in the CCH slot of 104ms to 150ms
+  NS_TEST_EXPECT_MSG_EQ (m_listener->m_count, 1, "the listener shall be notified of the current slot once");
+  NS_TEST_EXPECT_MSG_EQ (m_listener->m_time, MilliSeconds (120), "the current slot shall be notified at the initialization");
+  NS_TEST_EXPECT_MSG_EQ ((m_listener->m_cch && !m_listener->m_guard), true, "the current slot is a CCH slot");
+  NS_TEST_EXPECT_MSG_EQ (m_listener->m_duration, MilliSeconds (30), "the duration shall be the time left in the slot");
+}
+
+void
+SharedChannelCoordinationTestCase::StartAlternatingAccess (void)
+{
+  const SchInfo schInfo = SchInfo (SCH1, false, EXTENDED_ALTERNATING);
+  NS_TEST_EXPECT_MSG_EQ (m_second->StartSch (schInfo), true, "alternating access shall be assigned");
+}
+
+void
+SharedChannelCoordinationTestCase::TestChannel (uint32_t channelNumber)
+{
+  uint32_t now = Now ().GetMilliSeconds ();
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)m_second->GetPhy (0)->GetChannelNumber (), channelNumber, "now is " << now << "ms "
+                         "check the channel of the second device");
+}
+
+void
+SharedChannelCoordinationTestCase::TestCount (uint32_t count)
+{
+  uint32_t now = Now ().GetMilliSeconds ();
+  NS_TEST_EXPECT_MSG_EQ (m_listener->m_count, count, "now is " << now << "ms "
+                         "check the number of channel coordination events");
+}
+
+void
+SharedChannelCoordinationTestCase::DoRun ()
+{
+  m_coordinator = CreateObject<MmWaveWaveChannelCoordinator> ();
+  m_first = InstallDevice ();
+  Simulator::Schedule (MilliSeconds (120), &SharedChannelCoordinationTestCase::InstallLateDevice, this);
+  Simulator::Schedule (MicroSeconds (120001), &SharedChannelCoordinationTestCase::TestLateNotification, this);
+  Simulator::Schedule (MilliSeconds (130), &SharedChannelCoordinationTestCase::StartAlternatingAccess, this);
+  // the guard slots start at 150ms, 200ms, ... and the channel is switched
+  // to the SCH in the SCH interval, and back to the CCH in the CCH interval
+  Simulator::Schedule (MilliSeconds (175), &SharedChannelCoordinationTestCase::TestChannel, this, SCH1);
+  Simulator::Schedule (MilliSeconds (210), &MmWaveWaveNetDevice::Dispose, m_first);
+  Simulator::Schedule (MilliSeconds (225), &SharedChannelCoordinationTestCase::TestChannel, this, CCH);
+  Simulator::Schedule (MilliSeconds (275), &SharedChannelCoordinationTestCase::TestChannel, this, SCH1);
+  Simulator::Schedule (MilliSeconds (325), &SharedChannelCoordinationTestCase::TestChannel, this, CCH);
+  // the current slot, then the guard and SCH slots at 150ms and 154ms, ...,
+  // and the guard and CCH slots at 300ms and 304ms
+  Simulator::Schedule (MilliSeconds (345), &SharedChannelCoordinationTestCase::TestCount, this, 1 + 8);
+  // the coordinator is disposed with the second device, and stops
+  Simulator::Schedule (MilliSeconds (345), &SharedChannelCoordinationTestCase::DisposeLateDevice, this);
+  Simulator::Schedule (MilliSeconds (500), &SharedChannelCoordinationTestCase::TestCount, this, 1 + 8);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_first = 0;
+  m_second = 0;
+  m_listener = 0;
+  m_coordinator = 0;
+}
+
 /**
  * \ingroup wave-test
  * \ingroup tests
@@ -296,12 +511,9 @@ TestCaseHelper::CreatWaveDevice (uint32_t nodesNumber)
       model->SetPosition (Vector (x, y,0));
     }
 
-  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
-  YansWavePhyHelper wifiPhy =  YansWavePhyHelper::Default ();
-  wifiPhy.SetChannel (wifiChannel.Create ());
-  QosMmWaveWaveMacHelper waveMac = QosMmWaveWaveMacHelper::Default ();
   MmWaveWaveHelper waveHelper = MmWaveWaveHelper::Default ();
-  NetDeviceContainer devices = waveHelper.Install (wifiPhy, waveMac, nodes);
+  waveHelper.SetPropagationLossModel ("ns3::MmWaveV2VPropagationLossModel");
+  NetDeviceContainer devices = waveHelper.Install (nodes);
   return devices;
 }
 
@@ -354,7 +566,7 @@ private:
    */
   bool ReceiveVsa (Ptr<const Packet> pkt,const Address & address, uint32_t, uint32_t);
 
-  Ptr<WaveNetDevice>  m_sender; ///< sender
+  Ptr<MmWaveWaveNetDevice>  m_sender; ///< sender
 };
 
 ChannelRoutingTestCase::ChannelRoutingTestCase (void)
@@ -400,14 +612,14 @@ ChannelRoutingTestCase::DoRun ()
   //  check SendX method for WSMP packets
   {
     NetDeviceContainer devices = TestCaseHelper::CreatWaveDevice (1);
-    m_sender = DynamicCast<WaveNetDevice> (devices.Get (0));
+    m_sender = DynamicCast<MmWaveWaveNetDevice> (devices.Get (0));
 
     Simulator::Schedule (Seconds (0.1), &ChannelRoutingTestCase::SendWsmp, this, true, TxInfo (CCH));
     Simulator::Schedule (Seconds (0.1), &ChannelRoutingTestCase::SendWsmp, this, false, TxInfo (SCH1));
     Simulator::Schedule (Seconds (0.1), &ChannelRoutingTestCase::SendWsmp, this, false, TxInfo (SCH2));
 
     const SchInfo schInfo = SchInfo (SCH1, false, EXTENDED_ALTERNATING);
-    Simulator::Schedule (Seconds (0.2), &WaveNetDevice::StartSch, m_sender, schInfo);
+    Simulator::Schedule (Seconds (0.2), &MmWaveWaveNetDevice::StartSch, m_sender, schInfo);
 
     Simulator::Schedule (Seconds (0.3), &ChannelRoutingTestCase::SendWsmp, this, true, TxInfo (CCH));
     Simulator::Schedule (Seconds (0.3), &ChannelRoutingTestCase::SendWsmp, this, true, TxInfo (SCH1));
@@ -429,7 +641,7 @@ ChannelRoutingTestCase::DoRun ()
     Simulator::Schedule (Seconds (0.4), &ChannelRoutingTestCase::SendWsmp, this, true, TxInfo (CCH, 7, WifiMode (), WIFI_PREAMBLE_LONG, 8));
 
     // release channel access at 0.6s
-    Simulator::Schedule (Seconds (0.5), &WaveNetDevice::StopSch, m_sender, SCH1);
+    Simulator::Schedule (Seconds (0.5), &MmWaveWaveNetDevice::StopSch, m_sender, SCH1);
 
     // the packet will be dropped because channel access is not assigned again
     Simulator::Schedule (Seconds (0.6), &ChannelRoutingTestCase::SendWsmp, this, true, TxInfo (CCH));
@@ -444,33 +656,33 @@ ChannelRoutingTestCase::DoRun ()
   // check Send method for IP-based packets
   {
     NetDeviceContainer devices = TestCaseHelper::CreatWaveDevice (1);
-    m_sender = DynamicCast<WaveNetDevice> (devices.Get (0));
+    m_sender = DynamicCast<MmWaveWaveNetDevice> (devices.Get (0));
 
     bool ipv6 = true, ipv4 = false;
     Simulator::Schedule (Seconds (0.1), &ChannelRoutingTestCase::SendIp, this, false, ipv6);
     Simulator::Schedule (Seconds (0.1), &ChannelRoutingTestCase::SendIp, this, false, ipv4);
 
     const SchInfo schInfo = SchInfo (SCH1, false, EXTENDED_ALTERNATING);
-    Simulator::Schedule (Seconds (0.2), &WaveNetDevice::StartSch, m_sender, schInfo);
+    Simulator::Schedule (Seconds (0.2), &MmWaveWaveNetDevice::StartSch, m_sender, schInfo);
 
     Simulator::Schedule (Seconds (0.3), &ChannelRoutingTestCase::SendIp, this, false, ipv6);
     Simulator::Schedule (Seconds (0.3), &ChannelRoutingTestCase::SendIp, this, false, ipv4);
 
     TxProfile txProfile = TxProfile (SCH1);
-    Simulator::Schedule (Seconds (0.4), &WaveNetDevice::RegisterTxProfile, m_sender, txProfile);
+    Simulator::Schedule (Seconds (0.4), &MmWaveWaveNetDevice::RegisterTxProfile, m_sender, txProfile);
 
     Simulator::Schedule (Seconds (0.5), &ChannelRoutingTestCase::SendIp, this, true, ipv6);
     Simulator::Schedule (Seconds (0.5), &ChannelRoutingTestCase::SendIp, this, true, ipv4);
 
     // unregister txprofile
-    Simulator::Schedule (Seconds (0.5), &WaveNetDevice::DeleteTxProfile, m_sender,SCH1);
+    Simulator::Schedule (Seconds (0.5), &MmWaveWaveNetDevice::DeleteTxProfile, m_sender,SCH1);
 
     Simulator::Schedule (Seconds (0.6), &ChannelRoutingTestCase::SendIp, this, false, ipv6);
     Simulator::Schedule (Seconds (0.6), &ChannelRoutingTestCase::SendIp, this, false, ipv4);
 
     // release channel access
     // mac entities have no channel resource even phy device has ability to send
-    Simulator::Schedule (Seconds (0.7),&WaveNetDevice::StopSch, m_sender, SCH1);
+    Simulator::Schedule (Seconds (0.7),&MmWaveWaveNetDevice::StopSch, m_sender, SCH1);
 
     Simulator::Schedule (Seconds (0.8), &ChannelRoutingTestCase::SendIp, this, false, ipv6);
     Simulator::Schedule (Seconds (0.8), &ChannelRoutingTestCase::SendIp, this, false, ipv4);
@@ -483,7 +695,7 @@ ChannelRoutingTestCase::DoRun ()
   // check StartVsa method for WSA management frames
   {
     NetDeviceContainer devices = TestCaseHelper::CreatWaveDevice (1);
-    m_sender = DynamicCast<WaveNetDevice> (devices.Get (0));
+    m_sender = DynamicCast<MmWaveWaveNetDevice> (devices.Get (0));
 
     Ptr<Packet> packet = Create<Packet> (100);
     const Mac48Address dest = Mac48Address::GetBroadcast ();
@@ -495,10 +707,10 @@ ChannelRoutingTestCase::DoRun ()
 
     vsaInfo.channelNumber = CCH;
     Simulator::Schedule (Seconds (0.3), &ChannelRoutingTestCase::SendWsa, this, true, vsaInfo);
-    Simulator::Schedule (Seconds (0.39), &WaveNetDevice::StopVsa, m_sender, CCH);
+    Simulator::Schedule (Seconds (0.39), &MmWaveWaveNetDevice::StopVsa, m_sender, CCH);
 
     const SchInfo schInfo = SchInfo (SCH1, false, EXTENDED_ALTERNATING);
-    Simulator::Schedule (Seconds (0.4), &WaveNetDevice::StartSch, m_sender, schInfo);
+    Simulator::Schedule (Seconds (0.4), &MmWaveWaveNetDevice::StartSch, m_sender, schInfo);
     vsaInfo.channelNumber = CCH;
     Simulator::Schedule (Seconds (0.4), &ChannelRoutingTestCase::SendWsa, this, true, vsaInfo);
     vsaInfo.channelNumber = SCH1;
@@ -506,9 +718,9 @@ ChannelRoutingTestCase::DoRun ()
     vsaInfo.channelNumber = SCH2;
     Simulator::Schedule (Seconds (0.4), &ChannelRoutingTestCase::SendWsa, this, false, vsaInfo);
 
-    Simulator::Schedule (Seconds (0.49), &WaveNetDevice::StopVsa, m_sender, CCH);
-    Simulator::Schedule (Seconds (0.49), &WaveNetDevice::StopVsa, m_sender, SCH1);
-    Simulator::Schedule (Seconds (0.49),&WaveNetDevice::StopSch, m_sender, SCH1);
+    Simulator::Schedule (Seconds (0.49), &MmWaveWaveNetDevice::StopVsa, m_sender, CCH);
+    Simulator::Schedule (Seconds (0.49), &MmWaveWaveNetDevice::StopVsa, m_sender, SCH1);
+    Simulator::Schedule (Seconds (0.49),&MmWaveWaveNetDevice::StopSch, m_sender, SCH1);
 
     vsaInfo.channelNumber = CCH;
     Simulator::Schedule (Seconds (0.5), &ChannelRoutingTestCase::SendWsa, this, true, vsaInfo);
@@ -525,7 +737,7 @@ ChannelRoutingTestCase::DoRun ()
 
 /**
  * This test case tests channel access assignments which is done by
- * StartSch and StopSch method of WaveNetDevice.
+ * StartSch and StopSch method of MmWaveWaveNetDevice.
  * channel access assignments include ContinuousAccess, ExtendedAccess,
  * and AlternatingAccess.
  * The results of this test case depend on the implementation of ChannelScheduler
@@ -593,7 +805,7 @@ private:
   virtual void DoRun (void);
 
   NetDeviceContainer m_devices; ///< the devices
-  Ptr<WaveNetDevice>  m_sender; ///< sender
+  Ptr<MmWaveWaveNetDevice>  m_sender; ///< sender
   uint32_t m_received; ///< received
 };
 
@@ -614,7 +826,7 @@ ChannelAccessTestCase::TestContinuous (SchInfo &info, bool shouldSucceed)
 void
 ChannelAccessTestCase::TestContinuousAfter (uint32_t channelNumber, bool isAccessAssigned)
 {
-  bool result = m_sender->GetChannelScheduler ()->IsContinuousAccessAssigned (channelNumber);
+  bool result = m_sender->GetMmWaveWaveChannelScheduler ()->IsContinuousAccessAssigned (channelNumber);
   NS_TEST_EXPECT_MSG_EQ (result, isAccessAssigned, "TestContinuousAfter fail at " << Now ().GetSeconds ());
 }
 void
@@ -626,7 +838,7 @@ ChannelAccessTestCase::TestExtended (SchInfo &info, bool shouldSucceed)
 void
 ChannelAccessTestCase::TestExtendedAfter (uint32_t channelNumber, bool isAccessAssigned)
 {
-  bool result = m_sender->GetChannelScheduler ()->IsExtendedAccessAssigned (channelNumber);
+  bool result = m_sender->GetMmWaveWaveChannelScheduler ()->IsExtendedAccessAssigned (channelNumber);
   NS_TEST_EXPECT_MSG_EQ (result, isAccessAssigned, "TestExtendedAfter fail at " << Now ().GetSeconds ());
 }
 
@@ -639,7 +851,7 @@ ChannelAccessTestCase::TestAlternating (SchInfo &info, bool shouldSucceed)
 void
 ChannelAccessTestCase::TestAlternatingAfter (uint32_t channelNumber, bool isAccessAssigned)
 {
-  bool result = m_sender->GetChannelScheduler ()->IsAlternatingAccessAssigned (channelNumber);
+  bool result = m_sender->GetMmWaveWaveChannelScheduler ()->IsAlternatingAccessAssigned (channelNumber);
   NS_TEST_EXPECT_MSG_EQ (result, isAccessAssigned, "TestAlternating fail at " << Now ().GetSeconds ());
 }
 
@@ -720,7 +932,7 @@ ChannelAccessTestCase::DoRun ()
   // test ContinuousAccess in the sender side
   {
     m_devices = TestCaseHelper::CreatWaveDevice (1);
-    m_sender = DynamicCast<WaveNetDevice> (m_devices.Get (0));
+    m_sender = DynamicCast<MmWaveWaveNetDevice> (m_devices.Get (0));
 
     // there is no need for assigning CCH continuous access.
     SchInfo info = SchInfo (CCH, false, EXTENDED_CONTINUOUS);
@@ -746,7 +958,7 @@ ChannelAccessTestCase::DoRun ()
     Simulator::Schedule (Seconds (4), &ChannelAccessTestCase::TestContinuous, this, info, false);
 
     // then we release channel access at 0.5s
-    Simulator::Schedule (Seconds (5), &WaveNetDevice::StopSch, m_sender, SCH1);
+    Simulator::Schedule (Seconds (5), &MmWaveWaveNetDevice::StopSch, m_sender, SCH1);
 
     info = SchInfo (SCH2, false, EXTENDED_CONTINUOUS);
     // succeed to assign access for other SCH is previous SCH access is released
@@ -772,7 +984,7 @@ ChannelAccessTestCase::DoRun ()
         static std::vector<uint32_t> WaveChannels = MmWaveWaveChannelManager::GetWaveChannels ();
         uint32_t channel = WaveChannels[i - 1];
         const SchInfo info = SchInfo (channel, false, EXTENDED_CONTINUOUS);
-        Simulator::Schedule (Seconds (0), &WaveNetDevice::StartSch, device, info);
+        Simulator::Schedule (Seconds (0), &MmWaveWaveNetDevice::StartSch, device, info);
       }
 
     // at 0s, the sender is assigned DefaultCchAccess, so only node-1 can receive packets.
@@ -787,7 +999,7 @@ ChannelAccessTestCase::DoRun ()
 
     // at 1s, the sender is assigned ContinuousAccess for SCH1, so only node-2 can receive packets.
     SchInfo info = SchInfo (SCH1, false, EXTENDED_CONTINUOUS);
-    Simulator::Schedule (Seconds (1), &WaveNetDevice::StartSch, m_sender, info);
+    Simulator::Schedule (Seconds (1), &MmWaveWaveNetDevice::StartSch, m_sender, info);
     Simulator::Schedule (Seconds (1.1), &ChannelAccessTestCase::SendX, this, SCH1, 2);
     // other channel access cannot receive packets
     Simulator::Schedule (Seconds (1.1), &ChannelAccessTestCase::SendX, this, CCH, 0);
@@ -843,7 +1055,7 @@ ChannelAccessTestCase::DoRun ()
     Simulator::Schedule (Seconds (4), &ChannelAccessTestCase::TestExtended, this, info, true);
 
     // stop it at 5s even the end of extended access is (4s + 100ms + 100ms * 10) = 5.1s
-    Simulator::Schedule (Seconds (5), &WaveNetDevice::StopSch, m_sender, SCH2);
+    Simulator::Schedule (Seconds (5), &MmWaveWaveNetDevice::StopSch, m_sender, SCH2);
 
     Simulator::Schedule (Seconds (5), &ChannelAccessTestCase::TestExtendedAfter, this, SCH2, false);
     Simulator::Schedule (Seconds (5.1), &ChannelAccessTestCase::TestExtendedAfter, this, SCH2, false);
@@ -885,7 +1097,7 @@ ChannelAccessTestCase::DoRun ()
     // at 1s, the sender is assigned ExtendedAccess for SCH1 with extends 10,
     //, so only node-2 can receive packets from 1s - 2.1s ( 1s + 100ms + 100ms * 10)
     SchInfo info = SchInfo (SCH1, false, 10);
-    Simulator::Schedule (Seconds (1), &WaveNetDevice::StartSch, m_sender, info);
+    Simulator::Schedule (Seconds (1), &MmWaveWaveNetDevice::StartSch, m_sender, info);
     Simulator::Schedule (Seconds (1.1), &ChannelAccessTestCase::SendX, this, SCH1, 2);
     // other channel access cannot receive packets
     Simulator::Schedule (Seconds (1.1), &ChannelAccessTestCase::SendX, this, CCH, 0);
@@ -994,7 +1206,7 @@ ChannelAccessTestCase::DoRun ()
     Simulator::Schedule (Seconds (1.1), &ChannelAccessTestCase::SendX, this, SCH5, 0);
     Simulator::Schedule (Seconds (1.1), &ChannelAccessTestCase::SendX, this, SCH6, 0);
 
-    Simulator::Schedule (Seconds (2), &WaveNetDevice::StopSch, m_sender, SCH1);
+    Simulator::Schedule (Seconds (2), &MmWaveWaveNetDevice::StopSch, m_sender, SCH1);
     // if ContinuousAccess for SCH1 is released, node-2 cannot receive packets again
     Simulator::Schedule (Seconds (2.1), &ChannelAccessTestCase::SendX, this, CCH, 1);
     Simulator::Schedule (Seconds (2.1), &ChannelAccessTestCase::SendX, this, SCH1, 0);
@@ -1125,19 +1337,19 @@ AnnexC_TestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mo
 
   if (seq == 1)
     {
-      NS_TEST_EXPECT_MSG_GT (duration, ChannelCoordinator::GetDefaultSchInterval (), "fail to test Annex C when packet sequence is " << seq);
+      NS_TEST_EXPECT_MSG_GT (duration, MmWaveWaveChannelCoordinator::GetDefaultSchInterval (), "fail to test Annex C when packet sequence is " << seq);
     }
   else if (seq == 2)
     {
-      NS_TEST_EXPECT_MSG_LT (duration, ChannelCoordinator::GetDefaultSchInterval (), "fail to test Annex C when packet sequence is " << seq);
+      NS_TEST_EXPECT_MSG_LT (duration, MmWaveWaveChannelCoordinator::GetDefaultSchInterval (), "fail to test Annex C when packet sequence is " << seq);
     }
   else if (seq == 3)
     {
-      NS_TEST_EXPECT_MSG_GT (duration, ChannelCoordinator::GetDefaultCchInterval (), "fail to test Annex C when packet sequence is " << seq);
+      NS_TEST_EXPECT_MSG_GT (duration, MmWaveWaveChannelCoordinator::GetDefaultCchInterval (), "fail to test Annex C when packet sequence is " << seq);
     }
   else if (seq == 4)
     {
-      NS_TEST_EXPECT_MSG_LT (duration, ChannelCoordinator::GetDefaultCchInterval (), "fail to test Annex C when packet sequence is " << seq);
+      NS_TEST_EXPECT_MSG_LT (duration, MmWaveWaveChannelCoordinator::GetDefaultCchInterval (), "fail to test Annex C when packet sequence is " << seq);
     }
   return true;
 }
@@ -1194,10 +1406,11 @@ public:
 };
 
 WaveMacTestSuite::WaveMacTestSuite ()
-  : TestSuite ("wave-mac-extension", UNIT)
+  : TestSuite ("mmwave-wave-mac-extension", UNIT)
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new ChannelCoordinationTestCase, TestCase::QUICK);
+  AddTestCase (new SharedChannelCoordinationTestCase, TestCase::QUICK);
   AddTestCase (new ChannelRoutingTestCase, TestCase::QUICK);
   AddTestCase (new ChannelAccessTestCase, TestCase::QUICK);
   AddTestCase (new AnnexC_TestCase, TestCase::QUICK);
@@ -1205,3 +1418,5 @@ WaveMacTestSuite::WaveMacTestSuite ()
 
 // Do not forget to allocate an instance of this TestSuite
 static WaveMacTestSuite waveMacTestSuite; ///< the test suite
+
+} // unnamed namespace
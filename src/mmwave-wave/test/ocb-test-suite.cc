@@ -34,11 +34,15 @@
 #include "ns3/wifi-net-device.h"
 #include "ns3/packet-socket-server.h"
 #include "ns3/packet-socket-client.h"
-#include "ns3/ocb-wifi-mac.h"
-#include "ns3/wifi-80211p-helper.h"
-#include "ns3/wave-mac-helper.h"
+#include "ns3/mmwave-wave-ocb-wifi-mac.h"
+#include "ns3/mmwave-wifi-80211p-helper.h"
+#include "ns3/mmwave-wave-mac-helper.h"
 
 using namespace ns3;
+
+// the test classes have the same names as those of the wave module, whose
+// test library is loaded in the same test runner
+namespace {
 // helper function to assign streams to random variables, to control
 // randomness in the tests
 static void
@@ -462,3 +466,4 @@ OcbTestSuite::OcbTestSuite ()
 // Do not forget to allocate an instance of this TestSuite
 static OcbTestSuite ocbTestSuite; ///< the test suite
 
+} // unnamed namespace
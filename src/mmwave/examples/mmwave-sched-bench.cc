@@ -0,0 +1,493 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+/*
+ * Micro-benchmark of the MAC schedulers of the mmwave module.
+ *
+ * Each scheduler is driven in isolation through its SAPs, without the MAC,
+ * the PHY or the event loop. A synthetic stream of DL-CQI, UL-CQI, RLC
+ * buffer status, BSR and HARQ feedback is generated for each subframe, and
+ * the program reports the time and the heap allocations spent by the
+ * scheduler per subframe (TTI). The generation of the reports is not
+ * measured.
+ *
+ * It is a program rather than a test suite because it measures instead of
+ * checking: its timings have no pass/fail threshold, and it counts the heap
+ * allocations by replacing the global operator new, which must not be done
+ * in the test runner that links all the modules. It is built with the
+ * examples:
+ *
+ * ./waf configure --enable-examples
+ * ./waf --run "mmwave-sched-bench --numUes=10,100,1000 --ttis=1000"
+ *
+ * test.py runs it with a few UEs, as listed in src/mmwave/test/examples-to-run.py,
+ * so that it keeps building and running.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/mmwave-mac-scheduler.h"
+#include "ns3/mmwave-mac-sched-sap.h"
+#include "ns3/mmwave-mac-csched-sap.h"
+#include "ns3/lte-common.h"
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSchedBench");
+
+// heap allocations of the whole process, counted by the replacement of the
+// global operator new, which is also used by the ns-3 libraries
+static uint64_t g_numAllocs = 0;
+static uint64_t g_allocBytes = 0;
+
+void*
+operator new (std::size_t size)
+{
+  g_numAllocs++;
+  g_allocBytes += size;
+  void *p = std::malloc (size > 0 ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * \brief MAC side of the SCHED SAP, which keeps the allocation of the last
+ * subframe so that the feedback of the following subframes can be generated
+ */
+class BenchSchedSapUser : public MmWaveMacSchedSapUser
+{
+public:
+  virtual void SchedConfigInd (struct SchedConfigIndParameters&& params)
+  {
+    m_ind = std::move (params);
+  }
+
+  SchedConfigIndParameters m_ind;
+};
+
+/**
+ * \brief MAC side of the CSCHED SAP, which ignores the confirmations
+ */
+class BenchCschedSapUser : public MmWaveMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+  {
+  }
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+  {
+  }
+};
+
+/**
+ * \brief Cost of a scheduler over a number of subframes
+ */
+struct BenchResult
+{
+  uint32_t m_numTtis;
+  double m_elapsedNs;
+  uint64_t m_numAllocs;
+  uint64_t m_allocBytes;
+  uint64_t m_numSlots;
+};
+
+/**
+ * \brief Drives a scheduler with a synthetic traffic of a set of UEs
+ */
+class SchedBench
+{
+public:
+  /**
+   * @param the TypeId name of the scheduler
+   * @param the number of UEs
+   * @param the probability that a UE reports a DL-CQI, a RLC buffer
+   * status and a BSR in a subframe
+   * @param the probability of a NACK for each transmitted TB
+   */
+  SchedBench (std::string schedType, uint16_t numUes, double reportProb, double nackProb);
+
+  /**
+   * Run a number of subframes
+   * @param the number of subframes
+   * @returns the cost of the scheduler, accumulated over the subframes
+   */
+  BenchResult Run (uint32_t numTtis);
+
+private:
+  /**
+   * Generate the reports received by the MAC before the next subframe
+   */
+  void PrepareTti ();
+
+  /**
+   * Give the reports of the subframe to the scheduler and trigger it
+   */
+  void RunTti ();
+
+  /**
+   * Generate the HARQ feedback and the UL-CQI of the allocation of the last subframe
+   */
+  void ProcessAllocation ();
+
+  Ptr<MmWavePhyMacCommon> m_phyMacConfig;
+  Ptr<MmWaveMacScheduler> m_sched;
+  MmWaveMacSchedSapProvider* m_schedSapProvider;
+  MmWaveMacCschedSapProvider* m_cschedSapProvider;
+  BenchSchedSapUser m_schedSapUser;
+  BenchCschedSapUser m_cschedSapUser;
+
+  uint16_t m_numUes;
+  double m_reportProb;
+  double m_nackProb;
+  uint32_t m_tti;
+  Ptr<UniformRandomVariable> m_random;
+
+  // reports of the next subframe
+  MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters m_dlCqi;
+  std::vector<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> m_rlcBuffers;
+  MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters m_bsr;
+  MmWaveMacSchedSapProvider::SchedTriggerReqParameters m_trigger;
+  // feedback of the UL allocations, received UlSchedDelay subframes later
+  std::deque<std::vector<MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters> > m_ulCqis;
+  std::deque<std::vector<UlHarqInfo> > m_ulHarqs;
+};
+
+SchedBench::SchedBench (std::string schedType, uint16_t numUes, double reportProb, double nackProb)
+  : m_numUes (numUes),
+    m_reportProb (reportProb),
+    m_nackProb (nackProb),
+    m_tti (0)
+{
+  m_phyMacConfig = CreateObject<MmWavePhyMacCommon> ();
+  m_random = CreateObject<UniformRandomVariable> ();
+
+  ObjectFactory factory;
+  factory.SetTypeId (schedType);
+  m_sched = factory.Create<MmWaveMacScheduler> ();
+  m_sched->ConfigureCommonParameters (m_phyMacConfig);
+  m_sched->SetMacSchedSapUser (&m_schedSapUser);
+  m_sched->SetMacCschedSapUser (&m_cschedSapUser);
+  m_schedSapProvider = m_sched->GetMacSchedSapProvider ();
+  m_cschedSapProvider = m_sched->GetMacCschedSapProvider ();
+
+  MmWaveMacCschedSapProvider::CschedCellConfigReqParameters cellParams;
+  cellParams.m_ulBandwidth = m_phyMacConfig->GetNumRb ();
+  cellParams.m_dlBandwidth = m_phyMacConfig->GetNumRb ();
+  m_cschedSapProvider->CschedCellConfigReq (cellParams);
+
+  // each UE has a single data radio bearer, configured as done by MmWaveEnbMac
+  for (uint16_t rnti = 1; rnti <= m_numUes; rnti++)
+    {
+      MmWaveMacCschedSapProvider::CschedUeConfigReqParameters ueParams;
+      ueParams.m_rnti = rnti;
+      ueParams.m_transmissionMode = 0;
+      m_cschedSapProvider->CschedUeConfigReq (ueParams);
+
+      MmWaveMacCschedSapProvider::CschedLcConfigReqParameters lcParams;
+      lcParams.m_rnti = rnti;
+      lcParams.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lccle;
+      lccle.m_logicalChannelIdentity = 3;
+      lccle.m_logicalChannelGroup = 3;
+      lccle.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lccle.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lccle.m_qci = 9;
+      lccle.m_eRabMaximulBitrateUl = 0;
+      lccle.m_eRabMaximulBitrateDl = 0;
+      lccle.m_eRabGuaranteedBitrateUl = 0;
+      lccle.m_eRabGuaranteedBitrateDl = 0;
+      lcParams.m_logicalChannelConfigList.push_back (lccle);
+      m_cschedSapProvider->CschedLcConfigReq (lcParams);
+
+      m_trigger.m_ueList.push_back (rnti);
+    }
+
+  for (unsigned i = 0; i < m_phyMacConfig->GetUlSchedDelay (); i++)
+    {
+      m_ulCqis.push_back (std::vector<MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters> ());
+      m_ulHarqs.push_back (std::vector<UlHarqInfo> ());
+    }
+}
+
+BenchResult
+SchedBench::Run (uint32_t numTtis)
+{
+  BenchResult result;
+  result.m_numTtis = numTtis;
+  result.m_elapsedNs = 0;
+  result.m_numAllocs = 0;
+  result.m_allocBytes = 0;
+  result.m_numSlots = 0;
+  for (uint32_t i = 0; i < numTtis; i++)
+    {
+      PrepareTti ();
+
+      uint64_t numAllocs = g_numAllocs;
+      uint64_t allocBytes = g_allocBytes;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      RunTti ();
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+      result.m_elapsedNs += std::chrono::duration<double, std::nano> (end - start).count ();
+      result.m_numAllocs += g_numAllocs - numAllocs;
+      result.m_allocBytes += g_allocBytes - allocBytes;
+
+      result.m_numSlots += m_schedSapUser.m_ind.m_sfAllocInfo.m_slotAllocInfo.size ();
+      ProcessAllocation ();
+      m_tti++;
+    }
+  return result;
+}
+
+void
+SchedBench::PrepareTti ()
+{
+  uint32_t sfPerFrame = m_phyMacConfig->GetSubframesPerFrame ();
+  SfnSf sfn (m_tti / sfPerFrame, m_tti % sfPerFrame, 0);
+
+  m_dlCqi.m_sfnsf = sfn;
+  m_dlCqi.m_cqiList.clear ();
+  m_rlcBuffers.clear ();
+  m_bsr.m_sfnSf = sfn;
+  m_bsr.m_macCeList.clear ();
+  for (uint16_t rnti = 1; rnti <= m_numUes; rnti++)
+    {
+      if (m_random->GetValue () < m_reportProb)
+        {
+          DlCqiInfo cqi;
+          cqi.m_rnti = rnti;
+          cqi.m_ri = 1;
+          cqi.m_cqiType = DlCqiInfo::WB;
+          cqi.m_wbCqi = m_random->GetInteger (1, 15);
+          cqi.m_wbPmi = 0;
+          m_dlCqi.m_cqiList.push_back (cqi);
+        }
+      if (m_random->GetValue () < m_reportProb)
+        {
+          MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+          rlc.m_rnti = rnti;
+          rlc.m_logicalChannelIdentity = 3;
+          rlc.m_rlcTransmissionQueueSize = m_random->GetInteger (0, 20000);
+          rlc.m_rlcTransmissionQueueHolDelay = 0;
+          rlc.m_rlcRetransmissionQueueSize = 0;
+          rlc.m_rlcRetransmissionHolDelay = 0;
+          rlc.m_rlcStatusPduSize = 0;
+          rlc.m_arrivalRate = 0;
+          if (rlc.m_rlcTransmissionQueueSize > 0)
+            {
+              rlc.m_txPacketSizes.push_back (rlc.m_rlcTransmissionQueueSize);
+              rlc.m_txPacketDelays.push_back (0);
+            }
+          m_rlcBuffers.push_back (rlc);
+        }
+      if (m_random->GetValue () < m_reportProb)
+        {
+          MacCeElement bsr;
+          bsr.m_rnti = rnti;
+          bsr.m_macCeType = MacCeElement::BSR;
+          bsr.m_macCeValue.m_phr = 0;
+          bsr.m_macCeValue.m_crnti = 0;
+          bsr.m_macCeValue.m_bufferStatus.assign (4, 0);
+          bsr.m_macCeValue.m_bufferStatus[2] = BufferSizeLevelBsr::BufferSize2BsrId (m_random->GetInteger (0, 20000));
+          m_bsr.m_macCeList.push_back (bsr);
+        }
+    }
+
+  // the MAC triggers the scheduler for the subframe L1L2CtrlLatency subframes ahead
+  uint32_t schedTti = m_tti + m_phyMacConfig->GetL1L2CtrlLatency ();
+  m_trigger.m_snfSf = SfnSf (schedTti / sfPerFrame, schedTti % sfPerFrame, 0);
+  m_trigger.m_ulHarqInfoList.swap (m_ulHarqs.front ());
+  m_ulHarqs.front ().clear ();
+}
+
+void
+SchedBench::RunTti ()
+{
+  m_schedSapProvider->SchedDlCqiInfoReq (m_dlCqi);
+  for (unsigned i = 0; i < m_ulCqis.front ().size (); i++)
+    {
+      m_schedSapProvider->SchedUlCqiInfoReq (m_ulCqis.front ()[i]);
+    }
+  if (m_bsr.m_macCeList.size () > 0)
+    {
+      m_schedSapProvider->SchedUlMacCtrlInfoReq (m_bsr);
+    }
+  for (unsigned i = 0; i < m_rlcBuffers.size (); i++)
+    {
+      m_schedSapProvider->SchedDlRlcBufferReq (m_rlcBuffers[i]);
+    }
+  m_schedSapProvider->SchedTriggerReq (m_trigger);
+}
+
+void
+SchedBench::ProcessAllocation ()
+{
+  // the feedback delivered in this subframe is consumed, reuse its vectors
+  std::vector<MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters> ulCqis;
+  ulCqis.swap (m_ulCqis.front ());
+  ulCqis.clear ();
+  m_ulCqis.pop_front ();
+  std::vector<UlHarqInfo> ulHarqs;
+  ulHarqs.swap (m_ulHarqs.front ());
+  m_ulHarqs.pop_front ();
+
+  m_trigger.m_dlHarqInfoList.clear ();
+  const SfAllocInfo &sfAlloc = m_schedSapUser.m_ind.m_sfAllocInfo;
+  for (unsigned i = 0; i < sfAlloc.m_slotAllocInfo.size (); i++)
+    {
+      const SlotAllocInfo &slot = sfAlloc.m_slotAllocInfo[i];
+      if (slot.m_slotType != SlotAllocInfo::CTRL_DATA)
+        {
+          continue;
+        }
+      bool nack = m_random->GetValue () < m_nackProb;
+      if (slot.m_tddMode == SlotAllocInfo::DL_slotAllocInfo)
+        {
+          DlHarqInfo harq;
+          harq.m_rnti = slot.m_dci.m_rnti;
+          harq.m_harqProcessId = slot.m_dci.m_harqProcess;
+          harq.m_harqStatus = nack ? DlHarqInfo::NACK : DlHarqInfo::ACK;
+          harq.m_numRetx = slot.m_dci.m_rv;
+          m_trigger.m_dlHarqInfoList.push_back (harq);
+        }
+      else
+        {
+          UlHarqInfo harq;
+          harq.m_rnti = slot.m_dci.m_rnti;
+          harq.m_harqProcessId = slot.m_dci.m_harqProcess;
+          harq.m_receptionStatus = nack ? UlHarqInfo::NotOk : UlHarqInfo::Ok;
+          harq.m_tpc = 0;
+          harq.m_numRetx = slot.m_dci.m_rv;
+          ulHarqs.push_back (harq);
+
+          // the UL-CQI refers to the slot by its first symbol, as done by MmWaveEnbPhy
+          MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+          ulCqi.m_sfnSf = sfAlloc.m_sfnSf;
+          ulCqi.m_sfnSf.m_slotNum = slot.m_dci.m_symStart;
+          ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+          ulCqi.m_ulCqi.m_sinr.assign (m_phyMacConfig->GetTotalNumChunk (), m_random->GetValue (1.0, 1000.0));
+          ulCqis.push_back (ulCqi);
+        }
+    }
+  m_ulCqis.push_back (std::move (ulCqis));
+  m_ulHarqs.push_back (std::move (ulHarqs));
+}
+
+/**
+ * @param a comma separated list
+ * @returns the items of the list
+ */
+static std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string schedulers = "ns3::MmWaveFlexTtiMacScheduler,ns3::MmWaveFlexTtiMaxRateMacScheduler,"
+    "ns3::MmWaveFlexTtiPfMacScheduler,ns3::MmWaveFlexTtiMaxWeightMacScheduler";
+  std::string numUes = "10,100,1000";
+  uint32_t ttis = 1000;
+  uint32_t warmupTtis = 100;
+  double reportProb = 0.5;
+  double nackProb = 0.1;
+
+  CommandLine cmd;
+  cmd.AddValue ("schedulers", "Comma separated TypeId names of the schedulers", schedulers);
+  cmd.AddValue ("numUes", "Comma separated numbers of UEs", numUes);
+  cmd.AddValue ("ttis", "Number of measured subframes", ttis);
+  cmd.AddValue ("warmupTtis", "Number of subframes run before the measure", warmupTtis);
+  cmd.AddValue ("reportProb", "Probability that a UE sends each report in a subframe", reportProb);
+  cmd.AddValue ("nackProb", "Probability of a NACK for each transmitted TB", nackProb);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> schedList = SplitList (schedulers);
+  std::vector<std::string> ueList = SplitList (numUes);
+
+  std::cout << std::left << std::setw (42) << "scheduler" << std::right
+            << std::setw (6) << "UEs"
+            << std::setw (14) << "ns/TTI"
+            << std::setw (14) << "allocs/TTI"
+            << std::setw (14) << "bytes/TTI"
+            << std::setw (12) << "slots/TTI" << std::endl;
+  for (unsigned i = 0; i < schedList.size (); i++)
+    {
+      for (unsigned j = 0; j < ueList.size (); j++)
+        {
+          SchedBench bench (schedList[i], std::atoi (ueList[j].c_str ()), reportProb, nackProb);
+          bench.Run (warmupTtis);
+          BenchResult res = bench.Run (ttis);
+          std::cout << std::left << std::setw (42) << schedList[i] << std::right
+                    << std::setw (6) << ueList[j]
+                    << std::fixed << std::setprecision (1)
+                    << std::setw (14) << res.m_elapsedNs / res.m_numTtis
+                    << std::setw (14) << (double) res.m_numAllocs / res.m_numTtis
+                    << std::setw (14) << (double) res.m_allocBytes / res.m_numTtis
+                    << std::setw (12) << (double) res.m_numSlots / res.m_numTtis << std::endl;
+        }
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -33,7 +33,10 @@
 #include "mmwave-bearer-stats-calculator.h"
 #include "ns3/string.h"
 #include "ns3/nstime.h"
+#include <ns3/boolean.h>
+#include <ns3/simulator.h>
 #include <ns3/log.h>
+#include <string.h>
 #include <vector>
 #include <algorithm>
 
@@ -48,14 +51,16 @@ NS_OBJECT_ENSURE_REGISTERED ( MmWaveBearerStatsCalculator);
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator ()
   : m_firstWrite (true),
     m_pendingOutput (false),
-    m_protocolType ("RLC")
+    m_protocolType ("RLC"),
+    m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
 }
 
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator (std::string protocolType)
   : m_firstWrite (true),
-    m_pendingOutput (false)
+    m_pendingOutput (false),
+    m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
   m_protocolType = protocolType;
@@ -103,6 +108,13 @@ MmWaveBearerStatsCalculator::GetTypeId (void)
                    StringValue ("UlPdcpStats.txt"),
                    MakeStringAccessor (&MmWaveBearerStatsCalculator::SetUlPdcpOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "If true, each PDU is written to the output files as a fixed-size binary record "
+                   "by a background thread, instead of a line of text. The mmwave-trace-converter "
+                   "program in utils converts them to TSV or CSV",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveBearerStatsCalculator::m_binaryOutput),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -115,6 +127,9 @@ MmWaveBearerStatsCalculator::DoDispose ()
     {
       ShowResults ();
     }
+  // flush the binary records
+  m_dlWriter = 0;
+  m_ulWriter = 0;
 }
 
 void
@@ -148,6 +163,12 @@ MmWaveBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlTxPdu" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
+  if (m_binaryOutput)
+    {
+      WriteRecord (m_ulWriter, GetUlOutputFilename (), false, cellId, rnti, lcid, packetSize, 0);
+      return;
+    }
+
   if (!m_ulOutFile.is_open ())
     {
       m_ulOutFile.open (GetUlOutputFilename ().c_str ());
@@ -163,7 +184,7 @@ MmWaveBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
   // }
 
   m_ulOutFile << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << "\n";
 
   /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
@@ -181,6 +202,12 @@ MmWaveBearerStatsCalculator::DlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlTxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
+  if (m_binaryOutput)
+    {
+      WriteRecord (m_dlWriter, GetDlOutputFilename (), false, cellId, rnti, lcid, packetSize, 0);
+      return;
+    }
+
   if (!m_dlOutFile.is_open ())
     {
       m_dlOutFile.open (GetDlOutputFilename ().c_str ());
@@ -196,7 +223,7 @@ MmWaveBearerStatsCalculator::DlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
   // }
 
   m_dlOutFile << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << "\n";
 
 
   /*ImsiLcidPair_t p (imsi, lcid);
@@ -216,6 +243,12 @@ MmWaveBearerStatsCalculator::UlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
+  if (m_binaryOutput)
+    {
+      WriteRecord (m_ulWriter, GetUlOutputFilename (), true, cellId, rnti, lcid, packetSize, delay);
+      return;
+    }
+
   if (!m_ulOutFile.is_open ())
     {
       m_ulOutFile.open (GetUlOutputFilename ().c_str ());
@@ -231,7 +264,7 @@ MmWaveBearerStatsCalculator::UlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
   // }
 
   m_ulOutFile << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
 
   /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
@@ -258,6 +291,12 @@ MmWaveBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
+  if (m_binaryOutput)
+    {
+      WriteRecord (m_dlWriter, GetDlOutputFilename (), true, cellId, rnti, lcid, packetSize, delay);
+      return;
+    }
+
   if (!m_dlOutFile.is_open ())
     {
       m_dlOutFile.open (GetDlOutputFilename ().c_str ());
@@ -273,7 +312,7 @@ MmWaveBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
   // }
 
   m_dlOutFile << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
 
   /* ImsiLcidPair_t p (imsi, lcid);
    if (Simulator::Now () >= m_startTime)
@@ -295,6 +334,27 @@ MmWaveBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
    m_pendingOutput = true;*/
 }
 
+void
+MmWaveBearerStatsCalculator::WriteRecord (Ptr<MmWaveBinaryTraceWriter> &writer, std::string fileName, bool isRx,
+                                          uint16_t cellId, uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint64_t delay)
+{
+  if (writer == 0)
+    {
+      writer = Create<MmWaveBinaryTraceWriter> (fileName, MmWaveBinaryTraceWriter::BEARER_TRACE,
+                                                sizeof (MmWaveBearerTraceRecord));
+    }
+  MmWaveBearerTraceRecord record;
+  memset (&record, 0, sizeof (record));
+  record.m_time = Simulator::Now ().GetNanoSeconds () / 1.0e9;
+  record.m_delay = delay;
+  record.m_packetSize = packetSize;
+  record.m_cellId = cellId;
+  record.m_rnti = rnti;
+  record.m_lcid = lcid;
+  record.m_isRx = isRx;
+  writer->Write (&record);
+}
+
 void
 MmWaveBearerStatsCalculator::ShowResults (void)
 {
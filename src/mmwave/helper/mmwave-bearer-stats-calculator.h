@@ -35,6 +35,7 @@
 #include "ns3/object.h"
 #include "ns3/basic-data-calculators.h"
 #include "ns3/lte-common.h"
+#include <ns3/mmwave-binary-trace-writer.h>
 #include <string>
 #include <map>
 #include <fstream>
@@ -388,6 +389,20 @@ private:
   void
   ResetResults (void);
 
+  /**
+   * Append a record to a binary output file, which is opened at the first record
+   * @param writer the writer of the file
+   * @param fileName the name of the file
+   * @param isRx true for the receptions
+   * @param cellId CellId of the attached Enb
+   * @param rnti C-RNTI of the UE
+   * @param lcid LCID of the PDU
+   * @param packetSize size of the PDU in bytes
+   * @param delay RLC to RLC delay in nanoseconds, 0 for the transmissions
+   */
+  void WriteRecord (Ptr<MmWaveBinaryTraceWriter> &writer, std::string fileName, bool isRx,
+                    uint16_t cellId, uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint64_t delay);
+
   /**
    * Reschedules EndEpoch event. Usually used after
    * execution of SetStartTime() or SetEpoch()
@@ -458,6 +473,13 @@ private:
 
   std::ofstream m_dlOutFile;
   std::ofstream m_ulOutFile;
+
+  /**
+   * true if the PDUs are written as binary records instead of text
+   */
+  bool m_binaryOutput;
+  Ptr<MmWaveBinaryTraceWriter> m_dlWriter;
+  Ptr<MmWaveBinaryTraceWriter> m_ulWriter;
 };
 
 } // namespace mmwave
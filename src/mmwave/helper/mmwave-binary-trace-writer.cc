@@ -0,0 +1,307 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mmwave-binary-trace-writer.h"
+#include <ns3/core-config.h>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/fatal-error.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef HAVE_PTHREAD_H
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBinaryTraceWriter");
+
+namespace mmwave {
+
+/**
+ * Write a buffer to the file
+ * @param file the file
+ * @param buffer the data
+ * @param size the number of bytes
+ */
+static void
+WriteBuffer (FILE *file, const char *buffer, uint32_t size)
+{
+  if (size > 0 && fwrite (buffer, 1, size, file) != size)
+    {
+      NS_FATAL_ERROR ("Could not write the binary trace file");
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/**
+ * The ring of buffers of a MmWaveBinaryTraceWriter, and the thread that
+ * writes the full buffers to the file in the order they were submitted
+ */
+class MmWaveBinaryTraceWriterPrivate
+{
+public:
+  MmWaveBinaryTraceWriterPrivate (FILE *file, uint32_t bufferSize, uint32_t numBuffers);
+  ~MmWaveBinaryTraceWriterPrivate ();
+
+  /**
+   * Wait until a buffer is free and take it
+   * @returns the buffer
+   */
+  char * Acquire ();
+
+  /**
+   * Queue a buffer for writing
+   * @param buffer the buffer
+   * @param size the number of bytes used in the buffer
+   */
+  void Submit (char *buffer, uint32_t size);
+
+  /**
+   * Write the queued buffers and stop the thread
+   */
+  void Stop ();
+
+private:
+  /**
+   * The loop of the background thread
+   */
+  void Work ();
+
+  FILE *m_file;
+  std::vector<char *> m_buffers;    // all the buffers of the ring
+  std::vector<char *> m_free;
+  std::deque<std::pair<char *, uint32_t> > m_pending;
+  bool m_stop;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::thread m_thread;
+};
+
+MmWaveBinaryTraceWriterPrivate::MmWaveBinaryTraceWriterPrivate (FILE *file, uint32_t bufferSize, uint32_t numBuffers)
+  : m_file (file),
+    m_stop (false)
+{
+  NS_ASSERT (numBuffers > 1);
+  for (uint32_t i = 0; i < numBuffers; ++i)
+    {
+      m_buffers.push_back (new char [bufferSize]);
+    }
+  m_free = m_buffers;
+  m_thread = std::thread (&MmWaveBinaryTraceWriterPrivate::Work, this);
+}
+
+MmWaveBinaryTraceWriterPrivate::~MmWaveBinaryTraceWriterPrivate ()
+{
+  Stop ();
+  for (size_t i = 0; i < m_buffers.size (); ++i)
+    {
+      delete [] m_buffers[i];
+    }
+}
+
+char *
+MmWaveBinaryTraceWriterPrivate::Acquire ()
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (m_free.empty ())
+    {
+      m_cond.wait (lock);
+    }
+  char *buffer = m_free.back ();
+  m_free.pop_back ();
+  return buffer;
+}
+
+void
+MmWaveBinaryTraceWriterPrivate::Submit (char *buffer, uint32_t size)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_pending.push_back (std::make_pair (buffer, size));
+  m_cond.notify_all ();
+}
+
+void
+MmWaveBinaryTraceWriterPrivate::Stop ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+    m_cond.notify_all ();
+  }
+  if (m_thread.joinable ())
+    {
+      m_thread.join ();
+    }
+}
+
+void
+MmWaveBinaryTraceWriterPrivate::Work ()
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (m_pending.empty () && !m_stop)
+        {
+          m_cond.wait (lock);
+        }
+      if (m_pending.empty ())
+        {
+          // stopped, and all the buffers have been written
+          return;
+        }
+      std::pair<char *, uint32_t> buffer = m_pending.front ();
+      m_pending.pop_front ();
+      lock.unlock ();
+      WriteBuffer (m_file, buffer.first, buffer.second);
+      lock.lock ();
+      m_free.push_back (buffer.first);
+      m_cond.notify_all ();
+    }
+}
+
+#else /* HAVE_PTHREAD_H */
+
+class MmWaveBinaryTraceWriterPrivate
+{
+};
+
+#endif /* HAVE_PTHREAD_H */
+
+MmWaveBinaryTraceWriter::MmWaveBinaryTraceWriter (std::string fileName, RecordType recordType, uint32_t recordSize,
+                                                  uint32_t bufferSize, uint32_t numBuffers)
+  : m_recordSize (recordSize),
+    m_used (0),
+    m_priv (0)
+{
+  NS_LOG_FUNCTION (this << fileName << recordType << recordSize << bufferSize << numBuffers);
+  NS_ASSERT (recordSize > 0);
+  // each buffer holds a whole number of records, and at least one
+  m_bufferSize = std::max (bufferSize / recordSize, 1U) * recordSize;
+
+  m_file = fopen (fileName.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_FATAL_ERROR ("Could not open the binary trace file " << fileName);
+    }
+  MmWaveBinaryTraceHeader header;
+  memset (&header, 0, sizeof (header));
+  memcpy (header.m_magic, "MMWTRACE", sizeof (header.m_magic));
+  header.m_version = VERSION;
+  header.m_recordType = recordType;
+  header.m_recordSize = recordSize;
+  WriteBuffer (m_file, reinterpret_cast<const char *> (&header), sizeof (header));
+
+#ifdef HAVE_PTHREAD_H
+  m_priv = new MmWaveBinaryTraceWriterPrivate (m_file, m_bufferSize, std::max (numBuffers, 2U));
+  m_buffer = m_priv->Acquire ();
+#else
+  m_buffer = new char [m_bufferSize];
+#endif
+}
+
+MmWaveBinaryTraceWriter::~MmWaveBinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+MmWaveBinaryTraceWriter::Write (const void *record)
+{
+  NS_ASSERT_MSG (m_file != 0, "the binary trace was closed");
+  memcpy (m_buffer + m_used, record, m_recordSize);
+  m_used += m_recordSize;
+  if (m_used == m_bufferSize)
+    {
+      SubmitBuffer ();
+    }
+}
+
+void
+MmWaveBinaryTraceWriter::SubmitBuffer ()
+{
+#ifdef HAVE_PTHREAD_H
+  m_priv->Submit (m_buffer, m_used);
+  m_buffer = m_priv->Acquire ();
+#else
+  WriteBuffer (m_file, m_buffer, m_used);
+#endif
+  m_used = 0;
+}
+
+void
+MmWaveBinaryTraceWriter::Close ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file == 0)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  m_priv->Submit (m_buffer, m_used);
+  // the thread writes all the submitted buffers before it stops
+  delete m_priv;
+  m_priv = 0;
+#else
+  WriteBuffer (m_file, m_buffer, m_used);
+  delete [] m_buffer;
+#endif
+  m_buffer = 0;
+  m_used = 0;
+  fclose (m_file);
+  m_file = 0;
+}
+
+void
+WriteRxPacketTraceHeader (std::ostream &os, const char *sep)
+{
+  os << sep << "time" << sep << "frame" << sep << "subF" << sep << "1stSym" << sep << "symbol#"
+     << sep << "cellId" << sep << "rnti" << sep << "ccId" << sep << "tbSize" << sep << "mcs" << sep << "rv"
+     << sep << "SINR(dB)" << sep << "corrupt" << sep << "TBler" << "\n";
+}
+
+void
+WriteRxPacketTraceRecord (std::ostream &os, const char *sep, const MmWaveRxPacketTraceRecord &record)
+{
+  os << (record.m_isUplink ? "UL" : "DL") << sep << record.m_time << sep << record.m_frameNum
+     << sep << (unsigned) record.m_sfNum << sep << (unsigned) record.m_symStart << sep << (unsigned) record.m_numSym
+     << sep << record.m_cellId << sep << record.m_rnti << sep << (unsigned) record.m_ccId << sep << record.m_tbSize
+     << sep << (unsigned) record.m_mcs << sep << (unsigned) record.m_rv << sep << record.m_sinrDb
+     << sep << (unsigned) record.m_corrupt << sep << record.m_tbler << "\n";
+}
+
+void
+WriteBearerTraceRecord (std::ostream &os, const char *sep, const MmWaveBearerTraceRecord &record)
+{
+  os << (record.m_isRx ? "Rx" : "Tx") << sep << record.m_time << sep << record.m_cellId << sep << record.m_rnti
+     << sep << (unsigned) record.m_lcid << sep << record.m_packetSize << sep;
+  if (record.m_isRx)
+    {
+      os << record.m_delay;
+    }
+  os << "\n";
+}
+
+} // namespace mmwave
+
+} // namespace ns3
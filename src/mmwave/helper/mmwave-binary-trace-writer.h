@@ -0,0 +1,182 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SRC_MMWAVE_HELPER_MMWAVE_BINARY_TRACE_WRITER_H_
+#define SRC_MMWAVE_HELPER_MMWAVE_BINARY_TRACE_WRITER_H_
+
+#include <ns3/simple-ref-count.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <ostream>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * The header at the beginning of a binary trace file. The records that
+ * follow it are all of the same type, and they are written with the
+ * byte order of the host.
+ */
+struct MmWaveBinaryTraceHeader
+{
+  char m_magic[8];         // "MMWTRACE"
+  uint32_t m_version;
+  uint32_t m_recordType;   // a MmWaveBinaryTraceWriter::RecordType
+  uint32_t m_recordSize;   // size of each record, in bytes
+  uint32_t m_reserved;
+};
+
+/**
+ * A record of the RxPacketTrace of MmWavePhyRxTrace, with the same
+ * fields of a line of the text output
+ */
+struct MmWaveRxPacketTraceRecord
+{
+  double m_time;           // in seconds
+  uint64_t m_cellId;
+  uint32_t m_frameNum;
+  uint32_t m_tbSize;
+  uint16_t m_rnti;
+  uint8_t m_isUplink;
+  uint8_t m_sfNum;
+  uint8_t m_symStart;
+  uint8_t m_numSym;
+  uint8_t m_ccId;
+  uint8_t m_mcs;
+  uint8_t m_rv;
+  uint8_t m_corrupt;
+  uint8_t m_padding[6];
+  double m_sinrDb;
+  double m_tbler;
+};
+
+/**
+ * A record of the RLC or PDCP traces of MmWaveBearerStatsCalculator, with
+ * the same fields of a line of the text output
+ */
+struct MmWaveBearerTraceRecord
+{
+  double m_time;           // in seconds
+  uint64_t m_delay;        // in nanoseconds, 0 for the transmissions
+  uint32_t m_packetSize;
+  uint16_t m_cellId;
+  uint16_t m_rnti;
+  uint8_t m_lcid;
+  uint8_t m_isRx;
+  uint8_t m_padding[6];
+};
+
+class MmWaveBinaryTraceWriterPrivate;
+
+/**
+ * Writes the fixed-size records of a trace to a binary file. The records
+ * are copied into a ring of large buffers, and the full buffers are
+ * written to the file by a background thread, so that the simulation only
+ * waits for the disk when all the buffers are full.
+ *
+ * If ns-3 is built without thread support, a buffer is written by the
+ * calling thread as soon as it is full.
+ *
+ * The files can be converted to text with the mmwave-trace-converter
+ * program in utils.
+ */
+class MmWaveBinaryTraceWriter : public SimpleRefCount<MmWaveBinaryTraceWriter>
+{
+public:
+  enum RecordType
+  {
+    RX_PACKET_TRACE = 1,
+    BEARER_TRACE = 2
+  };
+
+  static const uint32_t VERSION = 1;
+
+  /**
+   * Open the file and write its header
+   * @param fileName the name of the file, which is truncated
+   * @param recordType the type of the records
+   * @param recordSize the size of each record, in bytes
+   * @param bufferSize the size of each buffer of the ring, in bytes
+   * @param numBuffers the number of buffers of the ring
+   */
+  MmWaveBinaryTraceWriter (std::string fileName, RecordType recordType, uint32_t recordSize,
+                           uint32_t bufferSize = 1 << 20, uint32_t numBuffers = 4);
+  ~MmWaveBinaryTraceWriter ();
+
+  /**
+   * Append a record to the trace
+   * @param record the record, of the size given to the constructor
+   */
+  void Write (const void *record);
+
+  /**
+   * Write the pending records, wait for the background thread and close
+   * the file. It is called by the destructor, if not called before.
+   */
+  void Close ();
+
+private:
+  MmWaveBinaryTraceWriter (const MmWaveBinaryTraceWriter &);
+  MmWaveBinaryTraceWriter & operator = (const MmWaveBinaryTraceWriter &);
+
+  /**
+   * Hand the current buffer to the background thread, and get an empty one
+   */
+  void SubmitBuffer ();
+
+  FILE *m_file;
+  uint32_t m_recordSize;
+  uint32_t m_bufferSize;            // multiple of m_recordSize
+  char *m_buffer;                   // the buffer being filled
+  uint32_t m_used;                  // bytes used in m_buffer
+  MmWaveBinaryTraceWriterPrivate *m_priv;       // the background thread, if threading is enabled
+};
+
+/**
+ * Write the names of the fields of the RxPacketTrace, as in the first line
+ * of the text output of MmWavePhyRxTrace, whose first column (UL or DL)
+ * has no name
+ * @param os the output stream
+ * @param sep the field separator
+ */
+void WriteRxPacketTraceHeader (std::ostream &os, const char *sep);
+
+/**
+ * Write a record of the RxPacketTrace as a line of text, with the fields
+ * in the order of the header
+ * @param os the output stream
+ * @param sep the field separator
+ * @param record the record
+ */
+void WriteRxPacketTraceRecord (std::ostream &os, const char *sep, const MmWaveRxPacketTraceRecord &record);
+
+/**
+ * Write a record of the RLC or PDCP traces as a line of text, with the
+ * fields of the text output of MmWaveBearerStatsCalculator, which has no
+ * header. The delay of the transmissions is left empty.
+ * @param os the output stream
+ * @param sep the field separator
+ * @param record the record
+ */
+void WriteBearerTraceRecord (std::ostream &os, const char *sep, const MmWaveBearerTraceRecord &record);
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_HELPER_MMWAVE_BINARY_TRACE_WRITER_H_ */
@@ -38,7 +38,9 @@
 #include <ns3/log.h>
 #include "mmwave-phy-rx-trace.h"
 #include <ns3/simulator.h>
+#include <ns3/boolean.h>
 #include <stdio.h>
+#include <string.h>
 
 namespace ns3 {
 
@@ -50,6 +52,8 @@ NS_OBJECT_ENSURE_REGISTERED (MmWavePhyRxTrace);
 
 std::ofstream MmWavePhyRxTrace::m_rxPacketTraceFile;
 std::string MmWavePhyRxTrace::m_rxPacketTraceFilename;
+bool MmWavePhyRxTrace::m_binaryOutput = false;
+Ptr<MmWaveBinaryTraceWriter> MmWavePhyRxTrace::m_rxPacketTraceWriter;
 
 MmWavePhyRxTrace::MmWavePhyRxTrace ()
 {
@@ -61,6 +65,8 @@ MmWavePhyRxTrace::~MmWavePhyRxTrace ()
     {
       m_rxPacketTraceFile.close ();
     }
+  // flush the binary records
+  m_rxPacketTraceWriter = 0;
 }
 
 TypeId
@@ -74,6 +80,14 @@ MmWavePhyRxTrace::GetTypeId (void)
                    StringValue ("RxPacketTrace.txt"),
                    MakeStringAccessor (&MmWavePhyRxTrace::SetOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "If true, the RxPacketTrace is written to OutputFilename as fixed-size binary records "
+                   "by a background thread, instead of text. The mmwave-trace-converter program in utils "
+                   "converts them to TSV or CSV",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWavePhyRxTrace::SetBinaryOutput,
+                                        &MmWavePhyRxTrace::GetBinaryOutput),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -85,6 +99,46 @@ MmWavePhyRxTrace::SetOutputFilename ( std::string fileName)
   m_rxPacketTraceFilename = fileName;
 }
 
+void
+MmWavePhyRxTrace::SetBinaryOutput (bool binary)
+{
+  m_binaryOutput = binary;
+}
+
+bool
+MmWavePhyRxTrace::GetBinaryOutput () const
+{
+  return m_binaryOutput;
+}
+
+void
+MmWavePhyRxTrace::WriteRxPacketTraceRecord (bool isUplink, const RxPacketTraceParams &params)
+{
+  if (m_rxPacketTraceWriter == 0)
+    {
+      m_rxPacketTraceWriter = Create<MmWaveBinaryTraceWriter> (m_rxPacketTraceFilename, MmWaveBinaryTraceWriter::RX_PACKET_TRACE,
+                                                               sizeof (MmWaveRxPacketTraceRecord));
+    }
+  MmWaveRxPacketTraceRecord record;
+  memset (&record, 0, sizeof (record));
+  record.m_time = Simulator::Now ().GetSeconds ();
+  record.m_cellId = params.m_cellId;
+  record.m_frameNum = params.m_frameNum;
+  record.m_tbSize = params.m_tbSize;
+  record.m_rnti = params.m_rnti;
+  record.m_isUplink = isUplink;
+  record.m_sfNum = params.m_sfNum;
+  record.m_symStart = params.m_symStart;
+  record.m_numSym = params.m_numSym;
+  record.m_ccId = params.m_ccId;
+  record.m_mcs = params.m_mcs;
+  record.m_rv = params.m_rv;
+  record.m_corrupt = params.m_corrupt;
+  record.m_sinrDb = 10 * std::log10 (params.m_sinr);
+  record.m_tbler = params.m_tbler;
+  m_rxPacketTraceWriter->Write (&record);
+}
+
 void
 MmWavePhyRxTrace::ReportCurrentCellRsrpSinrCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
                                                      uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power)
@@ -198,19 +252,26 @@ MmWavePhyRxTrace::ReportDLTbSize (uint64_t imsi, uint64_t tbSize)
 void
 MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
 {
-  if (!m_rxPacketTraceFile.is_open ())
+  if (m_binaryOutput)
+    {
+      WriteRxPacketTraceRecord (false, params);
+    }
+  else
     {
-      m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
-      m_rxPacketTraceFile << "\ttime\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler" << std::endl;
       if (!m_rxPacketTraceFile.is_open ())
         {
-          NS_FATAL_ERROR ("Could not open tracefile");
+          m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
+          WriteRxPacketTraceHeader (m_rxPacketTraceFile, "\t");
+          if (!m_rxPacketTraceFile.is_open ())
+            {
+              NS_FATAL_ERROR ("Could not open tracefile");
+            }
         }
+      m_rxPacketTraceFile << "DL\t" << Simulator::Now ().GetSeconds () << "\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
+                          << "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
+                          << "\t" << params.m_rnti << "\t" << (unsigned)params.m_ccId << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
+                          << 10 * std::log10 (params.m_sinr) << "\t" << " \t" << params.m_corrupt << "\t" <<  params.m_tbler << "\n";
     }
-  m_rxPacketTraceFile << "DL\t" << Simulator::Now ().GetSeconds () << "\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
-                      << "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
-                      << "\t" << params.m_rnti << "\t" << (unsigned)params.m_ccId << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-                      << 10 * std::log10 (params.m_sinr) << "\t" << " \t" << params.m_corrupt << "\t" <<  params.m_tbler << std::endl;
 
   if (params.m_corrupt)
     {
@@ -223,19 +284,26 @@ MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::
 void
 MmWavePhyRxTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
 {
-  if (!m_rxPacketTraceFile.is_open ())
+  if (m_binaryOutput)
+    {
+      WriteRxPacketTraceRecord (true, params);
+    }
+  else
     {
-      m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
-      m_rxPacketTraceFile << "\ttime\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler" << std::endl;
       if (!m_rxPacketTraceFile.is_open ())
         {
-          NS_FATAL_ERROR ("Could not open tracefile");
+          m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
+          WriteRxPacketTraceHeader (m_rxPacketTraceFile, "\t");
+          if (!m_rxPacketTraceFile.is_open ())
+            {
+              NS_FATAL_ERROR ("Could not open tracefile");
+            }
         }
+      m_rxPacketTraceFile << "UL\t" << Simulator::Now ().GetSeconds () << "\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
+                          << "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
+                          << "\t" << params.m_rnti << "\t" << (unsigned)params.m_ccId << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
+                          << 10 * std::log10 (params.m_sinr) << " \t" << params.m_corrupt << "\t" << params.m_tbler << "\n";
     }
-  m_rxPacketTraceFile << "UL\t" << Simulator::Now ().GetSeconds () << "\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
-                      << "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
-                      << "\t" << params.m_rnti << "\t" << (unsigned)params.m_ccId << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-                      << 10 * std::log10 (params.m_sinr) << " \t" << params.m_corrupt << "\t" << params.m_tbler << std::endl;
 
   if (params.m_corrupt)
     {
@@ -36,6 +36,7 @@
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/mmwave-binary-trace-writer.h>
 #include <fstream>
 #include <iostream>
 
@@ -60,8 +61,21 @@ public:
   static void RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
   static void RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
   void SetOutputFilename ( std::string fileName);
+  /**
+   * Select the format of the RxPacketTrace file
+   * @param binary true to write MmWaveRxPacketTraceRecord, false to write text
+   */
+  void SetBinaryOutput (bool binary);
+  bool GetBinaryOutput () const;
 
 private:
+  /**
+   * Append a record to the binary RxPacketTrace file, which is opened at the first record
+   * @param isUplink true for the UL TBs
+   * @param params the trace parameters
+   */
+  static void WriteRxPacketTraceRecord (bool isUplink, const RxPacketTraceParams &params);
+
   //void ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr);
   //void ReportPacketCountUe (UePhyPacketCountParameter param);
   //void ReportPacketCountEnb (EnbPhyPacketCountParameter param);
@@ -69,6 +83,8 @@ private:
 
   static std::ofstream m_rxPacketTraceFile;
   static std::string m_rxPacketTraceFilename;
+  static bool m_binaryOutput;
+  static Ptr<MmWaveBinaryTraceWriter> m_rxPacketTraceWriter;
 };
 
 } // namespace mmwave
@@ -30,6 +30,8 @@
 #include <ns3/simulator.h>
 #include "ns3/double.h"
 #include "ns3/boolean.h"
+#include <algorithm>
+#include <tuple>
 
 
 NS_LOG_COMPONENT_DEFINE ("AntennaArrayModel");
@@ -52,6 +54,10 @@ AntennaArrayModel::AntennaArrayModel ()
   m_noPlane = 0;
   m_isUe = false;
   m_totNoArrayElements = 0;
+  m_beamformingVectorVersion = 0;
+  m_lastVersion = 0;
+  m_patternResolution = 0;
+  m_patternTable = 0;
 }
 
 AntennaArrayModel::~AntennaArrayModel ()
@@ -80,6 +86,13 @@ AntennaArrayModel::GetTypeId ()
                    BooleanValue (true),
                    MakeBooleanAccessor (&AntennaArrayModel::m_isotropicElement),
                    MakeBooleanChecker ())
+    .AddAttribute ("RadiationPatternResolution",
+                   "Step, in degrees, of the angular grid over which the radiation pattern of the elements is tabulated. "
+                   "The pattern is interpolated from the grid. Set to 0 to compute the exact pattern",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&AntennaArrayModel::SetRadiationPatternResolution,
+                                       &AntennaArrayModel::GetRadiationPatternResolution),
+                   MakeDoubleChecker<double> (0, 90))
   ;
   return tid;
 }
@@ -158,6 +171,7 @@ AntennaArrayModel::SetDeviceType (bool isUe)
       m_hpbw = 65;           //HPBW value of each antenna element
       m_gMax = 8;           //directivity value expressed in dBi and valid only for TRP (see table A.1.6-3 in 38.802
     }
+  m_patternTable = 0;
 }
 
 double
@@ -223,16 +237,26 @@ AntennaArrayModel::SetBeamformingVectorPanelDevices (Ptr<NetDevice> thisDevice,
       std::map< Ptr<NetDevice>, std::pair<complexVector_t,int> >::iterator iter = m_beamformingVectorPanelMap.find (otherDevice);
       if (iter != m_beamformingVectorPanelMap.end ())
         {
+          if ((*iter).second.first != antennaWeights)
+            {
+              m_beamformingVectorVersionMap[otherDevice] = ++m_lastVersion;
+            }
           (*iter).second = std::make_pair (antennaWeights, panelId);
           m_lastUpdatePairMap[otherDevice] = Simulator::Now ();
         }
       else
         {
           m_beamformingVectorPanelMap.insert (std::make_pair (otherDevice, std::make_pair (antennaWeights, panelId) ));
+          m_beamformingVectorVersionMap[otherDevice] = ++m_lastVersion;
           m_lastUpdatePairMap.insert (std::make_pair (otherDevice, Simulator::Now ()));
 
           NS_LOG_INFO ("m_lastUpdatePairMap.size " << m_lastUpdatePairMap.size ());
         }
+      m_beamformingVectorVersion = m_beamformingVectorVersionMap[otherDevice];
+    }
+  else
+    {
+      m_beamformingVectorVersion = ++m_lastVersion;
     }
   m_beamformingVector = antennaWeights;
   m_currentPanelId = panelId;
@@ -252,12 +276,17 @@ AntennaArrayModel::SetBeamformingVectorPanel (complexVector_t antennaWeights, Pt
       auto iter = m_beamformingVectorPanelMap.find (device);
       if (iter != m_beamformingVectorPanelMap.end ())
         {
+          if ((*iter).second.first != antennaWeights)
+            {
+              m_beamformingVectorVersionMap[device] = ++m_lastVersion;
+            }
           (*iter).second = std::make_pair (antennaWeights, 0);
           m_lastUpdatePairMap[device] = Simulator::Now ();
         }
       else
         {
           m_beamformingVectorPanelMap.insert (std::make_pair (device, std::make_pair (antennaWeights, 0)) );
+          m_beamformingVectorVersionMap[device] = ++m_lastVersion;
           m_lastUpdatePairMap.insert (std::make_pair (device, Simulator::Now ()));
 
           NS_LOG_INFO ("m_lastUpdatePairMap.size " << m_lastUpdatePairMap.size ());
@@ -277,6 +306,7 @@ AntennaArrayModel::ChangeBeamformingVectorPanel (Ptr<NetDevice> device)
   NS_ASSERT_MSG (it != m_beamformingVectorPanelMap.end (), "could not find");
   NS_LOG_DEBUG ("ChangeBeamformingVectorPanel towards dev " << device << " prev panel " << m_currentPanelId << " updated to " << it->second.second);
   m_beamformingVector = it->second.first;
+  m_beamformingVectorVersion = m_beamformingVectorVersionMap[device];
   m_currentPanelId = it->second.second;
   m_currentDev = device;
 }
@@ -321,6 +351,17 @@ AntennaArrayModel::GetBeamformingVectorPanel (Ptr<NetDevice> device)
   return weights;
 }
 
+uint64_t
+AntennaArrayModel::GetBeamformingVectorVersion (Ptr<NetDevice> device)
+{
+  std::map< Ptr<NetDevice>, uint64_t>::iterator it = m_beamformingVectorVersionMap.find (device);
+  if (it != m_beamformingVectorVersionMap.end ())
+    {
+      return it->second;
+    }
+  return m_beamformingVectorVersion;
+}
+
 Ptr<NetDevice>
 AntennaArrayModel::GetCurrentDevice ()
 {
@@ -351,6 +392,26 @@ AntennaArrayModel::GetRadiationPattern (double vAngleRadian, double hAngleRadian
   //NS_LOG_INFO(" it is " << hAngle);
   NS_ASSERT_MSG (hAngle >= -180&&hAngle <= 180, "the horizontal angle should be the range of [-180,180]");
 
+  if (m_patternResolution > 0)
+    {
+      return InterpolateRadiationPattern (vAngle, hAngle);
+    }
+  return ComputeRadiationPattern (vAngle, hAngle);
+}
+
+double
+AntennaArrayModel::GetMaxElementGainDb () const
+{
+  if (m_isotropicElement)
+    {
+      return 0;
+    }
+  return m_gMax;
+}
+
+double
+AntennaArrayModel::ComputeRadiationPattern (double vAngle, double hAngle) const
+{
   double A_M = 30;       //front-back ratio expressed in dB
   double SLA = 30;       //side-lobe level limit expressed in dB
 
@@ -361,6 +422,60 @@ AntennaArrayModel::GetRadiationPattern (double vAngleRadian, double hAngleRadian
   return sqrt (pow (10,A / 10));     //filed factor term converted to linear;
 }
 
+double
+AntennaArrayModel::InterpolateRadiationPattern (double vAngle, double hAngle)
+{
+  uint32_t numV = ceil (180 / m_patternResolution) + 1;
+  uint32_t numH = ceil (360 / m_patternResolution) + 1;
+  if (m_patternTable == 0)
+    {
+      // the pattern only depends on the type of element, thus the tables are shared by all the arrays
+      typedef std::tuple<double, double, double> key_t;
+      static std::map<key_t, std::vector<double> > patternTables;
+      key_t key (m_hpbw, m_gMax, m_patternResolution);
+      std::map<key_t, std::vector<double> >::iterator it = patternTables.find (key);
+      if (it == patternTables.end ())
+        {
+          NS_LOG_LOGIC ("Tabulate the radiation pattern with HPBW " << m_hpbw << " and resolution " << m_patternResolution);
+          std::vector<double> table (numV * numH);
+          for (uint32_t v = 0; v < numV; v++)
+            {
+              for (uint32_t h = 0; h < numH; h++)
+                {
+                  table[v * numH + h] = ComputeRadiationPattern (std::min (v * m_patternResolution, 180.0),
+                                                                 std::min (h * m_patternResolution - 180, 180.0));
+                }
+            }
+          it = patternTables.insert (std::make_pair (key, table)).first;
+        }
+      m_patternTable = &it->second;
+    }
+
+  // bilinear interpolation between the 4 closest points of the grid
+  double v = vAngle / m_patternResolution;
+  double h = (hAngle + 180) / m_patternResolution;
+  uint32_t v0 = std::min<uint32_t> (v, numV - 2);
+  uint32_t h0 = std::min<uint32_t> (h, numH - 2);
+  double dv = v - v0;
+  double dh = h - h0;
+  const double *row0 = &(*m_patternTable)[v0 * numH + h0];
+  const double *row1 = row0 + numH;
+  return (1 - dv) * ((1 - dh) * row0[0] + dh * row0[1]) + dv * ((1 - dh) * row1[0] + dh * row1[1]);
+}
+
+void
+AntennaArrayModel::SetRadiationPatternResolution (double resolution)
+{
+  m_patternResolution = resolution;
+  m_patternTable = 0;
+}
+
+double
+AntennaArrayModel::GetRadiationPatternResolution () const
+{
+  return m_patternResolution;
+}
+
 Vector
 AntennaArrayModel::GetAntennaLocation (uint16_t index, uint16_t* antennaNum)
 {
@@ -372,6 +487,35 @@ AntennaArrayModel::GetAntennaLocation (uint16_t index, uint16_t* antennaNum)
   return loc;
 }
 
+void
+AntennaArrayModel::GetSteeringVectors (const double *vAngleRadian, const double *hAngleRadian, uint32_t numAngles,
+                                       uint16_t *antennaNum, complexVector_t &steering)
+{
+  uint32_t size = antennaNum[0] * antennaNum[1];
+  steering.resize (size * numAngles);
+  // the trigonometric functions of each direction are shared by all the elements
+  std::vector<double> kx (numAngles);
+  std::vector<double> ky (numAngles);
+  std::vector<double> kz (numAngles);
+  for (uint32_t a = 0; a < numAngles; a++)
+    {
+      double sinV = sin (vAngleRadian[a]);
+      kx[a] = sinV * cos (hAngleRadian[a]);
+      ky[a] = sinV * sin (hAngleRadian[a]);
+      kz[a] = cos (vAngleRadian[a]);
+    }
+  for (uint32_t ind = 0; ind < size; ind++)
+    {
+      Vector loc = GetAntennaLocation (ind, antennaNum);
+      std::complex<double> *elementSteering = &steering[ind * numAngles];
+      for (uint32_t a = 0; a < numAngles; a++)
+        {
+          double phase = 2 * M_PI * (kx[a] * loc.x + ky[a] * loc.y + kz[a] * loc.z);
+          elementSteering[a] = exp (std::complex<double> (0, phase));
+        }
+    }
+}
+
 void
 AntennaArrayModel::SetSector (uint8_t sector, uint16_t *antennaNum, double elevation)
 {
@@ -389,6 +533,7 @@ AntennaArrayModel::SetSector (uint8_t sector, uint16_t *antennaNum, double eleva
       tempVector.push_back (exp (std::complex<double> (0, phase)) * power);
     }
   m_beamformingVector = tempVector;
+  m_beamformingVectorVersion = ++m_lastVersion;
 }
 
 Time
@@ -54,11 +54,33 @@ public:
   void ChangeBeamformingVectorPanel (Ptr<NetDevice> device);
   complexVector_t GetBeamformingVectorPanel ();
   complexVector_t GetBeamformingVectorPanel (Ptr<NetDevice> device);
+  /**
+   * @param the device
+   * @returns the version of the BF vector returned by GetBeamformingVectorPanel (device),
+   * which changes every time the weights of the vector change
+   */
+  uint64_t GetBeamformingVectorVersion (Ptr<NetDevice> device);
 
   void ChangeToOmniTx ();
   bool IsOmniTx ();
   double GetRadiationPattern (double vangle, double hangle = 0);
+  /**
+   * @returns the maximum gain of an antenna element, in dBi, i.e., the square
+   * of the maximum of GetRadiationPattern, in dB
+   */
+  double GetMaxElementGainDb () const;
   Vector GetAntennaLocation (uint16_t index, uint16_t* antennaNum);
+  /**
+   * Compute the phase shifts exp (j 2 pi k . loc) of the elements of the array,
+   * where k is the unit vector of a direction, for a set of directions
+   * @param the zenith angles of the directions, in radians
+   * @param the azimuth angles of the directions, in radians
+   * @param the number of directions
+   * @param the number of antenna elements in the two dimensions of the array
+   * @param the phase shifts, element by element: steering[element * numAngles + angle]
+   */
+  void GetSteeringVectors (const double *vAngleRadian, const double *hAngleRadian, uint32_t numAngles,
+                           uint16_t *antennaNum, complexVector_t &steering);
   void SetSector (uint8_t sector, uint16_t *antennaNum, double elevation = 90);
 
   void SetPlanesNumber (double planesNumber);
@@ -71,6 +93,21 @@ public:
   Time GetLastUpdate (Ptr<NetDevice> device);
 
 private:
+  /**
+   * @param the vertical angle, in degrees, in [0, 180]
+   * @param the horizontal angle, in degrees, in [-180, 180]
+   * @returns the field pattern of an antenna element
+   */
+  double ComputeRadiationPattern (double vAngle, double hAngle) const;
+  /**
+   * @param the vertical angle, in degrees, in [0, 180]
+   * @param the horizontal angle, in degrees, in [-180, 180]
+   * @returns the field pattern of an antenna element, interpolated from m_patternTable
+   */
+  double InterpolateRadiationPattern (double vAngle, double hAngle);
+  void SetRadiationPatternResolution (double resolution);
+  double GetRadiationPatternResolution () const;
+
   bool m_omniTx;
   // double m_minAngle;
   // double m_maxAngle;
@@ -78,6 +115,9 @@ private:
   int m_currentPanelId;
   // std::map<Ptr<NetDevice>, complexVector_t> m_beamformingVectorMap;
   std::map<Ptr<NetDevice>, std::pair<complexVector_t,int> > m_beamformingVectorPanelMap;
+  uint64_t m_beamformingVectorVersion;       // version of m_beamformingVector
+  uint64_t m_lastVersion;       // last version assigned to a BF vector of this array
+  std::map<Ptr<NetDevice>, uint64_t> m_beamformingVectorVersionMap;       // version of the vectors in m_beamformingVectorPanelMap
 
   double m_disV;       //antenna spacing in the vertical direction in terms of wave length.
   double m_disH;       //antenna spacing in the horizontal direction in terms of wave length.
@@ -94,6 +134,8 @@ private:
   std::map<Ptr<NetDevice>, Time> m_lastUpdatePairMap;
 
   bool m_isotropicElement;
+  double m_patternResolution;       // step of the angular grid of m_patternTable, in degrees, 0 if the pattern is not tabulated
+  const std::vector<double> *m_patternTable;       // field pattern over the grid, shared by the arrays with the same element type, 0 if not computed yet
 };
 
 } /* namespace mmwave */
@@ -33,6 +33,7 @@
 #include <ns3/mmwave-phy.h>
 #include <ns3/mmwave-net-device.h>
 #include <ns3/node.h>
+#include <ns3/mobility-snapshot.h>
 #include <ns3/mmwave-ue-net-device.h>
 #include <ns3/mc-ue-net-device.h>
 #include <ns3/mmwave-enb-net-device.h>
@@ -43,7 +44,11 @@
 #include <random>       // std::default_random_engine
 #include <ns3/boolean.h>
 #include <ns3/integer.h>
+#include <ns3/uinteger.h>
+#include <ns3/enum.h>
 #include "mmwave-spectrum-value-helper.h"
+#include "mmwave-beamforming-kernels.h"
+#include "mmwave-beam-codebook.h"
 
 namespace ns3 {
 
@@ -53,6 +58,23 @@ NS_LOG_COMPONENT_DEFINE ("MmWave3gppChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (MmWave3gppChannel);
 
+// the largest number of clusters of the scenarios of TR 38.900 Table 7.5-6,
+// and the number of rays per cluster of all of them, which bound the BF gain
+static const uint32_t MAX_CLUSTERS = 20;
+static const uint32_t RAYS_PER_CLUSTER = 20;
+
+/*
+ * The generations of the channel realizations, see GetChannelGeneration.
+ * They are unique among all the channels of all the MmWave3gppChannel
+ * instances, and are never 0
+ */
+static uint64_t
+NextChannelGeneration (void)
+{
+  static uint64_t lastGeneration = 0;
+  return ++lastGeneration;
+}
+
 //Table 7.5-3: Ray offset angles within a cluster, given for rms angle spread normalized to 1.
 static const double offSetAlpha[20] = {
   0.0447,-0.0447,0.1413,-0.1413,0.2492,-0.2492,0.3715,-0.3715,0.5129,-0.5129,0.6797,-0.6797,0.8844,-0.8844,1.1481,-1.1481,1.5195,-1.5195,2.1551,-2.1551
@@ -177,6 +199,8 @@ MmWave3gppChannel::MmWave3gppChannel ()
   m_normalRvBlockage->SetAttribute ("Variance", DoubleValue (1));
   m_forceInitialBfComputation = false;
   m_interferenceOrDataMode = true;
+  m_updateScheduler.SetRefreshCallback (MakeCallback (&MmWave3gppChannel::RefreshChannels, this));
+  MmWaveBeamformingKernels::Configure ();
 }
 
 TypeId
@@ -189,6 +213,20 @@ MmWave3gppChannel::GetTypeId (void)
                    TimeValue (MilliSeconds (1)),
                    MakeTimeAccessor (&MmWave3gppChannel::m_updatePeriod),
                    MakeTimeChecker ())
+    .AddAttribute ("UpdateGranularity",
+                   "The update times of the channels are rounded up to a multiple of this value, "
+                   "so that the channels whose update is due in the same interval are updated together. "
+                   "Set to 0 ms to update each channel exactly after UpdatePeriod",
+                   TimeValue (MilliSeconds (0)),
+                   MakeTimeAccessor (&MmWave3gppChannel::SetUpdateGranularity,
+                                     &MmWave3gppChannel::GetUpdateGranularity),
+                   MakeTimeChecker ())
+    .AddAttribute ("EagerUpdate",
+                   "If true, the channels are updated as soon as their update is due. "
+                   "If false, they are updated at the next transmission on the link",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWave3gppChannel::m_eagerUpdate),
+                   MakeBooleanChecker ())
     .AddAttribute ("DirectBeam",
                    "If true, creates aligned beams between transmitter and receiver. If false, use optimal beamforming vector computation",
                    BooleanValue (false),
@@ -214,6 +252,36 @@ MmWave3gppChannel::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&MmWave3gppChannel::m_portraitMode),
                    MakeBooleanChecker ())
+    .AddAttribute ("LongTermBfMethod",
+                   "Method used to compute the optimal BF vectors when DirectBeam is false: "
+                   "the dominant eigenvectors of the tx and rx spatial correlation matrices, "
+                   "the dominant singular vectors of the channel matrix summed over the clusters, "
+                   "or the best pair of beams of the DFT codebooks, with an exhaustive or a two-stage search",
+                   EnumValue (MmWave3gppChannel::COV_MATRIX),
+                   MakeEnumAccessor (&MmWave3gppChannel::m_longTermBfMethod),
+                   MakeEnumChecker (MmWave3gppChannel::COV_MATRIX, "CovMatrix",
+                                    MmWave3gppChannel::RANK1_SVD, "Rank1Svd",
+                                    MmWave3gppChannel::BEAM_SEARCH, "BeamSearch",
+                                    MmWave3gppChannel::HIERARCHICAL_BEAM_SEARCH, "HierarchicalBeamSearch"))
+    .AddAttribute ("BfMaxIterations",
+                   "Maximum number of iterations of the power method used to compute the optimal BF vectors",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&MmWave3gppChannel::m_bfMaxIterations),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BfTolerance",
+                   "The power method stops when the squared norm of the difference between two consecutive BF vectors is below this value",
+                   DoubleValue (1e-10),
+                   MakeDoubleAccessor (&MmWave3gppChannel::m_bfTolerance),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxGainMarginDb",
+                   "Added to the upper bound of the BF gain of a link, which is used by the receivers to neglect "
+                   "the weak interferers. The bound is the array gain (the product of the number of antenna "
+                   "elements at the two ends), times the maximum gain of the elements at the two ends, times "
+                   "the number of rays that may add up coherently. Negative values assume that the rays never "
+                   "add up coherently, and neglect more interferers",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&MmWave3gppChannel::m_maxGainMarginDb),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
@@ -227,6 +295,11 @@ void
 MmWave3gppChannel::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_updateScheduler.Clear ();
+  m_linkEndMap.clear ();
+  m_channelTable.Clear ();
+  m_connectedPair.Clear ();
+  m_deviceRegistry.Clear ();
 }
 
 void
@@ -245,14 +318,7 @@ MmWave3gppChannel::GetConfigurationParameters (void) const
 void
 MmWave3gppChannel::ConnectDevices (Ptr<NetDevice> dev1, Ptr<NetDevice> dev2)
 {
-  key_t key = std::make_pair (dev1,dev2);
-
-  std::map< key_t, int >::iterator iter = m_connectedPair.find (key);
-  if (iter != m_connectedPair.end ())
-    {
-      m_connectedPair.erase (iter);
-    }
-  m_connectedPair.insert (std::make_pair (key,1));
+  m_connectedPair.Get (m_deviceRegistry.Register (dev1), m_deviceRegistry.Register (dev2)) = 1;
 }
 
 void
@@ -389,26 +455,209 @@ MmWave3gppChannel::Initial (NetDeviceContainer ueDevices, NetDeviceContainer enb
 
 
 
+const MmWave3gppChannel::LinkEnd &
+MmWave3gppChannel::GetLinkEnd (Ptr<const MobilityModel> mobility) const
+{
+  std::map<Ptr<const MobilityModel>, LinkEnd>::iterator it = m_linkEndMap.find (mobility);
+  if (it != m_linkEndMap.end ())
+    {
+      return it->second;
+    }
+
+  // the device of a node, its type and its antenna array do not change
+  // during the simulation, thus they are resolved only once
+  uint8_t ccId = m_phyMacConfig->GetCcId ();
+  LinkEnd end;
+  end.m_mobility = mobility;
+  Ptr<Node> node = mobility->GetObject<Node> ();
+  end.m_nodeId = node->GetId ();
+  end.m_device = node->GetDevice (0);
+  end.m_deviceIndex = m_deviceRegistry.Register (end.m_device);
+  end.m_enb = DynamicCast<MmWaveEnbNetDevice> (end.m_device);
+  end.m_ue = DynamicCast<MmWaveUeNetDevice> (end.m_device);
+  end.m_mcUe = DynamicCast<McUeNetDevice> (end.m_device);
+  end.m_antennaNum = 0;
+  if (end.m_enb != 0)
+    {
+      end.m_antennaNum = sqrt (end.m_enb->GetAntennaNum ());
+      end.m_antennaArray = DynamicCast<AntennaArrayModel> (
+          end.m_enb->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
+    }
+  else if (end.m_ue != 0)
+    {
+      end.m_antennaNum = sqrt (end.m_ue->GetAntennaNum ());
+      end.m_antennaArray = DynamicCast<AntennaArrayModel> (
+          end.m_ue->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
+    }
+  else if (end.m_mcUe != 0)
+    {
+      end.m_antennaNum = sqrt (end.m_mcUe->GetAntennaNum ());
+      end.m_antennaArray = DynamicCast<AntennaArrayModel> (
+          end.m_mcUe->GetMmWavePhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
+    }
+  return m_linkEndMap.insert (std::make_pair (mobility, end)).first->second;
+}
+
+MmWave3gppChannel::SubbandParams
+MmWave3gppChannel::GetSubbandParams (void) const
+{
+  SubbandParams subband;
+  subband.m_slotTime = Simulator::Now ().GetSeconds ();
+  subband.m_centerFrequency = m_phyMacConfig->GetCenterFrequency ();
+  subband.m_firstFrequency = subband.m_centerFrequency - GetSystemBandwidth () / 2;
+  subband.m_chunkWidth = m_phyMacConfig->GetChunkWidth ();
+  return subband;
+}
+
 Ptr<SpectrumValue>
 MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
                                                  Ptr<const MobilityModel> a,
                                                  Ptr<const MobilityModel> b) const
 {
   NS_LOG_FUNCTION (this);
-  Ptr<SpectrumValue> rxPsd = Copy (txPsd);
+  Ptr<SpectrumValue> rxPsd = txPsd->Copy ();
+  DoCalcRxPowerSpectralDensityInPlace (rxPsd, a, b);
+  return rxPsd;
+}
 
-  uint8_t ccId = m_phyMacConfig->GetCcId ();
+void
+MmWave3gppChannel::DoCalcRxPowerSpectralDensityInPlace (Ptr<SpectrumValue> psd,
+                                                        Ptr<const MobilityModel> a,
+                                                        Ptr<const MobilityModel> b) const
+{
+  NS_LOG_FUNCTION (this);
+  const LinkEnd &tx = GetLinkEnd (a);
+  const LinkEnd &rx = GetLinkEnd (b);
+  LinkGain gain;
+  PrepareLink (psd, tx, rx, gain);
+  if (gain.m_params == 0)
+    {
+      return;
+    }
+  // the transmitted PSD is kept only to print the BF gain
+  Ptr<const SpectrumValue> txPsd = g_log.IsEnabled (ns3::LOG_DEBUG) ? psd->Copy () : psd;
+  ApplyBeamformingGain (&(*psd->ValuesBegin ()), psd->GetSpectrumModel ()->GetNumBands (),
+                        *gain.m_params, gain.m_longTerm, gain.m_speed, GetSubbandParams ());
+  LogLinkGain (txPsd, psd, tx, rx, gain);
+}
 
-  Ptr<NetDevice> txDevice = a->GetObject<Node> ()->GetDevice (0);
-  Ptr<NetDevice> rxDevice = b->GetObject<Node> ()->GetDevice (0);
-  Ptr<MmWaveEnbNetDevice> txEnb =
-    DynamicCast<MmWaveEnbNetDevice> (txDevice);
-  Ptr<McUeNetDevice> rxMcUe =
-    DynamicCast<McUeNetDevice> (rxDevice);
-  Ptr<McUeNetDevice> txMcUe =
-    DynamicCast<McUeNetDevice> (txDevice);
-  Ptr<mmwave::MmWaveUeNetDevice> rxUe =
-    DynamicCast<mmwave::MmWaveUeNetDevice> (rxDevice);
+double
+MmWave3gppChannel::DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                   Ptr<const MobilityModel> b) const
+{
+  const LinkEnd &tx = GetLinkEnd (a);
+  const LinkEnd &rx = GetLinkEnd (b);
+  if (tx.m_antennaNum == 0 || rx.m_antennaNum == 0)
+    {
+      // no BF gain is applied to the links of other devices
+      return 0;
+    }
+  // with unit norm BF vectors, each ray of power P/M, of the M rays of a cluster
+  // of power P, contributes at most Ntx * Nrx * Gtx * Grx * P/M to the gain,
+  // where G is the maximum gain of the elements, and the rays of all the
+  // clusters add up to at most the number of rays times that. The cluster
+  // powers sum to one, and the LOS ray counts as one more ray.
+  // m_antennaNum is the number of elements per row of the square arrays
+  return 20 * std::log10 (double (tx.m_antennaNum) * rx.m_antennaNum)
+         + tx.m_antennaArray->GetMaxElementGainDb () + rx.m_antennaArray->GetMaxElementGainDb ()
+         + 10 * std::log10 (double (MAX_CLUSTERS * RAYS_PER_CLUSTER + 1)) + m_maxGainMarginDb;
+}
+
+/**
+ * The task that applies the BF gain to the links of a batch, which
+ * can be executed by the threads of a SpectrumWorkerPool
+ */
+struct MmWave3gppChannel::BeamformingGainTask
+{
+  const std::vector<LinkGain> *m_gains;
+  const std::vector<Ptr<SpectrumValue> > *m_psds;
+  const SubbandParams *m_subband;
+
+  void Run (uint32_t i)
+  {
+    const LinkGain &gain = (*m_gains)[i];
+    if (gain.m_params != 0)
+      {
+        // no Ptr is copied here, since the reference count is not thread safe
+        SpectrumValue &psd = *PeekPointer ((*m_psds)[i]);
+        ApplyBeamformingGain (&(*psd.ValuesBegin ()), psd.ValuesEnd () - psd.ValuesBegin (), *gain.m_params,
+                              gain.m_longTerm, gain.m_speed, *m_subband);
+      }
+  }
+};
+
+void
+MmWave3gppChannel::DoCalcRxPowerSpectralDensityBatch (const std::vector<Ptr<SpectrumValue> > &psds,
+                                                      Ptr<const MobilityModel> a,
+                                                      const std::vector<Ptr<const MobilityModel> > &b,
+                                                      Ptr<SpectrumWorkerPool> pool) const
+{
+  NS_LOG_FUNCTION (this << b.size ());
+
+  // the transmitter and the subband frequencies are the same for all the receivers
+  const LinkEnd &tx = GetLinkEnd (a);
+  SubbandParams subband = GetSubbandParams ();
+
+  // first, create or update the channels and select the BF vectors. This
+  // draws random numbers and schedules events, thus it is done serially
+  std::vector<LinkGain> gains (b.size ());
+  for (size_t i = 0; i < b.size (); ++i)
+    {
+      PrepareLink (psds[i], tx, GetLinkEnd (b[i]), gains[i]);
+    }
+
+  // the transmitted PSDs are kept only to print the BF gain
+  std::vector<Ptr<const SpectrumValue> > txPsds;
+  if (g_log.IsEnabled (ns3::LOG_DEBUG))
+    {
+      for (size_t i = 0; i < b.size (); ++i)
+        {
+          txPsds.push_back (psds[i]->Copy ());
+        }
+    }
+
+  // then apply the BF gain, which only depends on the data of each link
+  BeamformingGainTask task;
+  task.m_gains = &gains;
+  task.m_psds = &psds;
+  task.m_subband = &subband;
+  if (pool != 0)
+    {
+      pool->ParallelFor (b.size (), MakeCallback (&BeamformingGainTask::Run, &task));
+    }
+  else
+    {
+      for (uint32_t i = 0; i < b.size (); ++i)
+        {
+          task.Run (i);
+        }
+    }
+
+  for (size_t i = 0; i < txPsds.size (); ++i)
+    {
+      if (gains[i].m_params != 0)
+        {
+          LogLinkGain (txPsds[i], psds[i], tx, GetLinkEnd (b[i]), gains[i]);
+        }
+    }
+}
+
+void
+MmWave3gppChannel::PrepareLink (Ptr<const SpectrumValue> rxPsd, const LinkEnd &tx, const LinkEnd &rx,
+                                LinkGain &gain) const
+{
+  gain.m_params = 0;
+  Ptr<const MobilityModel> a = tx.m_mobility;
+  Ptr<const MobilityModel> b = rx.m_mobility;
+  Ptr<NetDevice> txDevice = tx.m_device;
+  Ptr<NetDevice> rxDevice = rx.m_device;
+  Ptr<MmWaveEnbNetDevice> txEnb = tx.m_enb;
+  Ptr<McUeNetDevice> rxMcUe = rx.m_mcUe;
+  Ptr<McUeNetDevice> txMcUe = tx.m_mcUe;
+  Ptr<mmwave::MmWaveUeNetDevice> rxUe = rx.m_ue;
+  // the positions are read many times below
+  Vector aPos = MobilitySnapshot::GetPosition (tx.m_nodeId);
+  Vector bPos = MobilitySnapshot::GetPosition (rx.m_nodeId);
 
   bool downlink = false;
   bool downlinkMc = false;
@@ -417,91 +666,48 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 
   /* txAntennaNum[0]-number of vertical antenna elements
    * txAntennaNum[1]-number of horizontal antenna elements*/
-  uint16_t txAntennaNum[2];
-  uint16_t rxAntennaNum[2];
-  Ptr<AntennaArrayModel> txAntennaArray, rxAntennaArray;
+  uint16_t txAntennaNum[2] = {tx.m_antennaNum, tx.m_antennaNum};
+  uint16_t rxAntennaNum[2] = {rx.m_antennaNum, rx.m_antennaNum};
+  Ptr<AntennaArrayModel> txAntennaArray = tx.m_antennaArray;
+  Ptr<AntennaArrayModel> rxAntennaArray = rx.m_antennaArray;
 
   Vector locUT;
   if (txEnb != 0 && rxUe != 0 && rxMcUe == 0)
     {
-      NS_LOG_INFO ("this is downlink case, a tx " << a->GetPosition () << " b rx " << b->GetPosition ());
+      NS_LOG_INFO ("this is downlink case, a tx " << aPos << " b rx " << bPos);
       downlink = true;
-      txAntennaNum[0] = sqrt (txEnb->GetAntennaNum ());
-      txAntennaNum[1] = sqrt (txEnb->GetAntennaNum ());
-      rxAntennaNum[0] = sqrt (rxUe->GetAntennaNum ());
-      rxAntennaNum[1] = sqrt (rxUe->GetAntennaNum ());
-
-      txAntennaArray = DynamicCast<AntennaArrayModel> (
-          txEnb->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      rxAntennaArray = DynamicCast<AntennaArrayModel> (
-          rxUe->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      locUT = b->GetPosition ();
-
+      locUT = bPos;
     }
   else if (txEnb != 0 && rxMcUe != 0 && rxUe == 0)
     {
-      NS_LOG_INFO ("this is MC downlink case, a tx " << a->GetPosition () << " b rx " << b->GetPosition ());
+      NS_LOG_INFO ("this is MC downlink case, a tx " << aPos << " b rx " << bPos);
       downlinkMc = true;
-      txAntennaNum[0] = sqrt (txEnb->GetAntennaNum ());
-      txAntennaNum[1] = sqrt (txEnb->GetAntennaNum ());
-      rxAntennaNum[0] = sqrt (rxMcUe->GetAntennaNum ());
-      rxAntennaNum[1] = sqrt (rxMcUe->GetAntennaNum ());
-
-      txAntennaArray = DynamicCast<AntennaArrayModel> (
-          txEnb->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      rxAntennaArray = DynamicCast<AntennaArrayModel> (
-          rxMcUe->GetMmWavePhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      locUT = b->GetPosition ();
+      locUT = bPos;
     }
   else if (txEnb == 0 && rxUe == 0 && txMcUe == 0 && rxMcUe == 0)
     {
-      NS_LOG_INFO ("this is uplink case, a tx " << a->GetPosition () << " b rx " << b->GetPosition ());
+      NS_LOG_INFO ("this is uplink case, a tx " << aPos << " b rx " << bPos);
+      NS_ASSERT_MSG (tx.m_ue != 0 && rx.m_enb != 0, "uplink transmission between unexpected devices");
       uplink = true;
-      Ptr<mmwave::MmWaveUeNetDevice> txUe =
-        DynamicCast<mmwave::MmWaveUeNetDevice> (txDevice);
-      Ptr<MmWaveEnbNetDevice> rxEnb =
-        DynamicCast<MmWaveEnbNetDevice> (rxDevice);
-
-      txAntennaNum[0] = sqrt (txUe->GetAntennaNum ());
-      txAntennaNum[1] = sqrt (txUe->GetAntennaNum ());
-      rxAntennaNum[0] = sqrt (rxEnb->GetAntennaNum ());
-      rxAntennaNum[1] = sqrt (rxEnb->GetAntennaNum ());
-
-      txAntennaArray = DynamicCast<AntennaArrayModel> (
-          txUe->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      rxAntennaArray = DynamicCast<AntennaArrayModel> (
-          rxEnb->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      locUT = a->GetPosition ();
-
+      locUT = aPos;
     }
   else if (txEnb == 0 && rxUe == 0 && txMcUe != 0 && rxMcUe == 0)
     {
-      NS_LOG_INFO ("this is MC uplink case, a tx " << a->GetPosition () << " b rx " << b->GetPosition ());
+      NS_LOG_INFO ("this is MC uplink case, a tx " << aPos << " b rx " << bPos);
+      NS_ASSERT_MSG (rx.m_enb != 0, "uplink transmission between unexpected devices");
       uplinkMc = true;
-      Ptr<MmWaveEnbNetDevice> rxEnb =
-        DynamicCast<MmWaveEnbNetDevice> (rxDevice);
-
-      txAntennaNum[0] = sqrt (txMcUe->GetAntennaNum ());
-      txAntennaNum[1] = sqrt (txMcUe->GetAntennaNum ());
-      rxAntennaNum[0] = sqrt (rxEnb->GetAntennaNum ());
-      rxAntennaNum[1] = sqrt (rxEnb->GetAntennaNum ());
-
-      txAntennaArray = DynamicCast<AntennaArrayModel> (
-          txMcUe->GetMmWavePhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      rxAntennaArray = DynamicCast<AntennaArrayModel> (
-          rxEnb->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
-      locUT = a->GetPosition ();
+      locUT = aPos;
     }
   else
     {
-      NS_LOG_INFO ("enb to enb or ue to ue transmission, skip beamforming a tx " << a->GetPosition () << " b rx " << b->GetPosition ());
-      return rxPsd;
+      NS_LOG_INFO ("enb to enb or ue to ue transmission, skip beamforming a tx " << aPos << " b rx " << bPos);
+      return;
     }
 
   if (txAntennaArray->IsOmniTx () || rxAntennaArray->IsOmniTx () )
     {
       //omi transmission, do nothing.
-      return rxPsd;
+      return;
     }
 
   /*txAntennaNum[0] = 1;
@@ -509,17 +715,14 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   rxAntennaNum[0] = 1;
   rxAntennaNum[1] = 1;*/
 
-  NS_ASSERT_MSG (a->GetDistanceFrom (b) != 0, "the position of tx and rx devices cannot be the same");
+  NS_ASSERT_MSG (CalculateDistance (aPos, bPos) != 0, "the position of tx and rx devices cannot be the same");
 
-  Vector rxSpeed = b->GetVelocity ();
-  Vector txSpeed = a->GetVelocity ();
+  Vector rxSpeed = MobilitySnapshot::GetVelocity (rx.m_nodeId);
+  Vector txSpeed = MobilitySnapshot::GetVelocity (tx.m_nodeId);
   Vector relativeSpeed (rxSpeed.x - txSpeed.x,rxSpeed.y - txSpeed.y,rxSpeed.z - txSpeed.z);
 
-  key_t key = std::make_pair (txDevice,rxDevice);
-  key_t keyReverse = std::make_pair (rxDevice,txDevice);
-
-  std::map< key_t, Ptr<Params3gpp> >::iterator it = m_channelMap.find (key);
-  std::map< key_t, Ptr<Params3gpp> >::iterator itReverse = m_channelMap.find (keyReverse);
+  Ptr<Params3gpp> *it = m_channelTable.Find (tx.m_deviceIndex, rx.m_deviceIndex);
+  Ptr<Params3gpp> *itReverse = m_channelTable.Find (rx.m_deviceIndex, tx.m_deviceIndex);
 
   Ptr<Params3gpp> channelParams;
 
@@ -528,15 +731,13 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   //Step 2: Assign propagation condition (LOS/NLOS).
 
   char condition;
-  if (DynamicCast<MmWave3gppPropagationLossModel> (m_3gppPathloss) != 0)
+  if (m_3gppPropagationLoss != 0)
     {
-      condition = m_3gppPathloss->GetObject<MmWave3gppPropagationLossModel> ()
-        ->GetChannelCondition (a->GetObject<MobilityModel> (),b->GetObject<MobilityModel> ());
+      condition = m_3gppPropagationLoss->GetChannelCondition (a->GetObject<MobilityModel> (),b->GetObject<MobilityModel> ());
     }
-  else if (DynamicCast<MmWave3gppBuildingsPropagationLossModel> (m_3gppPathloss) != 0)
+  else if (m_3gppBuildingsPropagationLoss != 0)
     {
-      condition = m_3gppPathloss->GetObject<MmWave3gppBuildingsPropagationLossModel> ()
-        ->GetChannelCondition (a->GetObject<MobilityModel> (),b->GetObject<MobilityModel> ());
+      condition = m_3gppBuildingsPropagationLoss->GetChannelCondition (a->GetObject<MobilityModel> (),b->GetObject<MobilityModel> ());
     }
   else
     {
@@ -564,90 +765,116 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   //Therefore, LOS/NLOS condition of updating is always consistent with the previous channel.
 
   //I only update the forward channel.
-  if ((it == m_channelMap.end () && itReverse == m_channelMap.end ())
-      || (it != m_channelMap.end () && it->second->m_channel.size () == 0)
-      || (it != m_channelMap.end () && it->second->m_los != los))
+  //A channel refreshed outside a transmission has no BF vectors yet.
+  if ((it == 0 && itReverse == 0)
+      || (it != 0 && (*it)->m_channel.IsEmpty ())
+      || (it != 0 && (*it)->m_los != los)
+      || (it != 0 && (*it)->m_beamformingPending))
     {
       NS_LOG_INFO ("Update or create the forward channel");
-      NS_LOG_LOGIC ("it == m_channelMap.end () " << (it == m_channelMap.end ()));
-      NS_LOG_LOGIC ("itReverse == m_channelMap.end () " << (itReverse == m_channelMap.end ()));
-      NS_LOG_LOGIC ("it->second->m_channel.size() == 0 " << (it->second->m_channel.size () == 0));
-      NS_LOG_LOGIC ("it->second->m_los != los" << (it->second->m_los != los));
+      NS_LOG_LOGIC ("it == 0 " << (it == 0));
+      NS_LOG_LOGIC ("itReverse == 0 " << (itReverse == 0));
+      NS_LOG_LOGIC ("(*it)->m_channel.IsEmpty () " << (it != 0 && (*it)->m_channel.IsEmpty ()));
+      NS_LOG_LOGIC ("(*it)->m_los != los" << (it != 0 && (*it)->m_los != los));
+      NS_LOG_LOGIC ("(*it)->m_beamformingPending " << (it != 0 && (*it)->m_beamformingPending));
 
-      //Step 1: The parameters are configured in the example code.
-      /*make sure txAngle rxAngle exist, i.e., the position of tx and rx cannot be the same*/
-      Angles txAngle (b->GetPosition (), a->GetPosition ());
-      Angles rxAngle (a->GetPosition (), b->GetPosition ());
-      NS_LOG_DEBUG ("txAngle  " << txAngle.phi << " " << txAngle.theta);
-      NS_LOG_DEBUG ("rxAngle " << rxAngle.phi << " " << rxAngle.theta);
+      bool channelUpdate = false;
+      if (it != 0 && (*it)->m_beamformingPending && !(*it)->m_channel.IsEmpty () && (*it)->m_los == los)
+        {
+          NS_LOG_INFO ("Select the BF vectors of the refreshed channel");
+          channelParams = *it;
+          channelParams->m_beamformingPending = false;
+          channelUpdate = true;
+        }
+      else
+        {
+          //Step 1: The parameters are configured in the example code.
+          /*make sure txAngle rxAngle exist, i.e., the position of tx and rx cannot be the same*/
+          Angles txAngle (bPos, aPos);
+          Angles rxAngle (aPos, bPos);
+          NS_LOG_DEBUG ("txAngle  " << txAngle.phi << " " << txAngle.theta);
+          NS_LOG_DEBUG ("rxAngle " << rxAngle.phi << " " << rxAngle.theta);
 
-      txAngle.phi = txAngle.phi - txAntennaArray->GetOffset ();          //adjustment of the angles due to multi-sector consideration
-      NS_LOG_DEBUG ("txAngle with offset PHI " << txAngle.phi);
-      rxAngle.phi = rxAngle.phi - rxAntennaArray->GetOffset ();
-      NS_LOG_DEBUG ("rxAngle with offset PHI " << rxAngle.phi);
+          txAngle.phi = txAngle.phi - txAntennaArray->GetOffset ();          //adjustment of the angles due to multi-sector consideration
+          NS_LOG_DEBUG ("txAngle with offset PHI " << txAngle.phi);
+          rxAngle.phi = rxAngle.phi - rxAntennaArray->GetOffset ();
+          NS_LOG_DEBUG ("rxAngle with offset PHI " << rxAngle.phi);
 
-      //Step 2: Assign propagation condition (LOS/NLOS).
-      //los, o2i condition is computed above.
+          //Step 2: Assign propagation condition (LOS/NLOS).
+          //los, o2i condition is computed above.
 
-      //Step 3: The propagation loss is handled in the mmWavePropagationLossModel class.
+          //Step 3: The propagation loss is handled in the mmWavePropagationLossModel class.
 
 
-      double x = a->GetPosition ().x - b->GetPosition ().x;
-      double y = a->GetPosition ().y - b->GetPosition ().y;
-      double distance2D = sqrt (x * x + y * y);
-      double hUT, hBS;
-      if (rxUe != 0 || rxMcUe != 0)
-        {
-          hUT = b->GetPosition ().z;
-          hBS = a->GetPosition ().z;
-        }
-      else
-        {
-          hUT = a->GetPosition ().z;
-          hBS = b->GetPosition ().z;
-        }
-      //Draw parameters from table 7.5-6 and 7.5-7 to 7.5-10.
-      Ptr<ParamsTable> table3gpp = Get3gppTable (los, o2i, hBS, hUT, distance2D);
+          double x = aPos.x - bPos.x;
+          double y = aPos.y - bPos.y;
+          double distance2D = sqrt (x * x + y * y);
+          double hUT, hBS;
+          if (rxUe != 0 || rxMcUe != 0)
+            {
+              hUT = bPos.z;
+              hBS = aPos.z;
+            }
+          else
+            {
+              hUT = aPos.z;
+              hBS = bPos.z;
+            }
+          //Draw parameters from table 7.5-6 and 7.5-7 to 7.5-10.
+          Ptr<ParamsTable> table3gpp = Get3gppTable (los, o2i, hBS, hUT, distance2D);
 
-      // Step 4-11 are performed in function GetNewChannel()
-      if ((it == m_channelMap.end () && itReverse == m_channelMap.end ())
-          || (it != m_channelMap.end () && it->second->m_channel.size () == 0))
-        {
-          //delete the channel parameter to cause the channel to be updated again.
-          //The m_updatePeriod can be configured to be relatively large in order to disable updates.
-          if (m_updatePeriod.GetMilliSeconds () > 0)
+          // Step 4-11 are performed in function GetNewChannel()
+          if ((it == 0 && itReverse == 0)
+              || (it != 0 && (*it)->m_channel.IsEmpty ()))
             {
-              NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << " schedule delete for a " << a->GetPosition () << " b " << b->GetPosition ()
-                                   << " m_updatePeriod " << m_updatePeriod.GetSeconds ());
-              Simulator::Schedule (m_updatePeriod, &MmWave3gppChannel::DeleteChannel,this,a,b);
+              //delete the channel parameter to cause the channel to be updated again.
+              //The m_updatePeriod can be configured to be relatively large in order to disable updates.
+              if (m_updatePeriod.GetMilliSeconds () > 0)
+                {
+                  NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << " schedule delete for a " << aPos << " b " << bPos
+                                       << " m_updatePeriod " << m_updatePeriod.GetSeconds ());
+                  m_updateScheduler.ScheduleRefresh (m_updatePeriod, a, b);
+                }
             }
-        }
 
-      double distance3D = a->GetDistanceFrom (b);
+          double distance3D = CalculateDistance (aPos, bPos);
 
-      bool channelUpdate = false;
-      if (it != m_channelMap.end () && it->second->m_channel.size () == 0)
-        {
-          //if the channel map is not empty, we only update the channel.
-          NS_LOG_DEBUG ("Update forward channel consistently between MobilityModel " << a << " " << b);
-          it->second->m_locUT = locUT;
-          it->second->m_los = los;
-          it->second->m_o2i = o2i;
-          channelParams = UpdateChannel (it->second, table3gpp, txAntennaArray, rxAntennaArray,
-                                         txAntennaNum, rxAntennaNum, rxAngle, txAngle);
-          it->second->m_dis3D = distance3D;
-          it->second->m_dis2D = distance2D;
-          it->second->m_speed = relativeSpeed;
-          it->second->m_generatedTime = Now ();
-          it->second->m_preLocUT = locUT;
-          channelUpdate = true;
+          if (it != 0 && (*it)->m_channel.IsEmpty ())
+            {
+              //if the channel map is not empty, we only update the channel.
+              NS_LOG_DEBUG ("Update forward channel consistently between MobilityModel " << a << " " << b);
+              (*it)->m_locUT = locUT;
+              (*it)->m_los = los;
+              (*it)->m_o2i = o2i;
+              channelParams = UpdateChannel (*it, table3gpp, txAntennaArray, rxAntennaArray,
+                                             txAntennaNum, rxAntennaNum, rxAngle, txAngle);
+              (*it)->m_dis3D = distance3D;
+              (*it)->m_dis2D = distance2D;
+              (*it)->m_speed = relativeSpeed;
+              (*it)->m_generatedTime = Now ();
+              (*it)->m_preLocUT = locUT;
+              channelUpdate = true;
+            }
+          else
+            {
+              //if the channel map is empty, we create a new channel.
+              NS_LOG_INFO ("Create new channel");
+              channelParams = GetNewChannel (table3gpp, locUT, los, o2i, txAntennaArray, rxAntennaArray,
+                                             txAntennaNum, rxAntennaNum, rxAngle, txAngle, relativeSpeed, distance2D, distance3D);
+            }
         }
-      else
+
+      if (rxPsd == 0)
         {
-          //if the channel map is empty, we create a new channel.
-          NS_LOG_INFO ("Create new channel");
-          channelParams = GetNewChannel (table3gpp, locUT, los, o2i, txAntennaArray, rxAntennaArray,
-                                         txAntennaNum, rxAntennaNum, rxAngle, txAngle, relativeSpeed, distance2D, distance3D);
+          // refreshed outside a transmission: the devices the antennas are
+          // pointing at are not set, thus the BF vectors are selected at the
+          // next transmission on the link
+          NS_LOG_INFO ("Channel refreshed, the BF vectors are selected at the next transmission");
+          channelParams->m_beamformingPending = true;
+          channelParams->m_allLongTermMap.clear ();
+          channelParams->m_generation = NextChannelGeneration ();
+          m_channelTable.Get (tx.m_deviceIndex, rx.m_deviceIndex) = channelParams;
+          return;
         }
 
       // std::map< key_t, int >::iterator it1 = m_connectedPair.find (key);
@@ -679,6 +906,9 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
           NS_LOG_DEBUG ("Consider UE " << txDevice << " connected to eNB " << enbConnectedToUeOfThisLink << " current link eNB " << rxDevice);
         }
 
+      // the long term components computed for the previous realization are not valid anymore
+      channelParams->m_allLongTermMap.clear ();
+
       if (m_directBeam)
         {
           if (downlink || downlinkMc)
@@ -688,40 +918,13 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
                   enbConnectedToUeOfThisLink = txDevice;
                 }
 
+              // update the beams of the eNB towards all the UEs, and the one of the UE towards
+              // the eNB to which it is associated (i.e., this eNB or another one). The long term
+              // components for interference or data tx are computed when needed, by GetInterferenceLongTerm
+              rxAntennaArray->SetBeamformingVectorPanelDevices (rxDevice,enbConnectedToUeOfThisLink);                                      // always consider rxDevice and the eNB to which it is actually connected
               for (auto ueDevIter = m_ueNetDeviceContainer.Begin (); ueDevIter != m_ueNetDeviceContainer.End (); ++ueDevIter)
                 {
-                  NS_LOG_DEBUG ("Compute LongTerm elements for DL eNB " << txDevice << " UE " << *ueDevIter << " for interference or data cases");
-
-                  // for interference or data tx: compute the longTerm component that
-                  // is associated to the channel between a and b, with the eNB using
-                  // the beamforming vector towards the UE in *ueDevIter and the UE
-                  // using the beamforming vector toward the eNB to which is associated
-                  // (i.e., this eNB or another one)
-                  rxAntennaArray->SetBeamformingVectorPanelDevices (rxDevice,enbConnectedToUeOfThisLink);                                      // always consider rxDevice and the eNB to which it is actually connected
                   txAntennaArray->SetBeamformingVectorPanelDevices (txDevice, *ueDevIter);
-
-                  // for now, store these BF vectors so that CalLongTerm can use them
-                  channelParams->m_txW = txAntennaArray->GetBeamformingVectorPanel ();
-                  channelParams->m_rxW = rxAntennaArray->GetBeamformingVectorPanel ();
-
-                  // call CalLongTerm, and get the longTerm params
-                  auto longTerm = CalLongTerm (channelParams);
-
-                  auto longTermIter = channelParams->m_allLongTermMap.find ((*ueDevIter));
-                  if (longTermIter == channelParams->m_allLongTermMap.end ())
-                    {
-                      channelParams->m_allLongTermMap.insert (std::make_pair ((*ueDevIter), longTerm));
-                    }
-                  else                                       //update
-                    {
-                      longTermIter->second = longTerm;
-                    }
-
-                  NS_LOG_DEBUG ("Compute the BF gain you would get on this link with these BF vector");
-                  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (rxPsd, channelParams, longTerm, relativeSpeed);
-                  SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
-                  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-                  NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain) / nbands);
                 }
 
               NS_LOG_DEBUG ("Compute LongTerm elements for DL eNB " << txDevice << " UE " << rxDevice << " for reference signals");
@@ -750,38 +953,12 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
                   enbConnectedToUeOfThisLink = rxDevice;
                 }
 
+              // update the beams of the eNB towards all the UEs, and the one of the UE towards
+              // the eNB to which it is associated (i.e., this eNB or another one)
+              txAntennaArray->SetBeamformingVectorPanelDevices (txDevice,enbConnectedToUeOfThisLink);                                      // TODO always consider txDevice and txAntenna
               for (auto ueDevIter = m_ueNetDeviceContainer.Begin (); ueDevIter != m_ueNetDeviceContainer.End (); ++ueDevIter)
                 {
-                  NS_LOG_DEBUG ("Compute LongTerm elements for UL eNB " << txDevice << " UE " << *ueDevIter << " for interference or data cases");
-                  // for interference or data tx: compute the longTerm component that
-                  // is associated to the channel between a and b, with the eNB using
-                  // the beamforming vector towards the UE in *ueDevIter and the UE
-                  // using the beamforming vector toward the eNB to which is associated
-                  // (i.e., this eNB or another one)
-                  txAntennaArray->SetBeamformingVectorPanelDevices (txDevice,enbConnectedToUeOfThisLink);                                      // TODO always consider txDevice and txAntenna
                   rxAntennaArray->SetBeamformingVectorPanelDevices (rxDevice,*ueDevIter);
-
-                  // for now, store these BF vectors so that CalLongTerm can use them
-                  channelParams->m_txW = txAntennaArray->GetBeamformingVectorPanel ();
-                  channelParams->m_rxW = rxAntennaArray->GetBeamformingVectorPanel ();
-
-                  // call CalLongTerm, and get the longTerm params
-                  auto longTerm = CalLongTerm (channelParams);
-
-                  auto longTermIter = channelParams->m_allLongTermMap.find ((*ueDevIter));
-                  if (longTermIter == channelParams->m_allLongTermMap.end ())
-                    {
-                      channelParams->m_allLongTermMap.insert (std::make_pair ((*ueDevIter), longTerm));
-                    }
-                  else                                       //update
-                    {
-                      longTermIter->second = longTerm;
-                    }
-                  NS_LOG_DEBUG ("Compute the BF gain you would get on this link with these BF vector");
-                  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (rxPsd, channelParams, longTerm, relativeSpeed);
-                  SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
-                  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-                  NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain) / nbands);
                 }
 
               // TODO check if we can do this independently of DL or UL
@@ -807,7 +984,14 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
       else
         {
           // compute the optimal BF vector for this channel
-          LongTermCovMatrixBeamforming (channelParams);
+          if (m_longTermBfMethod == BEAM_SEARCH || m_longTermBfMethod == HIERARCHICAL_BEAM_SEARCH)
+            {
+              BeamSearchBeamforming (channelParams, txAntennaArray, rxAntennaArray, txAntennaNum, rxAntennaNum);
+            }
+          else
+            {
+              LongTermCovMatrixBeamforming (channelParams);
+            }
           txAntennaArray->SetBeamformingVectorPanel (channelParams->m_txW, rxDevice);
           txAntennaArray->ChangeBeamformingVectorPanel (rxDevice);
           rxAntennaArray->SetBeamformingVectorPanel (channelParams->m_rxW, txDevice);
@@ -815,98 +999,21 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 
           auto longTerm = CalLongTerm (channelParams);
           channelParams->m_longTerm = longTerm;
-
-          if (downlink || downlinkMc)
-            {
-              auto ueBfVector = rxAntennaArray->GetBeamformingVectorPanel (enbConnectedToUeOfThisLink);
-
-              for (auto ueDevIter = m_ueNetDeviceContainer.Begin (); ueDevIter != m_ueNetDeviceContainer.End (); ++ueDevIter)
-                {
-                  NS_LOG_DEBUG ("Compute LongTerm elements for DL eNB " << txDevice << " UE " << *ueDevIter << " for interference or data cases");
-
-                  // for interference or data tx: compute the longTerm component that
-                  // is associated to the channel between a and b, with the eNB using
-                  // the beamforming vector towards the UE in *ueDevIter and the UE
-                  // using the beamforming vector toward the eNB to which is associated
-                  // (i.e., this eNB or another one)
-                  auto enbBfVector = txAntennaArray->GetBeamformingVectorPanel (*ueDevIter);
-
-                  // for now, store these BF vectors so that CalLongTerm can use them
-                  channelParams->m_txW = enbBfVector;
-                  channelParams->m_rxW = ueBfVector;
-
-                  // call CalLongTerm, and get the longTerm params
-                  auto longTerm = CalLongTerm (channelParams);
-
-                  auto longTermIter = channelParams->m_allLongTermMap.find ((*ueDevIter));
-                  if (longTermIter == channelParams->m_allLongTermMap.end ())
-                    {
-                      channelParams->m_allLongTermMap.insert (std::make_pair ((*ueDevIter), longTerm));
-                    }
-                  else                                       //update
-                    {
-                      longTermIter->second = longTerm;
-                    }
-                  NS_LOG_DEBUG ("Compute the BF gain you would get on this link with these BF vector");
-                  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (rxPsd, channelParams, longTerm, relativeSpeed);
-                  SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
-                  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-                  NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain) / nbands);
-                }
-            }
-          else
-            {
-              auto ueBfVector = txAntennaArray->GetBeamformingVectorPanel (enbConnectedToUeOfThisLink);
-
-              for (auto ueDevIter = m_ueNetDeviceContainer.Begin (); ueDevIter != m_ueNetDeviceContainer.End (); ++ueDevIter)
-                {
-                  NS_LOG_DEBUG ("Compute LongTerm elements for DL eNB " << rxDevice << " UE " << *ueDevIter << " for interference or data cases");
-
-                  // for interference or data tx: compute the longTerm component that
-                  // is associated to the channel between a and b, with the eNB using
-                  // the beamforming vector towards the UE in *ueDevIter and the UE
-                  // using the beamforming vector toward the eNB to which is associated
-                  // (i.e., this eNB or another one)
-                  auto enbBfVector = rxAntennaArray->GetBeamformingVectorPanel (*ueDevIter);
-
-                  // for now, store these BF vectors so that CalLongTerm can use them
-                  channelParams->m_txW = ueBfVector;
-                  channelParams->m_rxW = enbBfVector;
-
-                  // call CalLongTerm, and get the longTerm params
-                  auto longTerm = CalLongTerm (channelParams);
-
-                  auto longTermIter = channelParams->m_allLongTermMap.find ((*ueDevIter));
-                  if (longTermIter == channelParams->m_allLongTermMap.end ())
-                    {
-                      channelParams->m_allLongTermMap.insert (std::make_pair ((*ueDevIter), longTerm));
-                    }
-                  else                                       //update
-                    {
-                      longTermIter->second = longTerm;
-                    }
-                  NS_LOG_DEBUG ("Compute the BF gain you would get on this link with these BF vector");
-                  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (rxPsd, channelParams, longTerm, relativeSpeed);
-                  SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
-                  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-                  NS_LOG_DEBUG ("****** UL BF gain == " << Sum (bfGain) / nbands);
-                }
-
-            }
         }
 
-      // insert the channelParams in the map
-      m_channelMap[key] = channelParams;
+      // insert the channelParams in the table
+      channelParams->m_generation = NextChannelGeneration ();
+      m_channelTable.Get (tx.m_deviceIndex, rx.m_deviceIndex) = channelParams;
     }
-  else if (itReverse == m_channelMap.end ())                       // Find channel matrix in the forward link
+  else if (itReverse == 0)                       // Find channel matrix in the forward link
     {
-      channelParams = (*it).second;
+      channelParams = *it;
       NS_LOG_DEBUG ("No need to update the channel");
     }
   else                       // Find channel matrix in the Reverse link
     {
       reverseLink = true;
-      channelParams = (*itReverse).second;
+      channelParams = *itReverse;
 
       NS_LOG_DEBUG ("No need to update the channel");
     }
@@ -918,9 +1025,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   Ptr<NetDevice> correctUeForCommunication;
   if (downlink)
     {
-      Ptr<mmwave::MmWaveEnbNetDevice> enbTx = DynamicCast<mmwave::MmWaveEnbNetDevice> (txDevice);
-      Ptr<mmwave::MmWaveUeNetDevice> ueRx = DynamicCast<mmwave::MmWaveUeNetDevice> (rxDevice);
-      if (enbTx == ueRx->GetTargetEnb ())
+      if (tx.m_enb == rx.m_ue->GetTargetEnb ())
         {
           connectedPair = true;
         }
@@ -931,9 +1036,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
     }
   else if (downlinkMc)
     {
-      Ptr<mmwave::MmWaveEnbNetDevice> enbTx = DynamicCast<mmwave::MmWaveEnbNetDevice> (txDevice);
-      Ptr<mmwave::McUeNetDevice> ueRx = DynamicCast<mmwave::McUeNetDevice> (rxDevice);
-      if (enbTx == ueRx->GetMmWaveTargetEnb ())
+      if (tx.m_enb == rx.m_mcUe->GetMmWaveTargetEnb ())
         {
           connectedPair = true;
         }
@@ -943,9 +1046,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
     }
   else if (uplink)
     {
-      Ptr<mmwave::MmWaveUeNetDevice> ueTx = DynamicCast<mmwave::MmWaveUeNetDevice> (txDevice);
-      Ptr<mmwave::MmWaveEnbNetDevice> enbRx = DynamicCast<mmwave::MmWaveEnbNetDevice> (rxDevice);
-      if (enbRx == ueTx->GetTargetEnb ())
+      if (rx.m_enb == tx.m_ue->GetTargetEnb ())
         {
           connectedPair = true;
         }
@@ -955,9 +1056,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
     }
   else if (uplinkMc)
     {
-      Ptr<mmwave::McUeNetDevice> ueTx = DynamicCast<mmwave::McUeNetDevice> (txDevice);
-      Ptr<mmwave::MmWaveEnbNetDevice> enbRx = DynamicCast<mmwave::MmWaveEnbNetDevice> (rxDevice);
-      if (enbRx == ueTx->GetMmWaveTargetEnb ())
+      if (rx.m_enb == tx.m_mcUe->GetMmWaveTargetEnb ())
         {
           connectedPair = true;
         }
@@ -968,47 +1067,94 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 
   NS_LOG_DEBUG ("connectedPair " << connectedPair << " correctUeForCommunication " << correctUeForCommunication << " m_interferenceOrDataMode " << m_interferenceOrDataMode);
 
-  // get the correct LongTerm
-  NS_ASSERT_MSG (channelParams->m_allLongTermMap.find (correctUeForCommunication) !=
-                 channelParams->m_allLongTermMap.end (), "LongTerm not initialized for this!");
-
-  complexVector_t longTerm;
+  gain.m_params = channelParams;
   if (m_interferenceOrDataMode)
     {
-      longTerm = channelParams->m_allLongTermMap.find (correctUeForCommunication)->second;
+      // get the correct LongTerm
+      NS_ASSERT_MSG (correctUeForCommunication != 0, "LongTerm not initialized for this!");
+      const LinkEnd &enb = (downlink || downlinkMc) ? tx : rx;
+      const LinkEnd &ue = (downlink || downlinkMc) ? rx : tx;
+      Ptr<NetDevice> ueTargetEnb = (ue.m_ue != 0) ? Ptr<NetDevice> (ue.m_ue->GetTargetEnb ()) : Ptr<NetDevice> (ue.m_mcUe->GetMmWaveTargetEnb ());
+      if (ueTargetEnb == 0)
+        {
+          ueTargetEnb = enb.m_device;
+        }
+      // the channel realization is stored with the direction of the link that created it
+      bool enbIsTx = (downlink || downlinkMc) != reverseLink;
+      gain.m_longTerm = GetInterferenceLongTerm (channelParams, enb, ue, ueTargetEnb, correctUeForCommunication, enbIsTx);
     }
-  else                       // we are computing reference signals!
+  else
     {
-      longTerm = channelParams->m_longTerm;
+      gain.m_longTerm = channelParams->m_longTerm;             // we are computing reference signals!
     }
+  gain.m_speed = relativeSpeed;
+  gain.m_reverseLink = reverseLink;
+  gain.m_connectedPair = connectedPair;
+}
 
-  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (rxPsd, channelParams, longTerm, relativeSpeed);
+const complexVector_t&
+MmWave3gppChannel::GetInterferenceLongTerm (Ptr<Params3gpp> params, const LinkEnd &enb, const LinkEnd &ue,
+                                            Ptr<NetDevice> ueTargetEnb, Ptr<NetDevice> servedUe, bool enbIsTx) const
+{
+  uint64_t enbVersion = enb.m_antennaArray->GetBeamformingVectorVersion (servedUe);
+  uint64_t ueVersion = ue.m_antennaArray->GetBeamformingVectorVersion (ueTargetEnb);
+
+  auto longTermIter = params->m_allLongTermMap.find (servedUe);
+  if (longTermIter != params->m_allLongTermMap.end ()
+      && longTermIter->second.m_enbVersion == enbVersion
+      && longTermIter->second.m_ueVersion == ueVersion)
+    {
+      return longTermIter->second.m_longTerm;
+    }
+
+  NS_LOG_DEBUG ("Compute LongTerm elements for eNB " << enb.m_device << " UE " << servedUe << " for interference or data cases");
+  // compute the longTerm component that is associated to the channel between
+  // the eNB and the UE, with the eNB using the beamforming vector towards servedUe
+  // and the UE using the beamforming vector toward the eNB to which is associated
+  // (i.e., this eNB or another one)
+  complexVector_t enbBfVector = enb.m_antennaArray->GetBeamformingVectorPanel (servedUe);
+  complexVector_t ueBfVector = ue.m_antennaArray->GetBeamformingVectorPanel (ueTargetEnb);
+
+  LongTermCacheEntry &entry = params->m_allLongTermMap[servedUe];
+  entry.m_longTerm = enbIsTx ? CalLongTerm (params, enbBfVector, ueBfVector) : CalLongTerm (params, ueBfVector, enbBfVector);
+  entry.m_enbVersion = enbVersion;
+  entry.m_ueVersion = ueVersion;
+  return entry.m_longTerm;
+}
 
+void
+MmWave3gppChannel::LogLinkGain (Ptr<const SpectrumValue> rxPsd, Ptr<const SpectrumValue> bfPsd,
+                                const LinkEnd &tx, const LinkEnd &rx, const LinkGain &gain) const
+{
   //NS_LOG_DEBUG ("----> bfpsf " << *bfPsd);
+  if (!g_log.IsEnabled (ns3::LOG_DEBUG))
+    {
+      // the BF gain is only printed
+      return;
+    }
 
   SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
   uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-  if (reverseLink == false)
+  if (gain.m_reverseLink == false)
     {
       NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain) / nbands << " RX PSD " << Sum (*rxPsd) / nbands
-                                            << " a pos " << a->GetPosition ()
-                                            << " a antenna ID " << txAntennaArray->GetPlanesId ()
-                                            << " b pos " << b->GetPosition ()
-                                            << " b antenna ID " << rxAntennaArray->GetPlanesId () << " "
-                                            << " connectedPair " << connectedPair)
+                                            << " a pos " << tx.m_mobility->GetPosition ()
+                                            << " a antenna ID " << tx.m_antennaArray->GetPlanesId ()
+                                            << " b pos " << rx.m_mobility->GetPosition ()
+                                            << " b antenna ID " << rx.m_antennaArray->GetPlanesId () << " "
+                                            << " connectedPair " << gain.m_connectedPair)
       ;                           // print avg bf gain
     }
   else
     {
       NS_LOG_DEBUG ("****** UL BF gain == " << Sum (bfGain) / nbands << " RX PSD " << Sum (*rxPsd) / nbands
-                                            << " a pos " << a->GetPosition ()
-                                            << " a antenna ID " << txAntennaArray->GetPlanesId ()
-                                            << " b pos " << b->GetPosition ()
-                                            << " b antenna ID " << rxAntennaArray->GetPlanesId () << " "
-                                            << " connectedPair " << connectedPair)
+                                            << " a pos " << tx.m_mobility->GetPosition ()
+                                            << " a antenna ID " << tx.m_antennaArray->GetPlanesId ()
+                                            << " b pos " << rx.m_mobility->GetPosition ()
+                                            << " b antenna ID " << rx.m_antennaArray->GetPlanesId () << " "
+                                            << " connectedPair " << gain.m_connectedPair)
       ;
     }
-  return bfPsd;
 }
 
 void
@@ -1017,167 +1163,253 @@ MmWave3gppChannel::SetInterferenceOrDataMode (bool flag)
   m_interferenceOrDataMode = flag;
 }
 
-void
-MmWave3gppChannel::LongTermCovMatrixBeamforming (Ptr<Params3gpp> params) const
+uint64_t
+MmWave3gppChannel::GetChannelGeneration (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
 {
-  //generate transmitter side spatial correlation matrix
-  uint16_t txSize = params->m_channel.at (0).size ();
-  uint16_t rxSize = params->m_channel.size ();
-  complex2DVector_t txQ;
-  txQ.resize (txSize);
-
-  for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
+  const LinkEnd &aEnd = GetLinkEnd (a);
+  const LinkEnd &bEnd = GetLinkEnd (b);
+  // the channel is stored for the direction in which it was created
+  Ptr<Params3gpp> *it = m_channelTable.Find (aEnd.m_deviceIndex, bEnd.m_deviceIndex);
+  if (it == 0)
     {
-      txQ.at (txIndex).resize (txSize);
+      it = m_channelTable.Find (bEnd.m_deviceIndex, aEnd.m_deviceIndex);
     }
-
-  //compute the transmitter side spatial correlation matrix txQ = H*H, where H is the sum of H_n over n clusters.
-  for (uint16_t t1Index = 0; t1Index < txSize; t1Index++)
+  if (it == 0 || (*it)->m_channel.IsEmpty ())
     {
-      for (uint16_t t2Index = 0; t2Index < txSize; t2Index++)
-        {
-          for (uint16_t rxIndex = 0; rxIndex < rxSize; rxIndex++)
-            {
-              std::complex<double> cSum (0,0);
-              for (uint16_t cIndex = 0; cIndex < params->m_channel.at (rxIndex).at (t1Index).size (); cIndex++)
-                {
-                  cSum = cSum + std::conj (params->m_channel.at (rxIndex).at (t1Index).at (cIndex)) *
-                    (params->m_channel.at (rxIndex).at (t2Index).at (cIndex));
-                }
-              txQ[t1Index][t2Index] += cSum;
-            }
-
-        }
-    }
-
-
-  //calculate beamforming vector from spatial correlation matrix.
-  complexVector_t antennaWeights;
-  uint16_t txAntenna = txQ.size ();
-  for (uint16_t eIndex = 0; eIndex < txAntenna; eIndex++)
-    {
-      antennaWeights.push_back (txQ.at (0).at (eIndex));
+      return 0;
     }
+  return (*it)->m_generation;
+}
 
-
-  int iter = 10;
+/*
+ * Power iteration for the dominant eigenvector of the Hermitian matrix q,
+ * stored row-major with size n x n. weights contains the initial vector and,
+ * on return, the normalized eigenvector. scratch must have size n. No memory
+ * is allocated. The iteration stops when the squared norm of the difference
+ * between two consecutive vectors is below tolerance, or after maxIter steps
+ */
+static void
+DominantEigenvector (const complexVector_t &q, uint16_t n, complexVector_t &weights, complexVector_t &scratch,
+                     uint32_t maxIter, double tolerance)
+{
+  uint32_t iter = maxIter;
   double diff = 1;
-  while (iter != 0 && diff > 1e-10)
+  while (iter != 0 && diff > tolerance)
     {
-      complexVector_t antennaWeights_New;
-
-      for (uint16_t row = 0; row < txAntenna; row++)
+      for (uint16_t row = 0; row < n; row++)
         {
+          const std::complex<double> *qRow = &q[row * n];
           std::complex<double> sum (0,0);
-          for (uint16_t col = 0; col < txAntenna; col++)
+          for (uint16_t col = 0; col < n; col++)
             {
-              sum += txQ.at (row).at (col) * antennaWeights.at (col);
+              sum += qRow[col] * weights[col];
             }
-
-          antennaWeights_New.push_back (sum);
+          scratch[row] = sum;
         }
       //normalize antennaWeights;
       double weightSum = 0;
-      for (uint16_t i = 0; i < txAntenna; i++)
+      for (uint16_t i = 0; i < n; i++)
         {
-          weightSum += norm (antennaWeights_New.at (i));
-        }
-      for (uint16_t i = 0; i < txAntenna; i++)
-        {
-          antennaWeights_New.at (i) = antennaWeights_New.at (i) / sqrt (weightSum);
+          weightSum += norm (scratch[i]);
         }
+      double weightNorm = sqrt (weightSum);
       diff = 0;
-      for (uint16_t i = 0; i < txAntenna; i++)
+      for (uint16_t i = 0; i < n; i++)
         {
-          diff += std::norm (antennaWeights_New.at (i) - antennaWeights.at (i));
+          scratch[i] = scratch[i] / weightNorm;
+          diff += std::norm (scratch[i] - weights[i]);
         }
       iter--;
-      antennaWeights = antennaWeights_New;
+      weights.swap (scratch);
     }
+}
 
-  params->m_txW = antennaWeights;
+/*
+ * Set unit norm weights of equal phase, i.e., a broadside beam, used when
+ * the channel gives no direction to steer to
+ */
+static void
+SetBroadsideWeights (complexVector_t &weights, uint16_t n)
+{
+  weights.assign (n, std::complex<double> (1 / sqrt (n), 0));
+}
 
-  //compute the receiver side spatial correlation matrix rxQ = HH*, where H is the sum of H_n over n clusters.
-  complex2DVector_t rxQ;
-  rxQ.resize (rxSize);
-  for (uint16_t r1Index = 0; r1Index < rxSize; r1Index++)
+void
+MmWave3gppChannel::LongTermCovMatrixBeamforming (Ptr<Params3gpp> params) const
+{
+  if (m_longTermBfMethod == RANK1_SVD)
     {
-      rxQ.at (r1Index).resize (rxSize);
+      LongTermRank1Beamforming (params);
+      return;
     }
 
-  for (uint16_t r1Index = 0; r1Index < rxSize; r1Index++)
+  //generate transmitter side spatial correlation matrix
+  const MmWaveChannelTensor &channel = params->m_channel;
+  uint16_t txSize = channel.GetTxSize ();
+  uint16_t rxSize = channel.GetRxSize ();
+  complexVector_t txQ;
+  channel.GetTxCorrelation (txQ);
+
+  //calculate beamforming vector from spatial correlation matrix, starting from its first row.
+  complexVector_t antennaWeights (txQ.begin (), txQ.begin () + txSize);
+  complexVector_t scratch (txSize);
+  DominantEigenvector (txQ, txSize, antennaWeights, scratch, m_bfMaxIterations, m_bfTolerance);
+
+  params->m_txW = antennaWeights;
+
+  //compute the receiver side spatial correlation matrix rxQ = HH*, where H is the sum of H_n over n clusters.
+  complexVector_t rxQ;
+  channel.GetRxCorrelation (rxQ);
+
+  //calculate beamforming vector from spatial correlation matrix.
+  antennaWeights.assign (rxQ.begin (), rxQ.begin () + rxSize);
+  scratch.resize (rxSize);
+  DominantEigenvector (rxQ, rxSize, antennaWeights, scratch, m_bfMaxIterations, m_bfTolerance);
+
+  params->m_rxW = antennaWeights;
+}
+
+void
+MmWave3gppChannel::LongTermRank1Beamforming (Ptr<Params3gpp> params) const
+{
+  const MmWaveChannelTensor &channel = params->m_channel;
+  uint16_t txSize = channel.GetTxSize ();
+  uint16_t rxSize = channel.GetRxSize ();
+  uint8_t numCluster = channel.GetNumCluster ();
+
+  //sum the cluster planes, Hs = sum of H_n over n clusters (rx-major)
+  complexVector_t hSum (rxSize * txSize);
+  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
-      for (uint16_t r2Index = 0; r2Index < rxSize; r2Index++)
+      const double *hRe = channel.GetRealPlane (cIndex);
+      const double *hIm = channel.GetImagPlane (cIndex);
+      for (uint16_t rxIndex = 0; rxIndex < rxSize; rxIndex++)
         {
           for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
             {
-              std::complex<double> cSum (0,0);
-              for (uint16_t cIndex = 0; cIndex < params->m_channel.at (r1Index).at (txIndex).size (); cIndex++)
-                {
-                  cSum = cSum + params->m_channel.at (r1Index).at (txIndex).at (cIndex) *
-                    std::conj (params->m_channel.at (r2Index).at (txIndex).at (cIndex));
-                }
-              rxQ[r1Index][r2Index] += cSum;
+              hSum[rxIndex * txSize + txIndex] += std::complex<double> (hRe[rxIndex * txSize + txIndex],
+                                                                        hIm[rxIndex * txSize + txIndex]);
             }
-
         }
     }
 
-  //calculate beamforming vector from spatial correlation matrix.
-  antennaWeights.clear ();
-  uint16_t rxAntenna = rxQ.size ();
-  for (uint16_t eIndex = 0; eIndex < rxAntenna; eIndex++)
+  //the dominant singular vectors of Hs are found by alternating
+  //rxW = Hs txW and txW = Hs* rxW, starting from the strongest row of Hs
+  uint16_t bestRow = 0;
+  double bestNorm = -1;
+  for (uint16_t rxIndex = 0; rxIndex < rxSize; rxIndex++)
     {
-      antennaWeights.push_back (rxQ.at (0).at (eIndex));
+      double rowNorm = 0;
+      for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
+        {
+          rowNorm += std::norm (hSum[rxIndex * txSize + txIndex]);
+        }
+      if (rowNorm > bestNorm)
+        {
+          bestNorm = rowNorm;
+          bestRow = rxIndex;
+        }
     }
-
-  iter = 10;
-  diff = 1;
-  while (iter != 0 && diff > 1e-10)
+  if (bestNorm <= 0)
     {
-      complexVector_t antennaWeights_New;
+      //the clusters cancel out, or are fully attenuated: no beam has any gain
+      SetBroadsideWeights (params->m_txW, txSize);
+      SetBroadsideWeights (params->m_rxW, rxSize);
+      return;
+    }
+  complexVector_t txW (txSize);
+  complexVector_t rxW (rxSize);
+  complexVector_t txWNew (txSize);
+  for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
+    {
+      txW[txIndex] = std::conj (hSum[bestRow * txSize + txIndex]) / sqrt (bestNorm);
+    }
 
-      for (uint16_t row = 0; row < rxAntenna; row++)
+  uint32_t iter = m_bfMaxIterations;
+  double diff = 1;
+  while (iter != 0 && diff > m_bfTolerance)
+    {
+      double rxNorm = 0;
+      for (uint16_t rxIndex = 0; rxIndex < rxSize; rxIndex++)
         {
+          const std::complex<double> *hRow = &hSum[rxIndex * txSize];
           std::complex<double> sum (0,0);
-          for (uint16_t col = 0; col < rxAntenna; col++)
+          for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
             {
-              sum += rxQ.at (row).at (col) * antennaWeights.at (col);
+              sum += hRow[txIndex] * txW[txIndex];
             }
-
-          antennaWeights_New.push_back (sum);
+          rxW[rxIndex] = sum;
+          rxNorm += std::norm (sum);
         }
-
-      //normalize antennaWeights;
-      double weightSum = 0;
-      for (uint16_t i = 0; i < rxAntenna; i++)
+      rxNorm = sqrt (rxNorm);
+      if (rxNorm <= 0)
         {
-          weightSum += norm (antennaWeights_New.at (i));
+          //only possible if the values underflow, since Hs txW is not zero
+          SetBroadsideWeights (params->m_txW, txSize);
+          SetBroadsideWeights (params->m_rxW, rxSize);
+          return;
         }
-      for (uint16_t i = 0; i < rxAntenna; i++)
+      std::fill (txWNew.begin (), txWNew.end (), std::complex<double> (0,0));
+      for (uint16_t rxIndex = 0; rxIndex < rxSize; rxIndex++)
         {
-          antennaWeights_New.at (i) = antennaWeights_New.at (i) / sqrt (weightSum);
+          rxW[rxIndex] /= rxNorm;
+          const std::complex<double> *hRow = &hSum[rxIndex * txSize];
+          for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
+            {
+              txWNew[txIndex] += std::conj (hRow[txIndex]) * rxW[rxIndex];
+            }
+        }
+      double txNorm = 0;
+      for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
+        {
+          txNorm += std::norm (txWNew[txIndex]);
+        }
+      txNorm = sqrt (txNorm);
+      if (txNorm <= 0)
+        {
+          SetBroadsideWeights (params->m_txW, txSize);
+          SetBroadsideWeights (params->m_rxW, rxSize);
+          return;
         }
       diff = 0;
-      for (uint16_t i = 0; i < rxAntenna; i++)
+      for (uint16_t txIndex = 0; txIndex < txSize; txIndex++)
         {
-          diff += std::norm (antennaWeights_New.at (i) - antennaWeights.at (i));
+          txWNew[txIndex] /= txNorm;
+          diff += std::norm (txWNew[txIndex] - txW[txIndex]);
         }
+      txW.swap (txWNew);
       iter--;
-      antennaWeights = antennaWeights_New;
     }
 
-  params->m_rxW = antennaWeights;
+  params->m_txW = txW;
+  params->m_rxW = rxW;
 }
 
 Ptr<SpectrumValue>
 MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params,
-                                       complexVector_t longTerm, Vector speed) const
+                                       const complexVector_t &longTerm, Vector speed) const
+{
+  return CalBeamformingGain (txPsd, params, longTerm, speed, GetSubbandParams ());
+}
+
+Ptr<SpectrumValue>
+MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params,
+                                       const complexVector_t &longTerm, Vector speed,
+                                       const SubbandParams &subband) const
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue> (txPsd);
+  Ptr<SpectrumValue> tempPsd = txPsd->Copy ();
+  ApplyBeamformingGain (&(*tempPsd->ValuesBegin ()), tempPsd->GetSpectrumModel ()->GetNumBands (),
+                        *params, longTerm, speed, subband);
+  return tempPsd;
+}
 
+void
+MmWave3gppChannel::ApplyBeamformingGain (double *psd, uint32_t numSubband, const Params3gpp &params,
+                                         const complexVector_t &longTerm, Vector speed,
+                                         const SubbandParams &subband)
+{
   //NS_ASSERT_MSG (params->m_delay.size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and delay spread should be the same");
   //NS_ASSERT_MSG (params->m_txW.size()==params->m_channel.at(0).size(), "the tx antenna size of channel and antenna weights should be the same");
   //NS_ASSERT_MSG (params->m_rxW.size()==params->m_channel.size(), "the rx antenna size of channel and antenna weights should be the same");
@@ -1185,42 +1417,54 @@ MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Param
   //NS_ASSERT_MSG (params->m_angle.at(1).size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and ZOA should be the same");
 
   //channel[rx][tx][cluster]
-  uint8_t numCluster = params->m_delay.size ();
+  uint8_t numCluster = params.m_delay.size ();
   //uint8_t txAntenna = params->m_txW.size();
   //uint8_t rxAntenna = params->m_rxW.size();
   //the update of Doppler is simplified by only taking the center angle of each cluster in to consideration.
-  Values::iterator vit = tempPsd->ValuesBegin ();
-  uint16_t iSubband = 0;
-  double slotTime = Simulator::Now ().GetSeconds ();
-  complexVector_t doppler;
+  complexVector_t doppler (numCluster);
   for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
       //cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
-      double temp_doppler = 2 * M_PI * (sin (params->m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * cos (params->m_angle.at (AOA_INDEX).at (cIndex) * M_PI / 180) * speed.x
-                                        + sin (params->m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * sin (params->m_angle.at (AOA_INDEX).at (cIndex) * M_PI / 180) * speed.y
-                                        + cos (params->m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * speed.z) * slotTime * m_phyMacConfig->GetCenterFrequency () / 3e8;
-      doppler.push_back (exp (std::complex<double> (0, temp_doppler)));
-
+      double zoa = params.m_angle[ZOA_INDEX][cIndex] * M_PI / 180;
+      double aoa = params.m_angle[AOA_INDEX][cIndex] * M_PI / 180;
+      double sinZoa = sin (zoa);
+      double temp_doppler = 2 * M_PI * (sinZoa * cos (aoa) * speed.x
+                                        + sinZoa * sin (aoa) * speed.y
+                                        + cos (zoa) * speed.z) * subband.m_slotTime * subband.m_centerFrequency / 3e8;
+      doppler[cIndex] = std::polar (1.0, temp_doppler);
+    }
+
+  // The gain of subband k is |sum_n longTerm_n * doppler_n * exp (-j 2 pi f_k tau_n)|^2, with
+  // f_k = f_0 + k * chunkWidth. The delay term of subband k + 1 is obtained from the one of
+  // subband k by rotating it by exp (-j 2 pi chunkWidth tau_n), and it is recomputed exactly
+  // at the beginning of each block of SUBBAND_BLOCK subbands to bound the rounding error.
+  static const uint32_t SUBBAND_BLOCK = 64;
+  double f0 = subband.m_firstFrequency;
+  double chunkWidth = subband.m_chunkWidth;
+  alignedDoubleVector_t coeffRe (numCluster);
+  alignedDoubleVector_t coeffIm (numCluster);
+  alignedDoubleVector_t stepRe (numCluster);
+  alignedDoubleVector_t stepIm (numCluster);
+  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+      std::complex<double> step = std::polar (1.0, -2 * M_PI * chunkWidth * params.m_delay.at (cIndex));
+      stepRe[cIndex] = step.real ();
+      stepIm[cIndex] = step.imag ();
     }
 
-  while (vit != tempPsd->ValuesEnd ())
+  for (uint32_t firstSubband = 0; firstSubband < numSubband; firstSubband += SUBBAND_BLOCK)
     {
-      std::complex<double> subsbandGain (0.0,0.0);
-      if ((*vit) != 0.00)
+      double fsb = f0 + chunkWidth * firstSubband;
+      for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
         {
-          double fsb = m_phyMacConfig->GetCenterFrequency () - GetSystemBandwidth () / 2 + m_phyMacConfig->GetChunkWidth () * iSubband;
-          for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
-            {
-              double delay = -2 * M_PI * fsb * (params->m_delay.at (cIndex));
-              std::complex<double> txSum (0,0);
-              subsbandGain = subsbandGain + longTerm.at (cIndex) * doppler.at (cIndex) * exp (std::complex<double> (0, delay));
-            }
-          *vit = (*vit) * (norm (subsbandGain));
+          double delay = -2 * M_PI * fsb * (params.m_delay.at (cIndex));
+          std::complex<double> coeff = longTerm[cIndex] * doppler[cIndex] * std::polar (1.0, delay);
+          coeffRe[cIndex] = coeff.real ();
+          coeffIm[cIndex] = coeff.imag ();
         }
-      vit++;
-      iSubband++;
+      MmWaveBeamformingKernels::SubbandGain (coeffRe.data (), coeffIm.data (), stepRe.data (), stepIm.data (), numCluster,
+                                             psd + firstSubband, std::min (SUBBAND_BLOCK, numSubband - firstSubband));
     }
-  return tempPsd;
 }
 
 double
@@ -1235,13 +1479,15 @@ void
 MmWave3gppChannel::SetPathlossModel (Ptr<PropagationLossModel> pathloss)
 {
   m_3gppPathloss = pathloss;
-  if (DynamicCast<MmWave3gppPropagationLossModel> (m_3gppPathloss) != 0)
+  m_3gppPropagationLoss = DynamicCast<MmWave3gppPropagationLossModel> (m_3gppPathloss);
+  m_3gppBuildingsPropagationLoss = DynamicCast<MmWave3gppBuildingsPropagationLossModel> (m_3gppPathloss);
+  if (m_3gppPropagationLoss != 0)
     {
-      m_scenario = m_3gppPathloss->GetObject<MmWave3gppPropagationLossModel> ()->GetScenario ();
+      m_scenario = m_3gppPropagationLoss->GetScenario ();
     }
-  else if (DynamicCast<MmWave3gppBuildingsPropagationLossModel> (m_3gppPathloss) != 0)
+  else if (m_3gppBuildingsPropagationLoss != 0)
     {
-      m_scenario = m_3gppPathloss->GetObject<MmWave3gppBuildingsPropagationLossModel> ()->GetScenario ();
+      m_scenario = m_3gppBuildingsPropagationLoss->GetScenario ();
     }
   else
     {
@@ -1253,28 +1499,50 @@ MmWave3gppChannel::SetPathlossModel (Ptr<PropagationLossModel> pathloss)
 complexVector_t
 MmWave3gppChannel::CalLongTerm (Ptr<Params3gpp> params) const
 {
-  uint16_t txAntenna = params->m_txW.size ();
-  uint16_t rxAntenna = params->m_rxW.size ();
+  return CalLongTerm (params, params->m_txW, params->m_rxW);
+}
+
+complexVector_t
+MmWave3gppChannel::CalLongTerm (Ptr<Params3gpp> params, const complexVector_t &txW, const complexVector_t &rxW) const
+{
+  uint16_t txAntenna = txW.size ();
+  uint16_t rxAntenna = rxW.size ();
 
   NS_LOG_DEBUG ("CalLongTerm with txAntenna " << (uint16_t)txAntenna << " rxAntenna " << (uint16_t)rxAntenna);
   //store the long term part to reduce computation load
   //only the small scale fading is need to be updated if the large scale parameters and antenna weights remain unchanged.
-  complexVector_t longTerm;
+  const MmWaveChannelTensor &channel = params->m_channel;
   uint8_t numCluster = params->m_delay.size ();
+  NS_ASSERT_MSG (channel.GetNumCluster () == numCluster, "the cluster number of channel and delay should be the same");
+  NS_ASSERT_MSG (channel.GetTxSize () >= txAntenna && channel.GetRxSize () >= rxAntenna,
+                 "the antenna weights cannot be larger than the channel matrix");
+  uint16_t rowStride = channel.GetTxSize ();
+  complexVector_t longTerm (numCluster);
+
+  // split the tx weights in real and imaginary parts, as the channel planes
+  alignedDoubleVector_t txWRe (txAntenna);
+  alignedDoubleVector_t txWIm (txAntenna);
+  for (uint16_t txIndex = 0; txIndex < txAntenna; txIndex++)
+    {
+      txWRe[txIndex] = txW[txIndex].real ();
+      txWIm[txIndex] = txW[txIndex].imag ();
+    }
 
   for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
+      const double *hRe = channel.GetRealPlane (cIndex);
+      const double *hIm = channel.GetImagPlane (cIndex);
       std::complex<double> txSum (0,0);
-      for (uint16_t txIndex = 0; txIndex < txAntenna; txIndex++)
+      for (uint16_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
         {
-          std::complex<double> rxSum (0,0);
-          for (uint16_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
-            {
-              rxSum = rxSum + std::conj (params->m_rxW.at (rxIndex)) * params->m_channel.at (rxIndex).at (txIndex).at (cIndex);
-            }
-          txSum = txSum + params->m_txW.at (txIndex) * rxSum;
+          // w_tx applied to row rxIndex of H_n, which is contiguous in memory
+          std::complex<double> rowSum = MmWaveBeamformingKernels::ComplexDot (txWRe.data (), txWIm.data (),
+                                                                              hRe + rxIndex * rowStride,
+                                                                              hIm + rxIndex * rowStride,
+                                                                              txAntenna);
+          txSum += std::conj (rxW[rxIndex]) * rowSum;
         }
-      longTerm.push_back (txSum);
+      longTerm[cIndex] = txSum;
     }
   return longTerm;
 
@@ -1471,15 +1739,44 @@ MmWave3gppChannel::Get3gppTable (bool los, bool o2i, double hBS, double hUT, dou
 void
 MmWave3gppChannel::DeleteChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
 {
-  Ptr<NetDevice> dev1 = a->GetObject<Node> ()->GetDevice (0);
-  Ptr<NetDevice> dev2 = b->GetObject<Node> ()->GetDevice (0);
   NS_LOG_INFO ("a position " << a->GetPosition () << " b " << b->GetPosition ());
-  Ptr<Params3gpp> params = m_channelMap.find (std::make_pair (dev1,dev2))->second;
-  NS_LOG_INFO ("params " << params);
-  NS_LOG_INFO ("params m_channel size" << params->m_channel.size ());
-  NS_ASSERT_MSG (m_channelMap.find (std::make_pair (dev1,dev2)) != m_channelMap.end (), "Channel not found");
-  params->m_channel.clear ();
-  m_channelMap[std::make_pair (dev1,dev2)] = params;
+  Ptr<Params3gpp> *params = m_channelTable.Find (GetLinkEnd (a).m_deviceIndex, GetLinkEnd (b).m_deviceIndex);
+  NS_ASSERT_MSG (params != 0, "Channel not found");
+  NS_LOG_INFO ("params " << *params);
+  NS_LOG_INFO ("params m_channel clusters " << (uint16_t)(*params)->m_channel.GetNumCluster ());
+  (*params)->m_channel.Clear ();
+}
+
+void
+MmWave3gppChannel::RefreshChannels (const std::vector<MmWaveChannelUpdateScheduler::Link> &links) const
+{
+  NS_LOG_FUNCTION (this << links.size ());
+  for (size_t i = 0; i < links.size (); ++i)
+    {
+      DeleteChannel (links[i].m_a, links[i].m_b);
+    }
+  if (m_eagerUpdate)
+    {
+      // update the channel matrices now; the BF vectors depend on the devices
+      // the antennas point at, thus they are selected at the next transmission
+      for (size_t i = 0; i < links.size (); ++i)
+        {
+          LinkGain gain;
+          PrepareLink (0, GetLinkEnd (links[i].m_a), GetLinkEnd (links[i].m_b), gain);
+        }
+    }
+}
+
+void
+MmWave3gppChannel::SetUpdateGranularity (Time granularity)
+{
+  m_updateScheduler.SetGranularity (granularity);
+}
+
+Time
+MmWave3gppChannel::GetUpdateGranularity () const
+{
+  return m_updateScheduler.GetGranularity ();
 }
 
 Ptr<Params3gpp>
@@ -1500,6 +1797,8 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
   channelParams->m_speed = speed;
   channelParams->m_dis2D = dis2D;
   channelParams->m_dis3D = dis3D;
+  channelParams->m_generation = 0;       // the caller gives it a new generation
+  channelParams->m_beamformingPending = false;
   //Step 4: Generate large scale parameters. All LSPS are uncorrelated.
   doubleVector_t LSPsIndep, LSPs;
   uint8_t paramNum;
@@ -2077,61 +2376,66 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
 
   NS_LOG_INFO ("1st strongest cluster:" << (int)cluster1st << ", 2nd strongest cluster:" << (int)cluster2nd);
 
-  complex3DVector_t H_usn;       //channel coffecient H_usn[u][s][n];
-  //Since each of the strongest 2 clusters are divided into 3 sub-clusters, the total cluster will be numReducedCLuster + 4.
-
-  H_usn.resize (uSize);
-  for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
-    {
-      H_usn.at (uIndex).resize (sSize);
-      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
-        {
-          H_usn.at (uIndex).at (sIndex).resize (numReducedCluster);
-        }
-    }
+  MmWaveChannelTensor &H_usn = channelParams->m_channel;       //channel coffecient H_usn[u][s][n];
+  //Since each of the strongest 2 clusters are divided into 3 sub-clusters, the total cluster will be numReducedCLuster + 4
+  //(+ 2 if the strongest clusters coincide). The sub-clusters are stored after the other clusters, ordered by cluster index.
+  uint8_t numSubCluster = (cluster1st == cluster2nd) ? 2 : 4;
+  H_usn.Resize (uSize, sSize, numReducedCluster + numSubCluster);
   //double slotTime = Simulator::Now ().GetSeconds ();
   // The following for loops computes the channel coefficients
+  // The phase shifts of the array elements and the radiation pattern of the elements only depend on
+  // the direction of each ray, thus they are computed once per ray, and not for each pair of elements.
+  uint32_t numRays = numReducedCluster * raysPerCluster;
+  complexVector_t rxSteering;       // rxSteering[u * numRays + n * raysPerCluster + m]
+  complexVector_t txSteering;       // txSteering[s * numRays + n * raysPerCluster + m]
+  rxAntenna->GetSteeringVectors (&rayZoa_radian[0][0], &rayAoa_radian[0][0], numRays, rxAntennaNum, rxSteering);
+  txAntenna->GetSteeringVectors (&rayZod_radian[0][0], &rayAod_radian[0][0], numRays, txAntennaNum, txSteering);
+  complexVector_t rayCoefficient (numRays);       // initial phase and radiation pattern of each ray
+  for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
+    {
+      for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+        {
+          //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
+          rayCoefficient[nIndex * raysPerCluster + mIndex] = exp (std::complex<double> (0, clusterPhase.at (nIndex).at (mIndex)))
+            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
+               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]));
+        }
+    }
+  complexVector_t rxLosSteering;
+  complexVector_t txLosSteering;
+  std::complex<double> losCoefficient (0,0);
+  if (los)
+    {
+      rxAntenna->GetSteeringVectors (&rxAngle.theta, &rxAngle.phi, 1, rxAntennaNum, rxLosSteering);
+      txAntenna->GetSteeringVectors (&txAngle.theta, &txAngle.phi, 1, txAntennaNum, txLosSteering);
+      losCoefficient = exp (std::complex<double> (0, losPhase))
+        * (rxAntenna->GetRadiationPattern (rxAngle.theta,rxAngle.phi)
+           * txAntenna->GetRadiationPattern (txAngle.theta,rxAngle.phi));
+    }
+
   for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-      Vector uLoc = rxAntenna->GetAntennaLocation (uIndex,rxAntennaNum);
+      const std::complex<double> *uSteering = &rxSteering[uIndex * numRays];
 
       for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
         {
-
-          Vector sLoc = txAntenna->GetAntennaLocation (sIndex,txAntennaNum);
+          const std::complex<double> *sSteering = &txSteering[sIndex * numRays];
+          uint8_t subClusterIndex = H_usn.GetNumCluster () - numSubCluster;
 
           for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
             {
+              uint32_t firstRay = nIndex * raysPerCluster;
               //Compute the N-2 weakest cluster, only vertical polarization. (7.5-22)
               if (nIndex != cluster1st && nIndex != cluster2nd)
                 {
                   std::complex<double> rays (0,0);
-                  for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+                  for (uint32_t ray = firstRay; ray < firstRay + raysPerCluster; ray++)
                     {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
-                      //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
-                      //		+ sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
-                      //		+ cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-                      rays += exp (std::complex<double> (0, initialPhase))
-                        * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                           * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                        * exp (std::complex<double> (0, rxPhaseDiff))
-                        * exp (std::complex<double> (0, txPhaseDiff));
-                      //*exp(std::complex<double>(0, doppler));
-                      //rays += 1;
+                      //lambda_0 is accounted in the antenna spacing of the steering vectors.
+                      rays += rayCoefficient[ray] * uSteering[ray] * sSteering[ray];
                     }
-                  //rays *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
                   rays *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) = rays;
+                  H_usn.Set (uIndex, sIndex, nIndex, rays);
                 }
               else                   //(7.5-28)
                 {
@@ -2144,17 +2448,8 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
 
                       //ZML:Just remind me that the angle offsets for the 3 subclusters were not generated correctly.
 
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
-                      //		+ sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
-                      //		+ cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-                      //double delaySpread;
+                      uint32_t ray = firstRay + mIndex;
+                      std::complex<double> rayValue = rayCoefficient[ray] * uSteering[ray] * sSteering[ray];
                       switch (mIndex)
                         {
                         case 9:
@@ -2163,79 +2458,38 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
                         case 12:
                         case 17:
                         case 18:
-                          //delaySpread= -2*M_PI*(clusterDelay.at(nIndex)+1.28*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub2 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub2 +=1;
+                          raysSub2 += rayValue;
                           break;
                         case 13:
                         case 14:
                         case 15:
                         case 16:
-                          //delaySpread = -2*M_PI*(clusterDelay.at(nIndex)+2.56*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub3 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub3 +=1;
+                          raysSub3 += rayValue;
                           break;
                         default:                        //case 1,2,3,4,5,6,7,8,19,20
-                                                        //delaySpread = -2*M_PI*clusterDelay.at(nIndex)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub1 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub1 +=1;
+                          raysSub1 += rayValue;
                           break;
                         }
                     }
-                  //raysSub1 *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
-                  //raysSub2 *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
-                  //raysSub3 *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
                   raysSub1 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
                   raysSub2 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
                   raysSub3 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) = raysSub1;
-                  H_usn.at (uIndex).at (sIndex).push_back (raysSub2);
-                  H_usn.at (uIndex).at (sIndex).push_back (raysSub3);
+                  H_usn.Set (uIndex, sIndex, nIndex, raysSub1);
+                  H_usn.Set (uIndex, sIndex, subClusterIndex++, raysSub2);
+                  H_usn.Set (uIndex, sIndex, subClusterIndex++, raysSub3);
 
                 }
             }
           if (los)               //(7.5-29) && (7.5-30)
             {
-              std::complex<double> ray (0,0);
-              double rxPhaseDiff = 2 * M_PI * (sin (rxAngle.theta) * cos (rxAngle.phi) * uLoc.x
-                                               + sin (rxAngle.theta) * sin (rxAngle.phi) * uLoc.y
-                                               + cos (rxAngle.theta) * uLoc.z);
-              double txPhaseDiff = 2 * M_PI * (sin (txAngle.theta) * cos (txAngle.phi) * sLoc.x
-                                               + sin (txAngle.theta) * sin (txAngle.phi) * sLoc.y
-                                               + cos (txAngle.theta) * sLoc.z);
-              //double doppler = 2*M_PI*(sin(rxAngle.theta)*cos(rxAngle.phi)*relativeSpeed.x
-              //		+ sin(rxAngle.theta)*sin(rxAngle.phi)*relativeSpeed.y
-              //		+ cos(rxAngle.theta)*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-
-              ray = exp (std::complex<double> (0, losPhase))
-                * (rxAntenna->GetRadiationPattern (rxAngle.theta,rxAngle.phi)
-                   * txAntenna->GetRadiationPattern (txAngle.theta,rxAngle.phi))
-                * exp (std::complex<double> (0, rxPhaseDiff))
-                * exp (std::complex<double> (0, txPhaseDiff));
-              //*exp(std::complex<double>(0, doppler));
+              std::complex<double> ray = losCoefficient * rxLosSteering[uIndex] * txLosSteering[sIndex];
 
               double K_linear = pow (10,K_factor / 10);
               // the LOS path should be attenuated if blockage is enabled.
-              H_usn.at (uIndex).at (sIndex).at (0) = sqrt (1 / (K_linear + 1)) * H_usn.at (uIndex).at (sIndex).at (0) + sqrt (K_linear / (1 + K_linear)) * ray / pow (10,attenuation_dB.at (0) / 10);           //(7.5-30) for tau = tau1
-              double tempSize = H_usn.at (uIndex).at (sIndex).size ();
-              for (uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
+              H_usn.Set (uIndex, sIndex, 0, sqrt (1 / (K_linear + 1)) * H_usn.Get (uIndex, sIndex, 0) + sqrt (K_linear / (1 + K_linear)) * ray / pow (10,attenuation_dB.at (0) / 10));           //(7.5-30) for tau = tau1
+              for (uint8_t nIndex = 1; nIndex < H_usn.GetNumCluster (); nIndex++)
                 {
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) *= sqrt (1 / (K_linear + 1));                   //(7.5-30) for tau = tau2...taunN
+                  H_usn.Scale (uIndex, sIndex, nIndex, sqrt (1 / (K_linear + 1)));                   //(7.5-30) for tau = tau2...taunN
                 }
 
             }
@@ -2300,7 +2554,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
 
     }
 
-  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.size () << "][" << H_usn.at (0).size () << "][" << H_usn.at (0).at (0).size () << "]");
+  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.GetRxSize () << "][" << H_usn.GetTxSize () << "][" << (uint16_t)H_usn.GetNumCluster () << "]");
 
 
   /*std::cout << "Delay:";
@@ -2310,7 +2564,6 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
   }
   std::cout << "\n";*/
 
-  channelParams->m_channel = H_usn;
   channelParams->m_delay = clusterDelay;
 
   channelParams->m_angle.clear ();
@@ -2734,61 +2987,66 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
 
   NS_LOG_INFO ("1st strongest cluster:" << (int)cluster1st << ", 2nd strongest cluster:" << (int)cluster2nd);
 
-  complex3DVector_t H_usn;       //channel coffecient H_usn[u][s][n];
-  //Since each of the strongest 2 clusters are divided into 3 sub-clusters, the total cluster will be numReducedCLuster + 4.
-
-  H_usn.resize (uSize);
-  for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
-    {
-      H_usn.at (uIndex).resize (sSize);
-      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
-        {
-          H_usn.at (uIndex).at (sIndex).resize (params->m_numCluster);
-        }
-    }
+  MmWaveChannelTensor &H_usn = params->m_channel;       //channel coffecient H_usn[u][s][n];
+  //Since each of the strongest 2 clusters are divided into 3 sub-clusters, the total cluster will be numReducedCLuster + 4
+  //(+ 2 if the strongest clusters coincide). The sub-clusters are stored after the other clusters, ordered by cluster index.
+  uint8_t numSubCluster = (cluster1st == cluster2nd) ? 2 : 4;
+  H_usn.Resize (uSize, sSize, params->m_numCluster + numSubCluster);
   //double slotTime = Simulator::Now ().GetSeconds ();
   // The following for loops computes the channel coefficients
+  // The phase shifts of the array elements and the radiation pattern of the elements only depend on
+  // the direction of each ray, thus they are computed once per ray, and not for each pair of elements.
+  uint32_t numRays = params->m_numCluster * raysPerCluster;
+  complexVector_t rxSteering;       // rxSteering[u * numRays + n * raysPerCluster + m]
+  complexVector_t txSteering;       // txSteering[s * numRays + n * raysPerCluster + m]
+  rxAntenna->GetSteeringVectors (&rayZoa_radian[0][0], &rayAoa_radian[0][0], numRays, rxAntennaNum, rxSteering);
+  txAntenna->GetSteeringVectors (&rayZod_radian[0][0], &rayAod_radian[0][0], numRays, txAntennaNum, txSteering);
+  complexVector_t rayCoefficient (numRays);       // initial phase and radiation pattern of each ray
+  for (uint8_t nIndex = 0; nIndex < params->m_numCluster; nIndex++)
+    {
+      for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+        {
+          //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
+          rayCoefficient[nIndex * raysPerCluster + mIndex] = exp (std::complex<double> (0, clusterPhase.at (nIndex).at (mIndex)))
+            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
+               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]));
+        }
+    }
+  complexVector_t rxLosSteering;
+  complexVector_t txLosSteering;
+  std::complex<double> losCoefficient (0,0);
+  if (params->m_los)
+    {
+      rxAntenna->GetSteeringVectors (&rxAngle.theta, &rxAngle.phi, 1, rxAntennaNum, rxLosSteering);
+      txAntenna->GetSteeringVectors (&txAngle.theta, &txAngle.phi, 1, txAntennaNum, txLosSteering);
+      losCoefficient = exp (std::complex<double> (0, losPhase))
+        * (rxAntenna->GetRadiationPattern (rxAngle.theta,rxAngle.phi)
+           * txAntenna->GetRadiationPattern (txAngle.theta,txAngle.phi));
+    }
+
   for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-      Vector uLoc = rxAntenna->GetAntennaLocation (uIndex,rxAntennaNum);
+      const std::complex<double> *uSteering = &rxSteering[uIndex * numRays];
 
       for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
         {
-
-          Vector sLoc = txAntenna->GetAntennaLocation (sIndex,txAntennaNum);
+          const std::complex<double> *sSteering = &txSteering[sIndex * numRays];
+          uint8_t subClusterIndex = H_usn.GetNumCluster () - numSubCluster;
 
           for (uint8_t nIndex = 0; nIndex < params->m_numCluster; nIndex++)
             {
+              uint32_t firstRay = nIndex * raysPerCluster;
               //Compute the N-2 weakest cluster, only vertical polarization. (7.5-22)
               if (nIndex != cluster1st && nIndex != cluster2nd)
                 {
                   std::complex<double> rays (0,0);
-                  for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+                  for (uint32_t ray = firstRay; ray < firstRay + raysPerCluster; ray++)
                     {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
-                      //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
-                      //		+ sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
-                      //		+ cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-                      rays += exp (std::complex<double> (0, initialPhase))
-                        * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                           * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                        * exp (std::complex<double> (0, rxPhaseDiff))
-                        * exp (std::complex<double> (0, txPhaseDiff));
-                      //*exp(std::complex<double>(0, doppler));
-                      //rays += 1;
+                      //lambda_0 is accounted in the antenna spacing of the steering vectors.
+                      rays += rayCoefficient[ray] * uSteering[ray] * sSteering[ray];
                     }
-                  //rays *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
                   rays *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) = rays;
+                  H_usn.Set (uIndex, sIndex, nIndex, rays);
                 }
               else                   //(7.5-28)
                 {
@@ -2798,17 +3056,11 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
 
                   for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
                     {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
-                      //		+ sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
-                      //		+ cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-                      //double delaySpread;
+
+                      //ZML:Just remind me that the angle offsets for the 3 subclusters were not generated correctly.
+
+                      uint32_t ray = firstRay + mIndex;
+                      std::complex<double> rayValue = rayCoefficient[ray] * uSteering[ray] * sSteering[ray];
                       switch (mIndex)
                         {
                         case 9:
@@ -2817,79 +3069,38 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
                         case 12:
                         case 17:
                         case 18:
-                          //delaySpread= -2*M_PI*(clusterDelay.at(nIndex)+1.28*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub2 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub2 +=1;
+                          raysSub2 += rayValue;
                           break;
                         case 13:
                         case 14:
                         case 15:
                         case 16:
-                          //delaySpread = -2*M_PI*(clusterDelay.at(nIndex)+2.56*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub3 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub3 +=1;
+                          raysSub3 += rayValue;
                           break;
                         default:                        //case 1,2,3,4,5,6,7,8,19,20
-                                                        //delaySpread = -2*M_PI*clusterDelay.at(nIndex)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub1 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub1 +=1;
+                          raysSub1 += rayValue;
                           break;
                         }
                     }
-                  //raysSub1 *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
-                  //raysSub2 *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
-                  //raysSub3 *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
                   raysSub1 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
                   raysSub2 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
                   raysSub3 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) = raysSub1;
-                  H_usn.at (uIndex).at (sIndex).push_back (raysSub2);
-                  H_usn.at (uIndex).at (sIndex).push_back (raysSub3);
+                  H_usn.Set (uIndex, sIndex, nIndex, raysSub1);
+                  H_usn.Set (uIndex, sIndex, subClusterIndex++, raysSub2);
+                  H_usn.Set (uIndex, sIndex, subClusterIndex++, raysSub3);
 
                 }
             }
           if (params->m_los)               //(7.5-29) && (7.5-30)
             {
-              std::complex<double> ray (0,0);
-              double rxPhaseDiff = 2 * M_PI * (sin (rxAngle.theta) * cos (rxAngle.phi) * uLoc.x
-                                               + sin (rxAngle.theta) * sin (rxAngle.phi) * uLoc.y
-                                               + cos (rxAngle.theta) * uLoc.z);
-              double txPhaseDiff = 2 * M_PI * (sin (txAngle.theta) * cos (txAngle.phi) * sLoc.x
-                                               + sin (txAngle.theta) * sin (txAngle.phi) * sLoc.y
-                                               + cos (txAngle.theta) * sLoc.z);
-              //double doppler = 2*M_PI*(sin(rxAngle.theta)*cos(rxAngle.phi)*relativeSpeed.x
-              //		+ sin(rxAngle.theta)*sin(rxAngle.phi)*relativeSpeed.y
-              //		+ cos(rxAngle.theta)*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-
-              ray = exp (std::complex<double> (0, losPhase))
-                * (rxAntenna->GetRadiationPattern (rxAngle.theta,rxAngle.phi)
-                   * txAntenna->GetRadiationPattern (txAngle.theta,txAngle.phi))
-                * exp (std::complex<double> (0, rxPhaseDiff))
-                * exp (std::complex<double> (0, txPhaseDiff));
-              //*exp(std::complex<double>(0, doppler));
+              std::complex<double> ray = losCoefficient * rxLosSteering[uIndex] * txLosSteering[sIndex];
 
               double K_linear = pow (10,K_factor / 10);
 
-              H_usn.at (uIndex).at (sIndex).at (0) = sqrt (1 / (K_linear + 1)) * H_usn.at (uIndex).at (sIndex).at (0) + sqrt (K_linear / (1 + K_linear)) * ray / pow (10,attenuation_dB.at (0) / 10);           //(7.5-30) for tau = tau1
-              double tempSize = H_usn.at (uIndex).at (sIndex).size ();
-              for (uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
+              H_usn.Set (uIndex, sIndex, 0, sqrt (1 / (K_linear + 1)) * H_usn.Get (uIndex, sIndex, 0) + sqrt (K_linear / (1 + K_linear)) * ray / pow (10,attenuation_dB.at (0) / 10));           //(7.5-30) for tau = tau1
+              for (uint8_t nIndex = 1; nIndex < H_usn.GetNumCluster (); nIndex++)
                 {
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) *= sqrt (1 / (K_linear + 1));                   //(7.5-30) for tau = tau2...taunN
+                  H_usn.Scale (uIndex, sIndex, nIndex, sqrt (1 / (K_linear + 1)));                   //(7.5-30) for tau = tau2...taunN
                 }
 
             }
@@ -2937,7 +3148,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
 
     }
 
-  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.size () << "][" << H_usn.at (0).size () << "][" << H_usn.at (0).at (0).size () << "]");
+  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.GetRxSize () << "][" << H_usn.GetTxSize () << "][" << (uint16_t)H_usn.GetNumCluster () << "]");
 
 
   /*std::cout << "Delay:";
@@ -2948,7 +3159,6 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
   std::cout << "\n";*/
 
   params->m_delay = clusterDelay;
-  params->m_channel = H_usn;
   params->m_angle.clear ();
   params->m_angle.push_back (clusterAoa);
   params->m_angle.push_back (clusterZoa);
@@ -2956,58 +3166,37 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
   params->m_angle.push_back (clusterZod);
   //update the previous location.
 
+  // the caller selects the BF vectors of the updated channel, or marks them as pending again
+  params->m_beamformingPending = false;
   return params;
 
 }
 
 void
-MmWave3gppChannel::BeamSearchBeamforming (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
+MmWave3gppChannel::BeamSearchBeamforming (Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
                                           Ptr<AntennaArrayModel> rxAntenna, uint16_t *txAntennaNum, uint16_t *rxAntennaNum) const
 {
-  double max = 0, maxTx = 0, maxRx = 0, maxTxTheta = 0, maxRxTheta = 0;
   NS_LOG_LOGIC ("BeamSearchBeamforming method at time " << Simulator::Now ().GetSeconds ());
-  for (uint16_t txTheta = 60; txTheta < 121; txTheta = txTheta + 10)
+  Ptr<const MmWaveBeamCodebook> txCodebook = MmWaveBeamCodebook::Get (txAntenna, txAntennaNum);
+  Ptr<const MmWaveBeamCodebook> rxCodebook = MmWaveBeamCodebook::Get (rxAntenna, rxAntennaNum);
+
+  MmWaveBeamSearch::Result best;
+  if (m_longTermBfMethod == HIERARCHICAL_BEAM_SEARCH)
     {
-      for (uint16_t tx = 0; tx <= txAntennaNum[1]; tx++)
-        {
-          for (uint16_t rxTheta = 60; rxTheta < 121; rxTheta = rxTheta + 10)
-            {
-              for (uint16_t rx = 0; rx <= rxAntennaNum[1]; rx++)
-                {
-                  NS_LOG_LOGIC ("txTheta " << txTheta << " rxTheta " << rxTheta << " tx sector " <<
-                                (M_PI * (double)tx / (double)txAntennaNum[1] - 0.5 * M_PI) / (M_PI) * 180 << " rx sector " <<
-                                (M_PI * (double)rx / (double)rxAntennaNum[1] - 0.5 * M_PI) / (M_PI) * 180);
-
-                  txAntenna->SetSector (tx, txAntennaNum, txTheta);
-                  rxAntenna->SetSector (rx, rxAntennaNum, rxTheta);
-                  params->m_txW = txAntenna->GetBeamformingVectorPanel ();
-                  params->m_rxW = rxAntenna->GetBeamformingVectorPanel ();
-                  params->m_longTerm = CalLongTerm (params);
-                  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (txPsd, params, params->m_longTerm, Vector (0,0,0));
-
-                  SpectrumValue bfGain = (*bfPsd) / (*txPsd);
-                  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-                  double power = Sum (bfGain) / nbands;
-
-                  NS_LOG_LOGIC ("gain " << power);
-                  if (max < power)
-                    {
-                      max = power;
-                      maxTx = tx;
-                      maxRx = rx;
-                      maxTxTheta = txTheta;
-                      maxRxTheta = rxTheta;
-                    }
-                }
-            }
-        }
+      best = MmWaveBeamSearch::Hierarchical (params->m_channel, *txCodebook, *rxCodebook);
     }
-  NS_LOG_LOGIC ("maxTx " << maxTx << " txAntennaNum[1] " << (uint16_t)txAntennaNum[1]);
-  NS_LOG_LOGIC ("max gain " << max << " maxTx " << (M_PI * (double)maxTx / (double)txAntennaNum[1] - 0.5 * M_PI) / (M_PI) * 180 << " maxRx " << (M_PI * (double)maxRx / (double)rxAntennaNum[1] - 0.5 * M_PI) / (M_PI) * 180 << " maxTxTheta " << maxTxTheta << " maxRxTheta " << maxRxTheta);
-  txAntenna->SetSector (maxTx, txAntennaNum, maxTxTheta);
-  rxAntenna->SetSector (maxRx, rxAntennaNum, maxRxTheta);
-  params->m_txW = txAntenna->GetBeamformingVectorPanel ();
-  params->m_rxW = rxAntenna->GetBeamformingVectorPanel ();
+  else
+    {
+      best = MmWaveBeamSearch::Exhaustive (params->m_channel, *txCodebook, *rxCodebook);
+    }
+
+  NS_LOG_LOGIC ("max gain " << best.m_gain
+                << " maxTx " << (M_PI * (double)txCodebook->GetSector (best.m_txBeam) / (double)txAntennaNum[1] - 0.5 * M_PI) / (M_PI) * 180
+                << " maxRx " << (M_PI * (double)rxCodebook->GetSector (best.m_rxBeam) / (double)rxAntennaNum[1] - 0.5 * M_PI) / (M_PI) * 180
+                << " maxTxTheta " << txCodebook->GetElevation (best.m_txBeam)
+                << " maxRxTheta " << rxCodebook->GetElevation (best.m_rxBeam));
+  params->m_txW = txCodebook->GetBeam (best.m_txBeam);
+  params->m_rxW = rxCodebook->GetBeam (best.m_rxBeam);
 }
 
 doubleVector_t
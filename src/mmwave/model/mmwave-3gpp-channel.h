@@ -41,6 +41,9 @@
 #include "ns3/mmwave-3gpp-propagation-loss-model.h"
 #include <ns3/antenna-array-model.h>
 #include "ns3/mmwave-3gpp-buildings-propagation-loss-model.h"
+#include "ns3/mmwave-channel-tensor.h"
+#include "ns3/mmwave-link-table.h"
+#include "ns3/mmwave-channel-update-scheduler.h"
 
 #define AOA_INDEX 0
 #define ZOA_INDEX 1
@@ -58,6 +61,9 @@ namespace ns3 {
 namespace mmwave {
 
 //class MmWave3gppBuildingsPropagationLossModel;
+class MmWaveEnbNetDevice;
+class MmWaveUeNetDevice;
+class McUeNetDevice;
 
 typedef std::vector<double> doubleVector_t;
 typedef std::vector<doubleVector_t> double2DVector_t;
@@ -68,6 +74,17 @@ typedef std::vector<complex2DVector_t> complex3DVector_t;
 
 typedef std::pair<Ptr<NetDevice>, Ptr<NetDevice> > key_t;
 
+/**
+ * The long term component of a channel for a pair of BF vectors, and the
+ * versions of the two vectors (see AntennaArrayModel::GetBeamformingVectorVersion)
+ */
+struct LongTermCacheEntry
+{
+  complexVector_t m_longTerm;
+  uint64_t m_enbVersion;
+  uint64_t m_ueVersion;
+};
+
 /**
  * Data structure that stores a channel realization
  */
@@ -75,7 +92,7 @@ struct Params3gpp : public SimpleRefCount<Params3gpp>
 {
   complexVector_t                 m_txW;       // tx antenna weights.
   complexVector_t                 m_rxW;       // rx antenna weights.
-  complex3DVector_t               m_channel;       // channel matrix H[u][s][n].
+  MmWaveChannelTensor             m_channel;       // channel matrix H[u][s][n], stored cluster-major.
   doubleVector_t                  m_delay;       // cluster delay.
   double2DVector_t                m_angle;       //cluster angle angle[direction][n], where direction = 0(aoa), 1(zoa), 2(aod), 3(zod) in degree.
   complexVector_t                 m_longTerm;       // long term conponet.
@@ -98,7 +115,9 @@ struct Params3gpp : public SimpleRefCount<Params3gpp>
   double m_dis2D;
   double m_dis3D;
 
-  std::map<Ptr<NetDevice>, complexVector_t> m_allLongTermMap;
+  std::map<Ptr<NetDevice>, LongTermCacheEntry> m_allLongTermMap;       // long term component when the eNB serves each UE, filled on demand
+  uint64_t m_generation;       // changes every time the channel realization or m_longTerm change, see NextChannelGeneration
+  bool m_beamformingPending;       // the channel was refreshed outside a transmission, the BF vectors are selected at the next one
 };
 
 /**
@@ -172,6 +191,17 @@ class MmWave3gppChannel : public SpectrumPropagationLossModel
 {
 public:
   /**
+   * Method used to compute the optimal BF vectors
+   */
+  enum LongTermBfMethod
+  {
+    COV_MATRIX,   //!< dominant eigenvectors of the tx and rx spatial correlation matrices
+    RANK1_SVD,    //!< dominant singular vectors of the channel matrix summed over the clusters
+    BEAM_SEARCH,  //!< best pair of beams of the codebooks, with an exhaustive search
+    HIERARCHICAL_BEAM_SEARCH   //!< best pair of beams of the codebooks, with a two-stage search
+  };
+
+  /**
 * Constructor
 */
   MmWave3gppChannel ();
@@ -233,7 +263,59 @@ public:
    */
   void SetInterferenceOrDataMode (bool flag);
 
+  /**
+   * @param the mobility model of a device
+   * @param the mobility model of the other device
+   * @returns an identifier of the channel realization between the two devices,
+   * which changes every time the channel is created or updated, or 0 if the
+   * channel does not exist or has to be updated
+   */
+  uint64_t GetChannelGeneration (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const;
+
 private:
+  /**
+   * The device at one end of a link, with its type and its antenna array
+   */
+  struct LinkEnd
+  {
+    Ptr<const MobilityModel> m_mobility;
+    Ptr<NetDevice> m_device;
+    Ptr<MmWaveEnbNetDevice> m_enb;       // not null if the device is an eNB
+    Ptr<MmWaveUeNetDevice> m_ue;       // not null if the device is a UE
+    Ptr<McUeNetDevice> m_mcUe;       // not null if the device is a MC UE
+    Ptr<AntennaArrayModel> m_antennaArray;
+    uint16_t m_antennaNum;       // number of antenna elements per row
+    uint32_t m_deviceIndex;       // index of m_device in m_deviceRegistry
+    uint32_t m_nodeId;       // id of the node, to read the MobilitySnapshot
+  };
+
+  /**
+   * The quantities used to compute the frequency selective BF gain that
+   * only depend on the current time and on the configuration, and
+   * can thus be shared by all the links evaluated for a transmission
+   */
+  struct SubbandParams
+  {
+    double m_slotTime;       // current time, in seconds
+    double m_centerFrequency;
+    double m_firstFrequency;       // frequency of the first subband
+    double m_chunkWidth;
+  };
+
+  /**
+   * What is needed to apply the BF gain to a link, selected by PrepareLink
+   */
+  struct LinkGain
+  {
+    Ptr<Params3gpp> m_params;       // the channel realization, null if no BF gain has to be applied
+    complexVector_t m_longTerm;       // the long term component for the BF vectors in use
+    Vector m_speed;       // relative speed between rx and tx
+    bool m_reverseLink;       // true if the channel was generated for the reverse link
+    bool m_connectedPair;       // true if the UE is attached to the eNB of the link
+  };
+
+  struct BeamformingGainTask;
+
   /**
    * Inherited from SpectrumPropagationLossModel, it returns the PSD at the receiver
    * @params the transmitted PSD
@@ -245,6 +327,84 @@ private:
                                                    Ptr<const MobilityModel> a,
                                                    Ptr<const MobilityModel> b) const;
 
+  /**
+   * Inherited from SpectrumPropagationLossModel, it applies the BF gain
+   * to the transmitted PSD without copying it
+   * @params the transmitted PSD, replaced by the received PSD
+   * @params the mobility model of the transmitter
+   * @params the mobility model of the receiver
+   */
+  void DoCalcRxPowerSpectralDensityInPlace (Ptr<SpectrumValue> psd,
+                                            Ptr<const MobilityModel> a,
+                                            Ptr<const MobilityModel> b) const;
+
+  /**
+   * Inherited from SpectrumPropagationLossModel, it bounds the BF gain
+   * with the array and element gains of the link, summed over all the rays
+   * that may add up coherently, plus the MaxGainMarginDb attribute,
+   * without creating or updating the channel
+   * @params the mobility model of the transmitter
+   * @params the mobility model of the receiver
+   * @returns the upper bound of the BF gain, in dB
+   */
+  double DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                         Ptr<const MobilityModel> b) const;
+
+  /**
+   * Inherited from SpectrumPropagationLossModel, it computes in place the
+   * PSD at each receiver of the same transmission. The transmitter is
+   * resolved and the SubbandParams are computed only once for all the receivers.
+   * The channels are updated serially, then the BF gain of the links is
+   * computed by the threads of the pool, if any
+   * @params the transmitted PSD as seen by each receiver, replaced by the received PSD
+   * @params the mobility model of the transmitter
+   * @params the mobility models of the receivers
+   * @params the worker threads, can be null
+   */
+  void DoCalcRxPowerSpectralDensityBatch (const std::vector<Ptr<SpectrumValue> > &psds,
+                                          Ptr<const MobilityModel> a,
+                                          const std::vector<Ptr<const MobilityModel> > &b,
+                                          Ptr<SpectrumWorkerPool> pool) const;
+
+  /**
+   * Create or update the channel of a link, if needed, and select the
+   * long term component to be used for the BF gain
+   * @params the transmitted PSD, null if the channel is refreshed outside a
+   * transmission: then only the channel matrix is generated, and the BF
+   * vectors are selected at the next transmission on the link
+   * @params the transmitter
+   * @params the receiver
+   * @params the LinkGain to be filled, m_params is null if the PSD
+   * does not have to be changed (e.g., for omni transmissions)
+   */
+  void PrepareLink (Ptr<const SpectrumValue> txPsd, const LinkEnd &tx, const LinkEnd &rx,
+                    LinkGain &gain) const;
+
+  /**
+   * Log the average BF gain of a link
+   * @params the PSD before the BF gain
+   * @params the PSD after the BF gain
+   * @params the transmitter
+   * @params the receiver
+   * @params the LinkGain of the link
+   */
+  void LogLinkGain (Ptr<const SpectrumValue> rxPsd, Ptr<const SpectrumValue> bfPsd,
+                    const LinkEnd &tx, const LinkEnd &rx, const LinkGain &gain) const;
+
+  /**
+   * Returns the LinkEnd associated to a mobility model, which is resolved
+   * the first time it is requested and then cached
+   * @params the mobility model of the node
+   * @returns the LinkEnd
+   */
+  const LinkEnd & GetLinkEnd (Ptr<const MobilityModel> mobility) const;
+
+  /**
+   * Returns the SubbandParams for the current time
+   * @returns the SubbandParams
+   */
+  SubbandParams GetSubbandParams (void) const;
+
   /**
    * Get a new realization of the channel
    * @params the ParamsTable for the specific scenario
@@ -291,12 +451,23 @@ private:
    */
   void LongTermCovMatrixBeamforming (Ptr<Params3gpp> params) const;
 
+  /**
+   * Compute the BF vectors as the dominant left and right singular vectors
+   * of the channel matrix summed over the clusters, with alternating power iterations.
+   * It avoids building the spatial correlation matrices, and it is used
+   * by LongTermCovMatrixBeamforming when LongTermBfMethod is RANK1_SVD
+   * @params the channel realizationin as a Params3gpp object
+   */
+  void LongTermRank1Beamforming (Ptr<Params3gpp> params) const;
+
   /**
    * Scan all sectors with predefined code book and select the one returns maximum gain.
+   * The beams are taken from the MmWaveBeamCodebook of the arrays, and the search is
+   * exhaustive or hierarchical according to m_longTermBfMethod.
    * The BF vector is stored in the Params3gpp object passed as parameter
    * @params the channel realizationin as a Params3gpp object
    */
-  void BeamSearchBeamforming (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
+  void BeamSearchBeamforming (Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
                               Ptr<AntennaArrayModel> rxAntenna, uint16_t *txAntennaNum, uint16_t *rxAntennaNum) const;
 
 
@@ -307,6 +478,32 @@ private:
    */
   complexVector_t CalLongTerm (Ptr<Params3gpp> params) const;
 
+  /**
+   * Compute the long term component with the given BF vectors instead of
+   * the ones stored in the Params3gpp object
+   * @params the channel realizationin as a Params3gpp object
+   * @params the tx antenna weights
+   * @params the rx antenna weights
+   * @return the complexVector_t with the BF applied to the channel
+   */
+  complexVector_t CalLongTerm (Ptr<Params3gpp> params, const complexVector_t &txW, const complexVector_t &rxW) const;
+
+  /**
+   * Get the long term component of the channel between an eNB and a UE when
+   * the eNB points its beam towards servedUe and the UE points its beam
+   * towards the eNB it is attached to. It is read from the m_allLongTermMap of
+   * the channel and it is computed only if one of the two BF vectors changed
+   * @params the channel realizationin as a Params3gpp object
+   * @params the eNB
+   * @params the UE
+   * @params the eNB the UE is attached to
+   * @params the UE served by the eNB
+   * @params true if the eNB is the transmitter of the channel realization
+   * @return the long term component
+   */
+  const complexVector_t& GetInterferenceLongTerm (Ptr<Params3gpp> params, const LinkEnd &enb, const LinkEnd &ue,
+                                                  Ptr<NetDevice> ueTargetEnb, Ptr<NetDevice> servedUe, bool enbIsTx) const;
+
   /**
    * Compute the BF gain, apply frequency selectivity by phase-shifting with the cluster delays
    * and scale the txPsd to get the rxPsd
@@ -318,9 +515,38 @@ private:
    */
   Ptr<SpectrumValue> CalBeamformingGain (Ptr<const SpectrumValue> txPsd,
                                          Ptr<Params3gpp> params,
-                                         complexVector_t longTerm,
+                                         const complexVector_t &longTerm,
                                          Vector speed) const;
 
+  /**
+   * Compute the BF gain as above, with SubbandParams that have already been computed
+   * @params the tx PSD
+   * @params the channel realizationin as a Params3gpp object
+   * @params the longTerm component (i.e., with the BF vectors already applied)
+   * @params the relative speed between UE and eNB
+   * @params the SubbandParams for the current time
+   * @returns the rx PSD
+   */
+  Ptr<SpectrumValue> CalBeamformingGain (Ptr<const SpectrumValue> txPsd,
+                                         Ptr<Params3gpp> params,
+                                         const complexVector_t &longTerm,
+                                         Vector speed,
+                                         const SubbandParams &subband) const;
+
+  /**
+   * Scale the PSD values by the BF gain. This function only reads its
+   * parameters, thus it can be called by multiple threads at the same time
+   * @params the PSD values
+   * @params the number of subbands
+   * @params the channel realization
+   * @params the longTerm component (i.e., with the BF vectors already applied)
+   * @params the relative speed between UE and eNB
+   * @params the SubbandParams for the current time
+   */
+  static void ApplyBeamformingGain (double *psd, uint32_t numSubband, const Params3gpp &params,
+                                    const complexVector_t &longTerm, Vector speed,
+                                    const SubbandParams &subband);
+
   /**
    * Returns the bandwidth used in a scenario
    * @returns a double with the bandwidth
@@ -348,6 +574,21 @@ private:
    */
   void DeleteChannel (Ptr<const MobilityModel> a,
                       Ptr<const MobilityModel> b) const;
+
+  /**
+   * Called by m_updateScheduler when the update of a group of links is due.
+   * The channels of the links are deleted and, if EagerUpdate is true, they
+   * are updated right away instead of at the next transmission on each link
+   * @params the links
+   */
+  void RefreshChannels (const std::vector<MmWaveChannelUpdateScheduler::Link> &links) const;
+
+  /**
+   * Set the granularity of the update times of the channels
+   * @params the granularity
+   */
+  void SetUpdateGranularity (Time granularity);
+  Time GetUpdateGranularity () const;
   /*
    * Returns the attenuation of each cluster in dB after applying blockage model
    * @params the channel realizationin as a Params3gpp object
@@ -357,8 +598,11 @@ private:
   doubleVector_t CalAttenuationOfBlockage (Ptr<Params3gpp> params,
                                            doubleVector_t clusterAOA, doubleVector_t clusterZOA) const;
 
-  mutable std::map< key_t, int > m_connectedPair;
-  mutable std::map< key_t, Ptr<Params3gpp> > m_channelMap;
+  mutable MmWaveDeviceRegistry m_deviceRegistry;
+  mutable MmWaveLinkTable<int> m_connectedPair;
+  mutable MmWaveLinkTable<Ptr<Params3gpp> > m_channelTable;
+  mutable std::map< Ptr<const MobilityModel>, LinkEnd > m_linkEndMap;
+  mutable MmWaveChannelUpdateScheduler m_updateScheduler;
 
   Ptr<UniformRandomVariable> m_uniformRv;
   Ptr<UniformRandomVariable> m_uniformRvBlockage;
@@ -370,12 +614,19 @@ private:
   Ptr<ExponentialRandomVariable> m_expRv;
   Ptr<MmWavePhyMacCommon> m_phyMacConfig;
   Ptr<PropagationLossModel> m_3gppPathloss;
+  Ptr<MmWave3gppPropagationLossModel> m_3gppPropagationLoss;       // m_3gppPathloss, if it is a MmWave3gppPropagationLossModel
+  Ptr<MmWave3gppBuildingsPropagationLossModel> m_3gppBuildingsPropagationLoss;       // m_3gppPathloss, if it is a MmWave3gppBuildingsPropagationLossModel
   Ptr<ParamsTable> m_table3gpp;
   Time m_updatePeriod;
+  bool m_eagerUpdate;
   bool m_directBeam;
   bool m_blockage;
   uint16_t m_numNonSelfBloking;       //number of non-self-blocking regions.
   bool m_portraitMode;       //true (portrait mode); false (landscape mode).
+  LongTermBfMethod m_longTermBfMethod;       //method used to compute the optimal BF vectors
+  uint32_t m_bfMaxIterations;       //maximum number of iterations of the power method
+  double m_bfTolerance;       //convergence threshold of the power method
+  double m_maxGainMarginDb;       //margin over the array gain of the bound of the BF gain
   std::string m_scenario;
   double m_blockerSpeed;
   bool m_forceInitialBfComputation;
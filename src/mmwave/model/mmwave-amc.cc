@@ -223,6 +223,47 @@ MmWaveAmc::GetNumSymbolsFromTbsMcs (unsigned tbSize, unsigned mcs)
   return ceil ((double)reqRscElement / (double)rscElementPerSym);
 }
 
+uint8_t
+MmWaveAmc::SelectMcs (const SpectrumValue& sinr, const std::vector<int>& map, TbSizeMode mode, uint32_t param, double &tbler)
+{
+  // the MI of the TB only depends on the modulation, so it is computed once
+  // for each of them instead of once for each MCS. The TBLER is not monotonic
+  // in the MCS (e.g., MCS 0 and 1 for small TBs at low SINR), so the MCSs are
+  // still scanned in increasing order, as a bisection would change the outcome
+  double mi[3] = {
+    MmWaveMiErrorModel::Mib (sinr, map, 0),
+    MmWaveMiErrorModel::Mib (sinr, map, MMWAVE_MI_QPSK_MAX_ID + 1),
+    MmWaveMiErrorModel::Mib (sinr, map, MMWAVE_MI_16QAM_MAX_ID + 1)
+  };
+  uint8_t mcs = 0;
+  MmWaveHarqProcessInfoList_t harqInfoList;
+  while (mcs <= 28)
+    {
+      uint32_t tbSize = param;
+      if (mode == RBG_TB_SIZE)
+        {
+          tbSize = GetTbSizeFromMcs (mcs, param / 18) / 8;
+        }
+      else if (mode == SYMBOLS_TB_SIZE)
+        {
+          tbSize = GetTbSizeFromMcsSymbols (mcs, param) / 8;
+        }
+      double tbMi = mi[mcs <= MMWAVE_MI_QPSK_MAX_ID ? 0 : (mcs <= MMWAVE_MI_16QAM_MAX_ID ? 1 : 2)];
+      tbler = MmWaveMiErrorModel::GetTbDecodificationStats (tbMi, tbSize, mcs, harqInfoList).tbler;
+      if (tbler > 0.1)
+        {
+          break;
+        }
+      mcs++;
+    }
+  if (mcs > 0)
+    {
+      mcs--;
+    }
+
+  return mcs;
+}
+
 std::vector<int>
 MmWaveAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
 {
@@ -273,23 +314,8 @@ MmWaveAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
           rbgMap.push_back (rbId++);
           if ((rbId % rbgSize == 0)||((it + 1) == sinr.ConstValuesEnd ()))
             {
-              uint8_t mcs = 0;
               MmWaveTbStats_t tbStats;
-              while (mcs <= 28)
-                {
-                  MmWaveHarqProcessInfoList_t harqInfoList;
-                  tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, rbgMap, GetTbSizeFromMcs (mcs, rbgSize / 18) / 8, mcs, harqInfoList);
-                  if (tbStats.tbler > 0.1)
-                    {
-                      break;
-                    }
-                  mcs++;
-
-                }
-              if (mcs > 0)
-                {
-                  mcs--;
-                }
+              uint8_t mcs = SelectMcs (sinr, rbgMap, RBG_TB_SIZE, rbgSize, tbStats.tbler);
               NS_LOG_DEBUG (this << "\t RBG " << rbId << " MCS " << (uint16_t)mcs << " TBLER " << tbStats.tbler);
               int rbgCqi = 0;
               if ((tbStats.tbler > 0.1)&&(mcs == 0))
@@ -369,25 +395,10 @@ MmWaveAmc::CreateCqiFeedbacksTdma (const SpectrumValue& sinr, uint8_t numSym)
       int chunkId = 0;
       for (it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); it++)
         {
-          uint8_t mcs = 0;
           MmWaveTbStats_t tbStats;
           std::vector <int> chunkMap;
           chunkMap.push_back (chunkId++);
-          while (mcs <= 28)
-            {
-              MmWaveHarqProcessInfoList_t harqInfoList;
-              tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, GetTbSizeFromMcsSymbols (mcs, numSym) / 8, mcs, harqInfoList);
-              if (tbStats.tbler > 0.1)
-                {
-                  break;
-                }
-              mcs++;
-
-            }
-          if (mcs > 0)
-            {
-              mcs--;
-            }
+          uint8_t mcs = SelectMcs (sinr, chunkMap, SYMBOLS_TB_SIZE, numSym, tbStats.tbler);
           NS_LOG_DEBUG (this << "\t MCS " << (uint16_t)mcs << " TBLER " << tbStats.tbler);
           int chunkCqi = 0;
           if ((tbStats.tbler > 0.1)&&(mcs == 0))
@@ -481,22 +492,8 @@ MmWaveAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, u
         }
       sinrAvg /= chunkId;
 
-      mcs = 0;
       MmWaveTbStats_t tbStats;
-      while (mcs <= 28)
-        {
-          MmWaveHarqProcessInfoList_t harqInfoList;
-          tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
-          if (tbStats.tbler > 0.1)
-            {
-              break;
-            }
-          mcs++;
-        }
-      if (mcs > 0)
-        {
-          mcs--;
-        }
+      mcs = SelectMcs (sinr, chunkMap, FIXED_TB_SIZE, tbSize, tbStats.tbler);
 //		MmWaveHarqProcessInfoList_t harqInfoList;
 //		MmWaveTbStats_t tbStatsFinal = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
 //		NS_LOG_UNCOND ("TBLER " << tbStatsFinal.tbler << " for chunks " << chunkMap.size () << " numSym "
@@ -63,6 +63,28 @@ public:
   static const unsigned int m_crcLen = 24;
 
 private:
+  /**
+   * How the TB size of each MCS is obtained by SelectMcs
+   */
+  enum TbSizeMode
+  {
+    RBG_TB_SIZE,          // GetTbSizeFromMcs (mcs, param / 18)
+    SYMBOLS_TB_SIZE,      // GetTbSizeFromMcsSymbols (mcs, param)
+    FIXED_TB_SIZE         // param bytes for every MCS
+  };
+
+  /**
+   * Select the highest MCS before the first one, in increasing order, whose
+   * TBLER is above 0.1
+   * @param the SINR
+   * @param the RBs of the TB
+   * @param how the TB size of each MCS is obtained
+   * @param the parameter of the TB size
+   * @param on return, the TBLER of the last MCS evaluated by the scan
+   * @returns the MCS
+   */
+  uint8_t SelectMcs (const SpectrumValue& sinr, const std::vector<int>& map, TbSizeMode mode, uint32_t param, double &tbler);
+
   double m_ber;
   AmcModel m_amcModel;
 
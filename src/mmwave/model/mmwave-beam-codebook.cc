@@ -0,0 +1,286 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "mmwave-beam-codebook.h"
+#include "mmwave-beamforming-kernels.h"
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/simulator.h>
+#include <map>
+#include <tuple>
+
+namespace ns3 {
+
+namespace mmwave {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBeamCodebook");
+
+// the elevations of the codebook, as swept by the original beam search: 60, 70, ..., 120 degrees
+static const double FIRST_ELEVATION = 60;
+static const double ELEVATION_STEP = 10;
+static const uint16_t NUM_ELEVATIONS = 7;
+
+// the coarse codebook of the hierarchical search
+static const uint16_t COARSE_SECTOR_STEP = 2;
+static const uint16_t COARSE_ELEVATION_STEP = 3;
+
+// the codebooks shared by the arrays of the same size and spacing, released
+// when the simulator is destroyed
+typedef std::tuple<uint16_t, uint16_t, double, double> CodebookKey;
+typedef std::map<CodebookKey, Ptr<const MmWaveBeamCodebook> > CodebookMap;
+
+static CodebookMap &
+GetCodebooks (void)
+{
+  static CodebookMap codebooks;
+  return codebooks;
+}
+
+static void
+ClearCodebooks (void)
+{
+  GetCodebooks ().clear ();
+}
+
+Ptr<const MmWaveBeamCodebook>
+MmWaveBeamCodebook::Get (Ptr<AntennaArrayModel> antenna, uint16_t *antennaNum)
+{
+  DoubleValue disH;
+  DoubleValue disV;
+  antenna->GetAttribute ("AntennaHorizontalSpacing", disH);
+  antenna->GetAttribute ("AntennaVerticalSpacing", disV);
+
+  CodebookMap &codebooks = GetCodebooks ();
+  CodebookKey key (antennaNum[0], antennaNum[1], disH.Get (), disV.Get ());
+  CodebookMap::iterator it = codebooks.find (key);
+  if (it == codebooks.end ())
+    {
+      if (codebooks.empty ())
+        {
+          Simulator::ScheduleDestroy (&ClearCodebooks);
+        }
+      NS_LOG_LOGIC ("Create the codebook for a " << antennaNum[0] << "x" << antennaNum[1] << " array");
+      Ptr<const MmWaveBeamCodebook> codebook = Ptr<const MmWaveBeamCodebook> (new MmWaveBeamCodebook (antenna, antennaNum), false);
+      it = codebooks.insert (std::make_pair (key, codebook)).first;
+    }
+  return it->second;
+}
+
+MmWaveBeamCodebook::MmWaveBeamCodebook (Ptr<AntennaArrayModel> antenna, uint16_t *antennaNum)
+  : m_size (antennaNum[0] * antennaNum[1]),
+    m_numSectors (antennaNum[1] + 1),
+    m_numElevations (NUM_ELEVATIONS)
+{
+  m_real.resize (GetNumBeams () * m_size);
+  m_imag.resize (GetNumBeams () * m_size);
+  double power = 1 / sqrt (m_size);
+  for (uint16_t beam = 0; beam < GetNumBeams (); beam++)
+    {
+      // same weights as AntennaArrayModel::SetSector
+      double hAngle_radian = M_PI * (double)GetSector (beam) / (double)antennaNum[1] - 0.5 * M_PI;
+      double vAngle_radian = GetElevation (beam) * M_PI / 180;
+      double *re = m_real.data () + beam * m_size;
+      double *im = m_imag.data () + beam * m_size;
+      for (uint16_t ind = 0; ind < m_size; ind++)
+        {
+          Vector loc = antenna->GetAntennaLocation (ind, antennaNum);
+          double phase = -2 * M_PI * (sin (vAngle_radian) * cos (hAngle_radian) * loc.x
+                                      + sin (vAngle_radian) * sin (hAngle_radian) * loc.y
+                                      + cos (vAngle_radian) * loc.z);
+          std::complex<double> weight = exp (std::complex<double> (0, phase)) * power;
+          re[ind] = weight.real ();
+          im[ind] = weight.imag ();
+        }
+    }
+}
+
+double
+MmWaveBeamCodebook::GetElevation (uint16_t beam) const
+{
+  return FIRST_ELEVATION + ELEVATION_STEP * GetElevationIndex (beam);
+}
+
+complexVector_t
+MmWaveBeamCodebook::GetBeam (uint16_t beam) const
+{
+  const double *re = GetRealBeam (beam);
+  const double *im = GetImagBeam (beam);
+  complexVector_t weights (m_size);
+  for (uint16_t ind = 0; ind < m_size; ind++)
+    {
+      weights[ind] = std::complex<double> (re[ind], im[ind]);
+    }
+  return weights;
+}
+
+void
+MmWaveBeamSearch::Evaluate (const MmWaveChannelTensor &channel,
+                            const MmWaveBeamCodebook &txCodebook, const std::vector<uint16_t> &txBeams,
+                            const MmWaveBeamCodebook &rxCodebook, const std::vector<uint16_t> &rxBeams,
+                            Result &best)
+{
+  uint16_t txSize = channel.GetTxSize ();
+  uint16_t rxSize = channel.GetRxSize ();
+  NS_ASSERT_MSG (txCodebook.GetSize () == txSize && rxCodebook.GetSize () == rxSize,
+                 "the codebooks do not match the size of the channel matrix");
+  uint16_t numTx = txBeams.size ();
+  uint16_t numRx = rxBeams.size ();
+
+  // gain[t * numRx + r] is the gain of the pair (txBeams[t], rxBeams[r])
+  std::vector<double> gain (numTx * numRx, 0);
+  // hw[t * rxSize + u] is the element u of H_n w_tx, with w_tx = txBeams[t]
+  complexVector_t hw (numTx * rxSize);
+  for (uint8_t cIndex = 0; cIndex < channel.GetNumCluster (); cIndex++)
+    {
+      const double *hRe = channel.GetRealPlane (cIndex);
+      const double *hIm = channel.GetImagPlane (cIndex);
+      for (uint16_t t = 0; t < numTx; t++)
+        {
+          const double *wRe = txCodebook.GetRealBeam (txBeams[t]);
+          const double *wIm = txCodebook.GetImagBeam (txBeams[t]);
+          for (uint16_t u = 0; u < rxSize; u++)
+            {
+              hw[t * rxSize + u] = MmWaveBeamformingKernels::ComplexDot (wRe, wIm, hRe + u * txSize, hIm + u * txSize, txSize);
+            }
+        }
+      for (uint16_t r = 0; r < numRx; r++)
+        {
+          const double *wRe = rxCodebook.GetRealBeam (rxBeams[r]);
+          const double *wIm = rxCodebook.GetImagBeam (rxBeams[r]);
+          for (uint16_t t = 0; t < numTx; t++)
+            {
+              const std::complex<double> *col = &hw[t * rxSize];
+              double sumRe = 0;
+              double sumIm = 0;
+              for (uint16_t u = 0; u < rxSize; u++)
+                {
+                  // conj (w_rx[u]) * col[u]
+                  sumRe += wRe[u] * col[u].real () + wIm[u] * col[u].imag ();
+                  sumIm += wRe[u] * col[u].imag () - wIm[u] * col[u].real ();
+                }
+              gain[t * numRx + r] += sumRe * sumRe + sumIm * sumIm;
+            }
+        }
+    }
+
+  // the first pair with the maximum gain is selected, in the order of the original sweep
+  for (uint16_t t = 0; t < numTx; t++)
+    {
+      for (uint16_t r = 0; r < numRx; r++)
+        {
+          if (best.m_gain < gain[t * numRx + r])
+            {
+              best.m_gain = gain[t * numRx + r];
+              best.m_txBeam = txBeams[t];
+              best.m_rxBeam = rxBeams[r];
+            }
+        }
+    }
+}
+
+MmWaveBeamSearch::Result
+MmWaveBeamSearch::Exhaustive (const MmWaveChannelTensor &channel,
+                              const MmWaveBeamCodebook &txCodebook, const MmWaveBeamCodebook &rxCodebook)
+{
+  std::vector<uint16_t> txBeams (txCodebook.GetNumBeams ());
+  for (uint16_t beam = 0; beam < txBeams.size (); beam++)
+    {
+      txBeams[beam] = beam;
+    }
+  std::vector<uint16_t> rxBeams (rxCodebook.GetNumBeams ());
+  for (uint16_t beam = 0; beam < rxBeams.size (); beam++)
+    {
+      rxBeams[beam] = beam;
+    }
+
+  Result best = {0, 0, 0};
+  Evaluate (channel, txCodebook, txBeams, rxCodebook, rxBeams, best);
+  NS_LOG_LOGIC ("exhaustive search: " << txBeams.size () * rxBeams.size () << " pairs, gain " << best.m_gain);
+  return best;
+}
+
+/**
+ * @param the codebook
+ * @returns the beams of the coarse codebook used by the first stage of the hierarchical search
+ */
+static std::vector<uint16_t>
+GetCoarseBeams (const MmWaveBeamCodebook &codebook)
+{
+  std::vector<uint16_t> beams;
+  for (uint16_t elevation = 0; elevation < codebook.GetNumElevations (); elevation += COARSE_ELEVATION_STEP)
+    {
+      for (uint16_t sector = 0; sector < codebook.GetNumSectors (); sector += COARSE_SECTOR_STEP)
+        {
+          beams.push_back (codebook.GetBeamIndex (elevation, sector));
+        }
+      // always include the last sector, so that the whole azimuth range is covered
+      if ((codebook.GetNumSectors () - 1) % COARSE_SECTOR_STEP != 0)
+        {
+          beams.push_back (codebook.GetBeamIndex (elevation, codebook.GetNumSectors () - 1));
+        }
+    }
+  return beams;
+}
+
+/**
+ * @param the codebook
+ * @param a beam of the coarse codebook
+ * @returns the beams between the coarse beam and its neighbors in the coarse codebook
+ */
+static std::vector<uint16_t>
+GetNeighborBeams (const MmWaveBeamCodebook &codebook, uint16_t beam)
+{
+  int sector = codebook.GetSector (beam);
+  int elevation = codebook.GetElevationIndex (beam);
+  int firstSector = std::max (0, sector - COARSE_SECTOR_STEP + 1);
+  int lastSector = std::min<int> (codebook.GetNumSectors () - 1, sector + COARSE_SECTOR_STEP - 1);
+  int firstElevation = std::max (0, elevation - COARSE_ELEVATION_STEP + 1);
+  int lastElevation = std::min<int> (codebook.GetNumElevations () - 1, elevation + COARSE_ELEVATION_STEP - 1);
+
+  std::vector<uint16_t> beams;
+  for (int e = firstElevation; e <= lastElevation; e++)
+    {
+      for (int s = firstSector; s <= lastSector; s++)
+        {
+          beams.push_back (codebook.GetBeamIndex (e, s));
+        }
+    }
+  return beams;
+}
+
+MmWaveBeamSearch::Result
+MmWaveBeamSearch::Hierarchical (const MmWaveChannelTensor &channel,
+                                const MmWaveBeamCodebook &txCodebook, const MmWaveBeamCodebook &rxCodebook)
+{
+  Result coarse = {0, 0, 0};
+  std::vector<uint16_t> txBeams = GetCoarseBeams (txCodebook);
+  std::vector<uint16_t> rxBeams = GetCoarseBeams (rxCodebook);
+  Evaluate (channel, txCodebook, txBeams, rxCodebook, rxBeams, coarse);
+  NS_LOG_LOGIC ("hierarchical search, first stage: " << txBeams.size () * rxBeams.size () << " pairs, gain " << coarse.m_gain);
+
+  Result best = {coarse.m_txBeam, coarse.m_rxBeam, 0};
+  txBeams = GetNeighborBeams (txCodebook, coarse.m_txBeam);
+  rxBeams = GetNeighborBeams (rxCodebook, coarse.m_rxBeam);
+  Evaluate (channel, txCodebook, txBeams, rxCodebook, rxBeams, best);
+  NS_LOG_LOGIC ("hierarchical search, second stage: " << txBeams.size () * rxBeams.size () << " pairs, gain " << best.m_gain);
+  return best;
+}
+
+} // namespace mmwave
+} // namespace ns3
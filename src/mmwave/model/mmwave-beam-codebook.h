@@ -0,0 +1,178 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef MMWAVE_BEAM_CODEBOOK_H_
+#define MMWAVE_BEAM_CODEBOOK_H_
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/ptr.h>
+#include "antenna-array-model.h"
+#include "mmwave-channel-tensor.h"
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \brief The DFT codebook of a rectangular AntennaArrayModel, i.e., the
+ * beams AntennaArrayModel::SetSector generates for every sector
+ * 0, ..., antennaNum[1] and for the elevations 60, 70, ..., 120 degrees.
+ *
+ * The codewords are computed once for each array geometry (number of
+ * elements and spacing) and shared by all the arrays with that geometry.
+ * They are stored beam-major, with the real and imaginary parts in two
+ * separate arrays, as the planes of a MmWaveChannelTensor.
+ */
+class MmWaveBeamCodebook : public SimpleRefCount<MmWaveBeamCodebook>
+{
+public:
+  /**
+   * @param the antenna array
+   * @param the number of antenna elements in the two dimensions of the array
+   * @returns the codebook for the geometry of the array, shared by the arrays
+   * of the same geometry until Simulator::Destroy
+   */
+  static Ptr<const MmWaveBeamCodebook> Get (Ptr<AntennaArrayModel> antenna, uint16_t *antennaNum);
+
+  /**
+   * @returns the number of antenna elements
+   */
+  uint16_t GetSize () const
+  {
+    return m_size;
+  }
+  uint16_t GetNumSectors () const
+  {
+    return m_numSectors;
+  }
+  uint16_t GetNumElevations () const
+  {
+    return m_numElevations;
+  }
+  uint16_t GetNumBeams () const
+  {
+    return m_numSectors * m_numElevations;
+  }
+
+  /**
+   * @param the index of the elevation, from 0 to GetNumElevations () - 1
+   * @param the sector, from 0 to GetNumSectors () - 1
+   * @returns the index of the beam
+   */
+  uint16_t GetBeamIndex (uint16_t elevationIndex, uint16_t sector) const
+  {
+    return elevationIndex * m_numSectors + sector;
+  }
+  uint16_t GetElevationIndex (uint16_t beam) const
+  {
+    return beam / m_numSectors;
+  }
+  uint16_t GetSector (uint16_t beam) const
+  {
+    return beam % m_numSectors;
+  }
+  /**
+   * @param the index of the beam
+   * @returns the elevation of the beam, in degrees
+   */
+  double GetElevation (uint16_t beam) const;
+
+  const double* GetRealBeam (uint16_t beam) const
+  {
+    return m_real.data () + beam * m_size;
+  }
+  const double* GetImagBeam (uint16_t beam) const
+  {
+    return m_imag.data () + beam * m_size;
+  }
+  /**
+   * @param the index of the beam
+   * @returns the BF vector of the beam
+   */
+  complexVector_t GetBeam (uint16_t beam) const;
+
+private:
+  MmWaveBeamCodebook (Ptr<AntennaArrayModel> antenna, uint16_t *antennaNum);
+
+  uint16_t m_size;
+  uint16_t m_numSectors;
+  uint16_t m_numElevations;
+  alignedDoubleVector_t m_real;
+  alignedDoubleVector_t m_imag;
+};
+
+/**
+ * \brief Selection of the pair of beams of two MmWaveBeamCodebook that
+ * maximizes the wideband gain of a channel.
+ *
+ * The gain of the pair (w_tx, w_rx) is sum_n |w_rx^H H_n w_tx|^2, i.e., the
+ * average over the band of the BF gain computed by MmWave3gppChannel when the
+ * clusters add up incoherently. For each cluster, the gain of all the
+ * evaluated pairs is obtained with the matrix product W_rx^H H_n W_tx.
+ */
+class MmWaveBeamSearch
+{
+public:
+  /**
+   * The outcome of a search
+   */
+  struct Result
+  {
+    uint16_t m_txBeam;
+    uint16_t m_rxBeam;
+    double m_gain;
+  };
+
+  /**
+   * Evaluate all the pairs of beams
+   * @param the channel
+   * @param the codebook of the transmitter
+   * @param the codebook of the receiver
+   * @returns the best pair
+   */
+  static Result Exhaustive (const MmWaveChannelTensor &channel,
+                            const MmWaveBeamCodebook &txCodebook, const MmWaveBeamCodebook &rxCodebook);
+
+  /**
+   * Two-stage search: first evaluate the pairs of a coarse codebook, made of one sector
+   * every two and of the elevations 60, 90 and 120 degrees, then evaluate all the pairs
+   * in the neighborhood of the best coarse pair
+   * @param the channel
+   * @param the codebook of the transmitter
+   * @param the codebook of the receiver
+   * @returns the best pair
+   */
+  static Result Hierarchical (const MmWaveChannelTensor &channel,
+                              const MmWaveBeamCodebook &txCodebook, const MmWaveBeamCodebook &rxCodebook);
+
+private:
+  /**
+   * Evaluate all the pairs made of a beam in txBeams and a beam in rxBeams,
+   * and update best if one of them has a larger gain
+   */
+  static void Evaluate (const MmWaveChannelTensor &channel,
+                        const MmWaveBeamCodebook &txCodebook, const std::vector<uint16_t> &txBeams,
+                        const MmWaveBeamCodebook &rxCodebook, const std::vector<uint16_t> &rxBeams,
+                        Result &best);
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* MMWAVE_BEAM_CODEBOOK_H_ */
@@ -0,0 +1,308 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "mmwave-beamforming-kernels.h"
+#include <ns3/global-value.h>
+#include <ns3/enum.h>
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+#define MMWAVE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+namespace mmwave {
+
+/*
+ * Scalar kernels, always available
+ */
+
+static std::complex<double>
+ComplexDotScalar (const double *wRe, const double *wIm, const double *hRe, const double *hIm, uint32_t n)
+{
+  double sumRe = 0;
+  double sumIm = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sumRe += wRe[i] * hRe[i] - wIm[i] * hIm[i];
+      sumIm += wRe[i] * hIm[i] + wIm[i] * hRe[i];
+    }
+  return std::complex<double> (sumRe, sumIm);
+}
+
+static void
+SubbandGainScalar (double *coeffRe, double *coeffIm, const double *stepRe, const double *stepIm,
+                   uint32_t numCluster, double *psd, uint32_t numSubband)
+{
+  for (uint32_t k = 0; k < numSubband; k++)
+    {
+      double sumRe = 0;
+      double sumIm = 0;
+      for (uint32_t c = 0; c < numCluster; c++)
+        {
+          sumRe += coeffRe[c];
+          sumIm += coeffIm[c];
+          double re = coeffRe[c] * stepRe[c] - coeffIm[c] * stepIm[c];
+          coeffIm[c] = coeffRe[c] * stepIm[c] + coeffIm[c] * stepRe[c];
+          coeffRe[c] = re;
+        }
+      if (psd[k] != 0.0)
+        {
+          psd[k] *= sumRe * sumRe + sumIm * sumIm;
+        }
+    }
+}
+
+#ifdef MMWAVE_KERNELS_X86
+
+/*
+ * AVX2 + FMA kernels
+ *
+ * The vector kernels end with vzeroupper: the compiler only inserts it when
+ * optimizing, and without it the SSE code of an unoptimized build that runs
+ * afterwards pays an AVX-SSE transition penalty on every instruction
+ */
+
+__attribute__ ((target ("avx2,fma"))) static inline double
+HorizontalSumAvx2 (__m256d v)
+{
+  __m128d lo = _mm256_castpd256_pd128 (v);
+  __m128d hi = _mm256_extractf128_pd (v, 1);
+  lo = _mm_add_pd (lo, hi);
+  return _mm_cvtsd_f64 (_mm_add_sd (lo, _mm_unpackhi_pd (lo, lo)));
+}
+
+__attribute__ ((target ("avx2,fma"))) static std::complex<double>
+ComplexDotAvx2 (const double *wRe, const double *wIm, const double *hRe, const double *hIm, uint32_t n)
+{
+  __m256d accRe = _mm256_setzero_pd ();
+  __m256d accIm = _mm256_setzero_pd ();
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    {
+      __m256d wr = _mm256_loadu_pd (wRe + i);
+      __m256d wi = _mm256_loadu_pd (wIm + i);
+      __m256d hr = _mm256_loadu_pd (hRe + i);
+      __m256d hi = _mm256_loadu_pd (hIm + i);
+      accRe = _mm256_fmadd_pd (wr, hr, accRe);
+      accRe = _mm256_fnmadd_pd (wi, hi, accRe);
+      accIm = _mm256_fmadd_pd (wr, hi, accIm);
+      accIm = _mm256_fmadd_pd (wi, hr, accIm);
+    }
+  double sumRe = HorizontalSumAvx2 (accRe);
+  double sumIm = HorizontalSumAvx2 (accIm);
+  _mm256_zeroupper ();
+  for (; i < n; i++)
+    {
+      sumRe += wRe[i] * hRe[i] - wIm[i] * hIm[i];
+      sumIm += wRe[i] * hIm[i] + wIm[i] * hRe[i];
+    }
+  return std::complex<double> (sumRe, sumIm);
+}
+
+__attribute__ ((target ("avx2,fma"))) static void
+SubbandGainAvx2 (double *coeffRe, double *coeffIm, const double *stepRe, const double *stepIm,
+                 uint32_t numCluster, double *psd, uint32_t numSubband)
+{
+  uint32_t vecCluster = numCluster / 4 * 4;
+  for (uint32_t k = 0; k < numSubband; k++)
+    {
+      __m256d accRe = _mm256_setzero_pd ();
+      __m256d accIm = _mm256_setzero_pd ();
+      uint32_t c = 0;
+      for (; c < vecCluster; c += 4)
+        {
+          __m256d cr = _mm256_loadu_pd (coeffRe + c);
+          __m256d ci = _mm256_loadu_pd (coeffIm + c);
+          __m256d sr = _mm256_loadu_pd (stepRe + c);
+          __m256d si = _mm256_loadu_pd (stepIm + c);
+          accRe = _mm256_add_pd (accRe, cr);
+          accIm = _mm256_add_pd (accIm, ci);
+          _mm256_storeu_pd (coeffRe + c, _mm256_fmsub_pd (cr, sr, _mm256_mul_pd (ci, si)));
+          _mm256_storeu_pd (coeffIm + c, _mm256_fmadd_pd (cr, si, _mm256_mul_pd (ci, sr)));
+        }
+      double sumRe = HorizontalSumAvx2 (accRe);
+      double sumIm = HorizontalSumAvx2 (accIm);
+      for (; c < numCluster; c++)
+        {
+          sumRe += coeffRe[c];
+          sumIm += coeffIm[c];
+          double re = coeffRe[c] * stepRe[c] - coeffIm[c] * stepIm[c];
+          coeffIm[c] = coeffRe[c] * stepIm[c] + coeffIm[c] * stepRe[c];
+          coeffRe[c] = re;
+        }
+      if (psd[k] != 0.0)
+        {
+          psd[k] *= sumRe * sumRe + sumIm * sumIm;
+        }
+    }
+  _mm256_zeroupper ();
+}
+
+/*
+ * AVX-512 kernels
+ */
+
+__attribute__ ((target ("avx512f"))) static std::complex<double>
+ComplexDotAvx512 (const double *wRe, const double *wIm, const double *hRe, const double *hIm, uint32_t n)
+{
+  __m512d accRe = _mm512_setzero_pd ();
+  __m512d accIm = _mm512_setzero_pd ();
+  uint32_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    {
+      __m512d wr = _mm512_loadu_pd (wRe + i);
+      __m512d wi = _mm512_loadu_pd (wIm + i);
+      __m512d hr = _mm512_loadu_pd (hRe + i);
+      __m512d hi = _mm512_loadu_pd (hIm + i);
+      accRe = _mm512_fmadd_pd (wr, hr, accRe);
+      accRe = _mm512_fnmadd_pd (wi, hi, accRe);
+      accIm = _mm512_fmadd_pd (wr, hi, accIm);
+      accIm = _mm512_fmadd_pd (wi, hr, accIm);
+    }
+  if (i < n)
+    {
+      // masked tail, the lanes beyond n are loaded as zero
+      __mmask8 mask = (__mmask8)((1u << (n - i)) - 1);
+      __m512d wr = _mm512_maskz_loadu_pd (mask, wRe + i);
+      __m512d wi = _mm512_maskz_loadu_pd (mask, wIm + i);
+      __m512d hr = _mm512_maskz_loadu_pd (mask, hRe + i);
+      __m512d hi = _mm512_maskz_loadu_pd (mask, hIm + i);
+      accRe = _mm512_fmadd_pd (wr, hr, accRe);
+      accRe = _mm512_fnmadd_pd (wi, hi, accRe);
+      accIm = _mm512_fmadd_pd (wr, hi, accIm);
+      accIm = _mm512_fmadd_pd (wi, hr, accIm);
+    }
+  double sumRe = _mm512_reduce_add_pd (accRe);
+  double sumIm = _mm512_reduce_add_pd (accIm);
+  _mm256_zeroupper ();
+  return std::complex<double> (sumRe, sumIm);
+}
+
+__attribute__ ((target ("avx512f"))) static void
+SubbandGainAvx512 (double *coeffRe, double *coeffIm, const double *stepRe, const double *stepIm,
+                   uint32_t numCluster, double *psd, uint32_t numSubband)
+{
+  for (uint32_t k = 0; k < numSubband; k++)
+    {
+      __m512d accRe = _mm512_setzero_pd ();
+      __m512d accIm = _mm512_setzero_pd ();
+      for (uint32_t c = 0; c < numCluster; c += 8)
+        {
+          uint32_t left = numCluster - c;
+          __mmask8 mask = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+          __m512d cr = _mm512_maskz_loadu_pd (mask, coeffRe + c);
+          __m512d ci = _mm512_maskz_loadu_pd (mask, coeffIm + c);
+          __m512d sr = _mm512_maskz_loadu_pd (mask, stepRe + c);
+          __m512d si = _mm512_maskz_loadu_pd (mask, stepIm + c);
+          accRe = _mm512_add_pd (accRe, cr);
+          accIm = _mm512_add_pd (accIm, ci);
+          _mm512_mask_storeu_pd (coeffRe + c, mask, _mm512_fmsub_pd (cr, sr, _mm512_mul_pd (ci, si)));
+          _mm512_mask_storeu_pd (coeffIm + c, mask, _mm512_fmadd_pd (cr, si, _mm512_mul_pd (ci, sr)));
+        }
+      if (psd[k] != 0.0)
+        {
+          double sumRe = _mm512_reduce_add_pd (accRe);
+          double sumIm = _mm512_reduce_add_pd (accIm);
+          psd[k] *= sumRe * sumRe + sumIm * sumIm;
+        }
+    }
+  _mm256_zeroupper ();
+}
+
+#endif /* MMWAVE_KERNELS_X86 */
+
+// the scalar kernels are the default, and are set with constant
+// initialization, so that they can be used before any static constructor
+MmWaveBeamformingKernels::KernelLevel MmWaveBeamformingKernels::s_level = MmWaveBeamformingKernels::SCALAR;
+MmWaveBeamformingKernels::ComplexDotFunction MmWaveBeamformingKernels::s_complexDot = &ComplexDotScalar;
+MmWaveBeamformingKernels::SubbandGainFunction MmWaveBeamformingKernels::s_subbandGain = &SubbandGainScalar;
+
+static GlobalValue g_mmWaveBeamformingKernels ("MmWaveBeamformingKernels",
+                                                "The beamforming kernels used by MmWave3gppChannel and MmWaveMiErrorModel, "
+                                                "lowered to the best ones supported by the CPU. Only Scalar, the default, "
+                                                "gives the same results on every host",
+                                                EnumValue (MmWaveBeamformingKernels::SCALAR),
+                                                MakeEnumChecker (MmWaveBeamformingKernels::SCALAR, "Scalar",
+                                                                 MmWaveBeamformingKernels::AVX2, "Avx2",
+                                                                 MmWaveBeamformingKernels::AVX512, "Avx512"));
+
+MmWaveBeamformingKernels::KernelLevel
+MmWaveBeamformingKernels::GetSupportedLevel (void)
+{
+#ifdef MMWAVE_KERNELS_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx512f"))
+    {
+      return AVX512;
+    }
+  if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+    {
+      return AVX2;
+    }
+#endif
+  return SCALAR;
+}
+
+void
+MmWaveBeamformingKernels::SetLevel (KernelLevel level)
+{
+  KernelLevel supported = GetSupportedLevel ();
+  if (level > supported)
+    {
+      level = supported;
+    }
+  switch (level)
+    {
+#ifdef MMWAVE_KERNELS_X86
+    case AVX512:
+      s_complexDot = &ComplexDotAvx512;
+      s_subbandGain = &SubbandGainAvx512;
+      break;
+    case AVX2:
+      s_complexDot = &ComplexDotAvx2;
+      s_subbandGain = &SubbandGainAvx2;
+      break;
+#endif
+    default:
+      level = SCALAR;
+      s_complexDot = &ComplexDotScalar;
+      s_subbandGain = &SubbandGainScalar;
+      break;
+    }
+  s_level = level;
+}
+
+MmWaveBeamformingKernels::KernelLevel
+MmWaveBeamformingKernels::GetLevel (void)
+{
+  return s_level;
+}
+
+void
+MmWaveBeamformingKernels::Configure (void)
+{
+  EnumValue level;
+  g_mmWaveBeamformingKernels.GetValue (level);
+  SetLevel (static_cast<KernelLevel> (level.Get ()));
+}
+
+} // namespace mmwave
+} // namespace ns3
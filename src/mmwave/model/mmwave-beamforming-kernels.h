@@ -0,0 +1,129 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef MMWAVE_BEAMFORMING_KERNELS_H_
+#define MMWAVE_BEAMFORMING_KERNELS_H_
+
+#include <complex>
+#include <stdint.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \brief Numerical kernels used by MmWave3gppChannel to apply the beamforming
+ * vectors to the channel matrix (CalLongTerm) and to compute the frequency
+ * selective beamforming gain (CalBeamformingGain).
+ *
+ * Every kernel has a portable scalar implementation, which is used by
+ * default. On x86 CPUs, AVX2 and AVX-512 versions are also compiled, and
+ * can be selected at runtime with SetLevel, or with the
+ * MmWaveBeamformingKernels global value, applied by Configure when a
+ * MmWave3gppChannel is created. A level not supported by the CPU is lowered
+ * to the best supported one.
+ *
+ * The vector kernels sum in a different order, and with fused multiply-adds,
+ * so the results differ from the scalar ones in the last bits, and depend on
+ * the CPU. Only the scalar kernels give the same results on every host.
+ */
+class MmWaveBeamformingKernels
+{
+public:
+  enum KernelLevel
+  {
+    SCALAR = 0,
+    AVX2 = 1,
+    AVX512 = 2
+  };
+
+  /**
+   * @returns the highest kernel level supported by this CPU
+   */
+  static KernelLevel GetSupportedLevel (void);
+
+  /**
+   * Select the kernels to be used. Levels not supported by the CPU are
+   * lowered to the best supported one
+   * @param the requested level
+   */
+  static void SetLevel (KernelLevel level);
+
+  /**
+   * @returns the level of the kernels currently in use
+   */
+  static KernelLevel GetLevel (void);
+
+  /**
+   * Select the kernels of the level given by the MmWaveBeamformingKernels
+   * global value, lowered to the best one supported by the CPU
+   */
+  static void Configure (void);
+
+  /**
+   * Compute the complex dot product sum_i w[i] * h[i], where the real and
+   * imaginary parts of w and h are given as separate arrays
+   * @param real part of w
+   * @param imaginary part of w
+   * @param real part of h
+   * @param imaginary part of h
+   * @param the length of the vectors
+   * @returns the dot product
+   */
+  static std::complex<double> ComplexDot (const double *wRe, const double *wIm,
+                                          const double *hRe, const double *hIm, uint32_t n)
+  {
+    return s_complexDot (wRe, wIm, hRe, hIm, n);
+  }
+
+  /**
+   * For each subband k = 0, ..., numSubband - 1, scale psd[k] by
+   * |sum_n coeff_n * step_n^k|^2, i.e., apply a per-cluster phase rotation
+   * by recurrence instead of computing exp (j 2 pi f tau_n) for every subband.
+   * Subbands with psd[k] == 0 are left untouched.
+   * On return, coeff_n has been multiplied by step_n^numSubband.
+   * @param real part of the per-cluster coefficients
+   * @param imaginary part of the per-cluster coefficients
+   * @param real part of the per-cluster phase step between two subbands
+   * @param imaginary part of the per-cluster phase step between two subbands
+   * @param the number of clusters
+   * @param the PSD values to be scaled
+   * @param the number of subbands
+   */
+  static void SubbandGain (double *coeffRe, double *coeffIm, const double *stepRe, const double *stepIm,
+                           uint32_t numCluster, double *psd, uint32_t numSubband)
+  {
+    s_subbandGain (coeffRe, coeffIm, stepRe, stepIm, numCluster, psd, numSubband);
+  }
+
+private:
+  typedef std::complex<double> (*ComplexDotFunction) (const double*, const double*,
+                                                      const double*, const double*, uint32_t);
+  typedef void (*SubbandGainFunction) (double*, double*, const double*, const double*,
+                                       uint32_t, double*, uint32_t);
+
+  static KernelLevel s_level;
+  static ComplexDotFunction s_complexDot;
+  static SubbandGainFunction s_subbandGain;
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* MMWAVE_BEAMFORMING_KERNELS_H_ */
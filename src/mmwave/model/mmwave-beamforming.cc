@@ -132,6 +132,8 @@ void
 MmWaveBeamforming::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_channelMatrixTable.Clear ();
+  m_deviceRegistry.Clear ();
 }
 
 void
@@ -412,7 +414,6 @@ MmWaveBeamforming::Initial (NetDeviceContainer ueDevices, NetDeviceContainer enb
 void
 MmWaveBeamforming::SetChannelMatrix (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice)
 {
-  key_t key = std::make_pair (ueDevice,enbDevice);
   int randomInstance = m_uniformRV->GetValue (0, g_numInstance - 1);
   NS_LOG_UNCOND ("************* UPDATING CHANNEL MATRIX (instance " << randomInstance << ") *************");
 
@@ -423,12 +424,7 @@ MmWaveBeamforming::SetChannelMatrix (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enb
   bfParams->m_channelMatrix.m_ueSpatialMatrix = g_ueSpatialInstance.at (randomInstance);
   bfParams->m_channelMatrix.m_powerFraction = g_smallScaleFadingInstance.at (randomInstance);
   bfParams->m_beam = GetLongTermFading (bfParams);
-  std::map< key_t, Ptr<BeamformingParams> >::iterator iter = m_channelMatrixMap.find (key);
-  if (iter != m_channelMatrixMap.end ())
-    {
-      m_channelMatrixMap.erase (iter);
-    }
-  m_channelMatrixMap.insert (std::make_pair (key,bfParams));
+  m_channelMatrixTable.Get (m_deviceRegistry.Register (ueDevice), m_deviceRegistry.Register (enbDevice)) = bfParams;
   //update channel matrix periodically
   //Simulator::Schedule (Seconds (m_longTermUpdatePeriod), &MmWaveBeamforming::SetChannelMatrix,this,ueDevice,enbDevice);
 }
@@ -436,10 +432,9 @@ MmWaveBeamforming::SetChannelMatrix (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enb
 void
 MmWaveBeamforming::SetBeamformingVector (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice)
 {
-  key_t key = std::make_pair (ueDevice,enbDevice);
-  std::map< key_t, Ptr<BeamformingParams> >::iterator it = m_channelMatrixMap.find (key);
-  NS_ASSERT_MSG (it != m_channelMatrixMap.end (), "could not find");
-  Ptr<BeamformingParams> bfParams = it->second;
+  Ptr<BeamformingParams> *it = m_channelMatrixTable.Find (m_deviceRegistry.GetIndex (ueDevice), m_deviceRegistry.GetIndex (enbDevice));
+  NS_ASSERT_MSG (it != 0, "could not find");
+  Ptr<BeamformingParams> bfParams = *it;
 
   antennaPair antennaArrays = GetUeEnbAntennaPair (ueDevice, enbDevice);
   Ptr<AntennaArrayModel> enbAntennaArray = antennaArrays.second;
@@ -564,25 +559,23 @@ MmWaveBeamforming::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   Ptr<NetDevice> txDevice = a->GetObject<Node> ()->GetDevice (0);
   Ptr<NetDevice> rxDevice = b->GetObject<Node> ()->GetDevice (0);
   Ptr<SpectrumValue> rxPsd = Copy (txPsd);
-  key_t dlkey = std::make_pair (rxDevice,txDevice);
-  key_t ulkey = std::make_pair (txDevice,rxDevice);
+  uint32_t txIndex = m_deviceRegistry.GetIndex (txDevice);
+  uint32_t rxIndex = m_deviceRegistry.GetIndex (rxDevice);
 
-  std::map< key_t, Ptr<BeamformingParams> >::iterator it;
-  if (m_channelMatrixMap.find (dlkey) != m_channelMatrixMap.end ())
+  Ptr<BeamformingParams> *it;
+  if ((it = m_channelMatrixTable.Find (rxIndex, txIndex)) != 0)
     {
       // this is downlink case
       downlink = true;
       enbDevice = txDevice;
       ueDevice = rxDevice;
-      it = m_channelMatrixMap.find (dlkey);
     }
-  else if (m_channelMatrixMap.find (ulkey) != m_channelMatrixMap.end ())
+  else if ((it = m_channelMatrixTable.Find (txIndex, rxIndex)) != 0)
     {
       // this is uplink case
       downlink = false;
       ueDevice = txDevice;
       enbDevice = rxDevice;
-      it = m_channelMatrixMap.find (ulkey);
     }
   else
     {
@@ -591,7 +584,7 @@ MmWaveBeamforming::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
       return rxPsd;
     }
 
-  Ptr<BeamformingParams> bfParams = it->second;
+  Ptr<BeamformingParams> bfParams = *it;
 
   antennaPair antennaArrays = GetUeEnbAntennaPair (ueDevice, enbDevice);
   Ptr<AntennaArrayModel> enbAntennaArray = antennaArrays.second;
@@ -47,6 +47,7 @@
 #include <ns3/mmwave-phy-mac-common.h>
 #include <ns3/random-variable-stream.h>
 #include <ns3/antenna-array-model.h>
+#include <ns3/mmwave-link-table.h>
 
 
 
@@ -204,7 +205,8 @@ private:
   * \a map to store channel matrix
   * key pair<NetDevice,NetDevice> a pair of pointer to NetDevice present enb and ue for downlink
   */
-  mutable std::map< key_t, Ptr<BeamformingParams> > m_channelMatrixMap;
+  mutable MmWaveDeviceRegistry m_deviceRegistry;
+  mutable MmWaveLinkTable<Ptr<BeamformingParams> > m_channelMatrixTable;
 
   uint32_t m_pathNum;
   uint32_t m_enbAntennaSize;
@@ -95,6 +95,9 @@ void
 MmWaveChannelMatrix::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_channelMatrixTable.Clear ();
+  m_connectedPair.Clear ();
+  m_deviceRegistry.Clear ();
 }
 
 void
@@ -113,14 +116,7 @@ MmWaveChannelMatrix::GetConfigurationParameters (void) const
 void
 MmWaveChannelMatrix::ConnectDevices (Ptr<NetDevice> dev1, Ptr<NetDevice> dev2)
 {
-  key_t key = std::make_pair (dev1,dev2);
-
-  std::map< key_t, int >::iterator iter = m_connectedPair.find (key);
-  if (iter != m_connectedPair.end ())
-    {
-      m_connectedPair.erase (iter);
-    }
-  m_connectedPair.insert (std::make_pair (key,1));
+  m_connectedPair.Get (m_deviceRegistry.Register (dev1), m_deviceRegistry.Register (dev2)) = 1;
 }
 
 void
@@ -240,9 +236,10 @@ MmWaveChannelMatrix::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPs
   Ptr<mmWaveBeamFormingParams> bfParams = Create<mmWaveBeamFormingParams> ();
   Angles txAngles (b->GetPosition (), a->GetPosition ());
   Angles rxAngles (a->GetPosition (), b->GetPosition ());
-  key_t key = std::make_pair (txDevice,rxDevice);
-  std::map< key_t, Ptr<ChannelParams> >::iterator it = m_channelMatrixMap.find (key);
-  if (it == m_channelMatrixMap.end ())
+  uint32_t txIndex = m_deviceRegistry.Register (txDevice);
+  uint32_t rxIndex = m_deviceRegistry.Register (rxDevice);
+  Ptr<ChannelParams> *it = m_channelMatrixTable.Find (txIndex, rxIndex);
+  if (it == 0)
     {
       /*make sure txAngles rxAngles exist, i.e., the position of tx and rx cannot be the same*/
 
@@ -372,9 +369,8 @@ MmWaveChannelMatrix::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPs
       channel->m_doppler = dopplerShift;
 
 
-      m_channelMatrixMap.insert (std::make_pair (key,channel));
+      m_channelMatrixTable.Get (txIndex, rxIndex) = channel;
 
-      key_t reverseKey = std::make_pair (rxDevice,txDevice);
       Ptr<ChannelParams> reverseChannel = Create<ChannelParams> ();
       reverseChannel->m_txSpatialMatrix = rxSpatialMatrix;
       reverseChannel->m_rxSpatialMatrix = txSpatialMatrix;
@@ -382,13 +378,13 @@ MmWaveChannelMatrix::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPs
       reverseChannel->m_delaySpread = subpathDelay;
       reverseChannel->m_doppler = dopplerShift;
 
-      m_channelMatrixMap.insert (std::make_pair (reverseKey,reverseChannel));
+      m_channelMatrixTable.Get (rxIndex, txIndex) = reverseChannel;
 
       bfParams->m_channelParams = channel;
     }
   else
     {
-      bfParams->m_channelParams = (*it).second;
+      bfParams->m_channelParams = *it;
     }
   //	calculate antenna weights, better method should be implemented
   bfParams->m_txW = txAntennaArray->GetBeamformingVectorPanel ();
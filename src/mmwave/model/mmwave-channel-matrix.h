@@ -42,6 +42,7 @@
 #include <ns3/net-device-container.h>
 #include <ns3/random-variable-stream.h>
 #include "mmwave-phy-mac-common.h"
+#include "mmwave-link-table.h"
 
 
 
@@ -107,8 +108,9 @@ private:
   Ptr<SpectrumValue> GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmWaveBeamFormingParams> bfParams, double speed) const;
   double GetSystemBandwidth () const;
 
-  mutable std::map< key_t, int > m_connectedPair;
-  mutable std::map< key_t, Ptr<ChannelParams> > m_channelMatrixMap;
+  mutable MmWaveDeviceRegistry m_deviceRegistry;
+  mutable MmWaveLinkTable<int> m_connectedPair;
+  mutable MmWaveLinkTable<Ptr<ChannelParams> > m_channelMatrixTable;
   double m_antennaSeparation;       //the ratio of the distance between 2 antennas over wave length
   double m_subBW;
   uint32_t m_numRB;
@@ -100,6 +100,9 @@ void
 MmWaveChannelRaytracing::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_channelMatrixTable.Clear ();
+  m_connectedPair.Clear ();
+  m_deviceRegistry.Clear ();
 }
 
 void
@@ -193,14 +196,7 @@ MmWaveChannelRaytracing::LoadTraces ()
 void
 MmWaveChannelRaytracing::ConnectDevices (Ptr<NetDevice> dev1, Ptr<NetDevice> dev2)
 {
-  key_t key = std::make_pair (dev1,dev2);
-
-  std::map< key_t, int >::iterator iter = m_connectedPair.find (key);
-  if (iter != m_connectedPair.end ())
-    {
-      m_connectedPair.erase (iter);
-    }
-  m_connectedPair.insert (std::make_pair (key,1));
+  m_connectedPair.Get (m_deviceRegistry.Register (dev1), m_deviceRegistry.Register (dev2)) = 1;
 }
 
 void
@@ -353,7 +349,8 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
     }
 
   Ptr<mmWaveBeamFormingTraces> bfParams = Create<mmWaveBeamFormingTraces> ();
-  key_t key = std::make_pair (txDevice,rxDevice);
+  uint32_t txIndex = m_deviceRegistry.Register (txDevice);
+  uint32_t rxIndex = m_deviceRegistry.Register (rxDevice);
 
   double time = Simulator::Now ().GetSeconds ();
   uint16_t traceIndex = (m_startDistance + time * m_speed) * 100;
@@ -365,11 +362,11 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
   if (traceIndex != currentIndex)
     {
       currentIndex = traceIndex;
-      m_channelMatrixMap.clear ();
+      m_channelMatrixTable.Clear ();
     }
 
-  std::map< key_t, Ptr<TraceParams> >::iterator it = m_channelMatrixMap.find (key);
-  if (it == m_channelMatrixMap.end ())
+  Ptr<TraceParams> *it = m_channelMatrixTable.Find (txIndex, rxIndex);
+  if (it == 0)
     {
 
       complex2DVector_t txSpatialMatrix;
@@ -399,9 +396,8 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
       channel->m_doppler = dopplerShift;
 
 
-      m_channelMatrixMap.insert (std::make_pair (key,channel));
+      m_channelMatrixTable.Get (txIndex, rxIndex) = channel;
 
-      key_t reverseKey = std::make_pair (rxDevice,txDevice);
       Ptr<TraceParams> reverseChannel = Create<TraceParams> ();
       reverseChannel->m_txSpatialMatrix = rxSpatialMatrix;
       reverseChannel->m_rxSpatialMatrix = txSpatialMatrix;
@@ -409,13 +405,13 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
       reverseChannel->m_delaySpread = g_delay.at (traceIndex);
       reverseChannel->m_doppler = dopplerShift;
 
-      m_channelMatrixMap.insert (std::make_pair (reverseKey,reverseChannel));
+      m_channelMatrixTable.Get (rxIndex, txIndex) = reverseChannel;
 
       bfParams->m_channelParams = channel;
     }
   else
     {
-      bfParams->m_channelParams = (*it).second;
+      bfParams->m_channelParams = *it;
     }
 
   //	calculate antenna weights, better method should be implemented
@@ -424,8 +420,7 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
   bfParams->m_rxW = rxAntennaArray->GetBeamformingVectorPanel ();
   NS_LOG_LOGIC ("RX size " << bfParams->m_rxW.size ());
 
-  std::map< key_t, int >::iterator it1 = m_connectedPair.find (key);
-  if (it1 != m_connectedPair.end ())
+  if (m_connectedPair.Find (txIndex, rxIndex) != 0)
     {
       bfParams->m_txW = CalcBeamformingVector (bfParams->m_channelParams->m_txSpatialMatrix, bfParams->m_channelParams->m_powerFraction);
       bfParams->m_rxW = CalcBeamformingVector (bfParams->m_channelParams->m_rxSpatialMatrix, bfParams->m_channelParams->m_powerFraction);
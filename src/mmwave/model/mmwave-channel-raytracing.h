@@ -42,6 +42,7 @@
 #include <ns3/net-device-container.h>
 #include <ns3/random-variable-stream.h>
 #include "mmwave-phy-mac-common.h"
+#include "mmwave-link-table.h"
 
 
 
@@ -109,8 +110,9 @@ private:
   double GetSystemBandwidth () const;
   void SetBeamformingVector (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice);
 
-  mutable std::map< key_t, int > m_connectedPair;
-  mutable std::map< key_t, Ptr<TraceParams> > m_channelMatrixMap;
+  mutable MmWaveDeviceRegistry m_deviceRegistry;
+  mutable MmWaveLinkTable<int> m_connectedPair;
+  mutable MmWaveLinkTable<Ptr<TraceParams> > m_channelMatrixTable;
   double m_antennaSeparation;       //the ratio of the distance between 2 antennas over wave length
   Ptr<UniformRandomVariable> m_uniformRv;
   Ptr<MmWavePhyMacCommon> m_phyMacConfig;
@@ -0,0 +1,151 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "mmwave-channel-tensor.h"
+#include <algorithm>
+
+namespace ns3 {
+
+namespace mmwave {
+
+MmWaveChannelTensor::MmWaveChannelTensor ()
+  : m_rxSize (0),
+    m_txSize (0),
+    m_numCluster (0),
+    m_clusterStride (0)
+{
+}
+
+void
+MmWaveChannelTensor::Resize (uint16_t rxSize, uint16_t txSize, uint8_t numCluster)
+{
+  // pad each cluster plane so that every plane starts on an aligned address
+  const uint32_t elementsPerLine = MMWAVE_TENSOR_ALIGNMENT / sizeof (double);
+  uint32_t planeSize = rxSize * txSize;
+  m_clusterStride = (planeSize + elementsPerLine - 1) / elementsPerLine * elementsPerLine;
+  m_rxSize = rxSize;
+  m_txSize = txSize;
+  m_numCluster = numCluster;
+
+  // assign () keeps the capacity, so that updating a channel of the same
+  // size does not hit the allocator
+  m_real.assign (m_clusterStride * numCluster, 0.0);
+  m_imag.assign (m_clusterStride * numCluster, 0.0);
+}
+
+void
+MmWaveChannelTensor::Clear ()
+{
+  m_numCluster = 0;
+  m_real.clear ();
+  m_imag.clear ();
+}
+
+/*
+ * Size of the tiles in which the spatial correlation matrices are computed,
+ * so that the rows of the channel and the tile of the matrix stay in cache
+ */
+static const uint16_t GRAM_BLOCK = 32;
+
+void
+MmWaveChannelTensor::GetTxCorrelation (std::vector<std::complex<double> > &txQ) const
+{
+  txQ.assign (m_txSize * m_txSize, std::complex<double> (0, 0));
+
+  //The cluster planes are rx-major, so we accumulate the outer product of each row with itself.
+  //txQ is Hermitian, thus only the upper triangle is computed, tile by tile, and then mirrored.
+  for (uint16_t t1Block = 0; t1Block < m_txSize; t1Block += GRAM_BLOCK)
+    {
+      uint16_t t1End = std::min<uint16_t> (t1Block + GRAM_BLOCK, m_txSize);
+      for (uint16_t t2Block = t1Block; t2Block < m_txSize; t2Block += GRAM_BLOCK)
+        {
+          uint16_t t2End = std::min<uint16_t> (t2Block + GRAM_BLOCK, m_txSize);
+          for (uint8_t cIndex = 0; cIndex < m_numCluster; cIndex++)
+            {
+              const double *hRe = GetRealPlane (cIndex);
+              const double *hIm = GetImagPlane (cIndex);
+              for (uint16_t rxIndex = 0; rxIndex < m_rxSize; rxIndex++)
+                {
+                  const double *rowRe = hRe + rxIndex * m_txSize;
+                  const double *rowIm = hIm + rxIndex * m_txSize;
+                  for (uint16_t t1Index = t1Block; t1Index < t1End; t1Index++)
+                    {
+                      double aRe = rowRe[t1Index];
+                      double aIm = -rowIm[t1Index];
+                      std::complex<double> *txQRow = &txQ[t1Index * m_txSize];
+                      for (uint16_t t2Index = std::max (t1Index, t2Block); t2Index < t2End; t2Index++)
+                        {
+                          txQRow[t2Index] += std::complex<double> (aRe * rowRe[t2Index] - aIm * rowIm[t2Index],
+                                                                   aRe * rowIm[t2Index] + aIm * rowRe[t2Index]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+  for (uint16_t t1Index = 0; t1Index < m_txSize; t1Index++)
+    {
+      for (uint16_t t2Index = t1Index + 1; t2Index < m_txSize; t2Index++)
+        {
+          txQ[t2Index * m_txSize + t1Index] = std::conj (txQ[t1Index * m_txSize + t2Index]);
+        }
+    }
+}
+
+void
+MmWaveChannelTensor::GetRxCorrelation (std::vector<std::complex<double> > &rxQ) const
+{
+  rxQ.assign (m_rxSize * m_rxSize, std::complex<double> (0, 0));
+
+  //each entry of rxQ is the inner product of two rows of the cluster plane,
+  //only the upper triangle is computed and then mirrored
+  for (uint8_t cIndex = 0; cIndex < m_numCluster; cIndex++)
+    {
+      const double *hRe = GetRealPlane (cIndex);
+      const double *hIm = GetImagPlane (cIndex);
+      for (uint16_t r1Index = 0; r1Index < m_rxSize; r1Index++)
+        {
+          const double *row1Re = hRe + r1Index * m_txSize;
+          const double *row1Im = hIm + r1Index * m_txSize;
+          for (uint16_t r2Index = r1Index; r2Index < m_rxSize; r2Index++)
+            {
+              const double *row2Re = hRe + r2Index * m_txSize;
+              const double *row2Im = hIm + r2Index * m_txSize;
+              double sumRe = 0;
+              double sumIm = 0;
+              for (uint16_t txIndex = 0; txIndex < m_txSize; txIndex++)
+                {
+                  sumRe += row1Re[txIndex] * row2Re[txIndex] + row1Im[txIndex] * row2Im[txIndex];
+                  sumIm += row1Im[txIndex] * row2Re[txIndex] - row1Re[txIndex] * row2Im[txIndex];
+                }
+              rxQ[r1Index * m_rxSize + r2Index] += std::complex<double> (sumRe, sumIm);
+            }
+        }
+    }
+  for (uint16_t r1Index = 0; r1Index < m_rxSize; r1Index++)
+    {
+      for (uint16_t r2Index = r1Index + 1; r2Index < m_rxSize; r2Index++)
+        {
+          rxQ[r2Index * m_rxSize + r1Index] = std::conj (rxQ[r1Index * m_rxSize + r2Index]);
+        }
+    }
+}
+
+} // namespace mmwave
+} // namespace ns3
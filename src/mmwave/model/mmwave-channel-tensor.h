@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef MMWAVE_CHANNEL_TENSOR_H_
+#define MMWAVE_CHANNEL_TENSOR_H_
+
+#include <complex>
+#include <vector>
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+#define MMWAVE_TENSOR_ALIGNMENT 64
+
+/**
+ * Minimal allocator that returns storage aligned to MMWAVE_TENSOR_ALIGNMENT
+ * bytes, so that each plane of a MmWaveChannelTensor can be loaded with
+ * aligned vector instructions.
+ */
+template <typename T>
+struct MmWaveAlignedAllocator
+{
+  typedef T value_type;
+
+  MmWaveAlignedAllocator ()
+  {
+  }
+  template <typename U>
+  MmWaveAlignedAllocator (const MmWaveAlignedAllocator<U> &)
+  {
+  }
+
+  T* allocate (std::size_t n)
+  {
+    void *p = 0;
+    if (posix_memalign (&p, MMWAVE_TENSOR_ALIGNMENT, n * sizeof (T)) != 0)
+      {
+        throw std::bad_alloc ();
+      }
+    return static_cast<T*> (p);
+  }
+  void deallocate (T *p, std::size_t)
+  {
+    free (p);
+  }
+};
+
+template <typename T, typename U>
+bool operator== (const MmWaveAlignedAllocator<T> &, const MmWaveAlignedAllocator<U> &)
+{
+  return true;
+}
+template <typename T, typename U>
+bool operator!= (const MmWaveAlignedAllocator<T> &, const MmWaveAlignedAllocator<U> &)
+{
+  return false;
+}
+
+typedef std::vector<double, MmWaveAlignedAllocator<double> > alignedDoubleVector_t;
+
+/**
+ * \brief Contiguous storage for the channel coefficients H[u][s][n] of a link,
+ * where u is the rx element, s the tx element and n the cluster.
+ *
+ * The coefficients are stored cluster-major: for each cluster n there is a
+ * rx-major (u, s) plane, padded to a multiple of MMWAVE_TENSOR_ALIGNMENT bytes.
+ * Real and imaginary parts are kept in two separate planes, so that the
+ * beamforming kernels can stream over them without shuffling.
+ */
+class MmWaveChannelTensor
+{
+public:
+  MmWaveChannelTensor ();
+
+  /**
+   * Allocate (or reuse) the storage for the given dimensions and set
+   * all the coefficients to zero
+   * @param the number of rx antenna elements
+   * @param the number of tx antenna elements
+   * @param the number of clusters
+   */
+  void Resize (uint16_t rxSize, uint16_t txSize, uint8_t numCluster);
+
+  /**
+   * Drop the channel coefficients, so that the channel is considered
+   * expired. The allocated storage is kept for the next Resize
+   */
+  void Clear ();
+
+  /**
+   * @returns true if no channel coefficients are stored
+   */
+  bool IsEmpty () const
+  {
+    return m_numCluster == 0;
+  }
+
+  uint16_t GetRxSize () const
+  {
+    return m_rxSize;
+  }
+  uint16_t GetTxSize () const
+  {
+    return m_txSize;
+  }
+  uint8_t GetNumCluster () const
+  {
+    return m_numCluster;
+  }
+  /**
+   * @returns the distance, in elements, between the planes of two consecutive clusters
+   */
+  uint32_t GetClusterStride () const
+  {
+    return m_clusterStride;
+  }
+
+  std::complex<double> Get (uint16_t u, uint16_t s, uint8_t n) const
+  {
+    uint32_t i = Index (u, s, n);
+    return std::complex<double> (m_real[i], m_imag[i]);
+  }
+  void Set (uint16_t u, uint16_t s, uint8_t n, std::complex<double> value)
+  {
+    uint32_t i = Index (u, s, n);
+    m_real[i] = value.real ();
+    m_imag[i] = value.imag ();
+  }
+  void Scale (uint16_t u, uint16_t s, uint8_t n, double factor)
+  {
+    uint32_t i = Index (u, s, n);
+    m_real[i] *= factor;
+    m_imag[i] *= factor;
+  }
+
+  /**
+   * @param the cluster index
+   * @returns a pointer to the rx-major real plane of the cluster, i.e., element (u, s) is at u * GetTxSize () + s
+   */
+  const double* GetRealPlane (uint8_t n) const
+  {
+    return m_real.data () + n * m_clusterStride;
+  }
+  const double* GetImagPlane (uint8_t n) const
+  {
+    return m_imag.data () + n * m_clusterStride;
+  }
+
+  /**
+   * Compute the transmitter side spatial correlation matrix, i.e., the sum
+   * of H_n*H_n over the cluster planes H_n
+   * @param the row-major GetTxSize () x GetTxSize () matrix, overwritten
+   */
+  void GetTxCorrelation (std::vector<std::complex<double> > &txQ) const;
+
+  /**
+   * Compute the receiver side spatial correlation matrix, i.e., the sum
+   * of H_nH_n* over the cluster planes H_n
+   * @param the row-major GetRxSize () x GetRxSize () matrix, overwritten
+   */
+  void GetRxCorrelation (std::vector<std::complex<double> > &rxQ) const;
+
+private:
+  uint32_t Index (uint16_t u, uint16_t s, uint8_t n) const
+  {
+    return n * m_clusterStride + u * m_txSize + s;
+  }
+
+  uint16_t m_rxSize;
+  uint16_t m_txSize;
+  uint8_t m_numCluster;
+  uint32_t m_clusterStride;
+  alignedDoubleVector_t m_real;
+  alignedDoubleVector_t m_imag;
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* MMWAVE_CHANNEL_TENSOR_H_ */
@@ -0,0 +1,120 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "mmwave-channel-update-scheduler.h"
+#include <ns3/simulator.h>
+#include <ns3/log.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveChannelUpdateScheduler");
+
+MmWaveChannelUpdateScheduler::MmWaveChannelUpdateScheduler ()
+  : m_numPendingLinks (0),
+    m_granularity (Seconds (0))
+{
+}
+
+MmWaveChannelUpdateScheduler::~MmWaveChannelUpdateScheduler ()
+{
+  Clear ();
+}
+
+void
+MmWaveChannelUpdateScheduler::SetRefreshCallback (RefreshCallback cb)
+{
+  m_refreshCallback = cb;
+}
+
+void
+MmWaveChannelUpdateScheduler::SetGranularity (Time granularity)
+{
+  NS_ASSERT_MSG (!granularity.IsStrictlyNegative (), "the granularity cannot be negative");
+  m_granularity = granularity;
+}
+
+Time
+MmWaveChannelUpdateScheduler::GetGranularity () const
+{
+  return m_granularity;
+}
+
+void
+MmWaveChannelUpdateScheduler::ScheduleRefresh (Time delay, Ptr<const MobilityModel> a, Ptr<const MobilityModel> b)
+{
+  Time time = Simulator::Now () + delay;
+  if (m_granularity.IsStrictlyPositive ())
+    {
+      int64_t step = m_granularity.GetTimeStep ();
+      time = TimeStep (((time.GetTimeStep () + step - 1) / step) * step);
+    }
+
+  std::map<Time, Bucket>::iterator it = m_buckets.find (time);
+  if (it == m_buckets.end ())
+    {
+      NS_LOG_LOGIC ("new bucket at " << time.GetSeconds ());
+      it = m_buckets.insert (std::make_pair (time, Bucket ())).first;
+      it->second.m_event = Simulator::Schedule (time - Simulator::Now (), &MmWaveChannelUpdateScheduler::Refresh, this, time);
+    }
+  Link link;
+  link.m_a = a;
+  link.m_b = b;
+  it->second.m_links.push_back (link);
+  m_numPendingLinks++;
+}
+
+uint32_t
+MmWaveChannelUpdateScheduler::GetNumPendingLinks () const
+{
+  return m_numPendingLinks;
+}
+
+void
+MmWaveChannelUpdateScheduler::Clear ()
+{
+  for (std::map<Time, Bucket>::iterator it = m_buckets.begin (); it != m_buckets.end (); ++it)
+    {
+      it->second.m_event.Cancel ();
+    }
+  m_buckets.clear ();
+  m_numPendingLinks = 0;
+}
+
+void
+MmWaveChannelUpdateScheduler::Refresh (Time time)
+{
+  std::map<Time, Bucket>::iterator it = m_buckets.find (time);
+  NS_ASSERT_MSG (it != m_buckets.end (), "no bucket at " << time.GetSeconds ());
+  // the callback may schedule new updates, thus the bucket is removed first
+  std::vector<Link> links;
+  links.swap (it->second.m_links);
+  m_buckets.erase (it);
+  m_numPendingLinks -= links.size ();
+
+  NS_LOG_LOGIC ("refresh " << links.size () << " links at " << time.GetSeconds ());
+  if (!m_refreshCallback.IsNull ())
+    {
+      m_refreshCallback (links);
+    }
+}
+
+} // namespace mmwave
+} // namespace ns3
@@ -0,0 +1,112 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef MMWAVE_CHANNEL_UPDATE_SCHEDULER_H_
+#define MMWAVE_CHANNEL_UPDATE_SCHEDULER_H_
+
+#include <ns3/ptr.h>
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include <ns3/callback.h>
+#include <ns3/mobility-model.h>
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \brief Schedules the periodic update of the channel realizations of the links.
+ *
+ * Instead of an event per link, the links whose update is due at the same
+ * time are kept in a bucket, and a single event per bucket calls the refresh
+ * callback with all of them. If a granularity is set, the update times are
+ * rounded up to a multiple of it, so that the links whose update is due in
+ * the same interval (e.g., a slot) are refreshed together.
+ */
+class MmWaveChannelUpdateScheduler
+{
+public:
+  /**
+   * A link whose channel has to be updated
+   */
+  struct Link
+  {
+    Ptr<const MobilityModel> m_a;       // the transmitter
+    Ptr<const MobilityModel> m_b;       // the receiver
+  };
+
+  typedef Callback<void, const std::vector<Link> &> RefreshCallback;
+
+  MmWaveChannelUpdateScheduler ();
+  ~MmWaveChannelUpdateScheduler ();
+
+  /**
+   * @param the callback called with the links whose update is due
+   */
+  void SetRefreshCallback (RefreshCallback cb);
+
+  /**
+   * @param the granularity of the update times, 0 to refresh each link exactly when its update is due
+   */
+  void SetGranularity (Time granularity);
+  Time GetGranularity () const;
+
+  /**
+   * Schedule the update of a link
+   * @param the delay after which the update is due
+   * @param the mobility model of the transmitter
+   * @param the mobility model of the receiver
+   */
+  void ScheduleRefresh (Time delay, Ptr<const MobilityModel> a, Ptr<const MobilityModel> b);
+
+  /**
+   * @returns the number of links whose update is scheduled
+   */
+  uint32_t GetNumPendingLinks () const;
+
+  /**
+   * Cancel all the scheduled updates
+   */
+  void Clear ();
+
+private:
+  /**
+   * Call the refresh callback with the links of a bucket
+   * @param the update time of the bucket
+   */
+  void Refresh (Time time);
+
+  struct Bucket
+  {
+    std::vector<Link> m_links;
+    EventId m_event;
+  };
+
+  std::map<Time, Bucket> m_buckets;       // the pending updates, by update time
+  uint32_t m_numPendingLinks;
+  Time m_granularity;
+  RefreshCallback m_refreshCallback;
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* MMWAVE_CHANNEL_UPDATE_SCHEDULER_H_ */
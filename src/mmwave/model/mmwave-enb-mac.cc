@@ -42,6 +42,7 @@
 #include <ns3/lte-mac-sap.h>
 #include <ns3/lte-enb-cmac-sap.h>
 #include <ns3/log.h>
+#include <utility>
 
 namespace ns3 {
 
@@ -212,7 +213,7 @@ class MmWaveMacMemberMacSchedSapUser : public MmWaveMacSchedSapUser
 {
 public:
   MmWaveMacMemberMacSchedSapUser (MmWaveEnbMac* mac);
-  virtual void SchedConfigInd (const struct SchedConfigIndParameters& params);
+  virtual void SchedConfigInd (struct SchedConfigIndParameters&& params);
 private:
   MmWaveEnbMac* m_mac;
 };
@@ -224,7 +225,7 @@ MmWaveMacMemberMacSchedSapUser::MmWaveMacMemberMacSchedSapUser (MmWaveEnbMac* ma
 }
 
 void
-MmWaveMacMemberMacSchedSapUser::SchedConfigInd (const struct SchedConfigIndParameters& params)
+MmWaveMacMemberMacSchedSapUser::SchedConfigInd (struct SchedConfigIndParameters&& params)
 {
   m_mac->DoSchedConfigIndication (params);
 }
@@ -873,11 +874,8 @@ MmWaveEnbMac::DoTransmitPdu (LteMacSapProvider::TransmitPduParameters params)
 }
 
 void
-MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndParameters ind)
+MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndParameters &ind)
 {
-  m_phySapProvider->SetDlSfAllocInfo (ind.m_sfAllocInfo);
-  //m_phySapProvider->SetUlSfAllocInfo (ind.m_ulSfAllocInfo);
-
   for (unsigned islot = 0; islot < ind.m_sfAllocInfo.m_slotAllocInfo.size (); islot++)
     {
       SlotAllocInfo &slotAllocInfo = ind.m_sfAllocInfo.m_slotAllocInfo[islot];
@@ -991,6 +989,10 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
             }
         }
     }
+
+  // the slot list is handed to the PHY only now, as it is not copied
+  m_phySapProvider->SetDlSfAllocInfo (std::move (ind.m_sfAllocInfo));
+  //m_phySapProvider->SetUlSfAllocInfo (ind.m_ulSfAllocInfo);
 }
 
 uint8_t MmWaveEnbMac::AllocateTbUid (void)
@@ -135,7 +135,7 @@ public:
 
   void DoReceiveControlMessage  (Ptr<MmWaveControlMessage> msg);
 
-  void DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndParameters ind);
+  void DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndParameters &ind);
 
   MmWaveEnbPhySapUser* GetPhySapUser ();
   void SetPhySapProvider (MmWavePhySapProvider* ptr);
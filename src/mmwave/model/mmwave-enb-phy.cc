@@ -215,7 +215,6 @@ MmWaveEnbPhy::DoInitialize (void)
       NS_ASSERT_MSG ((double)m_transient / m_updateSinrPeriod >= 16, "Window too small to compute the variance according to the ApplyFilter method");
     }
   Simulator::Schedule (MicroSeconds (0), &MmWaveEnbPhy::UpdateUeSinrEstimate, this);
-  Simulator::Schedule (MicroSeconds (0), &MmWaveEnbPhy::CallPathloss, this);
   MmWavePhy::DoInitialize ();
 }
 void
@@ -596,97 +595,123 @@ MmWaveEnbPhy::GetUlSpectrumPhy () const
   return m_uplinkSpectrumPhy;
 }
 
-void
-MmWaveEnbPhy::CallPathloss ()
+Ptr<SpectrumValue>
+MmWaveEnbPhy::EstimateUeRxPsd (uint64_t imsi, Ptr<NetDevice> ueDevice)
 {
-  /* THIS METHOD IS JUST USED TO LOOK THROUGH THE ALL EXPERIMENTAL SINR ADITYA'S TRACE
-  EVEN WHEN THE SINR COMPUTATION IS NOT REQUIRED (SINCE THE SINR TRACE IS MADE EVERY 125MICROSECONDS) */
-
-  Ptr<SpectrumValue> noisePsd = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
-  Ptr<SpectrumValue> totalReceivedPsd = Create <SpectrumValue> (SpectrumValue (noisePsd->GetSpectrumModel ()));
-
-  for (std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin (); ue != m_ueAttachedImsiMap.end (); ++ue)
+  // distinguish between MC and MmWaveNetDevice
+  Ptr<mmwave::MmWaveUeNetDevice> ueNetDevice = DynamicCast<mmwave::MmWaveUeNetDevice> (ueDevice);
+  Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ueDevice);
+  Ptr<MmWaveUePhy> uePhy;
+  // get tx power
+  double ueTxPower = 0;
+  if (ueNetDevice != 0)
+    {
+      uePhy = ueNetDevice->GetPhy ();
+      ueTxPower = uePhy->GetTxPower ();
+    }
+  else if (mcUeDev != 0)           // it may be a MC device
     {
-      // distinguish between MC and MmWaveNetDevice
-      Ptr<mmwave::MmWaveUeNetDevice> ueNetDevice = DynamicCast<mmwave::MmWaveUeNetDevice> (ue->second);
-      Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
-      Ptr<MmWaveUePhy> uePhy;
-      // get tx power
-      double ueTxPower = 0;
-      if (ueNetDevice != 0)
-        {
-          uePhy = ueNetDevice->GetPhy ();
-          ueTxPower = uePhy->GetTxPower ();
-        }
-      else if (mcUeDev != 0)           // it may be a MC device
-        {
 
-          uePhy = mcUeDev->GetMmWavePhy ();
-          ueTxPower = uePhy->GetTxPower ();
-        }
-      else
+      uePhy = mcUeDev->GetMmWavePhy ();
+      ueTxPower = uePhy->GetTxPower ();
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unrecognized device");
+    }
+  NS_LOG_LOGIC ("UE Tx power = " << ueTxPower);
+  double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
+  double txPowerDensity = 0;
+  txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth ()));
+  NS_LOG_LOGIC ("Linear UE Tx power = " << powerTxW);
+  NS_LOG_LOGIC ("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth ());
+  NS_LOG_LOGIC ("txPowerDensity = " << txPowerDensity);
+  // get this node and remote node mobility
+  Ptr<MobilityModel> enbMob = m_netDevice->GetNode ()->GetObject<MobilityModel> ();
+  NS_LOG_LOGIC ("eNB mobility " << enbMob->GetPosition ());
+  Ptr<MobilityModel> ueMob = ueDevice->GetNode ()->GetObject<MobilityModel> ();
+  NS_LOG_DEBUG ("UE mobility " << ueMob->GetPosition ());
+
+  Ptr<AntennaArrayModel> enbAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
+  Ptr<AntennaArrayModel> ueAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna ());
+  Ptr<MmWave3gppChannel> channel3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
+
+  // adjuts beamforming of antenna model wrt user
+  Ptr<AntennaArrayModel> rxAntennaArray = enbAntennaArray;
+  rxAntennaArray->ChangeBeamformingVectorPanel (ueDevice);                                                                                // TODO check if this is the correct antenna
+  Ptr<AntennaArrayModel> txAntennaArray = ueAntennaArray;          // Dl, since the Ul is not actually used (TDD device)
+  txAntennaArray->ChangeBeamformingVectorPanel (m_netDevice);                                                                               // TODO check if this is the correct antenna
+
+  double pathLossDb = 0;
+  if (txAntennaArray != 0)
+    {
+      Angles txAngles (enbMob->GetPosition (), ueMob->GetPosition ());
+      double txAntennaGain = txAntennaArray->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+      pathLossDb -= txAntennaGain;
+    }
+  if (rxAntennaArray != 0)
+    {
+      Angles rxAngles (ueMob->GetPosition (), enbMob->GetPosition ());
+      double rxAntennaGain = rxAntennaArray->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+      pathLossDb -= rxAntennaGain;
+    }
+  if (m_propagationLoss)
+    {
+      if (m_losTracker != 0)               // if I am using the PL propagation model with Aditya's traces
         {
-          NS_FATAL_ERROR ("Unrecognized device");
+          m_losTracker->UpdateLosNlosState (ueMob,enbMob);                  // update the maps to keep trak of the real PL values, before computing the PL
         }
-      NS_LOG_LOGIC ("UE Tx power = " << ueTxPower);
-      double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
-      double txPowerDensity = 0;
-      txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth ()));
-      NS_LOG_LOGIC ("Linear UE Tx power = " << powerTxW);
-      NS_LOG_LOGIC ("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth ());
-      NS_LOG_LOGIC ("txPowerDensity = " << txPowerDensity);
+      double propagationGainDb = m_propagationLoss->CalcRxPower (0, ueMob, enbMob);
+      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+      pathLossDb -= propagationGainDb;
+    }
+  //NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");
+
+  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+
+  // reuse the previous estimate if nothing it depends on changed: the path
+  // loss and the antenna gains are recomputed every time, and only the BF
+  // gain of the channel is skipped
+  RxPsdEstimate estimate;
+  estimate.m_enbPosition = enbMob->GetPosition ();
+  estimate.m_uePosition = ueMob->GetPosition ();
+  estimate.m_ueTxPower = ueTxPower;
+  estimate.m_pathGain = pathGainLinear;
+  estimate.m_enbBfVersion = enbAntennaArray->GetBeamformingVectorVersion (ueDevice);
+  estimate.m_ueBfVersion = ueAntennaArray->GetBeamformingVectorVersion (m_netDevice);
+  // only the channel generation of MmWave3gppChannel is known, and its Doppler term changes over time if a node moves
+  bool cacheable = channel3gpp != 0 && CalculateDistance (enbMob->GetVelocity (), Vector ()) == 0
+    && CalculateDistance (ueMob->GetVelocity (), Vector ()) == 0;
+  estimate.m_channelGeneration = cacheable ? channel3gpp->GetChannelGeneration (ueMob, enbMob) : 0;
+  std::map<uint64_t, RxPsdEstimate>::iterator cached = m_rxPsdEstimateMap.find (imsi);
+  Ptr<SpectrumValue> rxPsd;
+  if (cached != m_rxPsdEstimateMap.end () && estimate.m_channelGeneration != 0
+      && cached->second.m_channelGeneration == estimate.m_channelGeneration
+      && CalculateDistance (cached->second.m_enbPosition, estimate.m_enbPosition) == 0
+      && CalculateDistance (cached->second.m_uePosition, estimate.m_uePosition) == 0
+      && cached->second.m_ueTxPower == estimate.m_ueTxPower
+      && cached->second.m_pathGain == estimate.m_pathGain
+      && cached->second.m_enbBfVersion == estimate.m_enbBfVersion
+      && cached->second.m_ueBfVersion == estimate.m_ueBfVersion)
+    {
+      NS_LOG_LOGIC ("Reuse the rx PSD estimate of UE " << imsi);
+      rxPsd = cached->second.m_rxPsd;
+    }
+  else
+    {
       // create tx psd
       Ptr<SpectrumValue> txPsd =                                                        // it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
         MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
       NS_LOG_LOGIC ("TxPsd " << *txPsd);
 
-      // get this node and remote node mobility
-      Ptr<MobilityModel> enbMob = m_netDevice->GetNode ()->GetObject<MobilityModel> ();
-      NS_LOG_LOGIC ("eNB mobility " << enbMob->GetPosition ());
-      Ptr<MobilityModel> ueMob = ue->second->GetNode ()->GetObject<MobilityModel> ();
-      NS_LOG_DEBUG ("UE mobility " << ueMob->GetPosition ());
-
       // compute rx psd
-
-      // adjuts beamforming of antenna model wrt user
-      Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
-      rxAntennaArray->ChangeBeamformingVectorPanel (ue->second);                                                                                // TODO check if this is the correct antenna
-      Ptr<AntennaArrayModel> txAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna ());          // Dl, since the Ul is not actually used (TDD device)
-      txAntennaArray->ChangeBeamformingVectorPanel (m_netDevice);                                                                               // TODO check if this is the correct antenna
-
-      double pathLossDb = 0;
-      if (txAntennaArray != 0)
-        {
-          Angles txAngles (enbMob->GetPosition (), ueMob->GetPosition ());
-          double txAntennaGain = txAntennaArray->GetGainDb (txAngles);
-          NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-          pathLossDb -= txAntennaGain;
-        }
-      if (rxAntennaArray != 0)
-        {
-          Angles rxAngles (ueMob->GetPosition (), enbMob->GetPosition ());
-          double rxAntennaGain = rxAntennaArray->GetGainDb (rxAngles);
-          NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-          pathLossDb -= rxAntennaGain;
-        }
-      if (m_propagationLoss)
-        {
-          if (m_losTracker != 0)               // if I am using the PL propagation model with Aditya's traces
-            {
-              m_losTracker->UpdateLosNlosState (ueMob,enbMob);                  // update the maps to keep trak of the real PL values, before computing the PL
-            }
-          double propagationGainDb = m_propagationLoss->CalcRxPower (0, ueMob, enbMob);
-          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-          pathLossDb -= propagationGainDb;
-        }
-      //NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");
-
-      double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-      Ptr<SpectrumValue> rxPsd = txPsd->Copy ();
+      rxPsd = txPsd->Copy ();
       *(rxPsd) *= pathGainLinear;
 
       Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
-      //beamforming->SetBeamformingVector(ue->second, m_netDevice);
+      //beamforming->SetBeamformingVector(ueDevice, m_netDevice);
       Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
       Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
       if (beamforming != 0)
@@ -704,48 +729,45 @@ MmWaveEnbPhy::CallPathloss ()
           rxPsd = rayTracing->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
           NS_LOG_LOGIC ("RxPsd " << *rxPsd);
         }
-      m_rxPsdMap[ue->first] = rxPsd;
-      *totalReceivedPsd += *rxPsd;
-
-      // set back the bf vector to the main eNB
-      if (ueNetDevice != 0)
-        {                                                                                                                       // target not set yet
-          if ((ueNetDevice->GetTargetEnb () != m_netDevice) && (ueNetDevice->GetTargetEnb () != 0))
-            {
-              txAntennaArray->ChangeBeamformingVectorPanel (ueNetDevice->GetTargetEnb ());
-            }
+      else if (channel3gpp != 0)
+        {
+          channel3gpp->SetInterferenceOrDataMode (false);
+          rxPsd = channel3gpp->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
+          NS_LOG_LOGIC ("RxPsd " << *rxPsd);
+          channel3gpp->SetInterferenceOrDataMode (true);
         }
-      else if (mcUeDev != 0)           // it may be a MC device
-        {                                                                                                                               // target not set yet
-          if ((mcUeDev->GetMmWaveTargetEnb () != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb () != 0))
-            {
-              txAntennaArray->ChangeBeamformingVectorPanel (mcUeDev->GetMmWaveTargetEnb ());
-            }
+    }
+
+  // set back the bf vector to the main eNB
+  if (ueNetDevice != 0)
+    {                                                                                                                       // target not set yet
+      if ((ueNetDevice->GetTargetEnb () != m_netDevice) && (ueNetDevice->GetTargetEnb () != 0))
+        {
+          txAntennaArray->ChangeBeamformingVectorPanel (ueNetDevice->GetTargetEnb ());
         }
-      else
+    }
+  else if (mcUeDev != 0)           // it may be a MC device
+    {                                                                                                                               // target not set yet
+      if ((mcUeDev->GetMmWaveTargetEnb () != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb () != 0))
         {
-          NS_FATAL_ERROR ("Unrecognized device");
+          txAntennaArray->ChangeBeamformingVectorPanel (mcUeDev->GetMmWaveTargetEnb ());
         }
-
     }
-
-  for (std::map<uint64_t, Ptr<SpectrumValue> >::iterator ue = m_rxPsdMap.begin (); ue != m_rxPsdMap.end (); ++ue)
+  else
     {
-      SpectrumValue interference = *totalReceivedPsd - *(ue->second);
-      NS_LOG_LOGIC ("interference " << interference);
-      SpectrumValue sinr = *(ue->second) / (*noisePsd + interference);
-      NS_LOG_LOGIC ("sinr " << sinr);
-      double sinrAvg = Sum (sinr) / (sinr.GetSpectrumModel ()->GetNumBands ());
-      NS_LOG_DEBUG ("Real SINR every 125 microseconds is: " << 10 * std::log10 (sinrAvg));
+      NS_FATAL_ERROR ("Unrecognized device");
     }
 
-  Simulator::Schedule (MicroSeconds (125), &MmWaveEnbPhy::CallPathloss, this);     // since one slot every 125 microseconds
+  // the channel of MmWave3gppChannel may have been created or updated by this estimate
+  if (cacheable)
+    {
+      estimate.m_channelGeneration = channel3gpp->GetChannelGeneration (ueMob, enbMob);
+    }
+  estimate.m_rxPsd = rxPsd;
+  m_rxPsdEstimateMap[imsi] = estimate;
+  return rxPsd;
 }
 
-
-
-
-
 void
 MmWaveEnbPhy::UpdateUeSinrEstimate ()
 {
@@ -759,140 +781,20 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
 
   for (std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin (); ue != m_ueAttachedImsiMap.end (); ++ue)
     {
-      // distinguish between MC and MmWaveNetDevice
-      Ptr<mmwave::MmWaveUeNetDevice> ueNetDevice = DynamicCast<mmwave::MmWaveUeNetDevice> (ue->second);
-      Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
-      Ptr<MmWaveUePhy> uePhy;
-      // get tx power
-      double ueTxPower = 0;
-      if (ueNetDevice != 0)
-        {
-          uePhy = ueNetDevice->GetPhy ();
-          ueTxPower = uePhy->GetTxPower ();
-        }
-      else if (mcUeDev != 0)           // it may be a MC device
-        {
-
-          uePhy = mcUeDev->GetMmWavePhy ();
-          ueTxPower = uePhy->GetTxPower ();
-        }
-      else
-        {
-          NS_FATAL_ERROR ("Unrecognized device");
-        }
-      NS_LOG_LOGIC ("UE Tx power = " << ueTxPower);
-      double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
-      double txPowerDensity = 0;
-      txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth ()));
-      NS_LOG_LOGIC ("Linear UE Tx power = " << powerTxW);
-      NS_LOG_LOGIC ("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth ());
-      NS_LOG_LOGIC ("txPowerDensity = " << txPowerDensity);
-      // create tx psd
-      Ptr<SpectrumValue> txPsd =                                                        // it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
-        MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
-      NS_LOG_LOGIC ("TxPsd " << *txPsd);
-
-      // get this node and remote node mobility
-      Ptr<MobilityModel> enbMob = m_netDevice->GetNode ()->GetObject<MobilityModel> ();
-      NS_LOG_LOGIC ("eNB mobility " << enbMob->GetPosition ());
-      Ptr<MobilityModel> ueMob = ue->second->GetNode ()->GetObject<MobilityModel> ();
-      NS_LOG_DEBUG ("UE mobility " << ueMob->GetPosition ());
-
-      // compute rx psd
-
-      // adjuts beamforming of antenna model wrt user
-      Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
-      rxAntennaArray->ChangeBeamformingVectorPanel (ue->second);                                                                                // TODO check if this is the correct antenna
-      Ptr<AntennaArrayModel> txAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna ());          // Dl, since the Ul is not actually used (TDD device)
-      txAntennaArray->ChangeBeamformingVectorPanel (m_netDevice);                                                                               // TODO check if this is the correct antenna
-
-      double pathLossDb = 0;
-      if (txAntennaArray != 0)
-        {
-          Angles txAngles (enbMob->GetPosition (), ueMob->GetPosition ());
-          double txAntennaGain = txAntennaArray->GetGainDb (txAngles);
-          NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-          pathLossDb -= txAntennaGain;
-        }
-      if (rxAntennaArray != 0)
-        {
-          Angles rxAngles (ueMob->GetPosition (), enbMob->GetPosition ());
-          double rxAntennaGain = rxAntennaArray->GetGainDb (rxAngles);
-          NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-          pathLossDb -= rxAntennaGain;
-        }
-      if (m_propagationLoss)
-        {
-          if (m_losTracker != 0)               // if I am using the PL propagation model with Aditya's traces
-            {
-              m_losTracker->UpdateLosNlosState (ueMob,enbMob);                  // update the maps to keep trak of the real PL values, before computing the PL
-            }
-          double propagationGainDb = m_propagationLoss->CalcRxPower (0, ueMob, enbMob);
-          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-          pathLossDb -= propagationGainDb;
-        }
-      //NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");
-
-      double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-      Ptr<SpectrumValue> rxPsd = txPsd->Copy ();
-      *(rxPsd) *= pathGainLinear;
-
-      Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
-      //beamforming->SetBeamformingVector(ue->second, m_netDevice);
-      Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
-      Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
-      Ptr<MmWave3gppChannel> mmWave3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
-      if (beamforming != 0)
-        {
-          rxPsd = beamforming->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
-          NS_LOG_LOGIC ("RxPsd " << *rxPsd);
-        }
-      else if (channelMatrix != 0)
-        {
-          rxPsd = channelMatrix->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
-          NS_LOG_LOGIC ("RxPsd " << *rxPsd);
-        }
-      else if (rayTracing != 0)
-        {
-          rxPsd = rayTracing->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
-          NS_LOG_LOGIC ("RxPsd " << *rxPsd);
-        }
-      else if (mmWave3gpp != 0)
-        {
-          mmWave3gpp->SetInterferenceOrDataMode (false);
-          rxPsd = mmWave3gpp->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
-          NS_LOG_LOGIC ("RxPsd " << *rxPsd);
-          mmWave3gpp->SetInterferenceOrDataMode (true);
-        }
+      Ptr<SpectrumValue> rxPsd = EstimateUeRxPsd (ue->first, ue->second);
       m_rxPsdMap[ue->first] = rxPsd;
       *totalReceivedPsd += *rxPsd;
-
-      // set back the bf vector to the main eNB
-      if (ueNetDevice != 0)
-        {                                                                                                                       // target not set yet
-          if ((ueNetDevice->GetTargetEnb () != m_netDevice) && (ueNetDevice->GetTargetEnb () != 0))
-            {
-              txAntennaArray->ChangeBeamformingVectorPanel (ueNetDevice->GetTargetEnb ());
-            }
-        }
-      else if (mcUeDev != 0)           // it may be a MC device
-        {                                                                                                                               // target not set yet
-          if ((mcUeDev->GetMmWaveTargetEnb () != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb () != 0))
-            {
-              txAntennaArray->ChangeBeamformingVectorPanel (mcUeDev->GetMmWaveTargetEnb ());
-            }
-        }
-      else
-        {
-          NS_FATAL_ERROR ("Unrecognized device");
-        }
-
     }
 
   for (std::map<uint64_t, Ptr<SpectrumValue> >::iterator ue = m_rxPsdMap.begin (); ue != m_rxPsdMap.end (); ++ue)
     {
       SpectrumValue interference = *totalReceivedPsd - *(ue->second);
       NS_LOG_LOGIC ("interference " << interference);
+      if (g_log.IsEnabled (ns3::LOG_DEBUG))
+        {
+          SpectrumValue realSinr = *(ue->second) / (*noisePsd + interference);
+          NS_LOG_DEBUG ("Real SINR is: " << 10 * std::log10 (Sum (realSinr) / (realSinr.GetSpectrumModel ()->GetNumBands ())));
+        }
       SpectrumValue sinr = *(ue->second) / (*noisePsd);           // + interference);
       // we consider the SNR only!
       NS_LOG_LOGIC ("sinr " << sinr);
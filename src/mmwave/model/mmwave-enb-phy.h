@@ -43,6 +43,7 @@
 #include <ns3/lte-enb-phy-sap.h>
 #include <ns3/lte-enb-cphy-sap.h>
 #include <ns3/mmwave-harq-phy.h>
+#include <ns3/vector.h>
 
 namespace ns3 {
 
@@ -124,7 +125,15 @@ public:
 
   void UpdateUeSinrEstimate ();
 
-  void CallPathloss ();
+  /**
+   * Estimate the PSD received by this eNB from a UE, with the beams of the two
+   * devices pointing at each other. The estimate is reused if the positions,
+   * the beams, the tx power and the channel realization did not change
+   * @param the IMSI of the UE
+   * @param the device of the UE
+   * @returns the rx PSD
+   */
+  Ptr<SpectrumValue> EstimateUeRxPsd (uint64_t imsi, Ptr<NetDevice> ueDevice);
 
   double AddGaussianNoise (double sample);
 
@@ -180,6 +189,22 @@ private:
   std::map <uint64_t, Ptr<NetDevice> > m_ueAttachedImsiMap;
   std::map <uint64_t, double > m_sinrMap;
   std::map <uint64_t, Ptr<SpectrumValue> > m_rxPsdMap;
+
+  /**
+   * An estimate computed by EstimateUeRxPsd, and what it depends on
+   */
+  struct RxPsdEstimate
+  {
+    Ptr<SpectrumValue> m_rxPsd;
+    Vector m_enbPosition;
+    Vector m_uePosition;
+    double m_ueTxPower;
+    double m_pathGain;       // linear gain of the path loss and of the antenna elements, recomputed at every estimate
+    uint64_t m_enbBfVersion;       // version of the BF vector of the eNB towards the UE
+    uint64_t m_ueBfVersion;       // version of the BF vector of the UE towards the eNB
+    uint64_t m_channelGeneration;       // see MmWave3gppChannel::GetChannelGeneration, 0 if the estimate cannot be reused
+  };
+  std::map <uint64_t, RxPsdEstimate> m_rxPsdEstimateMap;       // the estimates, by IMSI of the UE
   std::map <pairDevices_t, std::vector<double> > m_sinrVector;        // array containing all SINR values for a specific pair (UE-eNB)
   std::map <pairDevices_t, std::vector<double> > m_sinrVectorToFilter;        // array containing the  SINR values that must be filtered
   std::map <pairDevices_t, std::vector<double> > m_sinrVectorNoisy;        // array containing the  noisy SINR values that must be filteredF
@@ -0,0 +1,1448 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include "mmwave-flex-tti-ranked-mac-scheduler.h"
+#include "mmwave-flex-tti-maxrate-mac-scheduler.h"
+#include "mmwave-flex-tti-pf-mac-scheduler.h"
+#include "mmwave-flex-tti-maxweight-mac-scheduler.h"
+#include "mmwave-flex-tti-mac-scheduler.h"
+#include <ns3/lte-common.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include "mmwave-spectrum-value-helper.h"
+#include <cmath>
+#include <algorithm>
+#include <ns3/eps-bearer.h>
+#include <utility>
+
+namespace ns3 {
+
+namespace mmwave {
+
+MmWaveFlexTtiUeSchedInfo::MmWaveFlexTtiUeSchedInfo (uint16_t rnti, uint8_t numHarqProcess)
+  : m_rnti (rnti),
+    m_allocated (false),
+    m_dlInRange (false),
+    m_ulInRange (false),
+    m_dlMcs (0),
+    m_ulMcs (0),
+    m_dlSymbols (0),
+    m_ulSymbols (0),
+    m_dlSymbolsRetx (0),
+    m_ulSymbolsRetx (0),
+    m_dlTbSize (0),
+    m_ulTbSize (0),
+    m_dlAllocDone (false),
+    m_ulAllocDone (false),
+    m_avgTputDl (0.0),
+    m_avgTputUl (0.0),
+    m_lastAvgTputDl (0.0),
+    m_lastAvgTputUl (0.0),
+    m_currTputDl (0.0),
+    m_currTputUl (0.0),
+    m_totBufDl (0),
+    m_totBufUl (0),
+    m_allocUlLast (false),
+    m_pfHeapIndex (-1),
+    m_ulBsrSize (0),
+    m_dlCqiRxed (false),
+    m_dlCqi (0),
+    m_dlCqiTimer (0),
+    m_ulCqiRxed (false),
+    m_ulCqiNumSym (0),
+    m_ulCqiTbSize (0),
+    m_ulCqiTimer (0),
+    m_dlHarqStatus (numHarqProcess, 0),
+    m_dlHarqTimer (numHarqProcess, 0),
+    m_dlHarqDci (numHarqProcess),
+    m_dlHarqRlcPdu (numHarqProcess),
+    m_ulHarqStatus (numHarqProcess, 0),
+    m_ulHarqTimer (numHarqProcess, 0),
+    m_ulHarqDci (numHarqProcess)
+{
+  for (unsigned i = 0; i <= 3; i++)
+    {
+      m_flowStatsDl.push_back (MmWaveFlexTtiFlowStats (false, this, i));
+      m_flowStatsUl.push_back (MmWaveFlexTtiFlowStats (true, this, i));
+    }
+}
+
+void
+MmWaveFlexTtiUeSchedInfo::SplitDlBytes (uint32_t tbSize)
+{
+  // distribute bytes between active RLC queues
+  unsigned numLc = m_rlcPduInfo.size ();
+  unsigned bytesRem = tbSize;
+  unsigned numFulfilled = 0;
+  uint16_t avgPduSize = bytesRem / numLc;
+  // first for loop computes extra to add to average if some flows are less than average
+  for (unsigned i = 0; i < numLc; i++)
+    {
+      if (m_rlcPduInfo[i].m_size < avgPduSize)
+        {
+          bytesRem -= m_rlcPduInfo[i].m_size;
+          numFulfilled++;
+        }
+    }
+
+  if (numFulfilled < numLc)
+    {
+      avgPduSize = bytesRem / (numLc - numFulfilled);
+    }
+
+  for (unsigned i = 0; i < numLc; i++)
+    {
+      if (m_rlcPduInfo[i].m_size > avgPduSize)
+        {
+          m_rlcPduInfo[i].m_size = avgPduSize;
+        }
+      // else tbSize equals RLC queue size
+      NS_ASSERT (m_rlcPduInfo[i].m_size > 0);
+    }
+}
+
+MmWaveFlexTtiUeTable::~MmWaveFlexTtiUeTable ()
+{
+  Clear ();
+}
+
+MmWaveFlexTtiUeSchedInfo*
+MmWaveFlexTtiUeTable::Add (uint16_t rnti, uint8_t numHarqProcess)
+{
+  MmWaveFlexTtiUeSchedInfo *ue = Find (rnti);
+  if (ue != 0)
+    {
+      return ue;
+    }
+  if (rnti >= m_table.size ())
+    {
+      m_table.resize (rnti + 1, 0);
+    }
+  ue = new MmWaveFlexTtiUeSchedInfo (rnti, numHarqProcess);
+  m_table[rnti] = ue;
+  std::vector<MmWaveFlexTtiUeSchedInfo*>::iterator it = m_ues.begin ();
+  while (it != m_ues.end () && (*it)->m_rnti < rnti)
+    {
+      it++;
+    }
+  m_ues.insert (it, ue);
+  return ue;
+}
+
+void
+MmWaveFlexTtiUeTable::Remove (uint16_t rnti)
+{
+  MmWaveFlexTtiUeSchedInfo *ue = Find (rnti);
+  if (ue == 0)
+    {
+      return;
+    }
+  m_ues.erase (std::find (m_ues.begin (), m_ues.end (), ue));
+  m_table[rnti] = 0;
+  delete ue;
+}
+
+void
+MmWaveFlexTtiUeTable::Clear ()
+{
+  for (unsigned i = 0; i < m_ues.size (); i++)
+    {
+      delete m_ues[i];
+    }
+  m_ues.clear ();
+  m_table.clear ();
+}
+
+MmWaveFlexTtiRatePolicy::MmWaveFlexTtiRatePolicy ()
+  : m_timeWindow (99.0)
+{
+}
+
+void
+MmWaveFlexTtiRatePolicy::ComputeRates (const MmWaveFlexTtiSchedContext &ctx,
+                                       const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues) const
+{
+  for (unsigned i = 0; i < ues.size (); i++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ueInfo = ues[i];
+
+      // compute total DL and UL bytes buffered, and the rate per symbol
+      if (ueInfo->m_dlInRange)
+        {
+          for (unsigned iflow = 0; iflow < ueInfo->m_flowStatsDl.size (); iflow++)
+            {
+              if (ueInfo->m_flowStatsDl[iflow].m_totalBufSize > 0)
+                {
+                  ueInfo->m_totBufDl += ueInfo->m_flowStatsDl[iflow].m_totalBufSize;
+                  RlcPduInfo newRlcEl;
+                  newRlcEl.m_lcid = ueInfo->m_flowStatsDl[iflow].m_lcid;
+                  newRlcEl.m_size = ueInfo->m_flowStatsDl[iflow].m_totalBufSize;
+                  ueInfo->m_rlcPduInfo.push_back (newRlcEl);
+                }
+            }
+          if (ueInfo->m_totBufDl > 0)
+            {
+              uint32_t tbSizeMax = ctx.m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs, 1);
+              ueInfo->m_currTputDl = std::min (ueInfo->m_totBufDl,tbSizeMax) / (ctx.m_phyMacConfig->GetSubframePeriod () * 1E-6);
+              ueInfo->m_allocated = true;
+            }
+        }
+
+      if (ueInfo->m_ulInRange)
+        {
+          for (unsigned iflow = 0; iflow < ueInfo->m_flowStatsUl.size (); iflow++)
+            {
+              ueInfo->m_totBufUl += ueInfo->m_flowStatsUl[iflow].m_totalBufSize;
+            }
+          if (ueInfo->m_totBufUl > 0)
+            {
+              uint32_t tbSizeMax = ctx.m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_ulMcs, 1);
+              ueInfo->m_currTputUl = std::min (ueInfo->m_totBufUl,tbSizeMax) / (ctx.m_phyMacConfig->GetSubframePeriod () * 1E-6);
+              ueInfo->m_allocated = true;
+            }
+        }
+    }
+}
+
+bool
+MmWaveFlexTtiRatePolicy::AllocateSymbol (const MmWaveFlexTtiSchedContext &ctx, MmWaveFlexTtiUeSchedInfo *ueInfo, int &symAvail) const
+{
+  double sfPeriod = ctx.m_phyMacConfig->GetSubframePeriod () * 1E-6;
+
+  if (ueInfo->m_totBufDl == 0)
+    {
+      ueInfo->m_dlAllocDone = true;
+    }
+  if (ueInfo->m_totBufUl == 0)
+    {
+      ueInfo->m_ulAllocDone = true;
+    }
+
+  // evenly distribute symbols between DL and UL flows of same UE
+  if ((ueInfo->m_allocUlLast || ueInfo->m_dlAllocDone) && !ueInfo->m_ulAllocDone)
+    {
+      ueInfo->m_ulSymbols++;
+      symAvail--;
+      ueInfo->m_ulTbSize = ctx.m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_ulMcs, ueInfo->m_ulSymbols) / 8;
+      if (ueInfo->m_ulTbSize >= ueInfo->m_totBufUl)
+        {
+          ueInfo->m_ulAllocDone = true;
+          ueInfo->m_lastAvgTputUl = ueInfo->m_avgTputUl;
+        }
+      ueInfo->m_allocUlLast = true;
+
+      uint32_t tbSize = ctx.m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_ulMcs, ueInfo->m_ulSymbols);
+      ueInfo->m_currTputUl = std::min (ueInfo->m_totBufUl,tbSize) / sfPeriod;
+      ueInfo->m_avgTputUl = ((1.0 - (1.0 / m_timeWindow)) * ueInfo->m_lastAvgTputUl) +
+        ((1.0 / m_timeWindow) * ((double)ueInfo->m_ulTbSize / sfPeriod));
+      return true;
+    }
+  else if (!ueInfo->m_dlAllocDone)
+    {
+      ueInfo->m_dlSymbols++;
+      symAvail--;
+      ueInfo->m_dlTbSize = ctx.m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs, ueInfo->m_dlSymbols) / 8;
+      if (ueInfo->m_dlTbSize >= ueInfo->m_totBufDl)
+        {
+          ueInfo->m_dlAllocDone = true;
+          ueInfo->m_lastAvgTputDl = ueInfo->m_avgTputDl;
+        }
+      ueInfo->m_allocUlLast = false;
+
+      uint32_t tbSize = ctx.m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs, ueInfo->m_dlSymbols);
+      ueInfo->m_currTputDl = std::min (ueInfo->m_totBufDl,tbSize) / sfPeriod;
+      ueInfo->m_avgTputDl = ((1.0 - (1.0 / m_timeWindow)) * ueInfo->m_lastAvgTputDl) +
+        ((1.0 / m_timeWindow) * ((double)ueInfo->m_dlTbSize / sfPeriod));
+      return true;
+    }
+  return false;
+}
+
+void
+MmWaveFlexTtiRatePolicy::DistributeDlBytes (MmWaveFlexTtiUeSchedInfo *ueInfo, uint32_t tbSize) const
+{
+  ueInfo->SplitDlBytes (tbSize);
+
+  // each LC is listed twice, i.e., it gets two transmit opportunities
+  // from the MAC: the rate policies have always worked this way
+  unsigned numLc = ueInfo->m_rlcPduInfo.size ();
+  ueInfo->m_rlcPduInfo.reserve (2 * numLc);
+  for (unsigned i = 0; i < numLc; i++)
+    {
+      ueInfo->m_rlcPduInfo.push_back (ueInfo->m_rlcPduInfo[i]);
+    }
+}
+
+template <class Policy>
+class MmWaveFlexTtiRankedMacCschedSapProvider : public MmWaveMacCschedSapProvider
+{
+public:
+  MmWaveFlexTtiRankedMacCschedSapProvider (MmWaveFlexTtiRankedMacScheduler<Policy>* scheduler)
+    : m_scheduler (scheduler)
+  {
+  }
+
+  // inherited from MmWaveMacCschedSapProvider
+  virtual void CschedCellConfigReq (const struct MmWaveMacCschedSapProvider::CschedCellConfigReqParameters& params)
+  {
+    m_scheduler->DoCschedCellConfigReq (params);
+  }
+  virtual void CschedUeConfigReq (const struct MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params)
+  {
+    m_scheduler->DoCschedUeConfigReq (params);
+  }
+  virtual void CschedLcConfigReq (const struct MmWaveMacCschedSapProvider::CschedLcConfigReqParameters& params)
+  {
+    m_scheduler->DoCschedLcConfigReq (params);
+  }
+  virtual void CschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params)
+  {
+    m_scheduler->DoCschedLcReleaseReq (params);
+  }
+  virtual void CschedUeReleaseReq (const struct MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters& params)
+  {
+    m_scheduler->DoCschedUeReleaseReq (params);
+  }
+
+private:
+  MmWaveFlexTtiRankedMacCschedSapProvider ();
+  MmWaveFlexTtiRankedMacScheduler<Policy>* m_scheduler;
+};
+
+template <class Policy>
+class MmWaveFlexTtiRankedMacSchedSapProvider : public MmWaveMacSchedSapProvider
+{
+public:
+  MmWaveFlexTtiRankedMacSchedSapProvider (MmWaveFlexTtiRankedMacScheduler<Policy>* sched)
+    : m_scheduler (sched)
+  {
+  }
+
+  virtual void SchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+  {
+    m_scheduler->DoSchedDlRlcBufferReq (params);
+  }
+  virtual void SchedTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params)
+  {
+    m_scheduler->DoSchedTriggerReq (params);
+  }
+  virtual void SchedDlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters& params)
+  {
+    m_scheduler->DoSchedDlCqiInfoReq (params);
+  }
+  virtual void SchedUlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params)
+  {
+    m_scheduler->DoSchedUlCqiInfoReq (params);
+  }
+  virtual void SchedUlMacCtrlInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params)
+  {
+    m_scheduler->DoSchedUlMacCtrlInfoReq (params);
+  }
+  virtual void SchedSetMcs (int mcs)
+  {
+    m_scheduler->DoSchedSetMcs (mcs);
+  }
+
+private:
+  MmWaveFlexTtiRankedMacSchedSapProvider ();
+  MmWaveFlexTtiRankedMacScheduler<Policy>* m_scheduler;
+};
+
+template <class Policy>
+MmWaveFlexTtiRankedMacScheduler<Policy>::MmWaveFlexTtiRankedMacScheduler ()
+  : g_log (Policy::GetLogComponent ()),
+    m_tbUid (0),
+    m_macSchedSapUser (0),
+    m_macCschedSapUser (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_macSchedSapProvider = new MmWaveFlexTtiRankedMacSchedSapProvider<Policy> (this);
+  m_macCschedSapProvider = new MmWaveFlexTtiRankedMacCschedSapProvider<Policy> (this);
+}
+
+template <class Policy>
+MmWaveFlexTtiRankedMacScheduler<Policy>::~MmWaveFlexTtiRankedMacScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues = m_ueTable.GetUes ();
+  for (unsigned i = 0; i < ues.size (); i++)
+    {
+      Policy::RemoveUe (ues[i]);
+    }
+  m_ueTable.Clear ();
+  m_allocatedUes.clear ();
+  m_dlHarqInfoList.clear ();
+  m_ulHarqInfoList.clear ();
+  m_ulAllocationMap.clear ();
+  delete m_macCschedSapProvider;
+  delete m_macSchedSapProvider;
+}
+
+template <class Policy>
+TypeId
+MmWaveFlexTtiRankedMacScheduler<Policy>::GetTypeId (void)
+{
+  static TypeId tid = Policy::AddAttributes (TypeId (Policy::GetTypeName ())
+    .SetParent<MmWaveMacScheduler> ()
+    .AddConstructor<MmWaveFlexTtiRankedMacScheduler<Policy> > ()
+    .AddAttribute ("CqiTimerThreshold",
+                   "The number of TTIs a CQI is valid (default 1000 - 1 sec.)",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&MmWaveFlexTtiRankedMacScheduler::m_cqiTimersThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HarqEnabled",
+                   "Activate/Deactivate the HARQ [by default is active].",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiRankedMacScheduler::m_harqOn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FixedMcsDl",
+                   "Fix MCS to value set in McsDlDefault",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiRankedMacScheduler::m_fixedMcsDl),
+                   MakeBooleanChecker ())
+    .AddAttribute ("McsDefaultDl",
+                   "Fixed DL MCS",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWaveFlexTtiRankedMacScheduler::m_mcsDefaultDl),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("FixedMcsUl",
+                   "Fix MCS to value set in McsUlDefault (for testing)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiRankedMacScheduler::m_fixedMcsUl),
+                   MakeBooleanChecker ())
+    .AddAttribute ("McsDefaultUl",
+                   "Fixed UL MCS (for testing)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWaveFlexTtiRankedMacScheduler::m_mcsDefaultUl),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("DlSchedOnly",
+                   "Only schedule downlink traffic (for testing)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiRankedMacScheduler::m_dlOnly),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UlSchedOnly",
+                   "Only schedule uplink traffic (for testing)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiRankedMacScheduler::m_ulOnly),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FixedTti",
+                   "Fix slot size",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiRankedMacScheduler::m_fixedTti),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SymPerSlot",
+                   "Number of symbols per slot in Fixed TTI mode",
+                   UintegerValue (6),
+                   MakeUintegerAccessor (&MmWaveFlexTtiRankedMacScheduler::m_symPerSlot),
+                   MakeUintegerChecker<uint8_t> ()));
+
+  return tid;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::SetMacSchedSapUser (MmWaveMacSchedSapUser* sap)
+{
+  m_macSchedSapUser = sap;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::SetMacCschedSapUser (MmWaveMacCschedSapUser* sap)
+{
+  m_macCschedSapUser = sap;
+}
+
+template <class Policy>
+MmWaveMacSchedSapProvider*
+MmWaveFlexTtiRankedMacScheduler<Policy>::GetMacSchedSapProvider ()
+{
+  return m_macSchedSapProvider;
+}
+
+template <class Policy>
+MmWaveMacCschedSapProvider*
+MmWaveFlexTtiRankedMacScheduler<Policy>::GetMacCschedSapProvider ()
+{
+  return m_macCschedSapProvider;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> config)
+{
+  m_phyMacConfig = config;
+  m_amc = CreateObject <MmWaveAmc> (m_phyMacConfig);
+  m_numRbg = m_phyMacConfig->GetNumRb () / m_phyMacConfig->GetNumRbPerRbg ();
+  NS_ASSERT_MSG (m_phyMacConfig->GetNumRb () == 1, \
+                 "System must be configured with numRb=1 for TDMA mode");
+  m_ulSinr = Create<SpectrumValue> (MmWaveSpectrumValueHelper::GetSpectrumModel (m_phyMacConfig));
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoSchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+{
+  NS_LOG_FUNCTION (this << params.m_rnti << (uint32_t) params.m_logicalChannelIdentity);
+  MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (params.m_rnti);
+  if (ue == 0)
+    {
+      NS_LOG_ERROR ("UE entry not found in sched info map");
+      return;
+    }
+  uint8_t lcid = params.m_logicalChannelIdentity;
+  if ((unsigned)lcid >= ue->m_flowStatsDl.size ())
+    {
+      NS_LOG_ERROR ("LC not registered");
+      return;
+    }
+  MmWaveFlexTtiFlowStats &flow = ue->m_flowStatsDl[lcid];
+  NS_LOG_INFO ("BSR for RNTI " << params.m_rnti << " LC " << (uint16_t)lcid << " RLC tx size " << params.m_rlcTransmissionQueueSize << " RLC retx size " << params.m_rlcRetransmissionQueueSize << " RLC stat size " <<  params.m_rlcStatusPduSize);
+  flow.m_rlcTxQueueSize = params.m_rlcTransmissionQueueSize;
+  flow.m_rlcRetxQueueSize = params.m_rlcRetransmissionQueueSize;
+  flow.m_rlcStatusPduSize = params.m_rlcStatusPduSize;
+  if (params.m_txPacketSizes.size () > 0)
+    {
+      flow.m_txPacketSizes.clear ();
+      flow.m_txPacketDelays.clear ();
+      // add the new DL PDCP packet sizes and their delays
+      uint32_t totalSize = 0;
+      double maxDelay = 0.0;
+      std::list<uint32_t>::const_iterator itSize = params.m_txPacketSizes.begin ();
+      std::list<double>::const_iterator itDelay = params.m_txPacketDelays.begin ();
+      while (itSize != params.m_txPacketSizes.end () && itDelay != params.m_txPacketDelays.end ())
+        {
+          totalSize += *itSize;
+          if (totalSize > flow.m_totalSchedSize)
+            {
+              flow.m_totalBufSize = params.m_rlcTransmissionQueueSize;
+              flow.m_txPacketSizes.push_back (*itSize);
+              flow.m_txPacketDelays.push_back (*itDelay);
+              if (*itDelay > maxDelay)
+                {
+                  maxDelay = *itDelay;
+                }
+            }
+          itSize++;
+          itDelay++;
+        }
+      flow.m_txQueueHolDelay = maxDelay;
+    }
+  else if (params.m_rlcTransmissionQueueSize > 0)        // case for RlcSm
+    {
+      flow.m_totalBufSize = params.m_rlcTransmissionQueueSize;
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (unsigned int i = 0; i < params.m_macCeList.size (); i++)
+    {
+      if ( params.m_macCeList.at (i).m_macCeType == MacCeElement::BSR )
+        {
+          // buffer status report
+          // the BSR of each LCG updates the estimated queue of the LCG
+          uint16_t rnti = params.m_macCeList.at (i).m_rnti;
+          MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (rnti);
+          if (ue != 0)
+            {
+              // the total of the LCGs, for the policies that do not differentiate them
+              ue->m_ulBsrSize = 0;
+              for (uint8_t lcg = 0; lcg < 4; ++lcg)
+                {
+                  ue->m_ulBsrSize += BsrId2BufferSize (params.m_macCeList.at (i).m_macCeValue.m_bufferStatus.at (lcg));
+                }
+            }
+
+          for (uint8_t lcg = 1; lcg <= 3; ++lcg)
+            {
+              uint8_t bsrId = params.m_macCeList.at (i).m_macCeValue.m_bufferStatus.at (lcg - 1);
+              uint32_t bufSize = BsrId2BufferSize (bsrId);
+              if (bufSize > 0)
+                {
+                  if (ue == 0)
+                    {
+                      NS_LOG_ERROR ("UE entry not found in sched info map");
+                      continue;
+                    }
+                  MmWaveFlexTtiFlowStats &flow = ue->m_flowStatsUl[lcg];
+                  int diff = bufSize - (flow.m_totalBufSize + flow.m_totalSchedSize);
+                  if (diff > 0)
+                    {                               // estimate additional packet sizes
+                      flow.m_totalBufSize += diff;
+                      flow.m_txPacketSizes.push_back (diff);
+                      // since we expect the BSR to be generated following a packet arrival and sent at least by the end of the prev. subframe,
+                      // the maximum delay is one SF (in microseconds)
+                      flow.m_txPacketDelays.push_back (m_phyMacConfig->GetSubframePeriod ());
+                      if (flow.m_txQueueHolDelay == 0)
+                        {
+                          flow.m_txQueueHolDelay = m_phyMacConfig->GetSubframePeriod ();
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoSchedDlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (unsigned int i = 0; i < params.m_cqiList.size (); i++)
+    {
+      if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::WB )
+        {
+          // wideband CQI reporting
+          uint16_t rnti = params.m_cqiList.at (i).m_rnti;
+          MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (rnti);
+          if (ue == 0)
+            {
+              NS_LOG_INFO (this << " DL-CQI of RNTI " << rnti << ", which is not configured");
+              continue;
+            }
+          ue->m_dlCqiRxed = true;
+          ue->m_dlCqi = params.m_cqiList.at (i).m_wbCqi; // only codeword 0 at this stage (SISO)
+          ue->m_dlCqiTimer = m_cqiTimersThreshold;
+        }
+      else if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::SB )
+        {
+          // subband CQI reporting high layer configured
+          // Not used by this scheduler
+        }
+      else
+        {
+          NS_LOG_ERROR (this << " CQI type unknown");
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+
+  unsigned frameNum = params.m_sfnSf.m_frameNum;
+  unsigned subframeNum =  params.m_sfnSf.m_sfNum;
+  unsigned startSymIdx =  params.m_sfnSf.m_slotNum;
+
+  switch (params.m_ulCqi.m_type)
+    {
+    case UlCqiInfo::PUSCH:
+      {
+        typename std::map <uint32_t, struct AllocMapElem>::iterator itMap;
+        itMap = m_ulAllocationMap.find (params.m_sfnSf.Encode ());
+        if (itMap == m_ulAllocationMap.end ())
+          {
+            NS_LOG_INFO (this << " Does not find info on allocation, size : " << m_ulAllocationMap.size ());
+            return;
+          }
+        NS_ASSERT_MSG (itMap->second.m_rntiPerChunk.size () == m_phyMacConfig->GetTotalNumChunk (), "SINR chunk map must cover full BW in TDMA mode");
+        for (unsigned i = 0; i < itMap->second.m_rntiPerChunk.size (); i++)
+          {
+            uint16_t rnti = itMap->second.m_rntiPerChunk.at (i);
+            MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (rnti);
+            if (ue == 0)
+              {
+                continue;
+              }
+            if (!ue->m_ulCqiRxed)
+              {
+                // initialize the other chunks with NO_SINR value.
+                ue->m_ulCqi.assign (m_phyMacConfig->GetTotalNumChunk (), 30.0);
+                ue->m_ulCqiRxed = true;
+              }
+            ue->m_ulCqi.at (i) = params.m_ulCqi.m_sinr.at (i);
+            ue->m_ulCqiNumSym = itMap->second.m_numSym;
+            ue->m_ulCqiTbSize = itMap->second.m_tbSize;
+            ue->m_ulCqiTimer = m_cqiTimersThreshold;
+            NS_LOG_INFO ("UL CQI report for RNTI " << rnti << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr.at (i) << \
+                         " frame " << frameNum << " subframe " << subframeNum << " startSym " << startSymIdx);
+          }
+        // remove obsolete info on allocation
+        m_ulAllocationMap.erase (itMap);
+      }
+      break;
+    default:
+      NS_FATAL_ERROR ("Unknown type of UL-CQI");
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoSchedSetMcs (int mcs)
+{
+  if (mcs >= 0 && mcs <= 28)
+    {
+      m_mcsDefaultDl = mcs;
+      m_mcsDefaultUl = mcs;
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::RefreshHarqProcesses ()
+{
+  NS_LOG_FUNCTION (this);
+
+  const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues = m_ueTable.GetUes ();
+  for (unsigned iue = 0; iue < ues.size (); iue++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ue = ues[iue];
+      for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+        {
+          if (ue->m_dlHarqTimer.at (i) == m_phyMacConfig->GetHarqTimeout ())
+            {             // reset HARQ process
+              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << ue->m_rnti);
+              ue->m_dlHarqStatus.at (i) = 0;
+              ue->m_dlHarqTimer.at (i) = 0;
+            }
+          else
+            {
+              ue->m_dlHarqTimer.at (i)++;
+            }
+        }
+      for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+        {
+          if (ue->m_ulHarqTimer.at (i) == m_phyMacConfig->GetHarqTimeout ())
+            {             // reset HARQ process
+              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << ue->m_rnti);
+              ue->m_ulHarqStatus.at (i) = 0;
+              ue->m_ulHarqTimer.at (i) = 0;
+            }
+          else
+            {
+              ue->m_ulHarqTimer.at (i)++;
+            }
+        }
+    }
+}
+
+template <class Policy>
+uint8_t
+MmWaveFlexTtiRankedMacScheduler<Policy>::UpdateDlHarqProcessId (MmWaveFlexTtiUeSchedInfo *ue)
+{
+  NS_LOG_FUNCTION (this << ue->m_rnti);
+
+  if (m_harqOn == false)
+    {
+      uint8_t tbUid = m_tbUid;
+      m_tbUid = (m_tbUid + 1) % m_phyMacConfig->GetNumHarqProcess ();
+      return tbUid;
+    }
+
+  // search for available process ID, if none available return numHarqProcess
+  uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
+  for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+    {
+      if (ue->m_dlHarqStatus[i] == 0)
+        {
+          ue->m_dlHarqStatus[i] = 1;
+          harqId = i;
+          break;
+        }
+    }
+  return harqId;
+}
+
+template <class Policy>
+uint8_t
+MmWaveFlexTtiRankedMacScheduler<Policy>::UpdateUlHarqProcessId (MmWaveFlexTtiUeSchedInfo *ue)
+{
+  NS_LOG_FUNCTION (this << ue->m_rnti);
+
+  if (m_harqOn == false)
+    {
+      uint8_t tbUid = m_tbUid;
+      m_tbUid = (m_tbUid + 1) % m_phyMacConfig->GetNumHarqProcess ();
+      return tbUid;
+    }
+
+  // search for available process ID, if none available return numHarqProcess
+  uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
+  for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+    {
+      if (ue->m_ulHarqStatus[i] == 0)
+        {
+          ue->m_ulHarqStatus[i] = 1;
+          harqId = i;
+          break;
+        }
+    }
+  return harqId;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::UpdateLinkAdaptation ()
+{
+  const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues = m_ueTable.GetUes ();
+  for (unsigned i = 0; i < ues.size (); i++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ueInfo = ues[i];
+
+      // DL MCS from the wideband DL-CQI
+      uint8_t cqi = 0;
+      if (ueInfo->m_dlCqiRxed)
+        {
+          cqi = ueInfo->m_dlCqi;
+        }
+      else           // no CQI available
+        {
+          NS_LOG_INFO (this << " UE " << ueInfo->m_rnti << " does not have DL-CQI");
+          cqi = 1;               // lowest value for trying a transmission
+        }
+      // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
+      ueInfo->m_dlInRange = !m_ulOnly && (cqi != 0 || m_fixedMcsDl);
+      if (m_fixedMcsDl)
+        {
+          ueInfo->m_dlMcs = m_mcsDefaultDl;
+        }
+      else if (ueInfo->m_dlInRange)
+        {
+          ueInfo->m_dlMcs = m_amc->GetMcsFromCqi (cqi);                // update MCS
+        }
+
+      // UL MCS from the SINR of the last UL transmission
+      int mcs = 0;
+      if (ueInfo->m_ulCqiRxed)
+        {
+          // translate vector of doubles to SpectrumValue's
+          Values::iterator specIt = m_ulSinr->ValuesBegin ();
+          for (unsigned ichunk = 0; ichunk < m_phyMacConfig->GetTotalNumChunk (); ichunk++)
+            {
+              NS_ASSERT (specIt != m_ulSinr->ValuesEnd ());
+              *specIt = ueInfo->m_ulCqi.at (ichunk);                   //sinrLin;
+              specIt++;
+            }
+          // for UL CQI, we need to know the TB size previously allocated to accurately compute CQI/MCS
+          cqi = m_amc->CreateCqiFeedbackWbTdma (*m_ulSinr, ueInfo->m_ulCqiNumSym, ueInfo->m_ulCqiTbSize, mcs);
+        }
+      else
+        {
+          NS_LOG_INFO (this << " UE " << ueInfo->m_rnti << " does not have UL-CQI");
+          cqi = 1;
+          mcs = 0;
+        }
+      ueInfo->m_ulInRange = !m_dlOnly && (cqi != 0 || m_fixedMcsUl);
+      if (m_fixedMcsUl)
+        {
+          ueInfo->m_ulMcs = m_mcsDefaultUl;
+        }
+      else if (ueInfo->m_ulInRange)
+        {
+          ueInfo->m_ulMcs = mcs;
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::CollectAllocatedUes ()
+{
+  m_allocatedUes.clear ();
+  const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues = m_ueTable.GetUes ();
+  for (unsigned i = 0; i < ues.size (); i++)
+    {
+      if (ues[i]->m_allocated)
+        {
+          m_allocatedUes.push_back (ues[i]);
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::SendSchedConfigInd (MmWaveMacSchedSapUser::SchedConfigIndParameters &ret)
+{
+  // add slot for UL control
+  SlotAllocInfo ulCtrlSlot (0xFF, SlotAllocInfo::UL_slotAllocInfo, SlotAllocInfo::CTRL, SlotAllocInfo::DIGITAL, 0);
+  ulCtrlSlot.m_dci.m_numSym = 1;
+  ulCtrlSlot.m_dci.m_symStart = m_phyMacConfig->GetSymbolsPerSubframe () - 1;
+  ret.m_sfAllocInfo.m_slotAllocInfo.push_back (ulCtrlSlot);
+  m_macSchedSapUser->SchedConfigInd (std::move (ret));
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoSchedTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params)
+{
+  uint16_t frameNum = params.m_snfSf.m_frameNum;
+  uint8_t sfNum = params.m_snfSf.m_sfNum;
+
+  MmWaveMacSchedSapUser::SchedConfigIndParameters ret;
+  ret.m_sfnSf = params.m_snfSf;
+  ret.m_sfAllocInfo.m_sfnSf = ret.m_sfnSf;
+  SfnSf ulSfn = ret.m_sfnSf;
+  if (ret.m_sfnSf.m_sfNum + m_phyMacConfig->GetUlSchedDelay () >=  m_phyMacConfig->GetSubframesPerFrame ())
+    {
+      ulSfn.m_frameNum++;
+    }
+  ulSfn.m_sfNum = (ret.m_sfnSf.m_sfNum + m_phyMacConfig->GetUlSchedDelay ()) % m_phyMacConfig->GetSubframesPerFrame ();
+  NS_LOG_DEBUG ("Scheduling DL frame " << (unsigned)frameNum << " subframe " << (unsigned)sfNum
+                                       << " UL frame " << (unsigned)ulSfn.m_frameNum << " subframe " << (unsigned)ulSfn.m_sfNum);
+
+  // add slot for DL control
+  SlotAllocInfo dlCtrlSlot (0, SlotAllocInfo::DL_slotAllocInfo, SlotAllocInfo::CTRL, SlotAllocInfo::DIGITAL, 0);
+  dlCtrlSlot.m_dci.m_numSym = 1;
+  dlCtrlSlot.m_dci.m_symStart = 0;
+  ret.m_sfAllocInfo.m_slotAllocInfo.push_back (dlCtrlSlot);
+
+  int symAvail = m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetDlCtrlSymbols () - m_phyMacConfig->GetUlCtrlSymbols ();
+  uint8_t slotIdx = 1;
+  uint8_t symIdx = m_phyMacConfig->GetDlCtrlSymbols ();      // symbols reserved for control at beginning of subframe
+
+  // process received CQIs
+  RefreshDlCqiMaps ();
+  RefreshUlCqiMaps ();
+
+  // Process DL HARQ feedback
+  RefreshHarqProcesses ();
+
+  // retrieve past HARQ retx buffered
+  m_dlHarqInfoList.insert (m_dlHarqInfoList.end (), params.m_dlHarqInfoList.begin (), params.m_dlHarqInfoList.end ());
+  m_ulHarqInfoList.insert (m_ulHarqInfoList.end (), params.m_ulHarqInfoList.begin (), params.m_ulHarqInfoList.end ());
+
+  if (m_harqOn == false)                // Ignore HARQ feedback
+    {
+      m_dlHarqInfoList.clear ();
+    }
+  else
+    {
+      // Process DL HARQ feedback and assign slots for RETX if resources available
+      m_dlHarqInfoUntxed.clear ();
+      m_ulHarqInfoUntxed.clear ();
+
+      for (unsigned i = 0; i < m_dlHarqInfoList.size (); i++)
+        {
+          if (symAvail == 0)
+            {
+              break;                    // no symbols left to allocate
+            }
+          uint8_t harqId = m_dlHarqInfoList.at (i).m_harqProcessId;
+          uint16_t rnti = m_dlHarqInfoList.at (i).m_rnti;
+          MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (rnti);
+          if (ue == 0)
+            {
+              NS_LOG_INFO ("No HARQ info found for UE (might have changed eNB) " << rnti);
+              continue;
+            }
+          if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::ACK || ue->m_dlHarqStatus.at (harqId) == 0)
+            {             // acknowledgment or process timeout, reset process
+              ue->m_dlHarqStatus.at (harqId) = 0;                      // release process ID
+              ue->m_dlHarqRlcPdu.at (harqId).clear ();                  // clear RLC buffers
+              continue;
+            }
+          else if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::NACK)
+            {
+              DciInfoElementTdma dciInfoReTx = ue->m_dlHarqDci.at (harqId);
+              NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
+              NS_ASSERT (ue->m_dlHarqStatus.at (harqId) - 1 == dciInfoReTx.m_rv);
+              if (dciInfoReTx.m_rv == 3)                   // maximum number of retx reached -> drop process
+                {
+                  NS_LOG_INFO ("Max number of retransmissions reached -> drop process");
+                  ue->m_dlHarqStatus.at (harqId) = 0;
+                  ue->m_dlHarqRlcPdu.at (harqId).clear ();
+                  continue;
+                }
+              // allocate retx if enough symbols are available
+              if (symAvail >= dciInfoReTx.m_numSym)
+                {
+                  symAvail -= dciInfoReTx.m_numSym;
+                  dciInfoReTx.m_symStart = symIdx;
+                  symIdx += dciInfoReTx.m_numSym;
+                  NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
+                  dciInfoReTx.m_rv++;
+                  dciInfoReTx.m_ndi = 0;
+                  ue->m_dlHarqDci.at (harqId) = dciInfoReTx;
+                  ue->m_dlHarqStatus.at (harqId) = ue->m_dlHarqStatus.at (harqId) + 1;
+                  SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, rnti);
+                  slotInfo.m_dci = dciInfoReTx;
+                  NS_LOG_DEBUG ("UE" << dciInfoReTx.m_rnti << " gets DL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1) <<
+                                " tbs " << dciInfoReTx.m_tbSize << " harqId " << (unsigned)dciInfoReTx.m_harqProcess << " harqId " << (unsigned)dciInfoReTx.m_harqProcess <<
+                                " rv " << (unsigned)dciInfoReTx.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum << " RETX");
+                  const std::vector<RlcPduInfo> &rlcList = ue->m_dlHarqRlcPdu.at (dciInfoReTx.m_harqProcess);
+                  slotInfo.m_rlcPduInfo.insert (slotInfo.m_rlcPduInfo.end (), rlcList.begin (), rlcList.end ());
+                  ret.m_sfAllocInfo.m_slotAllocInfo.push_back (std::move (slotInfo));
+                  ret.m_sfAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
+
+                  ue->m_dlSymbolsRetx = dciInfoReTx.m_numSym;
+                  ue->m_allocated = true;
+                }
+              else
+                {
+                  NS_LOG_INFO ("No resource for this retx -> buffer it");
+                  m_dlHarqInfoUntxed.push_back (m_dlHarqInfoList.at (i));
+                }
+            }
+        }
+
+      m_dlHarqInfoList.swap (m_dlHarqInfoUntxed);
+
+      // Process UL HARQ feedback
+      for (uint16_t i = 0; i < m_ulHarqInfoList.size (); i++)
+        {
+          if (symAvail == 0)
+            {
+              break;                    // no symbols left to allocate
+            }
+          UlHarqInfo harqInfo = m_ulHarqInfoList.at (i);
+          uint8_t harqId = harqInfo.m_harqProcessId;
+          uint16_t rnti = harqInfo.m_rnti;
+          MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (rnti);
+          if (ue == 0)
+            {
+              NS_LOG_ERROR ("No info found in HARQ buffer for UE (might have changed eNB) " << rnti);
+              continue;
+            }
+          if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || ue->m_ulHarqStatus.at (harqId) == 0)
+            {
+              ue->m_ulHarqStatus.at (harqId) = 0;                        // release process ID
+            }
+          else if (harqInfo.m_receptionStatus == UlHarqInfo::NotOk)
+            {
+              // retx correspondent block: retrieve the UL-DCI
+              DciInfoElementTdma dciInfoReTx = ue->m_ulHarqDci.at (harqId);
+              NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
+              NS_ASSERT (ue->m_ulHarqStatus.at (harqId) > 0);
+              NS_ASSERT (ue->m_ulHarqStatus.at (harqId) - 1 == dciInfoReTx.m_rv);
+              if (dciInfoReTx.m_rv == 3)
+                {
+                  NS_LOG_INFO ("Max number of retransmissions reached (UL)-> drop process");
+                  ue->m_ulHarqStatus.at (harqId) = 0;
+                  continue;
+                }
+
+              if (symAvail >= dciInfoReTx.m_numSym)
+                {
+                  symAvail -= dciInfoReTx.m_numSym;
+                  dciInfoReTx.m_symStart = symIdx;
+                  symIdx += dciInfoReTx.m_numSym;
+                  NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
+                  dciInfoReTx.m_rv++;
+                  dciInfoReTx.m_ndi = 0;
+                  ue->m_ulHarqStatus.at (harqId) = ue->m_ulHarqStatus.at (harqId) + 1;
+                  ue->m_ulHarqDci.at (harqId) = dciInfoReTx;
+                  SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::UL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, rnti);
+                  slotInfo.m_dci = dciInfoReTx;
+                  NS_LOG_DEBUG ("UE" << dciInfoReTx.m_rnti << " gets UL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1) <<
+                                " tbs " << dciInfoReTx.m_tbSize << " harqId " << (unsigned)dciInfoReTx.m_harqProcess << " rv " << (unsigned)dciInfoReTx.m_rv << " in frame " << ulSfn.m_frameNum << " subframe " << (unsigned)ulSfn.m_sfNum <<
+                                " RETX");
+                  ret.m_sfAllocInfo.m_slotAllocInfo.push_back (std::move (slotInfo));
+                  ret.m_sfAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
+
+                  ue->m_ulSymbolsRetx = dciInfoReTx.m_numSym;
+                  ue->m_allocated = true;
+                }
+              else
+                {
+                  m_ulHarqInfoUntxed.push_back (m_ulHarqInfoList.at (i));
+                }
+            }
+        }
+
+      m_ulHarqInfoList.swap (m_ulHarqInfoUntxed);
+    }
+
+  // no further allocations
+  if (symAvail == 0)
+    {
+      SendSchedConfigInd (ret);
+
+      // reset the alloc info for the next scheduler call
+      CollectAllocatedUes ();
+      for (unsigned i = 0; i < m_allocatedUes.size (); i++)
+        {
+          m_allocatedUes[i]->m_dlSymbolsRetx = 0;
+          m_allocatedUes[i]->m_ulSymbolsRetx = 0;
+          m_allocatedUes[i]->m_allocated = false;
+        }
+      return;
+    }
+
+  // ********************* END OF HARQ SECTION, START OF NEW DATA SCHEDULING ********************* //
+
+  UpdateLinkAdaptation ();
+
+  MmWaveFlexTtiSchedContext ctx;
+  ctx.m_phyMacConfig = m_phyMacConfig;
+  ctx.m_amc = m_amc;
+  ctx.m_fixedTti = m_fixedTti;
+  ctx.m_symPerSlot = m_symPerSlot;
+  Policy::AllocateSymbols (ctx, m_ueTable.GetUes (), symAvail);
+
+  CollectAllocatedUes ();
+  Policy::SortAllocatedUes (m_allocatedUes);
+
+  // no further allocations
+  if (m_allocatedUes.size () == 0)
+    {
+      SendSchedConfigInd (ret);
+      return;
+    }
+
+  // iterate through the allocated UEs, assign TDMA symbol indices and create DCIs
+  for (unsigned iue = 0; iue < m_allocatedUes.size (); iue++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ueInfo = m_allocatedUes[iue];
+      if (ueInfo->m_dlSymbols > 0)
+        {
+          DciInfoElementTdma dci;
+          dci.m_rnti = ueInfo->m_rnti;
+          dci.m_format = 0;
+          dci.m_symStart = symIdx;
+          dci.m_numSym = ueInfo->m_dlSymbols;
+          symIdx += ueInfo->m_dlSymbols;
+          NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
+          dci.m_mcs = ueInfo->m_dlMcs;
+          dci.m_rv = 0;
+          dci.m_ndi = 1;
+          dci.m_tbSize = m_amc->GetTbSizeFromMcsSymbols (dci.m_mcs, dci.m_numSym) / 8;
+          dci.m_harqProcess = UpdateDlHarqProcessId (ueInfo);
+          NS_ASSERT (dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess ());
+          SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, ueInfo->m_rnti);
+          slotInfo.m_dci = dci;
+          NS_LOG_DEBUG ("UE" << dci.m_rnti << " gets DL symbols " << (unsigned)dci.m_symStart << "-" << (unsigned)(dci.m_symStart + dci.m_numSym - 1) <<
+                        " tbs " << dci.m_tbSize << " mcs " << (unsigned)dci.m_mcs << " harqId " << (unsigned)dci.m_harqProcess << " rv " << (unsigned)dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum);
+
+          if (m_harqOn == true)
+            {                   // store DCI for HARQ buffer
+              ueInfo->m_dlHarqDci.at (dci.m_harqProcess) = dci;
+              // refresh timer
+              ueInfo->m_dlHarqTimer.at (dci.m_harqProcess) = 0;
+            }
+
+          // distribute bytes between active RLC queues
+          Policy::DistributeDlBytes (ueInfo, dci.m_tbSize);
+          slotInfo.m_rlcPduInfo.insert (slotInfo.m_rlcPduInfo.end (), ueInfo->m_rlcPduInfo.begin (), ueInfo->m_rlcPduInfo.end ());
+          if (m_harqOn == true)
+            {
+              // store RLC PDU list for HARQ
+              std::vector<RlcPduInfo> &harqRlcList = ueInfo->m_dlHarqRlcPdu.at (dci.m_harqProcess);
+              harqRlcList.insert (harqRlcList.end (), ueInfo->m_rlcPduInfo.begin (), ueInfo->m_rlcPduInfo.end ());
+            }
+
+          if (m_harqOn == true)
+            {
+              // reorder/reindex slots to maintain DL before UL slot order
+              bool reordered = false;
+              std::deque <SlotAllocInfo>::iterator itSlot = ret.m_sfAllocInfo.m_slotAllocInfo.begin ();
+              for (unsigned islot = 0; islot < ret.m_sfAllocInfo.m_slotAllocInfo.size (); islot++)
+                {
+                  if (ret.m_sfAllocInfo.m_slotAllocInfo [islot].m_tddMode == SlotAllocInfo::UL_slotAllocInfo)
+                    {
+                      slotInfo.m_slotIdx = ret.m_sfAllocInfo.m_slotAllocInfo [islot].m_slotIdx;
+                      slotInfo.m_dci.m_symStart = ret.m_sfAllocInfo.m_slotAllocInfo [islot].m_dci.m_symStart;
+                      ret.m_sfAllocInfo.m_slotAllocInfo.insert (itSlot, slotInfo);
+                      for (unsigned jslot = islot + 1; jslot < ret.m_sfAllocInfo.m_slotAllocInfo.size (); jslot++)
+                        {
+                          ret.m_sfAllocInfo.m_slotAllocInfo[jslot].m_slotIdx++;                                 // increase indices of UL slots
+                          ret.m_sfAllocInfo.m_slotAllocInfo[jslot].m_dci.m_symStart =
+                            ret.m_sfAllocInfo.m_slotAllocInfo[jslot - 1].m_dci.m_symStart +
+                            ret.m_sfAllocInfo.m_slotAllocInfo[jslot - 1].m_dci.m_numSym;
+                        }
+                      reordered = true;
+                      break;
+                    }
+                  itSlot++;
+                }
+              if (!reordered)
+                {
+                  ret.m_sfAllocInfo.m_slotAllocInfo.push_back (std::move (slotInfo));
+                }
+            }
+          else
+            {
+              ret.m_sfAllocInfo.m_slotAllocInfo.push_back (std::move (slotInfo));
+            }
+          ret.m_sfAllocInfo.m_numSymAlloc += dci.m_numSym;
+        }
+    }
+  slotIdx = ret.m_sfAllocInfo.m_slotAllocInfo.back ().m_slotIdx + 1;
+  symIdx = ret.m_sfAllocInfo.m_slotAllocInfo.back ().m_dci.m_symStart + ret.m_sfAllocInfo.m_slotAllocInfo.back ().m_dci.m_numSym;
+
+  for (unsigned iue = 0; iue < m_allocatedUes.size (); iue++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ueInfo = m_allocatedUes[iue];
+      // Note: UL-DCI applies to subframe i+Tsched
+      if (ueInfo->m_ulSymbols > 0)
+        {
+          DciInfoElementTdma dci;
+          dci.m_rnti = ueInfo->m_rnti;
+          dci.m_format = 1;
+          dci.m_symStart = symIdx;
+          dci.m_numSym = ueInfo->m_ulSymbols;
+          symIdx += ueInfo->m_ulSymbols;
+          NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
+          dci.m_mcs = ueInfo->m_ulMcs;
+          dci.m_ndi = 1;
+          dci.m_tbSize = m_amc->GetTbSizeFromMcsSymbols (dci.m_mcs, dci.m_numSym) / 8;
+          dci.m_harqProcess = UpdateUlHarqProcessId (ueInfo);
+          NS_ASSERT (dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess ());
+          Policy::GrantUlBytes (ueInfo, dci.m_tbSize);
+          SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::UL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, ueInfo->m_rnti);
+          slotInfo.m_dci = dci;
+          NS_LOG_DEBUG ("UE" << dci.m_rnti << " gets UL symbols " << (unsigned)dci.m_symStart << "-" << (unsigned)(dci.m_symStart + dci.m_numSym - 1) <<
+                        " tbs " << dci.m_tbSize << " mcs " << (unsigned)dci.m_mcs << " harqId " << (unsigned)dci.m_harqProcess << " rv " << (unsigned)dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum);
+          ret.m_sfAllocInfo.m_slotAllocInfo.push_back (std::move (slotInfo));
+          ret.m_sfAllocInfo.m_numSymAlloc += dci.m_numSym;
+          std::vector<uint16_t> ueChunkMap (m_phyMacConfig->GetTotalNumChunk (), dci.m_rnti);
+          SfnSf slotSfn = ret.m_sfAllocInfo.m_sfnSf;
+          slotSfn.m_slotNum = dci.m_symStart;                // use the start symbol index of the slot because the absolute UL slot index depends on the future DL allocation
+          // insert into allocation map to recall previous allocations upon receiving UL-CQI
+          m_ulAllocationMap.insert ( std::pair<uint32_t, struct AllocMapElem> (slotSfn.Encode (), AllocMapElem (ueChunkMap, dci.m_numSym, dci.m_tbSize)) );
+
+          if (m_harqOn == true)
+            {
+              ueInfo->m_ulHarqDci.at (dci.m_harqProcess) = dci;
+              // Update HARQ process status (RV 0)
+              NS_ASSERT (ueInfo->m_ulHarqStatus[dci.m_harqProcess] > 0);
+              // refresh timer
+              ueInfo->m_ulHarqTimer.at (dci.m_harqProcess) = 0;
+            }
+        }
+    }
+
+  // reset the alloc info for the next scheduler call
+  for (unsigned iue = 0; iue < m_allocatedUes.size (); iue++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ueInfo = m_allocatedUes[iue];
+      ueInfo->m_allocated = false;
+      ueInfo->m_dlSymbols = 0;
+      ueInfo->m_ulSymbols = 0;
+      ueInfo->m_dlTbSize = 0;
+      ueInfo->m_ulTbSize = 0;
+      ueInfo->m_dlSymbolsRetx = 0;
+      ueInfo->m_ulSymbolsRetx = 0;
+      ueInfo->m_currTputDl = 0;
+      ueInfo->m_currTputUl = 0;
+      ueInfo->m_avgTputDl = 0;
+      ueInfo->m_avgTputUl = 0;
+      ueInfo->m_totBufDl = 0;
+      ueInfo->m_totBufUl = 0;
+      ueInfo->m_dlAllocDone = false;
+      ueInfo->m_ulAllocDone = false;
+      ueInfo->m_rlcPduInfo.clear ();
+    }
+
+  SendSchedConfigInd (ret);
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::RefreshDlCqiMaps (void)
+{
+  NS_LOG_FUNCTION (this);
+  // refresh DL CQI P01 Map
+  const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues = m_ueTable.GetUes ();
+  for (unsigned i = 0; i < ues.size (); i++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ue = ues[i];
+      if (!ue->m_dlCqiRxed)
+        {
+          continue;
+        }
+      NS_LOG_INFO (this << " P10-CQI for user " << ue->m_rnti << " is " << (uint32_t)ue->m_dlCqiTimer << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (ue->m_dlCqiTimer == 0)
+        {
+          NS_LOG_INFO (this << " P10-CQI exired for user " << ue->m_rnti);
+          ue->m_dlCqiRxed = false;
+        }
+      else
+        {
+          ue->m_dlCqiTimer--;
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::RefreshUlCqiMaps (void)
+{
+  // refresh UL CQI  Map
+  const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues = m_ueTable.GetUes ();
+  for (unsigned i = 0; i < ues.size (); i++)
+    {
+      MmWaveFlexTtiUeSchedInfo *ue = ues[i];
+      if (!ue->m_ulCqiRxed)
+        {
+          continue;
+        }
+      NS_LOG_INFO (this << " UL-CQI for user " << ue->m_rnti << " is " << (uint32_t)ue->m_ulCqiTimer << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (ue->m_ulCqiTimer == 0)
+        {
+          NS_LOG_INFO (this << " UL-CQI expired for user " << ue->m_rnti);
+          ue->m_ulCqiRxed = false;
+          ue->m_ulCqi.clear ();
+        }
+      else
+        {
+          ue->m_ulCqiTimer--;
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoCschedCellConfigReq (const struct MmWaveMacCschedSapProvider::CschedCellConfigReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+  // Read the subset of parameters used
+  m_cschedCellConfig = params;
+  MmWaveMacCschedSapUser::CschedUeConfigCnfParameters cnf;
+  cnf.m_result = SUCCESS;
+  m_macCschedSapUser->CschedUeConfigCnf (cnf);
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoCschedUeConfigReq (const struct MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params)
+{
+  NS_LOG_FUNCTION (this << " RNTI " << params.m_rnti << " txMode " << (uint16_t)params.m_transmissionMode);
+  m_ueTable.Add (params.m_rnti, m_phyMacConfig->GetNumHarqProcess ());
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoCschedLcConfigReq (const struct MmWaveMacCschedSapProvider::CschedLcConfigReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+  MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (params.m_rnti);
+  if (ue == 0)
+    {
+      NS_LOG_ERROR ("Cannot find UE info entry");
+      return;
+    }
+  for (uint16_t i = 0; i < params.m_logicalChannelConfigList.size (); i++)
+    {
+      const LogicalChannelConfigListElement_s &lc = params.m_logicalChannelConfigList[i];
+      EpsBearer lowLatBearer (EpsBearer::NGBR_LOW_LAT_EMBB_AR);
+      if (lc.m_direction == LogicalChannelConfigListElement_s::DIR_DL)
+        {
+          uint8_t lcid = lc.m_logicalChannelIdentity;
+          for (unsigned j = ue->m_flowStatsDl.size (); j <= lcid; j++)
+            {
+              ue->m_flowStatsDl.push_back (MmWaveFlexTtiFlowStats (false, ue, j));
+            }
+          ue->m_flowStatsDl[lcid].m_qci = lc.m_qci;
+          if (lc.m_qci == EpsBearer::NGBR_LOW_LAT_EMBB_AR)
+            {
+              ue->m_flowStatsDl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+            }
+          Policy::AddFlow (&ue->m_flowStatsDl[lcid]);
+        }
+      else if (lc.m_direction == LogicalChannelConfigListElement_s::DIR_UL)
+        {
+          uint8_t lcid = lc.m_logicalChannelGroup;   // use LCG ID instead of LCID
+          for (unsigned j = ue->m_flowStatsUl.size (); j <= lcid; j++)
+            {
+              ue->m_flowStatsUl.push_back (MmWaveFlexTtiFlowStats (true, ue, j));
+            }
+          ue->m_flowStatsUl[lcid].m_qci = lc.m_qci;
+          if (lc.m_qci == EpsBearer::NGBR_LOW_LAT_EMBB_AR)
+            {
+              ue->m_flowStatsUl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+            }
+          Policy::AddFlow (&ue->m_flowStatsUl[lcid]);
+        }
+      else if (lc.m_direction == LogicalChannelConfigListElement_s::DIR_BOTH)
+        {
+          uint8_t lcid = lc.m_logicalChannelIdentity;
+          for (unsigned j = ue->m_flowStatsDl.size (); j <= lcid; j++)
+            {
+              ue->m_flowStatsDl.push_back (MmWaveFlexTtiFlowStats (false, ue, j));
+              ue->m_flowStatsUl.push_back (MmWaveFlexTtiFlowStats (true, ue, j));
+            }
+          ue->m_flowStatsDl[lcid].m_qci = lc.m_qci;
+          ue->m_flowStatsUl[lcid].m_qci = lc.m_qci;
+          // the bidirectional bearers always get the low latency deadline
+          ue->m_flowStatsDl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+          ue->m_flowStatsUl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+          Policy::AddFlow (&ue->m_flowStatsDl[lcid]);
+          Policy::AddFlow (&ue->m_flowStatsUl[lcid]);
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoCschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+  // the flows are kept until the UE is released, only their RLC buffer status is dropped
+  MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (params.m_rnti);
+  if (ue == 0)
+    {
+      return;
+    }
+  for (uint16_t i = 0; i < params.m_logicalChannelIdentity.size (); i++)
+    {
+      uint8_t lcid = params.m_logicalChannelIdentity.at (i);
+      if ((unsigned)lcid < ue->m_flowStatsDl.size ())
+        {
+          ue->m_flowStatsDl[lcid].m_rlcTxQueueSize = 0;
+          ue->m_flowStatsDl[lcid].m_rlcRetxQueueSize = 0;
+          ue->m_flowStatsDl[lcid].m_rlcStatusPduSize = 0;
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiRankedMacScheduler<Policy>::DoCschedUeReleaseReq (const struct MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters& params)
+{
+  NS_LOG_FUNCTION (this << " Release RNTI " << params.m_rnti);
+  MmWaveFlexTtiUeSchedInfo *ue = m_ueTable.Find (params.m_rnti);
+  if (ue != 0)
+    {
+      Policy::RemoveUe (ue);
+      m_ueTable.Remove (params.m_rnti);
+    }
+}
+
+template class MmWaveFlexTtiRankedMacScheduler<MmWaveFlexTtiMaxRatePolicy>;
+template class MmWaveFlexTtiRankedMacScheduler<MmWaveFlexTtiPfPolicy>;
+template class MmWaveFlexTtiRankedMacScheduler<MmWaveFlexTtiMaxWeightPolicy>;
+template class MmWaveFlexTtiRankedMacScheduler<MmWaveFlexTtiRoundRobinPolicy>;
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveFlexTtiMaxRateMacScheduler);
+NS_OBJECT_ENSURE_REGISTERED (MmWaveFlexTtiPfMacScheduler);
+NS_OBJECT_ENSURE_REGISTERED (MmWaveFlexTtiMaxWeightMacScheduler);
+NS_OBJECT_ENSURE_REGISTERED (MmWaveFlexTtiMacScheduler);
+
+} // namespace mmwave
+
+} // namespace ns3
@@ -0,0 +1,468 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef SRC_MMWAVE_MODEL_MMWAVE_FLEX_TTI_RANKED_MAC_SCHEDULER_H_
+#define SRC_MMWAVE_MODEL_MMWAVE_FLEX_TTI_RANKED_MAC_SCHEDULER_H_
+
+#include "mmwave-mac-sched-sap.h"
+#include "mmwave-mac-csched-sap.h"
+#include "mmwave-mac-scheduler.h"
+#include "mmwave-amc.h"
+#include <ns3/log.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
+
+namespace ns3 {
+
+namespace mmwave {
+
+struct MmWaveFlexTtiUeSchedInfo;
+
+/**
+ * \brief The buffer of a logical channel (DL) or of a logical channel group
+ * (UL) of a UE, as estimated from the RLC buffer status and from the BSRs
+ */
+struct MmWaveFlexTtiFlowStats
+{
+  MmWaveFlexTtiFlowStats (bool uplink, MmWaveFlexTtiUeSchedInfo* ueSchedInfo, uint8_t lcid)
+    : m_isUplink (uplink),
+      m_ueSchedInfo (ueSchedInfo),
+      m_lcid (lcid),
+      m_arrivalRate (0.0),
+      m_grantedRate (0.0),
+      m_qci (0),
+      m_txQueueHolDelay (0),
+      m_reTxQueueHolDelay (0),
+      m_probErr (0.0),
+      m_deadlineUs (0),
+      m_totalBufSize (0),
+      m_totalSchedSize (0),
+      m_rlcTxQueueSize (0),
+      m_rlcRetxQueueSize (0),
+      m_rlcStatusPduSize (0)
+  {
+    NS_ASSERT (ueSchedInfo != 0);
+  }
+
+  bool            m_isUplink;                   // is uplink?
+  MmWaveFlexTtiUeSchedInfo* m_ueSchedInfo;      // pointer to parent UE Info
+  uint8_t         m_lcid;                       // LCID (for DL) or LC Group ID (for UL)
+  double          m_arrivalRate;                // Mbps
+  double          m_grantedRate;                // Mbps
+  uint8_t         m_qci;                        // We interpret QCI 69 as delay critical
+  double          m_txQueueHolDelay;
+  uint32_t        m_reTxQueueHolDelay;
+  double          m_probErr;                    // expected probability of each HARQ TX/reTX failure (i.e. 1/E[num TX to success])
+  double          m_deadlineUs;                 // relative deadline
+  std::list<uint32_t> m_txPacketSizes;          // estimated packet sizes from consecutive BSRs
+  uint32_t        m_totalBufSize;
+  std::list<uint32_t> m_retxPacketSizes;
+  std::list<double> m_txPacketDelays;           // estimated delays for each packet
+  std::list<double> m_retxPacketDelays;
+
+  // We maintain a queue of PDU sizes scheduled in the last M subframes.
+  // M = delay between scheduling and transmission (default DL = 1, UL = 2)
+  // The sum of these M elements is subtracted from the BSR to account for
+  // data that has been scheduled but not yet extracted from the DL or UL queue.
+  std::list<uint32_t> m_schedPacketSizes;
+  uint32_t        m_totalSchedSize;             // total of last M elements in list
+
+  // DL only: the queues of the last RLC buffer status, less what has been scheduled since then
+  uint32_t        m_rlcTxQueueSize;
+  uint32_t        m_rlcRetxQueueSize;
+  uint16_t        m_rlcStatusPduSize;
+};
+
+/**
+ * \brief All that a MmWaveFlexTtiRankedMacScheduler knows of a UE: the
+ * buffers, the last CQIs, the HARQ processes and the allocation in the
+ * subframe being scheduled.
+ *
+ * The flows point to the UE, hence a UE never moves once created.
+ */
+struct MmWaveFlexTtiUeSchedInfo
+{
+  MmWaveFlexTtiUeSchedInfo (uint16_t rnti, uint8_t numHarqProcess);
+
+  uint16_t        m_rnti;
+
+  // allocation in the current subframe
+  bool            m_allocated;                  // has a new transmission or a retransmission
+  bool            m_dlInRange;                  // false if the DL-CQI is out of range (0)
+  bool            m_ulInRange;                  // false if the UL-CQI is out of range (0)
+  uint8_t         m_dlMcs;
+  uint8_t         m_ulMcs;
+  uint8_t         m_dlSymbols;
+  uint8_t         m_ulSymbols;
+  uint8_t         m_dlSymbolsRetx;
+  uint8_t         m_ulSymbolsRetx;
+  uint32_t        m_dlTbSize;
+  uint32_t        m_ulTbSize;
+  std::vector <struct RlcPduInfo> m_rlcPduInfo;
+  bool            m_dlAllocDone;
+  bool            m_ulAllocDone;
+  double          m_avgTputDl;
+  double          m_avgTputUl;
+  double          m_lastAvgTputDl;
+  double          m_lastAvgTputUl;
+  double          m_currTputDl;
+  double          m_currTputUl;
+  uint32_t        m_totBufDl;
+  uint32_t        m_totBufUl;
+  bool            m_allocUlLast;
+  int32_t         m_pfHeapIndex;                // position in the UE heap of the PF policy, -1 if not in the heap
+  uint32_t        m_ulBsrSize;                  // bytes of all the LCGs in the last BSR, less the UL grants since then
+
+  // for each LC (DL) or LCG (UL): a deque, so that adding a flow does not move the others
+  std::deque<MmWaveFlexTtiFlowStats> m_flowStatsDl;
+  std::deque<MmWaveFlexTtiFlowStats> m_flowStatsUl;
+
+  // wideband DL-CQI, valid for m_dlCqiTimer more TTIs
+  bool            m_dlCqiRxed;
+  uint8_t         m_dlCqi;
+  uint32_t        m_dlCqiTimer;
+
+  // SINR per chunk of the last UL transmission, valid for m_ulCqiTimer more TTIs
+  bool            m_ulCqiRxed;
+  std::vector <double> m_ulCqi;
+  uint8_t         m_ulCqiNumSym;
+  uint32_t        m_ulCqiTbSize;
+  uint32_t        m_ulCqiTimer;
+
+  // HARQ status
+  // 0: process Id available
+  // x>0: process Id equal to `x` trasmission count
+  std::vector <uint8_t> m_dlHarqStatus;
+  std::vector <uint8_t> m_dlHarqTimer;
+  std::vector <DciInfoElementTdma> m_dlHarqDci;
+  std::vector < std::vector <struct RlcPduInfo> > m_dlHarqRlcPdu;   // the LCs of each HARQ process
+  std::vector <uint8_t> m_ulHarqStatus;
+  std::vector <uint8_t> m_ulHarqTimer;
+  std::vector <DciInfoElementTdma> m_ulHarqDci;
+
+  /**
+   * Cut the RLC PDUs in m_rlcPduInfo so that the LCs share a DL TB evenly:
+   * the LCs with less than an even share keep their size
+   * @param the size of the TB, in bytes
+   */
+  void SplitDlBytes (uint32_t tbSize);
+
+private:
+  MmWaveFlexTtiUeSchedInfo (const MmWaveFlexTtiUeSchedInfo &);
+  MmWaveFlexTtiUeSchedInfo& operator= (const MmWaveFlexTtiUeSchedInfo &);
+};
+
+/**
+ * \brief The UEs of a scheduler, indexed by RNTI and visited in order of RNTI
+ */
+class MmWaveFlexTtiUeTable
+{
+public:
+  MmWaveFlexTtiUeTable ()
+  {
+  }
+  ~MmWaveFlexTtiUeTable ();
+
+  /**
+   * @param the RNTI
+   * @returns the UE, or 0 if the RNTI is not configured
+   */
+  MmWaveFlexTtiUeSchedInfo* Find (uint16_t rnti) const
+  {
+    return rnti < m_table.size () ? m_table[rnti] : 0;
+  }
+
+  /**
+   * @param the RNTI
+   * @param the number of HARQ processes of the UE
+   * @returns the UE, which is created if the RNTI is not configured yet
+   */
+  MmWaveFlexTtiUeSchedInfo* Add (uint16_t rnti, uint8_t numHarqProcess);
+
+  /**
+   * Delete a UE, if configured
+   * @param the RNTI
+   */
+  void Remove (uint16_t rnti);
+
+  /**
+   * Delete all the UEs
+   */
+  void Clear ();
+
+  /**
+   * @returns the UEs, in order of RNTI
+   */
+  const std::vector<MmWaveFlexTtiUeSchedInfo*>& GetUes () const
+  {
+    return m_ues;
+  }
+
+private:
+  MmWaveFlexTtiUeTable (const MmWaveFlexTtiUeTable &);
+  MmWaveFlexTtiUeTable& operator= (const MmWaveFlexTtiUeTable &);
+
+  std::vector<MmWaveFlexTtiUeSchedInfo*> m_table;   // indexed by RNTI, 0 if the RNTI is not configured
+  std::vector<MmWaveFlexTtiUeSchedInfo*> m_ues;     // in order of RNTI
+};
+
+/**
+ * \brief What the policy of a MmWaveFlexTtiRankedMacScheduler may use to
+ * allocate the symbols of a subframe
+ */
+struct MmWaveFlexTtiSchedContext
+{
+  Ptr<MmWavePhyMacCommon> m_phyMacConfig;
+  Ptr<MmWaveAmc> m_amc;
+  bool m_fixedTti;                      // one slot per TTI
+  uint8_t m_symPerSlot;                 // symbols per slot
+};
+
+/**
+ * \brief Base of the policies that rank the UEs by their rate: a UE is given
+ * one symbol at a time, alternating UL and DL, until its buffers are empty,
+ * and its DL symbols are split evenly among its active logical channels.
+ */
+class MmWaveFlexTtiRatePolicy
+{
+public:
+  MmWaveFlexTtiRatePolicy ();
+
+  static TypeId AddAttributes (TypeId tid)
+  {
+    return tid;
+  }
+  void AddFlow (MmWaveFlexTtiFlowStats *flow)
+  {
+  }
+  void RemoveUe (MmWaveFlexTtiUeSchedInfo *ue)
+  {
+  }
+  void SortAllocatedUes (std::vector<MmWaveFlexTtiUeSchedInfo*> &ues) const
+  {
+  }
+  void GrantUlBytes (MmWaveFlexTtiUeSchedInfo *ue, uint32_t tbSize) const
+  {
+  }
+
+  /**
+   * Split the DL TB of a UE among its active logical channels
+   * @param the UE
+   * @param the size of the TB, in bytes
+   */
+  void DistributeDlBytes (MmWaveFlexTtiUeSchedInfo *ue, uint32_t tbSize) const;
+
+protected:
+  /**
+   * Compute the bytes buffered by the UEs in range and their rate with one
+   * symbol, and mark the UEs with data to send as allocated
+   * @param the scheduler context
+   * @param the UEs, in order of RNTI
+   */
+  void ComputeRates (const MmWaveFlexTtiSchedContext &ctx,
+                     const std::vector<MmWaveFlexTtiUeSchedInfo*> &ues) const;
+
+  /**
+   * Give one more symbol to the UL or to the DL of a UE, and update its rate
+   * @param the scheduler context
+   * @param the UE
+   * @param the number of symbols still available
+   * @returns false if the UE has nothing more to send
+   */
+  bool AllocateSymbol (const MmWaveFlexTtiSchedContext &ctx, MmWaveFlexTtiUeSchedInfo *ue, int &symAvail) const;
+
+  double m_timeWindow;          // of the moving average of the throughput, in subframes
+};
+
+/**
+ * \brief Flexible TTI TDMA scheduler, in which a Policy decides how the
+ * symbols of a subframe left after the HARQ retransmissions are given to
+ * the UEs. Everything else (CQIs, buffer status, HARQ, DCIs) is shared by
+ * the policies.
+ *
+ * A Policy provides:
+ * - static const char* GetTypeName (), the name of the TypeId of the scheduler
+ * - static LogComponent& GetLogComponent (), the log component of the scheduler
+ * - static TypeId AddAttributes (TypeId), to add the attributes of the policy
+ * - void AddFlow (MmWaveFlexTtiFlowStats*), called when a LC is configured
+ * - void RemoveUe (MmWaveFlexTtiUeSchedInfo*), called before a UE is deleted
+ * - void AllocateSymbols (const MmWaveFlexTtiSchedContext&, const std::vector<MmWaveFlexTtiUeSchedInfo*>&, int&),
+ *   which sets the DL and UL symbols of the UEs and marks them as allocated
+ * - void SortAllocatedUes (std::vector<MmWaveFlexTtiUeSchedInfo*>&), which
+ *   may reorder the allocated UEs, given in order of RNTI: the DL and the UL
+ *   symbols of the UEs follow this order
+ * - void DistributeDlBytes (MmWaveFlexTtiUeSchedInfo*, uint32_t), which
+ *   fills the RLC PDU list of a UE for its DL TB
+ * - void GrantUlBytes (MmWaveFlexTtiUeSchedInfo*, uint32_t), called for
+ *   each new UL TB
+ */
+template <class Policy>
+class MmWaveFlexTtiRankedMacScheduler : public MmWaveMacScheduler, public Policy
+{
+public:
+  MmWaveFlexTtiRankedMacScheduler ();
+
+  virtual ~MmWaveFlexTtiRankedMacScheduler ();
+  virtual void DoDispose (void);
+  static TypeId GetTypeId (void);
+
+  virtual void SetMacSchedSapUser (MmWaveMacSchedSapUser* sap);
+  virtual void SetMacCschedSapUser (MmWaveMacCschedSapUser* s);
+
+  virtual MmWaveMacSchedSapProvider* GetMacSchedSapProvider ();
+  virtual MmWaveMacCschedSapProvider* GetMacCschedSapProvider ();
+
+  virtual void ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> config);
+
+  void RefreshDlCqiMaps (void);
+  void RefreshUlCqiMaps (void);
+
+  //
+  // Implementation of the CSCHED API primitives
+  // (See 4.1 for description of the primitives)
+  //
+
+  void DoCschedCellConfigReq (const struct MmWaveMacCschedSapProvider::CschedCellConfigReqParameters& params);
+
+  void DoCschedUeConfigReq (const struct MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params);
+
+  void DoCschedLcConfigReq (const struct MmWaveMacCschedSapProvider::CschedLcConfigReqParameters& params);
+
+  void DoCschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params);
+
+  void DoCschedUeReleaseReq (const struct MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters& params);
+
+  //
+  // Implementation of the SCHED API primitives
+  // (See 4.2 for description of the primitives)
+  //
+
+  void DoSchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params);
+
+  void DoSchedDlCqiInfoReq (const MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters& params);
+
+  void DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params);
+
+  void DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params);
+
+  void DoSchedTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params);
+
+  void DoSchedSetMcs (int mcs);
+
+private:
+  uint32_t
+  BsrId2BufferSize (uint8_t val)
+  {
+    NS_ABORT_MSG_UNLESS (val < 64, "val = " << val << " is out of range");
+    return BufferSizeLevelBsrTable[val];
+  }
+
+  uint8_t UpdateDlHarqProcessId (MmWaveFlexTtiUeSchedInfo *ue);
+  uint8_t UpdateUlHarqProcessId (MmWaveFlexTtiUeSchedInfo *ue);
+
+  /**
+   * \brief Refresh HARQ processes according to the timers
+   *
+   */
+  void RefreshHarqProcesses ();
+
+  /**
+   * Compute the DL and UL MCS of all the UEs from their last CQIs
+   */
+  void UpdateLinkAdaptation ();
+
+  /**
+   * Collect the UEs allocated in the current subframe, in order of RNTI
+   */
+  void CollectAllocatedUes ();
+
+  /**
+   * Add the UL control slot and send the allocation of the subframe to the MAC
+   */
+  void SendSchedConfigInd (MmWaveMacSchedSapUser::SchedConfigIndParameters &ret);
+
+  NS_LOG_TEMPLATE_DECLARE;
+
+  Ptr<MmWaveAmc> m_amc;
+
+  uint32_t m_cqiTimersThreshold;       // # of TTIs for which a CQI can be considered valid
+
+  MmWaveFlexTtiUeTable m_ueTable;
+  std::vector<MmWaveFlexTtiUeSchedInfo*> m_allocatedUes;        // allocated in the current subframe
+
+  uint8_t m_tbUid;
+
+  MmWaveMacSchedSapProvider* m_macSchedSapProvider;
+  MmWaveMacSchedSapUser* m_macSchedSapUser;
+  MmWaveMacCschedSapUser* m_macCschedSapUser;
+  MmWaveMacCschedSapProvider* m_macCschedSapProvider;
+
+  MmWaveMacCschedSapProvider::CschedCellConfigReqParameters m_cschedCellConfig;
+
+  struct AllocMapElem
+  {
+    AllocMapElem (std::vector<uint16_t> rntiMap, uint8_t nSym, uint32_t tbs)
+      : m_rntiPerChunk (rntiMap),
+        m_numSym (nSym),
+        m_tbSize (tbs)
+    {
+    }
+
+    std::vector <uint16_t> m_rntiPerChunk;
+    uint8_t m_numSym;
+    uint32_t m_tbSize;
+  };
+  /*
+   * Map of previous allocated UE per RBG
+   * (used to retrieve info from UL-CQI)
+   */
+  std::map <uint32_t, struct AllocMapElem> m_ulAllocationMap;
+
+  // HARQ attributes
+  /**
+   * m_harqOn when false inhibit te HARQ mechanisms (by default active)
+   */
+  bool m_harqOn;
+  std::vector <DlHarqInfo> m_dlHarqInfoList;       // HARQ retx buffered
+  std::vector <UlHarqInfo> m_ulHarqInfoList;       // HARQ retx buffered
+  std::vector <DlHarqInfo> m_dlHarqInfoUntxed;     // TBs not retransmitted in the current subframe,
+  std::vector <UlHarqInfo> m_ulHarqInfoUntxed;     // kept across calls to reuse their storage
+
+  Ptr<SpectrumValue> m_ulSinr;       // UL-CQI of a UE, reused by UpdateLinkAdaptation
+
+  //for testing
+  bool m_fixedMcsDl;
+  bool m_fixedMcsUl;
+  uint8_t m_mcsDefaultDl;
+  uint8_t m_mcsDefaultUl;
+  bool m_dlOnly;
+  bool m_ulOnly;
+
+  bool m_fixedTti;                      // one slot per TTI
+  uint8_t m_symPerSlot;                 // symbols per slot
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MODEL_MMWAVE_FLEX_TTI_RANKED_MAC_SCHEDULER_H_ */
@@ -43,9 +43,7 @@ namespace mmwave {
 
 
 mmWaveInterference::mmWaveInterference ()
-  : m_receiving (false),
-    m_lastSignalId (0),
-    m_lastSignalIdBeforeReset (0)
+  : m_receiving (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -61,9 +59,11 @@ mmWaveInterference::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_PowerChunkProcessorList.clear ();
   m_sinrChunkProcessorList.clear ();
+  CancelEndingSignals ();
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_sinr = 0;
   Object::DoDispose ();
 }
 
@@ -138,17 +138,13 @@ mmWaveInterference::AddSignal (Ptr<const SpectrumValue> spd, const Time duration
 {
   NS_LOG_FUNCTION (this << *spd << duration);
   DoAddSignal (spd);
-  uint32_t signalId = ++m_lastSignalId;
-  if (signalId == m_lastSignalIdBeforeReset)
+  // the signals of the same slot end together, so they share the event
+  EndingSignals &ending = m_endingSignals[Now () + duration];
+  if (ending.m_signals.empty ())
     {
-      // This happens when m_lastSignalId eventually wraps around. Given that so
-      // many signals have elapsed since the last reset, we hope that by now there is
-      // no stale pending signal (i.e., a signal that was scheduled
-      // for subtraction before the reset). So we just move the
-      // boundary further.
-      m_lastSignalIdBeforeReset += 0x10000000;
+      ending.m_event = Simulator::Schedule (duration, &mmWaveInterference::DoSubtractSignals, this);
     }
-  Simulator::Schedule (duration, &mmWaveInterference::DoSubtractSignal, this, spd, signalId);
+  ending.m_signals.push_back (spd);
 }
 
 
@@ -161,19 +157,30 @@ mmWaveInterference::DoAddSignal  (Ptr<const SpectrumValue> spd)
 }
 
 void
-mmWaveInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId)
+mmWaveInterference::DoSubtractSignals ()
 {
-  NS_LOG_FUNCTION (this << *spd);
+  NS_LOG_FUNCTION (this);
   ConditionallyEvaluateChunk ();
-  int32_t deltaSignalId = signalId - m_lastSignalIdBeforeReset;
-  if (deltaSignalId > 0)
+  std::map<Time, EndingSignals>::iterator it = m_endingSignals.find (Now ());
+  NS_ASSERT (it != m_endingSignals.end ());
+  const std::vector<Ptr<const SpectrumValue> > &signals = it->second.m_signals;
+  NS_LOG_LOGIC (this << " removing " << signals.size () << " signals");
+  for (std::vector<Ptr<const SpectrumValue> >::const_iterator sIt = signals.begin (); sIt != signals.end (); ++sIt)
     {
-      (*m_allSignals) -= (*spd);
+      (*m_allSignals) -= (**sIt);
     }
-  else
+  m_endingSignals.erase (it);
+}
+
+void
+mmWaveInterference::CancelEndingSignals ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Time, EndingSignals>::iterator it = m_endingSignals.begin (); it != m_endingSignals.end (); ++it)
     {
-      NS_LOG_INFO ("ignoring signal scheduled for subtraction before last reset");
+      it->second.m_event.Cancel ();
     }
+  m_endingSignals.clear ();
 }
 
 
@@ -189,16 +196,28 @@ mmWaveInterference::ConditionallyEvaluateChunk ()
   if (m_receiving && (Now () > m_lastChangeTime))
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
-      SpectrumValue sinr = (*m_rxSignal) / interf;
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_PowerChunkProcessorList.begin (); it != m_PowerChunkProcessorList.end (); ++it)
         {
           (*it)->EvaluateChunk (*m_rxSignal, duration);
         }
-      for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
+      if (!m_sinrChunkProcessorList.empty ())
         {
-          (*it)->EvaluateChunk (sinr, duration);
+          // sinr = signal / (allSignals - signal + noise), in a single pass
+          // over the bands and without temporary SpectrumValues
+          const double *signal = &(*m_rxSignal->ConstValuesBegin ());
+          const double *all = &(*m_allSignals->ConstValuesBegin ());
+          const double *noise = &(*m_noise->ConstValuesBegin ());
+          double *sinr = &(*m_sinr->ValuesBegin ());
+          const size_t numBands = m_sinr->GetSpectrumModel ()->GetNumBands ();
+          for (size_t i = 0; i < numBands; ++i)
+            {
+              sinr[i] = signal[i] / (all[i] - signal[i] + noise[i]);
+            }
+          for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
+            {
+              (*it)->EvaluateChunk (*m_sinr, duration);
+            }
         }
       m_lastChangeTime = Now ();
     }
@@ -211,12 +230,14 @@ mmWaveInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noise
   ConditionallyEvaluateChunk ();
   m_noise = noisePsd;
   m_allSignals = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  m_sinr = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
   if (m_receiving == true)
     {
       // abort rx
       m_receiving = false;
     }
-  m_lastSignalIdBeforeReset = m_lastSignalId;
+  // the signals added before the reset are not in the new sum
+  CancelEndingSignals ();
 }
 
 void
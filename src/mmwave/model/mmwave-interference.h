@@ -33,8 +33,11 @@
 #include <ns3/object.h>
 #include <ns3/packet.h>
 #include <ns3/nstime.h>
+#include <ns3/event-id.h>
 #include <ns3/spectrum-value.h>
 #include <string.h>
+#include <map>
+#include <vector>
 #include <ns3/mmwave-chunk-processor.h>
 
 
@@ -42,6 +45,14 @@ namespace ns3 {
 
 namespace mmwave {
 
+/**
+ * Keeps the sum of the signals on the channel and evaluates the power and
+ * the SINR of the chunks of the signal being received.
+ *
+ * The signals ending at the same time are removed from the sum by a single
+ * event, and the SINR is computed in a preallocated SpectrumValue only when
+ * a SINR chunk processor is installed.
+ */
 class mmWaveInterference : public Object
 {
 public:
@@ -57,9 +68,26 @@ public:
   void AddSinrChunkProcessor (Ptr<mmWaveChunkProcessor> p);
 
 private:
+  /**
+   * The signals ending at the same time, subtracted from the sum in the
+   * order they were added
+   */
+  struct EndingSignals
+  {
+    std::vector<Ptr<const SpectrumValue> > m_signals;
+    EventId m_event;
+  };
+
   void ConditionallyEvaluateChunk ();
   void DoAddSignal (Ptr<const SpectrumValue> spd);
-  void DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId);
+  /**
+   * Subtract from the sum all the signals ending now
+   */
+  void DoSubtractSignals ();
+  /**
+   * Drop the pending subtractions, when the sum is reset
+   */
+  void CancelEndingSignals ();
   std::list<Ptr<mmWaveChunkProcessor> > m_PowerChunkProcessorList;
   std::list<Ptr<mmWaveChunkProcessor> > m_sinrChunkProcessorList;
 
@@ -69,11 +97,11 @@ private:
   Ptr<SpectrumValue> m_rxSignal;
   Ptr<SpectrumValue> m_allSignals;
   Ptr<const SpectrumValue> m_noise;
+  Ptr<SpectrumValue> m_sinr;        ///< SINR of the last chunk, reused at each chunk
 
   Time m_lastChangeTime;
 
-  uint32_t m_lastSignalId;
-  uint32_t m_lastSignalIdBeforeReset;
+  std::map<Time, EndingSignals> m_endingSignals;        ///< the signals on the channel, by end time
 };
 
 } // namespace mmwave
@@ -0,0 +1,60 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "mmwave-link-table.h"
+
+namespace ns3 {
+
+namespace mmwave {
+
+const uint32_t MmWaveDeviceRegistry::INVALID_INDEX;
+
+uint32_t
+MmWaveDeviceRegistry::Register (Ptr<NetDevice> device)
+{
+  uint32_t index = GetIndex (device);
+  if (index == INVALID_INDEX)
+    {
+      index = m_devices.size ();
+      m_indexMap.Get ((uintptr_t) PeekPointer (device)) = index;
+      m_devices.push_back (device);
+    }
+  return index;
+}
+
+uint32_t
+MmWaveDeviceRegistry::GetIndex (Ptr<const NetDevice> device) const
+{
+  const uint32_t *index = m_indexMap.Find ((uintptr_t) PeekPointer (device));
+  if (index == 0)
+    {
+      return INVALID_INDEX;
+    }
+  return *index;
+}
+
+void
+MmWaveDeviceRegistry::Clear ()
+{
+  m_indexMap.Clear ();
+  m_devices.clear ();
+}
+
+} // namespace mmwave
+} // namespace ns3
@@ -0,0 +1,323 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef MMWAVE_LINK_TABLE_H_
+#define MMWAVE_LINK_TABLE_H_
+
+#include <ns3/ptr.h>
+#include <ns3/net-device.h>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \brief Hash table with 64 bit keys, open addressing and linear probing.
+ *
+ * The keys, the state of the slots and the values are stored in three
+ * contiguous arrays, whose size is a power of two. A pointer or a reference
+ * to a value is valid until the next insertion.
+ */
+template <typename V>
+class MmWaveFlatHashMap
+{
+public:
+  MmWaveFlatHashMap ()
+    : m_size (0),
+      m_used (0)
+  {
+  }
+
+  /**
+   * @param the key
+   * @returns a pointer to the value of the key, or 0 if the key is not in the table
+   */
+  V* Find (uint64_t key)
+  {
+    if (m_size == 0)
+      {
+        return 0;
+      }
+    uint64_t mask = m_keys.size () - 1;
+    for (uint64_t i = Hash (key) & mask; ; i = (i + 1) & mask)
+      {
+        if (m_states[i] == EMPTY)
+          {
+            return 0;
+          }
+        if (m_states[i] == FULL && m_keys[i] == key)
+          {
+            return &m_values[i];
+          }
+      }
+  }
+  const V* Find (uint64_t key) const
+  {
+    return const_cast<MmWaveFlatHashMap*> (this)->Find (key);
+  }
+
+  /**
+   * @param the key
+   * @returns a reference to the value of the key, which is default
+   * constructed if the key is not in the table
+   */
+  V& Get (uint64_t key)
+  {
+    V *value = Find (key);
+    if (value != 0)
+      {
+        return *value;
+      }
+    if ((m_used + 1) * 4 > m_keys.size () * 3)
+      {
+        // grow, or just drop the erased slots if they are many
+        Rehash (m_size * 2 < m_keys.size () ? m_keys.size () : std::max<uint64_t> (16, m_keys.size () * 2));
+      }
+    uint64_t mask = m_keys.size () - 1;
+    uint64_t i = Hash (key) & mask;
+    while (m_states[i] == FULL)
+      {
+        i = (i + 1) & mask;
+      }
+    if (m_states[i] == EMPTY)
+      {
+        m_used++;
+      }
+    m_size++;
+    m_states[i] = FULL;
+    m_keys[i] = key;
+    m_values[i] = V ();
+    return m_values[i];
+  }
+
+  /**
+   * @param the key
+   * @returns true if the key was in the table
+   */
+  bool Erase (uint64_t key)
+  {
+    V *value = Find (key);
+    if (value == 0)
+      {
+        return false;
+      }
+    uint64_t i = value - &m_values[0];
+    m_states[i] = ERASED;
+    m_values[i] = V ();
+    m_size--;
+    return true;
+  }
+
+  /**
+   * Remove all the keys
+   */
+  void Clear ()
+  {
+    m_keys.clear ();
+    m_states.clear ();
+    m_values.clear ();
+    m_size = 0;
+    m_used = 0;
+  }
+
+  /**
+   * @returns the number of keys in the table
+   */
+  uint64_t GetSize () const
+  {
+    return m_size;
+  }
+
+  /**
+   * @returns the number of slots of the table
+   */
+  uint64_t GetCapacity () const
+  {
+    return m_keys.size ();
+  }
+
+private:
+  enum SlotState
+  {
+    EMPTY = 0,
+    FULL,
+    ERASED
+  };
+
+  static uint64_t Hash (uint64_t key)
+  {
+    // finalizer of MurmurHash3, so that the low bits depend on all the bits of the key
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  void Rehash (uint64_t capacity)
+  {
+    std::vector<uint64_t> keys (capacity);
+    std::vector<uint8_t> states (capacity, EMPTY);
+    std::vector<V> values (capacity);
+    uint64_t mask = capacity - 1;
+    for (uint64_t j = 0; j < m_keys.size (); j++)
+      {
+        if (m_states[j] == FULL)
+          {
+            uint64_t i = Hash (m_keys[j]) & mask;
+            while (states[i] == FULL)
+              {
+                i = (i + 1) & mask;
+              }
+            states[i] = FULL;
+            keys[i] = m_keys[j];
+            values[i] = m_values[j];
+          }
+      }
+    m_keys.swap (keys);
+    m_states.swap (states);
+    m_values.swap (values);
+    m_used = m_size;
+  }
+
+  std::vector<uint64_t> m_keys;
+  std::vector<uint8_t> m_states;
+  std::vector<V> m_values;
+  uint64_t m_size;        // number of FULL slots
+  uint64_t m_used;        // number of FULL or ERASED slots
+};
+
+/**
+ * \brief Assigns a small integer to each NetDevice, in order of registration,
+ * so that the state of a link can be indexed by a pair of integers instead
+ * of a pair of Ptr<NetDevice>.
+ */
+class MmWaveDeviceRegistry
+{
+public:
+  /**
+   * Index returned by GetIndex for the devices never registered
+   */
+  static const uint32_t INVALID_INDEX = 0xffffffff;
+
+  /**
+   * @param the device
+   * @returns the index of the device, which is assigned if the device was not registered yet
+   */
+  uint32_t Register (Ptr<NetDevice> device);
+
+  /**
+   * @param the device
+   * @returns the index of the device, or INVALID_INDEX if the device was never registered
+   */
+  uint32_t GetIndex (Ptr<const NetDevice> device) const;
+
+  /**
+   * @param the index of a device
+   * @returns the device
+   */
+  Ptr<NetDevice> GetDevice (uint32_t index) const
+  {
+    return m_devices[index];
+  }
+
+  /**
+   * Forget all the devices
+   */
+  void Clear ();
+
+private:
+  MmWaveFlatHashMap<uint32_t> m_indexMap;
+  std::vector<Ptr<NetDevice> > m_devices;
+};
+
+/**
+ * \brief The state of the links between pairs of devices registered in a
+ * MmWaveDeviceRegistry. A link is directed, i.e., (a, b) and (b, a) are two
+ * different links.
+ */
+template <typename T>
+class MmWaveLinkTable
+{
+public:
+  /**
+   * @param the index of the first device
+   * @param the index of the second device
+   * @returns a pointer to the state of the link, or 0 if the link is not in the table
+   */
+  T* Find (uint32_t a, uint32_t b)
+  {
+    return m_links.Find (Key (a, b));
+  }
+  const T* Find (uint32_t a, uint32_t b) const
+  {
+    return m_links.Find (Key (a, b));
+  }
+
+  /**
+   * @param the index of the first device
+   * @param the index of the second device
+   * @returns a reference to the state of the link, which is default
+   * constructed if the link is not in the table
+   */
+  T& Get (uint32_t a, uint32_t b)
+  {
+    return m_links.Get (Key (a, b));
+  }
+
+  /**
+   * @param the index of the first device
+   * @param the index of the second device
+   * @returns true if the link was in the table
+   */
+  bool Erase (uint32_t a, uint32_t b)
+  {
+    return m_links.Erase (Key (a, b));
+  }
+
+  /**
+   * Remove all the links
+   */
+  void Clear ()
+  {
+    m_links.Clear ();
+  }
+
+  uint64_t GetSize () const
+  {
+    return m_links.GetSize ();
+  }
+
+private:
+  static uint64_t Key (uint32_t a, uint32_t b)
+  {
+    return ((uint64_t) a << 32) | b;
+  }
+
+  MmWaveFlatHashMap<T> m_links;
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* MMWAVE_LINK_TABLE_H_ */
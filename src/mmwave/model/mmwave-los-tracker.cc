@@ -85,17 +85,20 @@ MmWaveLosTracker::UpdateLosNlosState (Ptr<MobilityModel> a, Ptr<MobilityModel> b
 
   /*Determine LOS or NLOS*/
   bool los = true;
+  // the positions do not change while the buildings are checked
+  Vector positionA = a->GetPosition ();
+  Vector positionB = b->GetPosition ();
   for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
     {
       Box boundaries = (*bit)->GetBoundaries ();
-      Vector locationA = a->GetPosition ();
-      Vector locationB = b->GetPosition ();
+      Vector locationA = positionA;
+      Vector locationB = positionB;
       Angles pathAngles (locationB, locationA);
       double angle = pathAngles.phi;
       if (angle >= M_PI / 2 || angle < -M_PI / 2)
         {
-          locationA = b->GetPosition ();
-          locationB = a->GetPosition ();
+          locationA = positionB;
+          locationB = positionA;
           Angles pathAngles (locationB, locationA);
           angle = pathAngles.phi;
         }
@@ -118,7 +118,12 @@ public:
     std::map<uint16_t, SchedInfo> m_schedInfoMap;
   };
 
-  virtual void SchedConfigInd (const struct SchedConfigIndParameters& params) = 0;
+  /**
+   * Give the allocation of a subframe to the MAC, which takes the ownership
+   * of the slot lists instead of copying them
+   * @param the allocation, moved from
+   */
+  virtual void SchedConfigInd (struct SchedConfigIndParameters&& params) = 0;
 private:
 };
 
@@ -38,8 +38,15 @@
 #include <stdint.h>
 #include <cmath>
 #include <stdint.h>
+#include <algorithm>
 #include "stdlib.h"
 #include "mmwave-mi-error-model.h"
+#include "mmwave-beamforming-kernels.h"
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+#define MMWAVE_MI_KERNELS_X86 1
+#include <immintrin.h>
+#endif
 
 
 
@@ -50,141 +57,240 @@ namespace ns3 {
 namespace mmwave {
 
 
+/*
+ * The MI of a RB is read from the table of the modulation of the TB, whose
+ * axis is uniformly spaced: index = ((sinrLin - axis[0]) / (axis[SIZE-1] - axis[0])) * (SIZE-1),
+ * and the MI is 1 above the last value of the axis
+ */
+struct MiTable
+{
+  const double *m_mi;
+  uint16_t m_size;
+  double m_minSinr;
+  double m_maxSinr;
+  double m_scale;
+};
+
+static const MiTable g_miTableQpsk = {
+  MI_map_qpsk, MMWAVE_MI_MAP_QPSK_SIZE,
+  MI_map_qpsk_axis[0], MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1],
+  (MMWAVE_MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1] - MI_map_qpsk_axis[0])
+};
+static const MiTable g_miTable16qam = {
+  MI_map_16qam, MMWAVE_MI_MAP_16QAM_SIZE,
+  MI_map_16qam_axis[0], MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1],
+  (MMWAVE_MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1] - MI_map_16qam_axis[0])
+};
+static const MiTable g_miTable64qam = {
+  MI_map_64qam, MMWAVE_MI_MAP_64QAM_SIZE,
+  MI_map_64qam_axis[0], MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1],
+  (MMWAVE_MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1] - MI_map_64qam_axis[0])
+};
+
+static const MiTable&
+GetMiTable (uint8_t mcs)
+{
+  if (mcs <= MMWAVE_MI_QPSK_MAX_ID)
+    {
+      return g_miTableQpsk;
+    }
+  if (mcs <= MMWAVE_MI_16QAM_MAX_ID)
+    {
+      return g_miTable16qam;
+    }
+  return g_miTable64qam;
+}
+
+static inline double
+GetRbMi (const MiTable &table, double sinrLin)
+{
+  if (sinrLin > table.m_maxSinr)
+    {
+      return 1;
+    }
+  double sinrIndexDouble = (sinrLin - table.m_minSinr) * table.m_scale + 1;
+  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
+  NS_ASSERT_MSG (sinrIndex < table.m_size, "MI map out of data");
+  return table.m_mi[sinrIndex];
+}
+
+static double
+MiSumScalar (const MiTable &table, const double *sinr, const int *map, uint32_t n)
+{
+  double sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += GetRbMi (table, sinr[map[i]]);
+    }
+  return sum;
+}
+
+#ifdef MMWAVE_MI_KERNELS_X86
+/*
+ * The SINRs of four RBs and their MIs are fetched with two gathers. The MIs
+ * are then added in the order of the map, so that the result is the same
+ * as the one of the scalar version. FMA is not enabled, so that the index
+ * is rounded as in the scalar version
+ */
+__attribute__ ((target ("avx2"))) static double
+MiSumAvx2 (const MiTable &table, const double *sinr, const int *map, uint32_t n)
+{
+  const __m256d one = _mm256_set1_pd (1);
+  const __m256d zero = _mm256_setzero_pd ();
+  const __m256d last = _mm256_set1_pd (table.m_size - 1);
+  const __m256d minSinr = _mm256_set1_pd (table.m_minSinr);
+  const __m256d maxSinr = _mm256_set1_pd (table.m_maxSinr);
+  const __m256d scale = _mm256_set1_pd (table.m_scale);
+  double mi[4];
+  double sum = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128i rb = _mm_loadu_si128 ((const __m128i*) (map + i));
+      __m256d s = _mm256_i32gather_pd (sinr, rb, 8);
+      __m256d index = _mm256_floor_pd (_mm256_add_pd (_mm256_mul_pd (_mm256_sub_pd (s, minSinr), scale), one));
+      // the index of the RBs above the axis is clamped, so that their gather stays in the table
+      index = _mm256_min_pd (_mm256_max_pd (index, zero), last);
+      __m256d v = _mm256_i32gather_pd (table.m_mi, _mm256_cvttpd_epi32 (index), 8);
+      v = _mm256_blendv_pd (v, one, _mm256_cmp_pd (s, maxSinr, _CMP_GT_OQ));
+      _mm256_storeu_pd (mi, v);
+      sum += mi[0];
+      sum += mi[1];
+      sum += mi[2];
+      sum += mi[3];
+    }
+  _mm256_zeroupper ();
+  for (; i < n; i++)
+    {
+      sum += GetRbMi (table, sinr[map[i]]);
+    }
+  return sum;
+}
+#endif
+
 double
 MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
 
-  double MI;
-  double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-
-  for (uint32_t i = 0; i < map.size (); i++)
+  // the table is selected once for the whole TB, and the SINR is read in place
+  const MiTable &table = GetMiTable (mcs);
+  const double *sinrLin = &(*sinr.ConstValuesBegin ());
+  double MIsum;
+  if (g_log.IsEnabled (ns3::LOG_LOGIC))
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MMWAVE_MI_QPSK_MAX_ID) // QPSK
+      MIsum = 0.0;
+      for (uint32_t i = 0; i < map.size (); i++)
         {
-
-          if (sinrLin > MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1])
-            {
-              MI = 1;
-            }
-          else
-            {
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-              static const double scalingCoeffQpsk =
-                (MMWAVE_MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-              uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
-            }
+          double MI = GetRbMi (table, sinrLin[map[i]]);
+          NS_LOG_LOGIC (" RB " << map[i] << "Minimum SNR = " << 10 * std::log10 (sinrLin[map[i]]) << " dB, " << sinrLin[map[i]] << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+          MIsum += MI;
         }
-      else
+    }
+#ifdef MMWAVE_MI_KERNELS_X86
+  else if (MmWaveBeamformingKernels::GetLevel () >= MmWaveBeamformingKernels::AVX2)
+    {
+      MIsum = MiSumAvx2 (table, sinrLin, map.data (), map.size ());
+    }
+#endif
+  else
+    {
+      MIsum = MiSumScalar (table, sinrLin, map.data (), map.size ());
+    }
+  double MI = MIsum / map.size ();
+  NS_LOG_LOGIC (" MI = " << MI);
+  return MI;
+}
+
+/*
+ * The parameters of the BLER curves of every (ECR, CB size) pair. The pairs
+ * without a curve (-1 in bEcrTable and cEcrTable) use the curve of the
+ * smallest larger CB size that has one, to remove the CB size quantization
+ * errors. The denominator of the erf argument is stored instead of c
+ */
+struct BlerCurve
+{
+  double m_b;
+  double m_sqrt2c;
+};
+
+static const BlerCurve&
+GetBlerCurve (uint8_t ecrId, int cbIndex)
+{
+  static struct BlerCurveTable
+  {
+    BlerCurveTable ()
+    {
+      for (int cb = 0; cb < 9; cb++)
         {
-          if (mcs > MMWAVE_MI_QPSK_MAX_ID && mcs <= MMWAVE_MI_16QAM_MAX_ID )    // 16-QAM
-            {
-              if (sinrLin > MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam =
-                    (MMWAVE_MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
-            }
-          else // 64-QAM
+          for (int ecr = 0; ecr <= MMWAVE_MI_64QAM_BLER_MAX_ID; ecr++)
             {
-              if (sinrLin > MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1])
+              double b = bEcrTable[cb][ecr];
+              for (int i = cb; (i < 9) && (b < 0); i++)
                 {
-                  MI = 1;
+                  b = bEcrTable[i][ecr];
                 }
-              else
+              double c = cEcrTable[cb][ecr];
+              for (int i = cb; (i < 9) && (c < 0); i++)
                 {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam =
-                    (MMWAVE_MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
+                  c = cEcrTable[i][ecr];
                 }
+              m_curves[cb][ecr].m_b = b;
+              m_curves[cb][ecr].m_sqrt2c = sqrt (2) * c;
             }
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
-      MIsum += MI;
     }
-  MI = MIsum / map.size ();
-  NS_LOG_LOGIC (" MI = " << MI);
-  return MI;
+    BlerCurve m_curves[9][MMWAVE_MI_64QAM_BLER_MAX_ID + 1];
+  } table;
+  return table.m_curves[cbIndex][ecrId];
 }
 
+// erf (x) is exactly +-1 in double precision for |x| >= 6
+static const double ERF_SATURATION = 6.0;
 
 double
 MmWaveMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
 {
   NS_LOG_FUNCTION (mib << (uint32_t) ecrId << (uint32_t) cbSize);
-  double b = 0;
-  double c = 0;
 
   NS_ASSERT_MSG (ecrId <= MMWAVE_MI_64QAM_BLER_MAX_ID, "ECR out of range [0..37]: " << (uint16_t) ecrId);
-  int cbIndex = 1;
-  while ((cbIndex < 9)&&(cbMiSizeTable[cbIndex] <= cbSize))
-    {
-      cbIndex++;
-    }
-  cbIndex--;
+  // the largest CB size of the curves not larger than cbSize, or the first one
+  int cbIndex = std::upper_bound (cbMiSizeTable + 1, cbMiSizeTable + 9, cbSize) - cbMiSizeTable - 1;
   NS_LOG_LOGIC (" ECRid " << (uint16_t)ecrId << " ECR " << BlerCurvesEcrMap[ecrId] << " CB size " << cbSize << " CB size curve " << cbMiSizeTable[cbIndex]);
 
-  b = bEcrTable[cbIndex][ecrId];
-  if (b < 0.0)
+  const BlerCurve &curve = GetBlerCurve (ecrId, cbIndex);
+  // see IEEE802.16m EMD formula 55 of section 4.3.2.1
+  double x = (mib - curve.m_b) / curve.m_sqrt2c;
+  double bler;
+  if (x >= ERF_SATURATION)
     {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i < 9)&&(b < 0))
-        {
-          b = bEcrTable[i++][ecrId];
-        }
+      bler = 0;
     }
-  c = cEcrTable[cbIndex][ecrId];
-  if (c < 0.0)
+  else if (x <= -ERF_SATURATION)
     {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i < 9)&&(c < 0))
-        {
-          c = cEcrTable[i++][ecrId];
-        }
+      bler = 1;
     }
-  // see IEEE802.16m EMD formula 55 of section 4.3.2.1
-  double bler = 0.5 * ( 1 - erf ((mib - b) / (sqrt (2) * c)) );
-  NS_LOG_LOGIC ("MIB: " << mib << " BLER:" << bler << " b:" << b << " c:" << c);
+  else
+    {
+      bler = 0.5 * ( 1 - erf (x) );
+    }
+  NS_LOG_LOGIC ("MIB: " << mib << " BLER:" << bler << " b:" << curve.m_b << " c:" << curve.m_sqrt2c / sqrt (2));
   return bler;
 }
 
 MmWaveTbStats_t
-MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
+MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, const MmWaveHarqProcessInfoList_t& miHistory)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
 
-  double tbMi = Mib (sinr, map, mcs);
+  return GetTbDecodificationStats (Mib (sinr, map, mcs), size, mcs, miHistory);
+}
+
+MmWaveTbStats_t
+MmWaveMiErrorModel::GetTbDecodificationStats (double tbMi, uint32_t size, uint8_t mcs, const MmWaveHarqProcessInfoList_t& miHistory)
+{
+  NS_LOG_FUNCTION (tbMi << (uint32_t) size << (uint32_t) mcs);
+
   double MI = 0.0;
   double Reff = 0.0;
   NS_ASSERT (mcs < 29);
@@ -334,6 +334,10 @@ public:
    * \param map the actives RBs for the TB
    * \param mcs the MCS of the TB
    * \return the mmib
+   *
+   * The MI table of the modulation is selected once per TB, and the MIs of
+   * the RBs are fetched with vector gathers when the AVX2 or AVX-512
+   * kernels are selected (see MmWaveBeamformingKernels::SetLevel)
    */
   static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
   /**
@@ -342,6 +346,9 @@ public:
    * \param ecrId Effective Code Rate ID
    * \param cbSize the size of the CB
    * \return the code block error rate
+   *
+   * The parameters of the curves of all the (ECR, CB size) pairs are resolved
+   * once, and erf is not evaluated where it saturates
    */
   static double MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize);
 
@@ -353,7 +360,16 @@ public:
    * \param mcs the MCS of the TB
    * \return the TB error rate and MI
    */
-  static MmWaveTbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory);
+  static MmWaveTbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, const MmWaveHarqProcessInfoList_t& miHistory);
+
+  /**
+   * \brief run the error-model algorithm for a TB whose MI is already known
+   * \param tbMi the mmib of the TB, as returned by Mib
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \return the TB error rate and MI
+   */
+  static MmWaveTbStats_t GetTbDecodificationStats (double tbMi, uint32_t size, uint8_t mcs, const MmWaveHarqProcessInfoList_t& miHistory);
 
 
 //private:
@@ -55,7 +55,10 @@ public:
 
   virtual void SendRachPreamble (uint8_t PreambleId, uint8_t Rnti) = 0;
 
-  virtual void SetDlSfAllocInfo (SfAllocInfo sfAllocInfo) = 0;
+  /**
+   * @param the allocation of a subframe, moved from
+   */
+  virtual void SetDlSfAllocInfo (SfAllocInfo&& sfAllocInfo) = 0;
 
   virtual void SetUlSfAllocInfo (SfAllocInfo sfAllocInfo) = 0;
 };
@@ -44,6 +44,7 @@
 #include "mmwave-mac-pdu-header.h"
 #include <sstream>
 #include <vector>
+#include <utility>
 
 namespace ns3 {
 
@@ -65,7 +66,7 @@ public:
 
   virtual void SendRachPreamble (uint8_t PreambleId, uint8_t Rnti);
 
-  virtual void SetDlSfAllocInfo (SfAllocInfo sfAllocInfo);
+  virtual void SetDlSfAllocInfo (SfAllocInfo&& sfAllocInfo);
 
   virtual void SetUlSfAllocInfo (SfAllocInfo sfAllocInfo);
 
@@ -98,9 +99,9 @@ MmWaveMemberPhySapProvider::SendRachPreamble (uint8_t PreambleId, uint8_t Rnti)
 }
 
 void
-MmWaveMemberPhySapProvider::SetDlSfAllocInfo (SfAllocInfo sfAllocInfo)
+MmWaveMemberPhySapProvider::SetDlSfAllocInfo (SfAllocInfo&& sfAllocInfo)
 {
-  m_phy->SetDlSfAllocInfo (sfAllocInfo);
+  m_phy->SetDlSfAllocInfo (std::move (sfAllocInfo));
 }
 
 void
@@ -331,13 +332,13 @@ MmWavePhy::GetSfAllocInfo (uint8_t subframeNum)
 }
 
 void
-MmWavePhy::SetDlSfAllocInfo (SfAllocInfo sfAllocInfo)
+MmWavePhy::SetDlSfAllocInfo (SfAllocInfo&& sfAllocInfo)
 {
   // get previously enqueued SfAllocInfo and set DL slot allocations
   //SfAllocInfo &sf = m_sfAllocInfo[sfAllocInfo.m_sfnSf.m_sfNum];
   // merge slot lists
   //sf.m_dlSlotAllocInfo = sfAllocInfo.m_dlSlotAllocInfo;
-  m_sfAllocInfo[sfAllocInfo.m_sfnSf.m_sfNum] = sfAllocInfo;
+  m_sfAllocInfo[sfAllocInfo.m_sfnSf.m_sfNum] = std::move (sfAllocInfo);
   //m_sfAllocInfoUpdated = true;
 }
 
@@ -122,7 +122,7 @@ public:
   void UpdateCurrentAllocationAndSchedule (uint32_t frame, uint32_t sf);
 
   SfAllocInfo GetSfAllocInfo (uint8_t subframeNum);
-  void SetDlSfAllocInfo (SfAllocInfo sfAllocInfo);
+  void SetDlSfAllocInfo (SfAllocInfo&& sfAllocInfo);
   void SetUlSfAllocInfo (SfAllocInfo sfAllocInfo);
 
   // hacks needed to compute SINR at eNB for each UE, without pilots
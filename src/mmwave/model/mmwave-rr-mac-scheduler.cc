@@ -34,6 +34,7 @@
 //#include "mmwave-mac-scheduler.h"
 #include <ns3/lte-common.h>
 #include <ns3/boolean.h>
+#include <utility>
 
 namespace ns3 {
 
@@ -1524,7 +1525,7 @@ MmWaveRrMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProvider:
         }
     }
 
-  m_macSchedSapUser->SchedConfigInd (ret);
+  m_macSchedSapUser->SchedConfigInd (std::move (ret));
   return;
 }
 
@@ -95,7 +95,8 @@ static const double EffectiveCodingRate[29] = {
 };
 
 MmWaveSpectrumPhy::MmWaveSpectrumPhy ()
-  : m_cellId (0),
+  : m_interferenceCullingDb (0),
+    m_cellId (0),
     m_state (IDLE),
     m_componentCarrierId (0)
 {
@@ -135,6 +136,13 @@ MmWaveSpectrumPhy::GetTypeId (void)
                    StringValue ("no"),
                    MakeStringAccessor (&MmWaveSpectrumPhy::m_fileName),
                    MakeStringChecker ())
+    .AddAttribute ("InterferenceCullingDb",
+                   "The data signals of the other cells that cannot increase the interference plus noise "
+                   "of any band by more than this value (in dB), given the upper bound of their BF gain, "
+                   "are dropped by the channel before the BF gain is computed. 0 disables the culling",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&MmWaveSpectrumPhy::m_interferenceCullingDb),
+                   MakeDoubleChecker<double> (0))
   ;
 
   return tid;
@@ -247,6 +255,7 @@ MmWaveSpectrumPhy::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noiseP
   NS_LOG_FUNCTION (this << noisePsd);
   NS_ASSERT (noisePsd);
   m_rxSpectrumModel = noisePsd->GetSpectrumModel ();
+  m_noisePsd = noisePsd;
   m_interferenceData->SetNoisePowerSpectralDensity (noisePsd);
 
 }
@@ -392,6 +401,54 @@ MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
     }
 }
 
+bool
+MmWaveSpectrumPhy::CanNeglectRx (void) const
+{
+  return m_interferenceCullingDb > 0 && m_noisePsd != 0;
+}
+
+bool
+MmWaveSpectrumPhy::IsNegligibleRx (Ptr<const SpectrumSignalParameters> params, double maxGainDb) const
+{
+  if (m_interferenceCullingDb <= 0 || m_noisePsd == 0)
+    {
+      return false;
+    }
+
+  // the same checks of StartRx, on the signals that it ignores
+  bool enbTx = DynamicCast<MmWaveEnbNetDevice> (params->txPhy->GetDevice ()) != 0;
+  bool enbRx = DynamicCast<MmWaveEnbNetDevice> (m_device) != 0;
+  if (enbTx == enbRx)
+    {
+      return true;
+    }
+  Ptr<const MmWaveSpectrumSignalParametersDlCtrlFrame> dlCtrlParams =
+    DynamicCast<const MmWaveSpectrumSignalParametersDlCtrlFrame> (params);
+  if (dlCtrlParams != 0)
+    {
+      return dlCtrlParams->cellId != m_cellId;
+    }
+  Ptr<const MmwaveSpectrumSignalParametersDataFrame> dataParams =
+    DynamicCast<const MmwaveSpectrumSignalParametersDataFrame> (params);
+  if (dataParams == 0 || dataParams->cellId == m_cellId)
+    {
+      return false;
+    }
+
+  // the interferer is neglected if, in every band, psd * maxGain <= noise * (10^(culling/10) - 1)
+  double maxRatio = (std::pow (10.0, m_interferenceCullingDb / 10) - 1) / std::pow (10.0, maxGainDb / 10);
+  Values::const_iterator noiseIt = m_noisePsd->ConstValuesBegin ();
+  for (Values::const_iterator it = params->psd->ConstValuesBegin (); it != params->psd->ConstValuesEnd (); ++it, ++noiseIt)
+    {
+      if (*it > *noiseIt * maxRatio)
+        {
+          return false;
+        }
+    }
+  NS_LOG_LOGIC ("neglecting the interferer of cell " << dataParams->cellId);
+  return true;
+}
+
 void
 MmWaveSpectrumPhy::StartRxData (Ptr<MmwaveSpectrumSignalParametersDataFrame> params)
 {
@@ -132,6 +132,21 @@ public:
   void SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noisePsd);
   void SetTxPowerSpectralDensity (Ptr<SpectrumValue> TxPsd);
   void StartRx (Ptr<SpectrumSignalParameters> params);
+  /**
+   * Inherited from SpectrumPhy. The signals that StartRx would ignore are
+   * negligible, as well as the data signals of the other cells that cannot
+   * raise the interference plus noise of any band by more than the
+   * InterferenceCullingDb attribute. Nothing is neglected if the attribute is 0.
+   * @param params the parameters of the signal, before the BF gain
+   * @param maxGainDb the upper bound of the BF gain
+   * @returns true if the signal can be neglected
+   */
+  bool IsNegligibleRx (Ptr<const SpectrumSignalParameters> params, double maxGainDb) const;
+  /**
+   * Inherited from SpectrumPhy
+   * @returns true if the InterferenceCullingDb attribute is not 0
+   */
+  bool CanNeglectRx (void) const;
   void StartRxData (Ptr<MmwaveSpectrumSignalParametersDataFrame> params);
   void StartRxCtrl (Ptr<SpectrumSignalParameters> params);
   Ptr<SpectrumChannel> GetSpectrumChannel ();
@@ -173,6 +188,8 @@ private:
   void EndRxCtrl ();
 
   Ptr<mmWaveInterference> m_interferenceData;
+  Ptr<const SpectrumValue> m_noisePsd;
+  double m_interferenceCullingDb;       // increase of the interference plus noise that an interferer may cause and still be neglected
   Ptr<MobilityModel> m_mobility;
   Ptr<NetDevice> m_device;
   Ptr<SpectrumChannel> m_channel;
@@ -0,0 +1,422 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/antenna-array-model.h"
+#include "ns3/mmwave-channel-tensor.h"
+#include "ns3/mmwave-beam-codebook.h"
+
+using namespace ns3;
+using namespace mmwave;
+
+typedef std::vector< std::complex<double> > complexVector_t;
+
+/**
+ * @param the channel
+ * @param the tx beamforming vector
+ * @param the rx beamforming vector
+ * @returns sum_n |w_rx^H H_n w_tx|^2, computed element by element
+ */
+static double
+BruteForceGain (const MmWaveChannelTensor &channel, const complexVector_t &txW, const complexVector_t &rxW)
+{
+  double gain = 0;
+  for (uint8_t n = 0; n < channel.GetNumCluster (); n++)
+    {
+      std::complex<double> sum (0, 0);
+      for (uint16_t u = 0; u < channel.GetRxSize (); u++)
+        {
+          for (uint16_t s = 0; s < channel.GetTxSize (); s++)
+            {
+              sum += std::conj (rxW[u]) * channel.Get (u, s, n) * txW[s];
+            }
+        }
+      gain += std::norm (sum);
+    }
+  return gain;
+}
+
+/**
+ * @param the channel
+ * @param the codebook of the transmitter
+ * @param the beams of the transmitter to evaluate
+ * @param the codebook of the receiver
+ * @param the beams of the receiver to evaluate
+ * @returns the first pair, in the order of the sweep, with the maximum BruteForceGain
+ */
+static MmWaveBeamSearch::Result
+BruteForceSearch (const MmWaveChannelTensor &channel,
+                  const MmWaveBeamCodebook &txCodebook, const std::vector<uint16_t> &txBeams,
+                  const MmWaveBeamCodebook &rxCodebook, const std::vector<uint16_t> &rxBeams)
+{
+  MmWaveBeamSearch::Result best = {0, 0, 0};
+  for (uint16_t t : txBeams)
+    {
+      for (uint16_t r : rxBeams)
+        {
+          double gain = BruteForceGain (channel, txCodebook.GetBeam (t), rxCodebook.GetBeam (r));
+          if (best.m_gain < gain)
+            {
+              best.m_txBeam = t;
+              best.m_rxBeam = r;
+              best.m_gain = gain;
+            }
+        }
+    }
+  return best;
+}
+
+/**
+ * @param the codebook
+ * @returns all the beams of the codebook
+ */
+static std::vector<uint16_t>
+AllBeams (const MmWaveBeamCodebook &codebook)
+{
+  std::vector<uint16_t> beams;
+  for (uint16_t beam = 0; beam < codebook.GetNumBeams (); beam++)
+    {
+      beams.push_back (beam);
+    }
+  return beams;
+}
+
+/**
+ * @param the codebook
+ * @returns the beams of the coarse codebook of MmWaveBeamSearch::Hierarchical:
+ * one sector every two, plus the last one, and the elevations 60, 90 and 120 degrees
+ */
+static std::vector<uint16_t>
+CoarseBeams (const MmWaveBeamCodebook &codebook)
+{
+  std::vector<uint16_t> beams;
+  for (uint16_t beam = 0; beam < codebook.GetNumBeams (); beam++)
+    {
+      uint16_t sector = codebook.GetSector (beam);
+      double elevation = codebook.GetElevation (beam);
+      bool coarseSector = (sector % 2 == 0) || (sector == codebook.GetNumSectors () - 1);
+      bool coarseElevation = (elevation == 60) || (elevation == 90) || (elevation == 120);
+      if (coarseSector && coarseElevation)
+        {
+          beams.push_back (beam);
+        }
+    }
+  return beams;
+}
+
+/**
+ * @param the channel to fill with independent coefficients, uniform in [-1, 1]
+ * @param the number of rx antenna elements
+ * @param the number of tx antenna elements
+ * @param the number of clusters
+ * @param the stream of the random variable
+ */
+static void
+FillRandomChannel (MmWaveChannelTensor &channel, uint16_t rxSize, uint16_t txSize, uint8_t numCluster,
+                   int64_t stream)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (stream);
+  uniform->SetAttribute ("Min", DoubleValue (-1));
+  uniform->SetAttribute ("Max", DoubleValue (1));
+  channel.Resize (rxSize, txSize, numCluster);
+  for (uint16_t u = 0; u < rxSize; u++)
+    {
+      for (uint16_t s = 0; s < txSize; s++)
+        {
+          for (uint8_t n = 0; n < numCluster; n++)
+            {
+              double re = uniform->GetValue ();
+              double im = uniform->GetValue ();
+              channel.Set (u, s, n, std::complex<double> (re, im));
+            }
+        }
+    }
+}
+
+/**
+ * Check that the beams of MmWaveBeamCodebook are the weights set by
+ * AntennaArrayModel::SetSector for the same sector and elevation
+ */
+class MmWaveBeamCodebookSectorTestCase : public TestCase
+{
+public:
+  /**
+   * @param the number of antenna elements in the first dimension of the array
+   * @param the number of antenna elements in the second dimension of the array
+   */
+  MmWaveBeamCodebookSectorTestCase (uint16_t antennaNum0, uint16_t antennaNum1);
+
+private:
+  virtual void DoRun (void);
+
+  uint16_t m_antennaNum[2];
+};
+
+static std::string
+Name (const std::string &prefix, uint16_t antennaNum0, uint16_t antennaNum1)
+{
+  std::ostringstream oss;
+  oss << prefix << " " << antennaNum0 << "x" << antennaNum1;
+  return oss.str ();
+}
+
+MmWaveBeamCodebookSectorTestCase::MmWaveBeamCodebookSectorTestCase (uint16_t antennaNum0, uint16_t antennaNum1)
+  : TestCase (Name ("sectors of a", antennaNum0, antennaNum1))
+{
+  m_antennaNum[0] = antennaNum0;
+  m_antennaNum[1] = antennaNum1;
+}
+
+void
+MmWaveBeamCodebookSectorTestCase::DoRun (void)
+{
+  Ptr<AntennaArrayModel> antenna = CreateObject<AntennaArrayModel> ();
+  Ptr<const MmWaveBeamCodebook> codebook = MmWaveBeamCodebook::Get (antenna, m_antennaNum);
+  uint16_t size = m_antennaNum[0] * m_antennaNum[1];
+  NS_TEST_ASSERT_MSG_EQ (codebook->GetSize (), size, "wrong size of the beams");
+  NS_TEST_ASSERT_MSG_EQ (codebook->GetNumSectors (), (m_antennaNum[1] + 1), "wrong number of sectors");
+  NS_TEST_ASSERT_MSG_EQ (codebook->GetNumElevations (), 7, "wrong number of elevations");
+  NS_TEST_ASSERT_MSG_EQ (MmWaveBeamCodebook::Get (antenna, m_antennaNum), codebook,
+                         "the codebook of an array of the same size is not shared");
+
+  for (uint16_t elevationIndex = 0; elevationIndex < codebook->GetNumElevations (); elevationIndex++)
+    {
+      double elevation = 60 + 10 * elevationIndex;
+      for (uint16_t sector = 0; sector < codebook->GetNumSectors (); sector++)
+        {
+          uint16_t beam = codebook->GetBeamIndex (elevationIndex, sector);
+          NS_TEST_ASSERT_MSG_EQ (codebook->GetSector (beam), sector, "wrong sector of beam " << beam);
+          NS_TEST_ASSERT_MSG_EQ_TOL (codebook->GetElevation (beam), elevation, 1e-12,
+                                     "wrong elevation of beam " << beam);
+
+          antenna->SetSector (sector, m_antennaNum, elevation);
+          complexVector_t expected = antenna->GetBeamformingVectorPanel ();
+          complexVector_t weights = codebook->GetBeam (beam);
+          NS_TEST_ASSERT_MSG_EQ (weights.size (), expected.size (), "wrong size of beam " << beam);
+          for (uint16_t ind = 0; ind < size; ind++)
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL (weights[ind].real (), expected[ind].real (), 1e-12,
+                                         "sector " << sector << " elevation " << elevation << " element " << ind);
+              NS_TEST_ASSERT_MSG_EQ_TOL (weights[ind].imag (), expected[ind].imag (), 1e-12,
+                                         "sector " << sector << " elevation " << elevation << " element " << ind);
+            }
+        }
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that MmWaveBeamSearch::Exhaustive selects the pair of beams with the
+ * maximum gain, computed by brute force, on a random channel
+ */
+class MmWaveBeamSearchExhaustiveTestCase : public TestCase
+{
+public:
+  /**
+   * @param the number of rx antenna elements in each dimension of the array
+   * @param the number of tx antenna elements in each dimension of the array
+   * @param the number of clusters
+   * @param the stream of the random coefficients
+   */
+  MmWaveBeamSearchExhaustiveTestCase (uint16_t rxNum, uint16_t txNum, uint8_t numCluster, int64_t stream);
+
+private:
+  virtual void DoRun (void);
+
+  uint16_t m_rxNum;
+  uint16_t m_txNum;
+  uint8_t m_numCluster;
+  int64_t m_stream;
+};
+
+MmWaveBeamSearchExhaustiveTestCase::MmWaveBeamSearchExhaustiveTestCase (uint16_t rxNum, uint16_t txNum,
+                                                                        uint8_t numCluster, int64_t stream)
+  : TestCase (Name ("exhaustive search, rx", rxNum, rxNum) + Name (" tx", txNum, txNum)),
+    m_rxNum (rxNum),
+    m_txNum (txNum),
+    m_numCluster (numCluster),
+    m_stream (stream)
+{
+}
+
+void
+MmWaveBeamSearchExhaustiveTestCase::DoRun (void)
+{
+  uint16_t rxAntennaNum[2] = {m_rxNum, m_rxNum};
+  uint16_t txAntennaNum[2] = {m_txNum, m_txNum};
+  Ptr<AntennaArrayModel> antenna = CreateObject<AntennaArrayModel> ();
+  Ptr<const MmWaveBeamCodebook> rxCodebook = MmWaveBeamCodebook::Get (antenna, rxAntennaNum);
+  Ptr<const MmWaveBeamCodebook> txCodebook = MmWaveBeamCodebook::Get (antenna, txAntennaNum);
+
+  MmWaveChannelTensor channel;
+  FillRandomChannel (channel, m_rxNum * m_rxNum, m_txNum * m_txNum, m_numCluster, m_stream);
+
+  MmWaveBeamSearch::Result expected = BruteForceSearch (channel, *txCodebook, AllBeams (*txCodebook),
+                                                        *rxCodebook, AllBeams (*rxCodebook));
+  MmWaveBeamSearch::Result result = MmWaveBeamSearch::Exhaustive (channel, *txCodebook, *rxCodebook);
+  NS_TEST_ASSERT_MSG_EQ (result.m_txBeam, expected.m_txBeam, "wrong tx beam");
+  NS_TEST_ASSERT_MSG_EQ (result.m_rxBeam, expected.m_rxBeam, "wrong rx beam");
+  NS_TEST_ASSERT_MSG_EQ_TOL (result.m_gain, expected.m_gain, 1e-9 * expected.m_gain, "wrong gain");
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that MmWaveBeamSearch::Hierarchical selects a pair of beams in the
+ * neighborhood of the best pair of the coarse codebook on a random channel,
+ * and the same pair as MmWaveBeamSearch::Exhaustive on a single-cluster LOS
+ * channel
+ */
+class MmWaveBeamSearchHierarchicalTestCase : public TestCase
+{
+public:
+  /**
+   * @param the number of antenna elements in each dimension of the arrays
+   * @param the stream of the random coefficients
+   */
+  MmWaveBeamSearchHierarchicalTestCase (uint16_t antennaNum, int64_t stream);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check that a beam is at most one sector and two elevations away from a beam of the coarse codebook
+   * @param the codebook
+   * @param the beam selected by the search
+   * @param the best beam of the coarse codebook
+   */
+  void CheckNeighbor (const MmWaveBeamCodebook &codebook, uint16_t beam, uint16_t coarseBeam);
+
+  /**
+   * Fill a single-cluster channel with the response of two arrays to a plane wave
+   * @param the channel
+   * @param the antenna model, to get the location of the elements
+   * @param the number of antenna elements in the two dimensions of the arrays
+   * @param the zenith and azimuth angles of departure, in degrees
+   * @param the zenith and azimuth angles of arrival, in degrees
+   */
+  static void FillLosChannel (MmWaveChannelTensor &channel, Ptr<AntennaArrayModel> antenna, uint16_t *antennaNum,
+                              double txZenith, double txAzimuth, double rxZenith, double rxAzimuth);
+
+  uint16_t m_antennaNum;
+  int64_t m_stream;
+};
+
+MmWaveBeamSearchHierarchicalTestCase::MmWaveBeamSearchHierarchicalTestCase (uint16_t antennaNum, int64_t stream)
+  : TestCase (Name ("hierarchical search,", antennaNum, antennaNum)),
+    m_antennaNum (antennaNum),
+    m_stream (stream)
+{
+}
+
+void
+MmWaveBeamSearchHierarchicalTestCase::CheckNeighbor (const MmWaveBeamCodebook &codebook, uint16_t beam,
+                                                     uint16_t coarseBeam)
+{
+  int sectorDistance = std::abs (codebook.GetSector (beam) - codebook.GetSector (coarseBeam));
+  int elevationDistance = std::abs (codebook.GetElevationIndex (beam) - codebook.GetElevationIndex (coarseBeam));
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (sectorDistance, 1, "beam " << beam << " is not a neighbor of " << coarseBeam);
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (elevationDistance, 2, "beam " << beam << " is not a neighbor of " << coarseBeam);
+}
+
+void
+MmWaveBeamSearchHierarchicalTestCase::FillLosChannel (MmWaveChannelTensor &channel, Ptr<AntennaArrayModel> antenna,
+                                                      uint16_t *antennaNum, double txZenith, double txAzimuth,
+                                                      double rxZenith, double rxAzimuth)
+{
+  uint16_t size = antennaNum[0] * antennaNum[1];
+  double txV = txZenith * M_PI / 180;
+  double txH = txAzimuth * M_PI / 180;
+  double rxV = rxZenith * M_PI / 180;
+  double rxH = rxAzimuth * M_PI / 180;
+  channel.Resize (size, size, 1);
+  for (uint16_t u = 0; u < size; u++)
+    {
+      Vector rxLoc = antenna->GetAntennaLocation (u, antennaNum);
+      double rxPhase = 2 * M_PI * (sin (rxV) * cos (rxH) * rxLoc.x + sin (rxV) * sin (rxH) * rxLoc.y
+                                   + cos (rxV) * rxLoc.z);
+      for (uint16_t s = 0; s < size; s++)
+        {
+          Vector txLoc = antenna->GetAntennaLocation (s, antennaNum);
+          double txPhase = 2 * M_PI * (sin (txV) * cos (txH) * txLoc.x + sin (txV) * sin (txH) * txLoc.y
+                                       + cos (txV) * txLoc.z);
+          channel.Set (u, s, 0, exp (std::complex<double> (0, txPhase - rxPhase)));
+        }
+    }
+}
+
+void
+MmWaveBeamSearchHierarchicalTestCase::DoRun (void)
+{
+  uint16_t antennaNum[2] = {m_antennaNum, m_antennaNum};
+  uint16_t size = m_antennaNum * m_antennaNum;
+  Ptr<AntennaArrayModel> antenna = CreateObject<AntennaArrayModel> ();
+  Ptr<const MmWaveBeamCodebook> codebook = MmWaveBeamCodebook::Get (antenna, antennaNum);
+
+  // random channel: the selected pair is in the neighborhood of the best coarse pair,
+  // and it is not worse than that pair
+  MmWaveChannelTensor channel;
+  FillRandomChannel (channel, size, size, 5, m_stream);
+  std::vector<uint16_t> coarseBeams = CoarseBeams (*codebook);
+  MmWaveBeamSearch::Result coarse = BruteForceSearch (channel, *codebook, coarseBeams, *codebook, coarseBeams);
+  MmWaveBeamSearch::Result result = MmWaveBeamSearch::Hierarchical (channel, *codebook, *codebook);
+  CheckNeighbor (*codebook, result.m_txBeam, coarse.m_txBeam);
+  CheckNeighbor (*codebook, result.m_rxBeam, coarse.m_rxBeam);
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (result.m_gain, coarse.m_gain * (1 - 1e-9), "the second stage lost gain");
+  double gain = BruteForceGain (channel, codebook->GetBeam (result.m_txBeam), codebook->GetBeam (result.m_rxBeam));
+  NS_TEST_ASSERT_MSG_EQ_TOL (result.m_gain, gain, 1e-9 * gain, "wrong gain");
+
+  // single-cluster LOS channel, with directions between the beams of the codebook:
+  // the gain is the product of the tx and rx array gains, which have a single
+  // main lobe, so the two searches select the same pair; the azimuths are away from
+  // +-90 degrees, where the first and the last sector are almost the same beam
+  const double directions[][4] = {{75, 20, 100, -35}, {95, -50, 65, 40}, {112, 5, 83, -25}};
+  for (const double *d : directions)
+    {
+      FillLosChannel (channel, antenna, antennaNum, d[0], d[1], d[2], d[3]);
+      MmWaveBeamSearch::Result exhaustive = MmWaveBeamSearch::Exhaustive (channel, *codebook, *codebook);
+      MmWaveBeamSearch::Result hierarchical = MmWaveBeamSearch::Hierarchical (channel, *codebook, *codebook);
+      NS_TEST_ASSERT_MSG_EQ (hierarchical.m_txBeam, exhaustive.m_txBeam, "wrong tx beam, departure " << d[0] << " " << d[1]);
+      NS_TEST_ASSERT_MSG_EQ (hierarchical.m_rxBeam, exhaustive.m_rxBeam, "wrong rx beam, arrival " << d[2] << " " << d[3]);
+      NS_TEST_ASSERT_MSG_EQ_TOL (hierarchical.m_gain, exhaustive.m_gain, 1e-9 * exhaustive.m_gain, "wrong gain");
+    }
+  Simulator::Destroy ();
+}
+
+class MmWaveBeamCodebookTestSuite : public TestSuite
+{
+public:
+  MmWaveBeamCodebookTestSuite ();
+};
+
+MmWaveBeamCodebookTestSuite::MmWaveBeamCodebookTestSuite ()
+  : TestSuite ("mmwave-beam-codebook", UNIT)
+{
+  AddTestCase (new MmWaveBeamCodebookSectorTestCase (4, 4), TestCase::QUICK);
+  AddTestCase (new MmWaveBeamCodebookSectorTestCase (2, 8), TestCase::QUICK);
+  AddTestCase (new MmWaveBeamSearchExhaustiveTestCase (2, 3, 5, 1), TestCase::QUICK);
+  AddTestCase (new MmWaveBeamSearchExhaustiveTestCase (3, 2, 12, 2), TestCase::QUICK);
+  AddTestCase (new MmWaveBeamSearchHierarchicalTestCase (4, 3), TestCase::QUICK);
+  AddTestCase (new MmWaveBeamSearchHierarchicalTestCase (8, 4), TestCase::QUICK);
+}
+
+static MmWaveBeamCodebookTestSuite g_mmWaveBeamCodebookTestSuite;
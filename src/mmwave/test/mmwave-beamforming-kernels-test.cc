@@ -0,0 +1,217 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/config.h"
+#include "ns3/mmwave-beamforming-kernels.h"
+#include <cmath>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * Run the kernels of a level on random vectors of several lengths, including
+ * lengths that are not a multiple of the vector width, and compare the
+ * results with the scalar kernels
+ */
+class MmWaveBeamformingKernelsTestCase : public TestCase
+{
+public:
+  /**
+   * @param the level of the kernels to be compared with the scalar ones
+   */
+  MmWaveBeamformingKernelsTestCase (MmWaveBeamformingKernels::KernelLevel level);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * @param the number of values
+   * @returns values uniformly distributed in [-1, 1]
+   */
+  std::vector<double> GetValues (uint32_t n);
+
+  MmWaveBeamformingKernels::KernelLevel m_level;
+  Ptr<UniformRandomVariable> m_random;
+};
+
+static std::string
+LevelName (MmWaveBeamformingKernels::KernelLevel level)
+{
+  switch (level)
+    {
+    case MmWaveBeamformingKernels::AVX512:
+      return "AVX-512";
+    case MmWaveBeamformingKernels::AVX2:
+      return "AVX2";
+    default:
+      return "scalar";
+    }
+}
+
+MmWaveBeamformingKernelsTestCase::MmWaveBeamformingKernelsTestCase (MmWaveBeamformingKernels::KernelLevel level)
+  : TestCase (LevelName (level) + " kernels against the scalar kernels"),
+    m_level (level)
+{
+}
+
+std::vector<double>
+MmWaveBeamformingKernelsTestCase::GetValues (uint32_t n)
+{
+  std::vector<double> values (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values[i] = m_random->GetValue ();
+    }
+  return values;
+}
+
+void
+MmWaveBeamformingKernelsTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_random->SetAttribute ("Min", DoubleValue (-1));
+  m_random->SetAttribute ("Max", DoubleValue (1));
+  MmWaveBeamformingKernels::KernelLevel previous = MmWaveBeamformingKernels::GetLevel ();
+
+  const uint32_t lengths[] = {1, 3, 4, 7, 8, 9, 15, 16, 17, 64, 70, 256};
+  for (uint32_t l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++)
+    {
+      uint32_t n = lengths[l];
+      std::vector<double> wRe = GetValues (n);
+      std::vector<double> wIm = GetValues (n);
+      std::vector<double> hRe = GetValues (n);
+      std::vector<double> hIm = GetValues (n);
+
+      MmWaveBeamformingKernels::SetLevel (MmWaveBeamformingKernels::SCALAR);
+      std::complex<double> expected = MmWaveBeamformingKernels::ComplexDot (&wRe[0], &wIm[0], &hRe[0], &hIm[0], n);
+      MmWaveBeamformingKernels::SetLevel (m_level);
+      std::complex<double> actual = MmWaveBeamformingKernels::ComplexDot (&wRe[0], &wIm[0], &hRe[0], &hIm[0], n);
+      // the sum of n products of values bounded by 1 is exact within n rounding errors
+      double tol = 4 * n * 1e-16;
+      NS_TEST_EXPECT_MSG_EQ_TOL (actual.real (), expected.real (), tol, "ComplexDot of length " << n << " differs");
+      NS_TEST_EXPECT_MSG_EQ_TOL (actual.imag (), expected.imag (), tol, "ComplexDot of length " << n << " differs");
+
+      // unit phase steps, so that the coefficients keep their magnitude
+      // over the subbands, and some zero subbands that must be skipped
+      std::vector<double> coeffRe = GetValues (n);
+      std::vector<double> coeffIm = GetValues (n);
+      std::vector<double> stepRe (n);
+      std::vector<double> stepIm (n);
+      for (uint32_t c = 0; c < n; c++)
+        {
+          double phase = M_PI * m_random->GetValue ();
+          stepRe[c] = std::cos (phase);
+          stepIm[c] = std::sin (phase);
+        }
+      const uint32_t numSubband = 72;
+      std::vector<double> psd = GetValues (numSubband);
+      for (uint32_t k = 0; k < numSubband; k += 5)
+        {
+          psd[k] = 0;
+        }
+
+      std::vector<double> expectedCoeffRe = coeffRe;
+      std::vector<double> expectedCoeffIm = coeffIm;
+      std::vector<double> expectedPsd = psd;
+      MmWaveBeamformingKernels::SetLevel (MmWaveBeamformingKernels::SCALAR);
+      MmWaveBeamformingKernels::SubbandGain (&expectedCoeffRe[0], &expectedCoeffIm[0], &stepRe[0], &stepIm[0], n,
+                                             &expectedPsd[0], numSubband);
+      MmWaveBeamformingKernels::SetLevel (m_level);
+      MmWaveBeamformingKernels::SubbandGain (&coeffRe[0], &coeffIm[0], &stepRe[0], &stepIm[0], n,
+                                             &psd[0], numSubband);
+
+      // the rounding errors of the rotations accumulate over the subbands
+      tol = 4 * (n + numSubband) * 1e-16;
+      for (uint32_t k = 0; k < numSubband; k++)
+        {
+          // the gain is at most n^2
+          NS_TEST_EXPECT_MSG_EQ_TOL (psd[k], expectedPsd[k], tol * n * n,
+                                     "SubbandGain of " << n << " clusters differs at subband " << k);
+        }
+      for (uint32_t c = 0; c < n; c++)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (coeffRe[c], expectedCoeffRe[c], tol,
+                                     "SubbandGain of " << n << " clusters leaves a different coefficient " << c);
+          NS_TEST_EXPECT_MSG_EQ_TOL (coeffIm[c], expectedCoeffIm[c], tol,
+                                     "SubbandGain of " << n << " clusters leaves a different coefficient " << c);
+        }
+    }
+
+  MmWaveBeamformingKernels::SetLevel (previous);
+}
+
+/**
+ * Check that the MmWaveBeamformingKernels global value selects the kernels
+ */
+class MmWaveBeamformingKernelsConfigureTestCase : public TestCase
+{
+public:
+  MmWaveBeamformingKernelsConfigureTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveBeamformingKernelsConfigureTestCase::MmWaveBeamformingKernelsConfigureTestCase ()
+  : TestCase ("the MmWaveBeamformingKernels global value selects the kernels")
+{
+}
+
+void
+MmWaveBeamformingKernelsConfigureTestCase::DoRun (void)
+{
+  MmWaveBeamformingKernels::KernelLevel previous = MmWaveBeamformingKernels::GetLevel ();
+
+  Config::SetGlobal ("MmWaveBeamformingKernels", EnumValue (MmWaveBeamformingKernels::SCALAR));
+  MmWaveBeamformingKernels::Configure ();
+  NS_TEST_EXPECT_MSG_EQ (MmWaveBeamformingKernels::GetLevel (), MmWaveBeamformingKernels::SCALAR,
+                         "the scalar kernels should be forced");
+
+  Config::SetGlobal ("MmWaveBeamformingKernels", EnumValue (MmWaveBeamformingKernels::AVX512));
+  MmWaveBeamformingKernels::Configure ();
+  NS_TEST_EXPECT_MSG_EQ (MmWaveBeamformingKernels::GetLevel (), MmWaveBeamformingKernels::GetSupportedLevel (),
+                         "the level should be lowered to the one supported by the CPU");
+
+  MmWaveBeamformingKernels::SetLevel (previous);
+}
+
+class MmWaveBeamformingKernelsTestSuite : public TestSuite
+{
+public:
+  MmWaveBeamformingKernelsTestSuite ();
+};
+
+MmWaveBeamformingKernelsTestSuite::MmWaveBeamformingKernelsTestSuite ()
+  : TestSuite ("mmwave-beamforming-kernels", UNIT)
+{
+  // every level supported by this CPU, the scalar one included
+  for (int level = MmWaveBeamformingKernels::SCALAR; level <= MmWaveBeamformingKernels::GetSupportedLevel (); level++)
+    {
+      AddTestCase (new MmWaveBeamformingKernelsTestCase (static_cast<MmWaveBeamformingKernels::KernelLevel> (level)),
+                   TestCase::QUICK);
+    }
+  AddTestCase (new MmWaveBeamformingKernelsConfigureTestCase, TestCase::QUICK);
+}
+
+static MmWaveBeamformingKernelsTestSuite g_mmWaveBeamformingKernelsTestSuite;
@@ -0,0 +1,248 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/mmwave-binary-trace-writer.h"
+#include <sstream>
+#include <string.h>
+#include <stdio.h>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * @param the number of the record
+ * @returns a RxPacketTrace record whose fields depend on the number
+ */
+static MmWaveRxPacketTraceRecord
+MakeRxPacketTraceRecord (uint32_t i)
+{
+  MmWaveRxPacketTraceRecord record;
+  memset (&record, 0, sizeof (record));
+  record.m_time = i * 0.000125;
+  record.m_cellId = i % 3 + 1;
+  record.m_frameNum = i / 80;
+  record.m_tbSize = 100 + i;
+  record.m_rnti = i % 7 + 1;
+  record.m_isUplink = i % 2;
+  record.m_sfNum = i % 8;
+  record.m_symStart = i % 24;
+  record.m_numSym = i % 5 + 1;
+  record.m_ccId = i % 2;
+  record.m_mcs = i % 29;
+  record.m_rv = i % 4;
+  record.m_corrupt = (i % 11 == 0);
+  record.m_sinrDb = 0.25 * i - 10;
+  record.m_tbler = 1.0 / (i + 1);
+  return record;
+}
+
+/**
+ * @param the number of the record
+ * @returns a bearer trace record whose fields depend on the number
+ */
+static MmWaveBearerTraceRecord
+MakeBearerTraceRecord (uint32_t i)
+{
+  MmWaveBearerTraceRecord record;
+  memset (&record, 0, sizeof (record));
+  record.m_time = i * 0.001;
+  record.m_isRx = i % 2;
+  record.m_delay = record.m_isRx ? 1000 * i : 0;
+  record.m_packetSize = 1400 - i;
+  record.m_cellId = i % 3 + 1;
+  record.m_rnti = i % 7 + 1;
+  record.m_lcid = i % 4 + 1;
+  return record;
+}
+
+/**
+ * Write records with MmWaveBinaryTraceWriter, with buffers so small that
+ * the records fill several buffers and a partial one, then read the file
+ * back and check the header and every record
+ */
+template <class Record>
+class MmWaveBinaryTraceWriterTestCase : public TestCase
+{
+public:
+  /**
+   * @param the name of the test case
+   * @param the type of the records
+   * @param the function making the records
+   * @param the number of records
+   * @param the size of each buffer of the ring, in bytes
+   * @param the number of buffers of the ring
+   */
+  MmWaveBinaryTraceWriterTestCase (std::string name, MmWaveBinaryTraceWriter::RecordType recordType,
+                                   Record (*makeRecord)(uint32_t), uint32_t numRecords,
+                                   uint32_t bufferSize, uint32_t numBuffers);
+
+private:
+  virtual void DoRun (void);
+
+  MmWaveBinaryTraceWriter::RecordType m_recordType;
+  Record (*m_makeRecord)(uint32_t);
+  uint32_t m_numRecords;
+  uint32_t m_bufferSize;
+  uint32_t m_numBuffers;
+};
+
+template <class Record>
+MmWaveBinaryTraceWriterTestCase<Record>::MmWaveBinaryTraceWriterTestCase (std::string name,
+                                                                          MmWaveBinaryTraceWriter::RecordType recordType,
+                                                                          Record (*makeRecord)(uint32_t), uint32_t numRecords,
+                                                                          uint32_t bufferSize, uint32_t numBuffers)
+  : TestCase (name),
+    m_recordType (recordType),
+    m_makeRecord (makeRecord),
+    m_numRecords (numRecords),
+    m_bufferSize (bufferSize),
+    m_numBuffers (numBuffers)
+{
+}
+
+template <class Record>
+void
+MmWaveBinaryTraceWriterTestCase<Record>::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("mmwave-binary-trace.bin");
+  Ptr<MmWaveBinaryTraceWriter> writer = Create<MmWaveBinaryTraceWriter> (fileName, m_recordType, sizeof (Record),
+                                                                         m_bufferSize, m_numBuffers);
+  for (uint32_t i = 0; i < m_numRecords; i++)
+    {
+      Record record = m_makeRecord (i);
+      writer->Write (&record);
+    }
+  writer->Close ();
+  // closing again, as the destructor does, must not write anything
+  writer = 0;
+
+  FILE *in = fopen (fileName.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (in, 0, "could not open " << fileName);
+  MmWaveBinaryTraceHeader header;
+  NS_TEST_ASSERT_MSG_EQ (fread (&header, sizeof (header), 1, in), 1, "the header is truncated");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (header.m_magic, "MMWTRACE", sizeof (header.m_magic)), 0, "wrong magic");
+  NS_TEST_ASSERT_MSG_EQ (header.m_version, MmWaveBinaryTraceWriter::VERSION, "wrong version");
+  NS_TEST_ASSERT_MSG_EQ (header.m_recordType, (uint32_t) m_recordType, "wrong record type");
+  NS_TEST_ASSERT_MSG_EQ (header.m_recordSize, sizeof (Record), "wrong record size");
+
+  for (uint32_t i = 0; i < m_numRecords; i++)
+    {
+      Record record;
+      NS_TEST_ASSERT_MSG_EQ (fread (&record, sizeof (record), 1, in), 1, "record " << i << " is missing");
+      Record expected = m_makeRecord (i);
+      NS_TEST_ASSERT_MSG_EQ (memcmp (&record, &expected, sizeof (record)), 0, "record " << i << " differs");
+    }
+  char extra;
+  NS_TEST_ASSERT_MSG_EQ (fread (&extra, 1, 1, in), 0, "the file has bytes after the last record");
+  fclose (in);
+  remove (fileName.c_str ());
+}
+
+/**
+ * Check that the converted text has the columns of the text output of
+ * MmWavePhyRxTrace and MmWaveBearerStatsCalculator
+ */
+class MmWaveTraceTextTestCase : public TestCase
+{
+public:
+  MmWaveTraceTextTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveTraceTextTestCase::MmWaveTraceTextTestCase ()
+  : TestCase ("text of the converted records")
+{
+}
+
+/**
+ * @param a line of text
+ * @param the field separator
+ * @returns the number of fields of the line
+ */
+static uint32_t
+CountFields (std::string line, char sep)
+{
+  uint32_t count = 1;
+  for (size_t i = 0; i < line.size (); i++)
+    {
+      count += (line[i] == sep);
+    }
+  return count;
+}
+
+void
+MmWaveTraceTextTestCase::DoRun (void)
+{
+  // the first line of the text output of MmWavePhyRxTrace, whose first column has no name
+  std::ostringstream header;
+  WriteRxPacketTraceHeader (header, "\t");
+  NS_TEST_ASSERT_MSG_EQ (header.str (), "\ttime\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\n",
+                         "the header differs from the one of the text output");
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      std::ostringstream line;
+      WriteRxPacketTraceRecord (line, "\t", MakeRxPacketTraceRecord (i));
+      NS_TEST_ASSERT_MSG_EQ (line.str ().substr (0, 3), (i == 0 ? "DL\t" : "UL\t"), "the first column should be the mode");
+      NS_TEST_ASSERT_MSG_EQ (CountFields (line.str (), '\t'), CountFields (header.str (), '\t'),
+                             "a record should have a field for each column of the header");
+    }
+
+  // the lines of the text output of MmWaveBearerStatsCalculator, which has no header
+  MmWaveBearerTraceRecord record = MakeBearerTraceRecord (5);
+  std::ostringstream rx;
+  WriteBearerTraceRecord (rx, " ", record);
+  NS_TEST_ASSERT_MSG_EQ (rx.str (), "Rx 0.005 3 6 2 1395 5000\n", "wrong line of a reception");
+  record = MakeBearerTraceRecord (4);
+  std::ostringstream tx;
+  WriteBearerTraceRecord (tx, " ", record);
+  NS_TEST_ASSERT_MSG_EQ (tx.str (), "Tx 0.004 2 5 1 1396 \n", "wrong line of a transmission");
+}
+
+class MmWaveBinaryTraceWriterTestSuite : public TestSuite
+{
+public:
+  MmWaveBinaryTraceWriterTestSuite ();
+};
+
+MmWaveBinaryTraceWriterTestSuite::MmWaveBinaryTraceWriterTestSuite ()
+  : TestSuite ("mmwave-binary-trace-writer", UNIT)
+{
+  // 3 records per buffer: 5 full buffers and a partial one, through a ring of 2
+  AddTestCase (new MmWaveBinaryTraceWriterTestCase<MmWaveRxPacketTraceRecord> ("RxPacketTrace records", MmWaveBinaryTraceWriter::RX_PACKET_TRACE,
+                                                                                &MakeRxPacketTraceRecord, 17,
+                                                                                3 * sizeof (MmWaveRxPacketTraceRecord) + 10, 2),
+               TestCase::QUICK);
+  // buffers smaller than a record hold one record each
+  AddTestCase (new MmWaveBinaryTraceWriterTestCase<MmWaveBearerTraceRecord> ("bearer trace records", MmWaveBinaryTraceWriter::BEARER_TRACE,
+                                                                              &MakeBearerTraceRecord, 9, 1, 3),
+               TestCase::QUICK);
+  // records that fill the buffers exactly, and no partial buffer
+  AddTestCase (new MmWaveBinaryTraceWriterTestCase<MmWaveBearerTraceRecord> ("bearer trace records in full buffers", MmWaveBinaryTraceWriter::BEARER_TRACE,
+                                                                              &MakeBearerTraceRecord, 1000,
+                                                                              100 * sizeof (MmWaveBearerTraceRecord), 4),
+               TestCase::QUICK);
+  AddTestCase (new MmWaveTraceTextTestCase, TestCase::QUICK);
+}
+
+static MmWaveBinaryTraceWriterTestSuite g_mmWaveBinaryTraceWriterTestSuite;
@@ -0,0 +1,210 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/mmwave-channel-tensor.h"
+
+using namespace ns3;
+using namespace mmwave;
+
+typedef std::vector< std::complex<double> > complexVector_t;
+typedef std::vector<complexVector_t> complex2DVector_t;
+typedef std::vector<complex2DVector_t> complex3DVector_t;
+
+/**
+ * Fill a MmWaveChannelTensor the way MmWave3gppChannel::GetNewChannel does,
+ * and the nested H[u][s][n] vectors the tensor replaced, with the same
+ * random coefficients, then check that the coefficients and the spatial
+ * correlation matrices are the same
+ */
+class MmWaveChannelTensorTestCase : public TestCase
+{
+public:
+  /**
+   * @param the number of rx antenna elements
+   * @param the number of tx antenna elements
+   * @param the number of clusters, before the two strongest are split
+   * @param the index of the strongest cluster
+   * @param the index of the second strongest cluster
+   */
+  MmWaveChannelTensorTestCase (uint16_t rxSize, uint16_t txSize, uint8_t numCluster,
+                               uint8_t cluster1st, uint8_t cluster2nd);
+
+private:
+  virtual void DoRun (void);
+
+  uint16_t m_rxSize;
+  uint16_t m_txSize;
+  uint8_t m_numCluster;
+  uint8_t m_cluster1st;
+  uint8_t m_cluster2nd;
+};
+
+static std::string
+Name (uint16_t rxSize, uint16_t txSize, uint8_t numCluster, uint8_t cluster1st, uint8_t cluster2nd)
+{
+  std::ostringstream oss;
+  oss << "rx " << rxSize << " tx " << txSize << " clusters " << (uint16_t)numCluster
+      << " strongest " << (uint16_t)cluster1st << " " << (uint16_t)cluster2nd;
+  return oss.str ();
+}
+
+MmWaveChannelTensorTestCase::MmWaveChannelTensorTestCase (uint16_t rxSize, uint16_t txSize, uint8_t numCluster,
+                                                          uint8_t cluster1st, uint8_t cluster2nd)
+  : TestCase (Name (rxSize, txSize, numCluster, cluster1st, cluster2nd)),
+    m_rxSize (rxSize),
+    m_txSize (txSize),
+    m_numCluster (numCluster),
+    m_cluster1st (cluster1st),
+    m_cluster2nd (cluster2nd)
+{
+}
+
+void
+MmWaveChannelTensorTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  random->SetAttribute ("Min", DoubleValue (-1));
+  random->SetAttribute ("Max", DoubleValue (1));
+
+  // the nested vectors, where the sub-clusters of the strongest clusters
+  // are appended after the clusters, as GetNewChannel used to do
+  complex3DVector_t reference (m_rxSize, complex2DVector_t (m_txSize, complexVector_t (m_numCluster)));
+  MmWaveChannelTensor tensor;
+  // a previous realization of a different size, whose storage is reused
+  tensor.Resize (3, 5, 2);
+  tensor.Set (2, 4, 1, std::complex<double> (1, 1));
+  tensor.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (tensor.IsEmpty (), true, "a cleared tensor should be empty");
+
+  uint8_t numSubCluster = (m_cluster1st == m_cluster2nd) ? 2 : 4;
+  tensor.Resize (m_rxSize, m_txSize, m_numCluster + numSubCluster);
+  for (uint16_t u = 0; u < m_rxSize; u++)
+    {
+      for (uint16_t s = 0; s < m_txSize; s++)
+        {
+          uint8_t subClusterIndex = tensor.GetNumCluster () - numSubCluster;
+          for (uint8_t n = 0; n < m_numCluster; n++)
+            {
+              std::complex<double> value (random->GetValue (), random->GetValue ());
+              reference[u][s][n] = value;
+              tensor.Set (u, s, n, value);
+              if (n == m_cluster1st || n == m_cluster2nd)
+                {
+                  std::complex<double> sub2 (random->GetValue (), random->GetValue ());
+                  std::complex<double> sub3 (random->GetValue (), random->GetValue ());
+                  reference[u][s].push_back (sub2);
+                  reference[u][s].push_back (sub3);
+                  tensor.Set (u, s, subClusterIndex++, sub2);
+                  tensor.Set (u, s, subClusterIndex++, sub3);
+                }
+            }
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ ((uint16_t)tensor.GetNumCluster (), reference[0][0].size (), "wrong number of clusters");
+  for (uint8_t n = 0; n < tensor.GetNumCluster (); n++)
+    {
+      uint64_t address = reinterpret_cast<uint64_t> (tensor.GetRealPlane (n));
+      NS_TEST_ASSERT_MSG_EQ (address % MMWAVE_TENSOR_ALIGNMENT, 0, "the real plane of cluster " << (uint16_t)n << " is not aligned");
+      address = reinterpret_cast<uint64_t> (tensor.GetImagPlane (n));
+      NS_TEST_ASSERT_MSG_EQ (address % MMWAVE_TENSOR_ALIGNMENT, 0, "the imaginary plane of cluster " << (uint16_t)n << " is not aligned");
+    }
+  for (uint16_t u = 0; u < m_rxSize; u++)
+    {
+      for (uint16_t s = 0; s < m_txSize; s++)
+        {
+          for (uint8_t n = 0; n < tensor.GetNumCluster (); n++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (tensor.Get (u, s, n), reference[u][s][n],
+                                     "H[" << u << "][" << s << "][" << (uint16_t)n << "] differs");
+            }
+        }
+    }
+
+  // the spatial correlation matrices, computed as LongTermCovMatrixBeamforming used to
+  complexVector_t txQ;
+  tensor.GetTxCorrelation (txQ);
+  NS_TEST_ASSERT_MSG_EQ (txQ.size (), (uint32_t)m_txSize * m_txSize, "wrong size of the tx correlation");
+  for (uint16_t t1 = 0; t1 < m_txSize; t1++)
+    {
+      for (uint16_t t2 = 0; t2 < m_txSize; t2++)
+        {
+          std::complex<double> expected (0, 0);
+          for (uint16_t rx = 0; rx < m_rxSize; rx++)
+            {
+              std::complex<double> cSum (0, 0);
+              for (uint8_t c = 0; c < reference[rx][t1].size (); c++)
+                {
+                  cSum = cSum + std::conj (reference[rx][t1][c]) * reference[rx][t2][c];
+                }
+              expected += cSum;
+            }
+          NS_TEST_ASSERT_MSG_EQ_TOL (txQ[t1 * m_txSize + t2].real (), expected.real (), 1e-9,
+                                     "txQ[" << t1 << "][" << t2 << "] differs");
+          NS_TEST_ASSERT_MSG_EQ_TOL (txQ[t1 * m_txSize + t2].imag (), expected.imag (), 1e-9,
+                                     "txQ[" << t1 << "][" << t2 << "] differs");
+        }
+    }
+
+  complexVector_t rxQ;
+  tensor.GetRxCorrelation (rxQ);
+  NS_TEST_ASSERT_MSG_EQ (rxQ.size (), (uint32_t)m_rxSize * m_rxSize, "wrong size of the rx correlation");
+  for (uint16_t r1 = 0; r1 < m_rxSize; r1++)
+    {
+      for (uint16_t r2 = 0; r2 < m_rxSize; r2++)
+        {
+          std::complex<double> expected (0, 0);
+          for (uint16_t tx = 0; tx < m_txSize; tx++)
+            {
+              std::complex<double> cSum (0, 0);
+              for (uint8_t c = 0; c < reference[r1][tx].size (); c++)
+                {
+                  cSum = cSum + reference[r1][tx][c] * std::conj (reference[r2][tx][c]);
+                }
+              expected += cSum;
+            }
+          NS_TEST_ASSERT_MSG_EQ_TOL (rxQ[r1 * m_rxSize + r2].real (), expected.real (), 1e-9,
+                                     "rxQ[" << r1 << "][" << r2 << "] differs");
+          NS_TEST_ASSERT_MSG_EQ_TOL (rxQ[r1 * m_rxSize + r2].imag (), expected.imag (), 1e-9,
+                                     "rxQ[" << r1 << "][" << r2 << "] differs");
+        }
+    }
+}
+
+class MmWaveChannelTensorTestSuite : public TestSuite
+{
+public:
+  MmWaveChannelTensorTestSuite ();
+};
+
+MmWaveChannelTensorTestSuite::MmWaveChannelTensorTestSuite ()
+  : TestSuite ("mmwave-channel-tensor", UNIT)
+{
+  AddTestCase (new MmWaveChannelTensorTestCase (1, 1, 1, 0, 0), TestCase::QUICK);
+  AddTestCase (new MmWaveChannelTensorTestCase (4, 16, 7, 0, 3), TestCase::QUICK);
+  AddTestCase (new MmWaveChannelTensorTestCase (16, 64, 19, 5, 5), TestCase::QUICK);
+  // more tx elements than a tile of the correlation matrix, and planes that need padding
+  AddTestCase (new MmWaveChannelTensorTestCase (3, 70, 12, 11, 2), TestCase::QUICK);
+}
+
+static MmWaveChannelTensorTestSuite g_mmWaveChannelTensorTestSuite;
@@ -0,0 +1,251 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mmwave-link-table.h"
+#include <map>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * Apply random insertions, lookups and erasures to a MmWaveFlatHashMap and
+ * to a std::map, and check that they hold the same keys and values after
+ * every operation, across the rehashes of the growing table
+ */
+class MmWaveFlatHashMapRandomTestCase : public TestCase
+{
+public:
+  MmWaveFlatHashMapRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveFlatHashMapRandomTestCase::MmWaveFlatHashMapRandomTestCase ()
+  : TestCase ("random operations against std::map")
+{
+}
+
+void
+MmWaveFlatHashMapRandomTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  MmWaveFlatHashMap<uint32_t> table;
+  std::map<uint64_t, uint32_t> reference;
+  NS_TEST_ASSERT_MSG_EQ (table.Find (1), 0, "an empty table should not hold any key");
+  NS_TEST_ASSERT_MSG_EQ (table.Erase (1), false, "an empty table should not hold any key");
+
+  for (uint32_t op = 0; op < 20000; op++)
+    {
+      // keys from a small range, so that the same keys are erased and inserted again,
+      // and keys that differ only in the high bits
+      uint64_t key = random->GetInteger (0, 1999);
+      if (random->GetInteger (0, 1) == 1)
+        {
+          key <<= 32;
+        }
+      uint32_t action = random->GetInteger (0, 2);
+      if (action < 2)
+        {
+          table.Get (key) = op;
+          reference[key] = op;
+        }
+      else
+        {
+          bool erased = table.Erase (key);
+          NS_TEST_ASSERT_MSG_EQ (erased, (reference.erase (key) == 1), "Erase of key " << key << " at operation " << op);
+        }
+      NS_TEST_ASSERT_MSG_EQ (table.GetSize (), reference.size (), "wrong size at operation " << op);
+      uint64_t probe = random->GetInteger (0, 1999);
+      const uint32_t *value = table.Find (probe);
+      std::map<uint64_t, uint32_t>::const_iterator it = reference.find (probe);
+      NS_TEST_ASSERT_MSG_EQ ((value != 0), (it != reference.end ()), "Find of key " << probe << " at operation " << op);
+      if (value != 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (*value, it->second, "wrong value of key " << probe << " at operation " << op);
+        }
+    }
+
+  for (std::map<uint64_t, uint32_t>::const_iterator it = reference.begin (); it != reference.end (); ++it)
+    {
+      const uint32_t *value = table.Find (it->first);
+      NS_TEST_ASSERT_MSG_NE (value, 0, "key " << it->first << " is missing");
+      NS_TEST_ASSERT_MSG_EQ (*value, it->second, "wrong value of key " << it->first);
+    }
+
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 0, "a cleared table should be empty");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (reference.begin ()->first), 0, "a cleared table should not hold any key");
+  table.Get (7) = 3;
+  NS_TEST_ASSERT_MSG_EQ (*table.Find (7), 3, "a cleared table should be usable");
+}
+
+/**
+ * Check that the erased slots are reused by the insertions, that the keys
+ * probed past an erased slot are still found, and that a table whose slots
+ * are mostly erased is rehashed without growing
+ */
+class MmWaveFlatHashMapTombstoneTestCase : public TestCase
+{
+public:
+  MmWaveFlatHashMapTombstoneTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveFlatHashMapTombstoneTestCase::MmWaveFlatHashMapTombstoneTestCase ()
+  : TestCase ("erased slots")
+{
+}
+
+void
+MmWaveFlatHashMapTombstoneTestCase::DoRun (void)
+{
+  MmWaveFlatHashMap<uint64_t> table;
+  // 11 keys in the 16 slots of the first allocation collide in some probe sequences
+  for (uint64_t key = 0; key < 11; key++)
+    {
+      table.Get (key) = key * 10;
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetCapacity (), 16, "the first allocation should have 16 slots");
+
+  // erasing any key must not hide the keys placed after it in a probe sequence
+  for (uint64_t erased = 0; erased < 11; erased++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table.Erase (erased), true, "key " << erased << " should be erased");
+      NS_TEST_ASSERT_MSG_EQ (table.Erase (erased), false, "key " << erased << " should be erased once");
+      NS_TEST_ASSERT_MSG_EQ (table.Find (erased), 0, "key " << erased << " should not be found");
+      for (uint64_t key = 0; key < 11; key++)
+        {
+          if (key != erased)
+            {
+              const uint64_t *value = table.Find (key);
+              NS_TEST_ASSERT_MSG_NE (value, 0, "key " << key << " is hidden by erased key " << erased);
+              NS_TEST_ASSERT_MSG_EQ (*value, key * 10, "wrong value of key " << key);
+            }
+        }
+      // the erased slot is reused, and the value is default constructed
+      NS_TEST_ASSERT_MSG_EQ (table.Get (erased), 0, "a reinserted key should have a default value");
+      table.Get (erased) = erased * 10;
+      NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 11, "wrong size after reinserting key " << erased);
+      NS_TEST_ASSERT_MSG_EQ (table.GetCapacity (), 16, "reinserting key " << erased << " should not grow the table");
+    }
+
+  // replace a few keys many times: the erased slots fill the table and
+  // trigger rehashes that drop them instead of growing the table
+  MmWaveFlatHashMap<uint64_t> churn;
+  for (uint64_t round = 0; round < 100; round++)
+    {
+      for (uint64_t key = 0; key < 4; key++)
+        {
+          if (round > 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (churn.Erase ((round - 1) * 100 + key), true, "key of round " << round - 1 << " should be erased");
+            }
+          churn.Get (round * 100 + key) = round;
+        }
+      NS_TEST_ASSERT_MSG_EQ (churn.GetSize (), 4, "wrong size in round " << round);
+      NS_TEST_ASSERT_MSG_EQ (churn.GetCapacity (), 16, "the table should not grow in round " << round);
+    }
+  for (uint64_t key = 0; key < 4; key++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (*churn.Find (9900 + key), 99, "key " << 9900 + key << " lost by the rehashes");
+      NS_TEST_ASSERT_MSG_EQ (churn.Find (9800 + key), 0, "erased key " << 9800 + key << " found after the rehashes");
+    }
+}
+
+/**
+ * Check the indices of MmWaveDeviceRegistry and the directed links of
+ * MmWaveLinkTable
+ */
+class MmWaveLinkTableTestCase : public TestCase
+{
+public:
+  MmWaveLinkTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveLinkTableTestCase::MmWaveLinkTableTestCase ()
+  : TestCase ("device registry and link table")
+{
+}
+
+void
+MmWaveLinkTableTestCase::DoRun (void)
+{
+  MmWaveDeviceRegistry registry;
+  std::vector<Ptr<NetDevice> > devices;
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      devices.push_back (CreateObject<SimpleNetDevice> ());
+      NS_TEST_ASSERT_MSG_EQ (registry.GetIndex (devices[i]), MmWaveDeviceRegistry::INVALID_INDEX,
+                             "device " << i << " is not registered yet");
+      NS_TEST_ASSERT_MSG_EQ (registry.Register (devices[i]), i, "devices should be numbered in order of registration");
+    }
+  for (uint32_t i = 0; i < devices.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (registry.Register (devices[i]), i, "a device registered again should keep its index");
+      NS_TEST_ASSERT_MSG_EQ (registry.GetIndex (devices[i]), i, "wrong index of device " << i);
+      NS_TEST_ASSERT_MSG_EQ (registry.GetDevice (i), devices[i], "wrong device of index " << i);
+    }
+
+  MmWaveLinkTable<double> links;
+  links.Get (3, 5) = 1.5;
+  NS_TEST_ASSERT_MSG_EQ (links.Find (5, 3), 0, "the links should be directed");
+  links.Get (5, 3) = 2.5;
+  NS_TEST_ASSERT_MSG_EQ (*links.Find (3, 5), 1.5, "wrong state of link (3, 5)");
+  NS_TEST_ASSERT_MSG_EQ (*links.Find (5, 3), 2.5, "wrong state of link (5, 3)");
+  // the two indices are not mixed
+  NS_TEST_ASSERT_MSG_EQ (links.Find (0, (3 << 16) | 5), 0, "link (0, 3 << 16 | 5) should not exist");
+  NS_TEST_ASSERT_MSG_EQ (links.GetSize (), 2, "wrong number of links");
+  NS_TEST_ASSERT_MSG_EQ (links.Erase (3, 5), true, "link (3, 5) should be erased");
+  NS_TEST_ASSERT_MSG_EQ (links.Find (3, 5), 0, "link (3, 5) should not exist");
+  NS_TEST_ASSERT_MSG_EQ (*links.Find (5, 3), 2.5, "link (5, 3) should survive the erasure of (3, 5)");
+  links.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (links.GetSize (), 0, "a cleared table should be empty");
+
+  registry.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (registry.GetIndex (devices[0]), MmWaveDeviceRegistry::INVALID_INDEX,
+                         "a cleared registry should forget the devices");
+  NS_TEST_ASSERT_MSG_EQ (registry.Register (devices[7]), 0, "a cleared registry should number the devices from 0");
+}
+
+class MmWaveLinkTableTestSuite : public TestSuite
+{
+public:
+  MmWaveLinkTableTestSuite ();
+};
+
+MmWaveLinkTableTestSuite::MmWaveLinkTableTestSuite ()
+  : TestSuite ("mmwave-link-table", UNIT)
+{
+  AddTestCase (new MmWaveFlatHashMapRandomTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveFlatHashMapTombstoneTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveLinkTableTestCase, TestCase::QUICK);
+}
+
+static MmWaveLinkTableTestSuite g_mmWaveLinkTableTestSuite;
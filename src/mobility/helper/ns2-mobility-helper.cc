@@ -41,14 +41,27 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <algorithm>
+#include <iterator>
+#include <string.h>
+#include <stdlib.h>
+#include "ns3/core-config.h"
 #include "ns3/log.h"
 #include "ns3/unused.h"
 #include "ns3/simulator.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/node-list.h"
 #include "ns3/node.h"
 #include "ns3/constant-velocity-mobility-model.h"
 #include "ns2-mobility-helper.h"
 
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ns2MobilityHelper");
@@ -166,10 +179,12 @@ static bool IsSchedSetPos (ParseResult pr);
 static bool IsSchedMobilityPos (ParseResult pr);
 
 /**
- * Set waypoints and speed for movement.
+ * Set waypoints and speed for movement. The times are relative to the
+ * Install, and elapsed is the time since the Install.
  */
 static DestinationPoint SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector lastPos, double at,
-                                     double xFinalPosition, double yFinalPosition, double speed);
+                                     double xFinalPosition, double yFinalPosition, double speed,
+                                     Time elapsed);
 
 /**
  * Set initial position for a node
@@ -182,8 +197,140 @@ static Vector SetInitialPosition (Ptr<ConstantVelocityMobilityModel> model, std:
 static Vector SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, double at, std::string coord, double coordVal);
 
 
+/**
+ * A token of a line of ns2 mobility, pointing into the line
+ */
+struct Ns2Token
+{
+  const char *m_begin; //!< first character of the token
+  size_t m_size;       //!< number of characters of the token
+};
+
+/**
+ * A statement of a line of ns2 mobility, as parsed by ParseNs2Statement
+ */
+struct Ns2Statement
+{
+  /// The kinds of statements
+  enum Type
+  {
+    EMPTY,            //!< blank line or comment
+    INVALID,          //!< not a valid statement
+    INITIAL_POSITION, //!< $node_(0) set X_ 123
+    SCHED_POSITION,   //!< $ns_ at 1 "$node_(0) set X_ 2"
+    SCHED_SETDEST     //!< $ns_ at 1 "$node_(0) setdest 2 3 4"
+  };
+  Type m_type;          //!< kind of statement
+  uint32_t m_nodeId;    //!< node of the statement
+  double m_at;          //!< time of a scheduled statement
+  std::string m_coord;  //!< X_, Y_ or Z_ for the set statements
+  double m_values[3];   //!< the coordinate value, or x, y and speed for setdest
+};
+
+/**
+ * Split a line of ns2 mobility into tokens, without copying it. Blanks,
+ * quotes and semicolons separate the tokens, and a # starts a comment.
+ * \param begin first character of the line
+ * \param end end of the line
+ * \param tokens filled with the first maxTokens tokens
+ * \param maxTokens size of tokens
+ * \return the number of tokens of the line, which may be more than maxTokens
+ */
+static size_t TokenizeNs2Line (const char *begin, const char *end, Ns2Token *tokens, size_t maxTokens);
+
+/**
+ * Parse a line of ns2 mobility with TokenizeNs2Line
+ * \param begin first character of the line
+ * \param end end of the line
+ * \param statement filled with the statement of the line
+ */
+static void ParseNs2Statement (const char *begin, const char *end, Ns2Statement &statement);
+
+
+/**
+ * Reads the movements of a ns2 mobility file while the simulation runs,
+ * for Ns2MobilityHelper::SetStreamingWindow. It is kept alive by its next
+ * scheduled read, and by nothing else, so it is deleted after the last
+ * read or by Simulator::Destroy.
+ */
+class Ns2MobilityStreamReader : public SimpleRefCount<Ns2MobilityStreamReader>
+{
+public:
+  /**
+   * Map the file
+   * \param filename filename of the ns2 mobility trace
+   * \param window time between two reads
+   * \param objects the input objects, indexed by node id
+   */
+  Ns2MobilityStreamReader (std::string filename, Time window, const std::vector<Ptr<Object> > &objects);
+  ~Ns2MobilityStreamReader ();
+
+  /**
+   * Set the initial positions of the statements at the start of the
+   * file, up to the first scheduled statement
+   */
+  void ReadInitialPositions (void);
+
+  /**
+   * Schedule the movements of the next two windows, and the next read
+   */
+  void Read (void);
+
+private:
+  /// What is known of a node while the file is read
+  struct NodeState
+  {
+    Ptr<ConstantVelocityMobilityModel> m_model; //!< mobility model, created at the first statement of the node
+    DestinationPoint m_point; //!< last movement scheduled
+    Vector m_position;        //!< position set by the last set statement
+  };
+
+  /**
+   * Find the line at the read offset
+   * \param begin set to the first character of the line
+   * \param end set to the end of the line
+   * \return false at the end of the file
+   */
+  bool GetLine (const char *&begin, const char *&end) const;
+
+  /**
+   * Move the read offset after a line
+   * \param end the end of the line
+   */
+  void SkipLine (const char *end);
+
+  /**
+   * Get or create the mobility model of a node
+   * \param id the node id
+   * \return the mobility model, or 0 if there is no such input object
+   */
+  Ptr<ConstantVelocityMobilityModel> GetMobilityModel (uint32_t id);
+
+  /**
+   * Give back the pages of the file before the read offset
+   */
+  void ReleaseReadPages (void);
+
+  /**
+   * Unmap the file
+   */
+  void Close (void);
+
+  Time m_window;             //!< time between two reads
+  Time m_start;              //!< time of the Install, the origin of the times of the file
+  const char *m_data;        //!< content of the file
+  size_t m_size;             //!< size of the file
+  size_t m_offset;           //!< offset of the next line to read
+  size_t m_released;         //!< size of the pages already released
+  std::vector<char> m_buffer; //!< content of the file, if it cannot be mapped
+  std::vector<Ptr<Object> > m_objects; //!< input objects, indexed by node id
+  std::vector<NodeState> m_nodes;      //!< state of the nodes, indexed by node id
+};
+
+
 Ns2MobilityHelper::Ns2MobilityHelper (std::string filename)
-  : m_filename (filename)
+  : m_filename (filename),
+    m_streamingWindow (Seconds (0))
 {
   std::ifstream file (m_filename.c_str (), std::ios::in);
   if (!(file.is_open ())) NS_FATAL_ERROR("Could not open trace file " << m_filename.c_str() << " for reading, aborting here \n"); 
@@ -211,9 +358,23 @@ Ns2MobilityHelper::GetMobilityModel (std::string idString, const ObjectStore &st
 }
 
 
+void
+Ns2MobilityHelper::SetStreamingWindow (Time window)
+{
+  NS_ASSERT_MSG (!window.IsNegative (), "The streaming window cannot be negative");
+  m_streamingWindow = window;
+}
+
+
 void
 Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 {
+  if (!m_streamingWindow.IsZero ())
+    {
+      StreamNodesMovements (store);
+      return;
+    }
+
   std::map<int, DestinationPoint> last_pos;    // Stores previous movement scheduled for each node
 
   //*****************************************************************
@@ -394,7 +555,7 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
                       last_pos[iNodeId].m_finalPosition = reached;
                     }
                   //                                     last position     time  X coord     Y coord      velocity
-                  last_pos[iNodeId] = SetMovement (model, last_pos[iNodeId].m_finalPosition, at, pr.dvals[5], pr.dvals[6], pr.dvals[7]);
+                  last_pos[iNodeId] = SetMovement (model, last_pos[iNodeId].m_finalPosition, at, pr.dvals[5], pr.dvals[6], pr.dvals[7], Seconds (0));
 
                   // Log new position
                   NS_LOG_DEBUG ("Positions after parse for node " << iNodeId << " " << nodeId << " position =" << last_pos[iNodeId].m_finalPosition);
@@ -430,6 +591,438 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 }
 
 
+void
+Ns2MobilityHelper::StreamNodesMovements (const ObjectStore &store) const
+{
+  std::vector<Ptr<Object> > objects;
+  for (uint32_t i = 0; ; ++i)
+    {
+      Ptr<Object> object = store.Get (i);
+      if (object == 0)
+        {
+          break;
+        }
+      objects.push_back (object);
+    }
+
+  Ptr<Ns2MobilityStreamReader> reader = Create<Ns2MobilityStreamReader> (m_filename, m_streamingWindow, objects);
+  reader->ReadInitialPositions ();
+  reader->Read ();
+}
+
+
+Ns2MobilityStreamReader::Ns2MobilityStreamReader (std::string filename, Time window,
+                                                  const std::vector<Ptr<Object> > &objects)
+  : m_window (window),
+    m_start (Simulator::Now ()),
+    m_data (0),
+    m_size (0),
+    m_offset (0),
+    m_released (0),
+    m_objects (objects),
+    m_nodes (objects.size ())
+{
+#ifdef HAVE_SYS_MMAN_H
+  int fd = open (filename.c_str (), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat (fd, &st) != 0)
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << filename << " for reading");
+    }
+  m_size = st.st_size;
+  if (m_size > 0)
+    {
+      void *data = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED)
+        {
+          NS_FATAL_ERROR ("Could not map trace file " << filename);
+        }
+      madvise (data, m_size, MADV_SEQUENTIAL);
+      m_data = static_cast<const char *> (data);
+    }
+  close (fd);
+#else
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << filename << " for reading");
+    }
+  m_buffer.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+  m_size = m_buffer.size ();
+  m_data = m_size > 0 ? &m_buffer[0] : 0;
+#endif
+
+  // the nodes of the trace are not known before it is read, and the
+  // models are needed now, e.g., to connect to their traces
+  for (uint32_t id = 0; id < m_objects.size (); ++id)
+    {
+      if (m_objects[id]->GetObject<MobilityModel> () == 0)
+        {
+          GetMobilityModel (id);
+        }
+    }
+}
+
+Ns2MobilityStreamReader::~Ns2MobilityStreamReader ()
+{
+  Close ();
+}
+
+void
+Ns2MobilityStreamReader::Close (void)
+{
+#ifdef HAVE_SYS_MMAN_H
+  if (m_data != 0)
+    {
+      munmap (const_cast<char *> (m_data), m_size);
+    }
+#endif
+  m_buffer.clear ();
+  m_data = 0;
+  m_size = 0;
+  m_offset = 0;
+  m_released = 0;
+}
+
+bool
+Ns2MobilityStreamReader::GetLine (const char *&begin, const char *&end) const
+{
+  if (m_offset >= m_size)
+    {
+      return false;
+    }
+  begin = m_data + m_offset;
+  end = static_cast<const char *> (memchr (begin, '\n', m_size - m_offset));
+  if (end == 0)
+    {
+      end = m_data + m_size;
+    }
+  return true;
+}
+
+void
+Ns2MobilityStreamReader::SkipLine (const char *end)
+{
+  m_offset = std::min (static_cast<size_t> (end - m_data) + 1, m_size);
+}
+
+void
+Ns2MobilityStreamReader::ReleaseReadPages (void)
+{
+#ifdef HAVE_SYS_MMAN_H
+  size_t pageSize = sysconf (_SC_PAGESIZE);
+  size_t read = m_offset / pageSize * pageSize;
+  if (read > m_released)
+    {
+      madvise (const_cast<char *> (m_data) + m_released, read - m_released, MADV_DONTNEED);
+      m_released = read;
+    }
+#endif
+}
+
+Ptr<ConstantVelocityMobilityModel>
+Ns2MobilityStreamReader::GetMobilityModel (uint32_t id)
+{
+  if (id >= m_objects.size ())
+    {
+      return 0;
+    }
+  NodeState &node = m_nodes[id];
+  if (node.m_model == 0)
+    {
+      node.m_model = m_objects[id]->GetObject<ConstantVelocityMobilityModel> ();
+      if (node.m_model == 0)
+        {
+          node.m_model = CreateObject<ConstantVelocityMobilityModel> ();
+          m_objects[id]->AggregateObject (node.m_model);
+        }
+      node.m_position = node.m_model->GetPosition ();
+    }
+  return node.m_model;
+}
+
+void
+Ns2MobilityStreamReader::ReadInitialPositions (void)
+{
+  const char *begin;
+  const char *end;
+  Ns2Statement statement;
+  while (GetLine (begin, end))
+    {
+      ParseNs2Statement (begin, end, statement);
+      if (statement.m_type == Ns2Statement::SCHED_POSITION || statement.m_type == Ns2Statement::SCHED_SETDEST)
+        {
+          break;
+        }
+      SkipLine (end);
+
+      if (statement.m_type == Ns2Statement::INVALID)
+        {
+          NS_LOG_ERROR ("Line is not a valid statement (corrupted file?): " << std::string (begin, end));
+          continue;
+        }
+      if (statement.m_type == Ns2Statement::EMPTY)
+        {
+          continue;
+        }
+
+      Ptr<ConstantVelocityMobilityModel> model = GetMobilityModel (statement.m_nodeId);
+      if (model == 0)
+        {
+          NS_LOG_ERROR ("Unknown node ID (corrupted file?): " << statement.m_nodeId);
+          continue;
+        }
+      NodeState &node = m_nodes[statement.m_nodeId];
+      node.m_point = DestinationPoint ();
+      node.m_point.m_finalPosition = SetInitialPosition (model, statement.m_coord, statement.m_values[0]);
+      node.m_position = node.m_point.m_finalPosition;
+      NS_LOG_DEBUG ("Positions after parse for node " << statement.m_nodeId <<
+                    " position = " << node.m_point.m_finalPosition);
+    }
+}
+
+void
+Ns2MobilityStreamReader::Read (void)
+{
+  Time elapsed = Simulator::Now () - m_start;
+  Time horizon = elapsed + m_window + m_window;
+  Time next;
+  bool pending = false;
+
+  const char *begin;
+  const char *end;
+  Ns2Statement statement;
+  while (GetLine (begin, end))
+    {
+      ParseNs2Statement (begin, end, statement);
+      Time at = Seconds (statement.m_at);
+      if ((statement.m_type == Ns2Statement::SCHED_POSITION || statement.m_type == Ns2Statement::SCHED_SETDEST)
+          && at > horizon)
+        {
+          // left for a later read
+          next = at;
+          pending = true;
+          break;
+        }
+      SkipLine (end);
+
+      if (statement.m_type == Ns2Statement::EMPTY)
+        {
+          continue;
+        }
+      if (statement.m_type == Ns2Statement::INVALID)
+        {
+          NS_LOG_ERROR ("Line is not a valid statement (corrupted file?): " << std::string (begin, end));
+          continue;
+        }
+      if (statement.m_type == Ns2Statement::INITIAL_POSITION)
+        {
+          NS_LOG_WARN ("Initial position after the scheduled statements is ignored: " << std::string (begin, end));
+          continue;
+        }
+      if (at < elapsed)
+        {
+          NS_LOG_WARN ("Time " << statement.m_at << " is in the past, the trace is not sorted by time: "
+                                << std::string (begin, end));
+          continue;
+        }
+
+      Ptr<ConstantVelocityMobilityModel> model = GetMobilityModel (statement.m_nodeId);
+      if (model == 0)
+        {
+          NS_LOG_ERROR ("Unknown node ID (corrupted file?): " << statement.m_nodeId);
+          continue;
+        }
+      NodeState &node = m_nodes[statement.m_nodeId];
+      DestinationPoint &last = node.m_point;
+
+      if (statement.m_type == Ns2Statement::SCHED_SETDEST)
+        {
+          if (last.m_targetArrivalTime > statement.m_at)
+            {
+              NS_LOG_LOGIC ("Did not reach a destination! stoptime = " << last.m_targetArrivalTime << ", at = " << statement.m_at);
+              double actuallytraveled = statement.m_at - last.m_travelStartTime;
+              Vector reached = Vector (
+                  last.m_startPosition.x + last.m_speed.x * actuallytraveled,
+                  last.m_startPosition.y + last.m_speed.y * actuallytraveled,
+                  0
+                  );
+              NS_LOG_LOGIC ("Final point = " << last.m_finalPosition << ", actually reached = " << reached);
+              last.m_stopEvent.Cancel ();
+              last.m_finalPosition = reached;
+            }
+          last = SetMovement (model, last.m_finalPosition, statement.m_at,
+                              statement.m_values[0], statement.m_values[1], statement.m_values[2], elapsed);
+        }
+      else
+        {
+          // the other coordinates are those of the last set statement,
+          // as they are taken from the model when the whole file is read
+          node.m_position = SetOneInitialCoord (node.m_position, statement.m_coord, statement.m_values[0]);
+          Simulator::Schedule (at - elapsed, &ConstantVelocityMobilityModel::SetPosition, model, node.m_position);
+          last.m_finalPosition = node.m_position;
+          if (last.m_targetArrivalTime > statement.m_at)
+            {
+              last.m_stopEvent.Cancel ();
+            }
+          last.m_targetArrivalTime = statement.m_at;
+          last.m_travelStartTime = statement.m_at;
+        }
+      NS_LOG_DEBUG ("Positions after parse for node " << statement.m_nodeId <<
+                    " position =" << last.m_finalPosition);
+    }
+
+  ReleaseReadPages ();
+  if (!pending)
+    {
+      NS_LOG_LOGIC ("End of the trace");
+      Close ();
+      return;
+    }
+  // read again when the pending statement is within two windows, but not
+  // before a window, so that each movement is scheduled at least a window
+  // in advance
+  Time delay = std::max (m_window, next - horizon);
+  Simulator::Schedule (delay, &Ns2MobilityStreamReader::Read, Ptr<Ns2MobilityStreamReader> (this));
+}
+
+
+size_t
+TokenizeNs2Line (const char *begin, const char *end, Ns2Token *tokens, size_t maxTokens)
+{
+  size_t n = 0;
+  const char *p = begin;
+  while (p < end && *p != '#')
+    {
+      if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '"' || *p == ';')
+        {
+          ++p;
+          continue;
+        }
+      const char *token = p;
+      while (p < end && *p != '#' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '"' && *p != ';')
+        {
+          ++p;
+        }
+      if (n < maxTokens)
+        {
+          tokens[n].m_begin = token;
+          tokens[n].m_size = p - token;
+        }
+      ++n;
+    }
+  return n;
+}
+
+/**
+ * Check if a token is a string
+ */
+static bool
+IsNs2Token (const Ns2Token &token, const char *str)
+{
+  size_t size = strlen (str);
+  return token.m_size == size && memcmp (token.m_begin, str, size) == 0;
+}
+
+/**
+ * Check if a token is a coordinate name, and get it
+ */
+static bool
+GetNs2Coord (const Ns2Token &token, std::string &coord)
+{
+  if (IsNs2Token (token, NS2_X_COORD) || IsNs2Token (token, NS2_Y_COORD) || IsNs2Token (token, NS2_Z_COORD))
+    {
+      coord.assign (token.m_begin, token.m_size);
+      return true;
+    }
+  return false;
+}
+
+/**
+ * Check if a token is a number, and get it
+ */
+static bool
+GetNs2Double (const Ns2Token &token, double &value)
+{
+  char str[64];
+  if (token.m_size == 0 || token.m_size >= sizeof (str))
+    {
+      return false;
+    }
+  memcpy (str, token.m_begin, token.m_size);
+  str[token.m_size] = 0;
+  char *endp;
+  value = strtod (str, &endp);
+  return endp == str + token.m_size;
+}
+
+/**
+ * Check if a token has a node id like $node_(4), and get it
+ */
+static bool
+GetNs2NodeId (const Ns2Token &token, uint32_t &id)
+{
+  const char *end = token.m_begin + token.m_size;
+  const char *p = static_cast<const char *> (memchr (token.m_begin, '(', token.m_size));
+  if (p == 0)
+    {
+      return false;
+    }
+  const char *digits = ++p;
+  uint64_t value = 0;
+  while (p < end && *p >= '0' && *p <= '9' && value <= 0xffffffff)
+    {
+      value = value * 10 + (*p - '0');
+      ++p;
+    }
+  if (p == digits || p == end || *p != ')' || value > 0xffffffff)
+    {
+      return false;
+    }
+  id = static_cast<uint32_t> (value);
+  return true;
+}
+
+void
+ParseNs2Statement (const char *begin, const char *end, Ns2Statement &statement)
+{
+  Ns2Token tokens[8];
+  size_t n = TokenizeNs2Line (begin, end, tokens, 8);
+
+  statement.m_type = Ns2Statement::INVALID;
+  statement.m_at = 0;
+  if (n == 0)
+    {
+      statement.m_type = Ns2Statement::EMPTY;
+    }
+  else if (n == 4)
+    {
+      // line like $node_(0) set X_ 123
+      if (GetNs2NodeId (tokens[0], statement.m_nodeId) && IsNs2Token (tokens[1], NS2_SET)
+          && GetNs2Coord (tokens[2], statement.m_coord) && GetNs2Double (tokens[3], statement.m_values[0]))
+        {
+          statement.m_type = Ns2Statement::INITIAL_POSITION;
+        }
+    }
+  else if ((n == 7 || n == 8) && IsNs2Token (tokens[0], NS2_NS_SCH) && IsNs2Token (tokens[1], NS2_AT)
+           && GetNs2Double (tokens[2], statement.m_at) && GetNs2NodeId (tokens[3], statement.m_nodeId))
+    {
+      // line like $ns_ at 1 "$node_(0) set X_ 2"
+      if (n == 7 && IsNs2Token (tokens[4], NS2_SET) && GetNs2Coord (tokens[5], statement.m_coord)
+          && GetNs2Double (tokens[6], statement.m_values[0]))
+        {
+          statement.m_type = Ns2Statement::SCHED_POSITION;
+        }
+      // line like $ns_ at 1 "$node_(0) setdest 2 3 4"
+      else if (n == 8 && IsNs2Token (tokens[4], NS2_SETDEST) && GetNs2Double (tokens[5], statement.m_values[0])
+               && GetNs2Double (tokens[6], statement.m_values[1]) && GetNs2Double (tokens[7], statement.m_values[2]))
+        {
+          statement.m_type = Ns2Statement::SCHED_SETDEST;
+        }
+    }
+}
+
+
 ParseResult
 ParseNs2Line (const std::string& str)
 {
@@ -731,7 +1324,7 @@ IsSchedMobilityPos (ParseResult pr)
 
 DestinationPoint
 SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at,
-             double xFinalPosition, double yFinalPosition, double speed)
+             double xFinalPosition, double yFinalPosition, double speed, Time elapsed)
 {
   DestinationPoint retval;
   retval.m_startPosition = last_pos;
@@ -742,7 +1335,7 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
   if (speed == 0)
     {
       // We have to maintain last position, and stop the movement
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model,
+      retval.m_stopEvent = Simulator::Schedule (Seconds (at) - elapsed, &ConstantVelocityMobilityModel::SetVelocity, model,
                                                 Vector (0, 0, 0));
       return retval;
     }
@@ -766,8 +1359,8 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
       NS_LOG_DEBUG ("Calculated Speed: X=" << xSpeed << " Y=" << ySpeed << " Z=" << zSpeed);
 
       // Set the Values
-      Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (xSpeed, ySpeed, zSpeed));
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at + time), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
+      Simulator::Schedule (Seconds (at) - elapsed, &ConstantVelocityMobilityModel::SetVelocity, model, Vector (xSpeed, ySpeed, zSpeed));
+      retval.m_stopEvent = Simulator::Schedule (Seconds (at + time) - elapsed, &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
       retval.m_finalPosition.x += xSpeed * time;
       retval.m_finalPosition.y += ySpeed * time;
       retval.m_targetArrivalTime += time;
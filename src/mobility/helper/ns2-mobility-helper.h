@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -69,6 +70,15 @@ class ConstantVelocityMobilityModel;
  *
  *  See usage example in examples/mobility/ns2-mobility-trace.cc
  *
+ * By default the whole file is read by Install, and all the movements are
+ * scheduled at once. For long traces, SetStreamingWindow makes Install
+ * read only the initial positions, and the movements are read while the
+ * simulation runs, a window at a time, so that neither the time taken by
+ * Install nor the size of the event queue grow with the length of the
+ * trace. In this mode the scheduled statements must be sorted by time, as
+ * in the traces written by SUMO, and the initial position statements must
+ * come before them.
+ *
  * \bug Rounding errors may cause movement to diverge from the mobility
  * pattern in ns-2 (using the same trace).
  * See https://www.nsnam.org/bugzilla/show_bug.cgi?id=1316
@@ -103,6 +113,23 @@ public:
    */
   template <typename T>
   void Install (T begin, T end) const;
+
+  /**
+   * \brief Read the trace while the simulation runs
+   * \param window the time between two reads of the trace. Each read
+   *        schedules the movements of the next two windows. If zero, the
+   *        default, the whole trace is read by Install.
+   *
+   * The file is memory mapped, where supported, and the pages already read
+   * are released, so that the memory used does not grow with the length of
+   * the trace either. A scheduled statement earlier than the time of the
+   * read, i.e., out of order by more than the window, is ignored with a
+   * warning, as well as an initial position statement that follows the
+   * first scheduled statement. Since the nodes of the trace are only known
+   * as it is read, Install gives a ConstantVelocityMobilityModel to all the
+   * input objects without a mobility model, not only to those in the trace.
+   */
+  void SetStreamingWindow (Time window);
 private:
   /**
    * \brief a class to hold input objects internally
@@ -123,6 +150,12 @@ public:
    * \param store Object store containing ns-3 mobility models
    */
   void ConfigNodesMovements (const ObjectStore &store) const;
+  /**
+   * Sets the initial positions of the ns-2 mobility file, and starts
+   * reading its movements a window at a time
+   * \param store Object store containing ns-3 mobility models
+   */
+  void StreamNodesMovements (const ObjectStore &store) const;
   /**
    * Get or create a ConstantVelocityMobilityModel corresponding to idString
    * \param idString string name for a node
@@ -131,6 +164,7 @@ public:
    */
   Ptr<ConstantVelocityMobilityModel> GetMobilityModel (std::string idString, const ObjectStore &store) const;
   std::string m_filename; //!< filename of file containing ns-2 mobility trace 
+  Time m_streamingWindow; //!< time between two reads of the trace, zero to read it all at Install
 };
 
 } // namespace ns3
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <vector>
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/log.h"
+#include "mobility-model.h"
+#include "mobility-snapshot.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobilitySnapshot");
+
+/**
+ * \ingroup mobility
+ * \brief private implementation detail of the MobilitySnapshot API.
+ */
+class MobilitySnapshotPriv
+{
+public:
+  /**
+   * The state of a node
+   */
+  struct Entry
+  {
+    Ptr<MobilityModel> m_mobility; //!< the mobility model of the node, 0 until the first query
+    int64_t m_time;                //!< time step at which the position and velocity were read
+    bool m_valid;                  //!< false if the node changed course since they were read
+    Vector m_position;             //!< position of the node at m_time
+    Vector m_velocity;             //!< velocity of the node at m_time
+
+    Entry ()
+      : m_time (0),
+        m_valid (false)
+    {
+    }
+  };
+
+  /**
+   * \return the snapshot, which is created on the first call of each simulation
+   */
+  static MobilitySnapshotPriv * Get (void);
+
+  /**
+   * \param nodeId the id of the node
+   * \return the entry of the node, up to date at the current simulation time
+   */
+  const Entry & Lookup (uint32_t nodeId);
+
+private:
+  /**
+   * \return the location of the pointer to the snapshot
+   */
+  static MobilitySnapshotPriv ** DoGet (void);
+
+  /**
+   * Delete the snapshot when the simulator is destroyed
+   */
+  static void Delete (void);
+
+  /**
+   * Invalidate the entry of a node, connected to its CourseChange trace
+   * \param nodeId the id of the node
+   * \param mobility the mobility model of the node
+   */
+  static void NotifyCourseChange (uint32_t nodeId, Ptr<const MobilityModel> mobility);
+
+  std::vector<Entry> m_entries; //!< the entries, indexed by node id
+};
+
+MobilitySnapshotPriv **
+MobilitySnapshotPriv::DoGet (void)
+{
+  static MobilitySnapshotPriv *ptr = 0;
+  return &ptr;
+}
+
+MobilitySnapshotPriv *
+MobilitySnapshotPriv::Get (void)
+{
+  MobilitySnapshotPriv **ptr = DoGet ();
+  if (*ptr == 0)
+    {
+      *ptr = new MobilitySnapshotPriv ();
+      Simulator::ScheduleDestroy (&MobilitySnapshotPriv::Delete);
+    }
+  return *ptr;
+}
+
+void
+MobilitySnapshotPriv::Delete (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  MobilitySnapshotPriv **ptr = DoGet ();
+  delete *ptr;
+  *ptr = 0;
+}
+
+void
+MobilitySnapshotPriv::NotifyCourseChange (uint32_t nodeId, Ptr<const MobilityModel> mobility)
+{
+  // the callbacks of the previous simulations may still be connected
+  MobilitySnapshotPriv *priv = *DoGet ();
+  if (priv != 0 && nodeId < priv->m_entries.size ())
+    {
+      priv->m_entries[nodeId].m_valid = false;
+    }
+}
+
+const MobilitySnapshotPriv::Entry &
+MobilitySnapshotPriv::Lookup (uint32_t nodeId)
+{
+  if (nodeId >= m_entries.size ())
+    {
+      m_entries.resize (std::max (nodeId + 1, NodeList::GetNNodes ()));
+    }
+  Entry &entry = m_entries[nodeId];
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  if (entry.m_valid && entry.m_time == now)
+    {
+      return entry;
+    }
+  if (entry.m_mobility == 0)
+    {
+      entry.m_mobility = NodeList::GetNode (nodeId)->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (entry.m_mobility != 0, "node " << nodeId << " has no mobility model");
+      entry.m_mobility->TraceConnectWithoutContext ("CourseChange",
+                                                    MakeBoundCallback (&MobilitySnapshotPriv::NotifyCourseChange, nodeId));
+    }
+  entry.m_position = entry.m_mobility->GetPosition ();
+  entry.m_velocity = entry.m_mobility->GetVelocity ();
+  entry.m_time = now;
+  entry.m_valid = true;
+  return entry;
+}
+
+Vector
+MobilitySnapshot::GetPosition (uint32_t nodeId)
+{
+  return MobilitySnapshotPriv::Get ()->Lookup (nodeId).m_position;
+}
+
+Vector
+MobilitySnapshot::GetVelocity (uint32_t nodeId)
+{
+  return MobilitySnapshotPriv::Get ()->Lookup (nodeId).m_velocity;
+}
+
+double
+MobilitySnapshot::GetDistanceSquaredBetween (uint32_t a, uint32_t b)
+{
+  MobilitySnapshotPriv *priv = MobilitySnapshotPriv::Get ();
+  // copied, since the second lookup may grow the array
+  Vector positionA = priv->Lookup (a).m_position;
+  const Vector &positionB = priv->Lookup (b).m_position;
+  double dx = positionA.x - positionB.x;
+  double dy = positionA.y - positionB.y;
+  double dz = positionA.z - positionB.z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace ns3
@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MOBILITY_SNAPSHOT_H
+#define MOBILITY_SNAPSHOT_H
+
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ *
+ * \brief Positions and velocities of the nodes at the current simulation time.
+ *
+ * The first query about a node at a given simulation time reads the
+ * position and the velocity of the MobilityModel aggregated to the node,
+ * and stores them in flat arrays indexed by node id. The following queries
+ * about the node at the same time read the arrays, without the virtual
+ * calls and the update of the mobility model. A course change of the node
+ * (e.g., a SetPosition or a SetVelocity) invalidates its entry.
+ *
+ * The snapshot is cleared when the simulator is destroyed. It must only be
+ * used from the simulation thread.
+ */
+class MobilitySnapshot
+{
+public:
+  /**
+   * \param nodeId the id of a node with a MobilityModel
+   * \return the position of the node at the current simulation time
+   */
+  static Vector GetPosition (uint32_t nodeId);
+  /**
+   * \param nodeId the id of a node with a MobilityModel
+   * \return the velocity of the node at the current simulation time
+   */
+  static Vector GetVelocity (uint32_t nodeId);
+  /**
+   * \param a the id of the first node
+   * \param b the id of the second node
+   * \return the squared distance between the two nodes at the current simulation time
+   */
+  static double GetDistanceSquaredBetween (uint32_t a, uint32_t b);
+};
+
+} // namespace ns3
+
+#endif /* MOBILITY_SNAPSHOT_H */
@@ -0,0 +1,356 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/mobility-snapshot.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief A mobility model that counts the reads of its position, and
+ * whose position can be changed without a course change, as the models
+ * that move between two course changes
+ */
+class MobilitySnapshotTestMobilityModel : public MobilityModel
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void);
+  MobilitySnapshotTestMobilityModel ();
+
+  /**
+   * \param position the new position, set without a course change
+   */
+  void Move (const Vector &position);
+  /**
+   * \return the number of reads of the position
+   */
+  uint32_t GetReads (void) const;
+
+private:
+  virtual Vector DoGetPosition (void) const;
+  virtual void DoSetPosition (const Vector &position);
+  virtual Vector DoGetVelocity (void) const;
+
+  Vector m_position; ///< the position
+  mutable uint32_t m_reads; ///< the number of reads of the position
+};
+
+TypeId
+MobilitySnapshotTestMobilityModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MobilitySnapshotTestMobilityModel")
+    .SetParent<MobilityModel> ()
+    .SetGroupName ("Mobility")
+    .AddConstructor<MobilitySnapshotTestMobilityModel> ()
+  ;
+  return tid;
+}
+
+MobilitySnapshotTestMobilityModel::MobilitySnapshotTestMobilityModel ()
+  : m_reads (0)
+{
+}
+
+void
+MobilitySnapshotTestMobilityModel::Move (const Vector &position)
+{
+  m_position = position;
+}
+
+uint32_t
+MobilitySnapshotTestMobilityModel::GetReads (void) const
+{
+  return m_reads;
+}
+
+Vector
+MobilitySnapshotTestMobilityModel::DoGetPosition (void) const
+{
+  m_reads++;
+  return m_position;
+}
+
+void
+MobilitySnapshotTestMobilityModel::DoSetPosition (const Vector &position)
+{
+  m_position = position;
+  NotifyCourseChange ();
+}
+
+Vector
+MobilitySnapshotTestMobilityModel::DoGetVelocity (void) const
+{
+  return Vector (0, 0, 0);
+}
+
+/**
+ * \param position the position of the node
+ * \return a new node with a MobilitySnapshotTestMobilityModel
+ */
+static Ptr<Node>
+CreateTestNode (const Vector &position)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<MobilitySnapshotTestMobilityModel> mobility = CreateObject<MobilitySnapshotTestMobilityModel> ();
+  mobility->SetPosition (position);
+  node->AggregateObject (mobility);
+  return node;
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check that the mobility model of a node is read once per
+ * simulation time step
+ */
+class MobilitySnapshotCacheTestCase : public TestCase
+{
+public:
+  MobilitySnapshotCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Query the nodes several times in the same time step
+  void CheckSameTimeStep (void);
+  /// Query the nodes in the next time step
+  void CheckNextTimeStep (void);
+
+  Ptr<Node> m_node; ///< the node whose reads are counted
+  Ptr<Node> m_other; ///< another node
+};
+
+MobilitySnapshotCacheTestCase::MobilitySnapshotCacheTestCase ()
+  : TestCase ("MobilitySnapshot reads each node once per time step")
+{
+}
+
+void
+MobilitySnapshotCacheTestCase::CheckSameTimeStep (void)
+{
+  Ptr<MobilitySnapshotTestMobilityModel> mobility = m_node->GetObject<MobilitySnapshotTestMobilityModel> ();
+  uint32_t reads = mobility->GetReads ();
+  uint32_t id = m_node->GetId ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (1, 2, 3)), 0, 1e-9,
+                             "wrong position");
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (1, 2, 3)), 0, 1e-9,
+                             "wrong position");
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetVelocity (id), Vector (0, 0, 0)), 0, 1e-9,
+                             "wrong velocity");
+  NS_TEST_EXPECT_MSG_EQ_TOL (MobilitySnapshot::GetDistanceSquaredBetween (id, m_other->GetId ()), 4 + 4 + 9, 1e-9,
+                             "wrong squared distance");
+  NS_TEST_EXPECT_MSG_EQ (mobility->GetReads (), reads + 1, "the model should be read once in a time step");
+
+  // a move without course change is only seen in the next time step
+  mobility->Move (Vector (5, 5, 5));
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (1, 2, 3)), 0, 1e-9,
+                             "the position should be cached");
+  NS_TEST_EXPECT_MSG_EQ (mobility->GetReads (), reads + 1, "the model should be read once in a time step");
+}
+
+void
+MobilitySnapshotCacheTestCase::CheckNextTimeStep (void)
+{
+  Ptr<MobilitySnapshotTestMobilityModel> mobility = m_node->GetObject<MobilitySnapshotTestMobilityModel> ();
+  uint32_t reads = mobility->GetReads ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (m_node->GetId ()), Vector (5, 5, 5)), 0, 1e-9,
+                         "the position should be read again in a new time step");
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (m_node->GetId ()), Vector (5, 5, 5)), 0, 1e-9,
+                             "wrong position");
+  NS_TEST_EXPECT_MSG_EQ (mobility->GetReads (), reads + 1, "the model should be read once in a time step");
+}
+
+void
+MobilitySnapshotCacheTestCase::DoRun (void)
+{
+  m_node = CreateTestNode (Vector (1, 2, 3));
+  m_other = CreateTestNode (Vector (3, 4, 6));
+  Simulator::Schedule (Seconds (1), &MobilitySnapshotCacheTestCase::CheckSameTimeStep, this);
+  Simulator::Schedule (Seconds (1) + TimeStep (1), &MobilitySnapshotCacheTestCase::CheckNextTimeStep, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_node = 0;
+  m_other = 0;
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check that a SetPosition or a SetVelocity is seen in the same
+ * time step, through the CourseChange trace
+ */
+class MobilitySnapshotCourseChangeTestCase : public TestCase
+{
+public:
+  MobilitySnapshotCourseChangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Change the course of the node and query it
+  void Check (void);
+
+  Ptr<Node> m_node; ///< the node
+  Ptr<Node> m_other; ///< another node
+};
+
+MobilitySnapshotCourseChangeTestCase::MobilitySnapshotCourseChangeTestCase ()
+  : TestCase ("MobilitySnapshot sees the course changes in the same time step")
+{
+}
+
+void
+MobilitySnapshotCourseChangeTestCase::Check (void)
+{
+  Ptr<ConstantVelocityMobilityModel> mobility = m_node->GetObject<ConstantVelocityMobilityModel> ();
+  uint32_t id = m_node->GetId ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (2, 0, 0)), 0, 1e-9,
+                             "wrong position after 2 s at 1 m/s");
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetVelocity (id), Vector (1, 0, 0)), 0, 1e-9,
+                             "wrong velocity");
+
+  mobility->SetPosition (Vector (10, 0, 0));
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (10, 0, 0)), 0, 1e-9,
+                             "SetPosition should invalidate the entry");
+  NS_TEST_EXPECT_MSG_EQ_TOL (MobilitySnapshot::GetDistanceSquaredBetween (id, m_other->GetId ()), 100, 1e-9,
+                             "wrong squared distance after SetPosition");
+
+  mobility->SetVelocity (Vector (0, 2, 0));
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetVelocity (id), Vector (0, 2, 0)), 0, 1e-9,
+                             "SetVelocity should invalidate the entry");
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (10, 0, 0)), 0, 1e-9,
+                             "wrong position after SetVelocity");
+
+  m_other->GetObject<MobilityModel> ()->SetPosition (Vector (10, 3, 4));
+  NS_TEST_EXPECT_MSG_EQ_TOL (MobilitySnapshot::GetDistanceSquaredBetween (id, m_other->GetId ()), 25, 1e-9,
+                             "wrong squared distance after moving the other node");
+}
+
+void
+MobilitySnapshotCourseChangeTestCase::DoRun (void)
+{
+  m_node = CreateObject<Node> ();
+  Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+  mobility->SetPosition (Vector (0, 0, 0));
+  mobility->SetVelocity (Vector (1, 0, 0));
+  m_node->AggregateObject (mobility);
+  m_other = CreateObject<Node> ();
+  Ptr<ConstantPositionMobilityModel> otherMobility = CreateObject<ConstantPositionMobilityModel> ();
+  otherMobility->SetPosition (Vector (0, 0, 0));
+  m_other->AggregateObject (otherMobility);
+
+  Simulator::Schedule (Seconds (2), &MobilitySnapshotCourseChangeTestCase::Check, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_node = 0;
+  m_other = 0;
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check the nodes created after the first query, whose ids are
+ * beyond the arrays of the snapshot
+ */
+class MobilitySnapshotNewNodesTestCase : public TestCase
+{
+public:
+  MobilitySnapshotNewNodesTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Create nodes after the first query and query them
+  void Check (void);
+
+  Ptr<Node> m_node; ///< the node created before the simulation
+};
+
+MobilitySnapshotNewNodesTestCase::MobilitySnapshotNewNodesTestCase ()
+  : TestCase ("MobilitySnapshot handles the nodes created after the first query")
+{
+}
+
+void
+MobilitySnapshotNewNodesTestCase::Check (void)
+{
+  Ptr<MobilitySnapshotTestMobilityModel> mobility = m_node->GetObject<MobilitySnapshotTestMobilityModel> ();
+  uint32_t id = m_node->GetId ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (id), Vector (1, 1, 0)), 0, 1e-9,
+                             "wrong position");
+  uint32_t reads = mobility->GetReads ();
+
+  Ptr<Node> second = CreateTestNode (Vector (4, 5, 0));
+  NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (MobilitySnapshot::GetPosition (second->GetId ()), Vector (4, 5, 0)), 0, 1e-9,
+                         "wrong position of a node created after the first query");
+
+  // the second lookup grows the arrays, and the first position must survive it
+  Ptr<Node> third = CreateTestNode (Vector (1, 1, 12));
+  NS_TEST_EXPECT_MSG_EQ_TOL (MobilitySnapshot::GetDistanceSquaredBetween (id, third->GetId ()), 144, 1e-9,
+                             "wrong squared distance to a node created after the first query");
+  NS_TEST_EXPECT_MSG_EQ_TOL (MobilitySnapshot::GetDistanceSquaredBetween (third->GetId (), second->GetId ()), 9 + 16 + 144, 1e-9,
+                             "wrong squared distance between two new nodes");
+  NS_TEST_EXPECT_MSG_EQ (mobility->GetReads (), reads, "the growth of the arrays should keep the cached entries");
+
+  // the course changes of the new nodes are connected as well
+  third->GetObject<MobilityModel> ()->SetPosition (Vector (1, 1, 2));
+  NS_TEST_EXPECT_MSG_EQ_TOL (MobilitySnapshot::GetDistanceSquaredBetween (id, third->GetId ()), 4, 1e-9,
+                             "a new node should be invalidated by its course changes");
+}
+
+void
+MobilitySnapshotNewNodesTestCase::DoRun (void)
+{
+  m_node = CreateTestNode (Vector (1, 1, 0));
+  Simulator::Schedule (Seconds (1), &MobilitySnapshotNewNodesTestCase::Check, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_node = 0;
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief MobilitySnapshot Test Suite
+ */
+class MobilitySnapshotTestSuite : public TestSuite
+{
+public:
+  MobilitySnapshotTestSuite ();
+};
+
+MobilitySnapshotTestSuite::MobilitySnapshotTestSuite ()
+  : TestSuite ("mobility-snapshot", UNIT)
+{
+  AddTestCase (new MobilitySnapshotCacheTestCase, TestCase::QUICK);
+  AddTestCase (new MobilitySnapshotCourseChangeTestCase, TestCase::QUICK);
+  AddTestCase (new MobilitySnapshotNewNodesTestCase, TestCase::QUICK);
+}
+
+static MobilitySnapshotTestSuite g_mobilitySnapshotTestSuite; ///< the test suite
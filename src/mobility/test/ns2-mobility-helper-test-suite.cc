@@ -56,6 +56,23 @@ NS_LOG_COMPONENT_DEFINE ("ns2-mobility-helper-test-suite");
 // -----------------------------------------------------------------------------
 // Testing
 // -----------------------------------------------------------------------------
+/**
+ * \param name the name of a test case
+ * \param window the streaming window of the helper, zero to read the whole trace
+ * \return the name, with the streaming window if not zero
+ */
+static std::string
+StreamingName (std::string const & name, Time window)
+{
+  if (window.IsZero ())
+    {
+      return name;
+    }
+  std::ostringstream oss;
+  oss << name << " (streaming window " << window.GetSeconds () << " s)";
+  return oss.str ();
+}
+
 bool AreVectorsEqual (Vector const & actual, Vector const & limit, double tol)
 {
   if (actual.x > limit.x + tol || actual.x < limit.x - tol)
@@ -121,11 +138,13 @@ public:
    * \param name        Short description
    * \param timeLimit   Test time limit
    * \param nodes       Number of nodes used in the test trace, 1 by default
+   * \param window      Streaming window of the helper, 0 by default to read the whole trace
    */
-  Ns2MobilityHelperTest (std::string const & name, Time timeLimit, uint32_t nodes = 1)
-    : TestCase (name),
+  Ns2MobilityHelperTest (std::string const & name, Time timeLimit, uint32_t nodes = 1, Time window = Seconds (0))
+    : TestCase (StreamingName (name, window)),
       m_timeLimit (timeLimit),
       m_nodeCount (nodes),
+      m_window (window),
       m_nextRefPoint (0)
   {
   }
@@ -154,6 +173,8 @@ private:
   Time m_timeLimit;
   /// Number of nodes used in the test
   uint32_t m_nodeCount;
+  /// Streaming window of the helper
+  Time m_window;
   /// Trace as string
   std::string m_trace;
   /// Reference mobility
@@ -254,6 +275,10 @@ private:
         return;
       }
     Ns2MobilityHelper mobility (m_traceFile);
+    if (!m_window.IsZero ())
+      {
+        mobility.SetStreamingWindow (m_window);
+      }
     mobility.Install ();
     if (CheckInitialPositions ())
       {
@@ -266,6 +291,168 @@ private:
   }
 };
 
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Read a trace of several nodes whole and streamed, and compare the
+ * course changes and the positions and velocities sampled over the run.
+ *
+ * Most setdest statements of the trace are interrupted by the next one of
+ * the same node, while the fastest ones reach their destination first.
+ */
+class Ns2MobilityHelperStreamingTest : public TestCase
+{
+public:
+  /**
+   * Create new test case
+   *
+   * \param window Streaming window of the helper
+   */
+  Ns2MobilityHelperStreamingTest (Time window)
+    : TestCase (StreamingName ("streamed setdest interruptions against whole trace", window)),
+      m_window (window)
+  {
+  }
+
+private:
+  /// Single course change or sample of a node
+  struct State
+  {
+    uint32_t node;          ///< node ID
+    Time time;              ///< timestamp
+    Vector pos;             ///< position
+    Vector vel;             ///< velocity
+  };
+
+  /// Streaming window of the helper
+  Time m_window;
+  /// TMP trace file name
+  std::string m_traceFile;
+  /// Course changes of the current run
+  std::vector<State> m_courseChanges;
+  /// Samples of the current run
+  std::vector<State> m_samples;
+
+  /// Number of nodes of the trace
+  static const uint32_t NODES = 5;
+  /// Number of setdest statements of the trace
+  static const uint32_t SETDESTS = 60;
+
+  /// Dump NS-2 trace to tmp file
+  bool WriteTrace ()
+  {
+    m_traceFile = CreateTempDirFilename ("Ns2MobilityHelperStreamingTest.tcl");
+    std::ofstream of (m_traceFile.c_str ());
+    NS_TEST_ASSERT_MSG_EQ_RETURNS_BOOL (of.is_open (), true, "Need to write tmp. file");
+    for (uint32_t n = 0; n < NODES; n++)
+      {
+        of << "$node_(" << n << ") set X_ " << 10.0 * n << "\n";
+        of << "$node_(" << n << ") set Y_ " << 100.0 - 10.0 * n << "\n";
+      }
+    // a setdest every 0.37 s, and every 1.85 s for the same node; the
+    // times are not multiples of each other, so that no arrival coincides
+    // with a setdest
+    for (uint32_t k = 0; k < SETDESTS; k++)
+      {
+        double speed = (k % 3 == 0) ? 200 : 5 + k % 10;
+        of << "$ns_ at " << 0.5 + 0.37 * k << " \"$node_(" << k % NODES << ") setdest "
+           << (k * 37) % 100 << " " << (k * 53) % 100 << " " << speed << "\"\n";
+      }
+    of.close ();
+    return false; // no errors
+  }
+  /// Listen for course change events
+  void CourseChange (std::string context, Ptr<const MobilityModel> mobility)
+  {
+    State state = {mobility->GetObject<Node> ()->GetId (), Simulator::Now (),
+                   mobility->GetPosition (), mobility->GetVelocity ()};
+    m_courseChanges.push_back (state);
+  }
+  /// Sample all the nodes, and schedule the next sample
+  void Sample ()
+  {
+    for (uint32_t n = 0; n < NodeList::GetNNodes (); n++)
+      {
+        Ptr<MobilityModel> mobility = NodeList::GetNode (n)->GetObject<MobilityModel> ();
+        State state = {n, Simulator::Now (), mobility->GetPosition (), mobility->GetVelocity ()};
+        m_samples.push_back (state);
+      }
+    Simulator::Schedule (MilliSeconds (100), &Ns2MobilityHelperStreamingTest::Sample, this);
+  }
+  /**
+   * Read the trace and run the simulation
+   *
+   * \param window Streaming window of the helper, zero to read the whole trace
+   */
+  void Run (Time window)
+  {
+    m_courseChanges.clear ();
+    m_samples.clear ();
+    NodeContainer nodes;
+    nodes.Create (NODES);
+    Ns2MobilityHelper mobility (m_traceFile);
+    if (!window.IsZero ())
+      {
+        mobility.SetStreamingWindow (window);
+      }
+    mobility.Install ();
+    Config::Connect ("/NodeList/*/$ns3::MobilityModel/CourseChange",
+                     MakeCallback (&Ns2MobilityHelperStreamingTest::CourseChange, this));
+    // the samples never coincide with a setdest, whose order with a sample
+    // at the same time depends on when the setdest was scheduled
+    Simulator::Schedule (MilliSeconds (33), &Ns2MobilityHelperStreamingTest::Sample, this);
+    Simulator::Stop (Seconds (30));
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+  /**
+   * Compare the states of two runs
+   *
+   * \param actual States of the streamed run
+   * \param expected States of the whole trace run
+   * \param what Description of the states
+   */
+  void Compare (std::vector<State> const & actual, std::vector<State> const & expected, std::string const & what)
+  {
+    NS_TEST_ASSERT_MSG_EQ (actual.size (), expected.size (), "Wrong number of " << what);
+    double tol = 0.001;
+    for (size_t i = 0; i < actual.size (); i++)
+      {
+        NS_TEST_ASSERT_MSG_EQ (actual[i].node, expected[i].node, "Node ID mismatch of " << what << " " << i);
+        NS_TEST_ASSERT_MSG_EQ (actual[i].time, expected[i].time, "Time mismatch of " << what << " " << i);
+        NS_TEST_EXPECT_MSG_EQ (AreVectorsEqual (actual[i].pos, expected[i].pos, tol), true,
+                               "Position mismatch at time " << actual[i].time.GetSeconds () << " s for node " << actual[i].node);
+        NS_TEST_EXPECT_MSG_EQ (AreVectorsEqual (actual[i].vel, expected[i].vel, tol), true,
+                               "Velocity mismatch at time " << actual[i].time.GetSeconds () << " s for node " << actual[i].node);
+      }
+  }
+
+  void DoTeardown ()
+  {
+    Simulator::Destroy ();
+  }
+
+  /// Go
+  void DoRun ()
+  {
+    if (WriteTrace ())
+      {
+        return;
+      }
+    Run (Seconds (0));
+    std::vector<State> courseChanges = m_courseChanges;
+    std::vector<State> samples = m_samples;
+    // every setdest changes the course, and so does every arrival
+    NS_TEST_ASSERT_MSG_GT (courseChanges.size (), SETDESTS, "Some setdest should reach its destination");
+    NS_TEST_ASSERT_MSG_LT (courseChanges.size (), 2 * SETDESTS, "Some setdest should be interrupted");
+
+    Run (m_window);
+    Compare (m_courseChanges, courseChanges, "course changes");
+    Compare (m_samples, samples, "samples");
+  }
+};
+
 /**
  * \ingroup mobility-test
  * \ingroup tests
@@ -279,12 +466,32 @@ public:
   {
     SetDataDir (NS_TEST_SOURCEDIR);
 
+    // every trace is read whole by Install, and streamed with windows
+    // shorter than, comparable to and longer than its statement intervals
+    AddTraceTestCases (Seconds (0));
+    AddTraceTestCases (Seconds (0.01));
+    AddTraceTestCases (Seconds (0.3));
+    AddTraceTestCases (Seconds (100));
+
+    AddTestCase (new Ns2MobilityHelperStreamingTest (Seconds (0.01)), TestCase::QUICK);
+    AddTestCase (new Ns2MobilityHelperStreamingTest (Seconds (0.3)), TestCase::QUICK);
+    AddTestCase (new Ns2MobilityHelperStreamingTest (Seconds (100)), TestCase::QUICK);
+  }
+
+private:
+  /**
+   * Add the test cases of the traces
+   *
+   * \param window the streaming window of the helper, zero to read the whole trace
+   */
+  void AddTraceTestCases (Time window)
+  {
     // to be used as temporary variable for test cases.
     // Note that test suite takes care of deleting all test cases.
     Ns2MobilityHelperTest * t (0);
 
     // Initial position
-    t = new Ns2MobilityHelperTest ("initial position", Seconds (1));
+    t = new Ns2MobilityHelperTest ("initial position", Seconds (1), 1, window);
     t->SetTrace ("$node_(0) set X_ 1.0\n"
                  "$node_(0) set Y_ 2.0\n"
                  "$node_(0) set Z_ 3.0\n"
@@ -293,7 +500,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Check parsing comments, empty lines and no EOF at the end of file
-    t = new Ns2MobilityHelperTest ("comments", Seconds (1));
+    t = new Ns2MobilityHelperTest ("comments", Seconds (1), 1, window);
     t->SetTrace ("# comment\n"
                  "\n\n" // empty lines
                  "$node_(0) set X_ 1.0 # comment \n"
@@ -305,7 +512,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Simple setdest. Arguments are interpreted as x, y, speed by default
-    t = new Ns2MobilityHelperTest ("simple setdest", Seconds (10));
+    t = new Ns2MobilityHelperTest ("simple setdest", Seconds (10), 1, window);
     t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 25 0 5\"");
     //                     id  t  position         velocity
     t->AddReferencePoint ("0", 0, Vector (0, 0, 0), Vector (0, 0, 0));
@@ -314,7 +521,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Several set and setdest. Arguments are interpreted as x, y, speed by default
-    t = new Ns2MobilityHelperTest ("square setdest", Seconds (6));
+    t = new Ns2MobilityHelperTest ("square setdest", Seconds (6), 1, window);
     t->SetTrace ("$node_(0) set X_ 0.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 5  0  5\"\n"
@@ -338,28 +545,35 @@ public:
     // the end of the trace rather than at the beginning.
     //
     // Several set and setdest. Arguments are interpreted as x, y, speed by default
-    t = new Ns2MobilityHelperTest ("square setdest (initial positions at end)", Seconds (6));
-    t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 15  10  5\"\n"
-                 "$ns_ at 2.0 \"$node_(0) setdest 15  15  5\"\n"
-                 "$ns_ at 3.0 \"$node_(0) setdest 10  15  5\"\n"
-                 "$ns_ at 4.0 \"$node_(0) setdest 10  10  5\"\n"
-                 "$node_(0) set X_ 10.0\n"
-                 "$node_(0) set Y_ 10.0\n"
-                 );
-    //                     id  t  position         velocity
-    t->AddReferencePoint ("0", 0, Vector (10, 10, 0), Vector (0,  0, 0));
-    t->AddReferencePoint ("0", 1, Vector (10, 10, 0), Vector (5,  0, 0));
-    t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  0, 0));
-    t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  5, 0));
-    t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (0,  0, 0));
-    t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (-5, 0, 0));
-    t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, 0, 0));
-    t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, -5, 0));
-    t->AddReferencePoint ("0", 5, Vector (10, 10, 0), Vector (0,  0, 0));
-    AddTestCase (t, TestCase::QUICK);
+    //
+    // A streamed trace must give the initial positions before the first
+    // scheduled statement (see Ns2MobilityHelper::SetStreamingWindow), so
+    // this trace is only read whole
+    if (window.IsZero ())
+      {
+        t = new Ns2MobilityHelperTest ("square setdest (initial positions at end)", Seconds (6), 1, window);
+        t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 15  10  5\"\n"
+                     "$ns_ at 2.0 \"$node_(0) setdest 15  15  5\"\n"
+                     "$ns_ at 3.0 \"$node_(0) setdest 10  15  5\"\n"
+                     "$ns_ at 4.0 \"$node_(0) setdest 10  10  5\"\n"
+                     "$node_(0) set X_ 10.0\n"
+                     "$node_(0) set Y_ 10.0\n"
+                     );
+        //                     id  t  position         velocity
+        t->AddReferencePoint ("0", 0, Vector (10, 10, 0), Vector (0,  0, 0));
+        t->AddReferencePoint ("0", 1, Vector (10, 10, 0), Vector (5,  0, 0));
+        t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  0, 0));
+        t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  5, 0));
+        t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (0,  0, 0));
+        t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (-5, 0, 0));
+        t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, 0, 0));
+        t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, -5, 0));
+        t->AddReferencePoint ("0", 5, Vector (10, 10, 0), Vector (0,  0, 0));
+        AddTestCase (t, TestCase::QUICK);
+      }
 
     // Scheduled set position
-    t = new Ns2MobilityHelperTest ("scheduled set position", Seconds (2));
+    t = new Ns2MobilityHelperTest ("scheduled set position", Seconds (2), 1, window);
     t->SetTrace ("$ns_ at 1.0 \"$node_(0) set X_ 10\"\n"
                  "$ns_ at 1.0 \"$node_(0) set Z_ 10\"\n"
                  "$ns_ at 1.0 \"$node_(0) set Y_ 10\"");
@@ -370,7 +584,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Malformed lines
-    t = new Ns2MobilityHelperTest ("malformed lines", Seconds (2));
+    t = new Ns2MobilityHelperTest ("malformed lines", Seconds (2), 1, window);
     t->SetTrace ("$node() set X_ 1 # node id is not present\n"
                  "$node # incoplete line\"\n"
                  "$node this line is not correct\n"
@@ -386,7 +600,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Non possible values
-    t = new Ns2MobilityHelperTest ("non possible values", Seconds (2));
+    t = new Ns2MobilityHelperTest ("non possible values", Seconds (2), 1, window);
     t->SetTrace ("$node_(0) set X_ 1 # line OK \n"
                  "$node_(0) set Y_ 2 # line OK \n"
                  "$node_(0) set Z_ 3 # line OK \n"
@@ -406,7 +620,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // More than one node
-    t = new Ns2MobilityHelperTest ("few nodes, combinations of set and setdest", Seconds (10), 3);
+    t = new Ns2MobilityHelperTest ("few nodes, combinations of set and setdest", Seconds (10), 3, window);
     t->SetTrace ("$node_(0) set X_ 1.0\n"
                  "$node_(0) set Y_ 2.0\n"
                  "$node_(0) set Z_ 3.0\n"
@@ -434,7 +648,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Test for Speed == 0, that acts as stop the node.
-    t = new Ns2MobilityHelperTest ("setdest with speed cero", Seconds (10));
+    t = new Ns2MobilityHelperTest ("setdest with speed cero", Seconds (10), 1, window);
     t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 25 0 5\"\n"
                  "$ns_ at 7.0 \"$node_(0) setdest 11  22  0\"\n");
     //                     id  t  position         velocity
@@ -446,7 +660,7 @@ public:
 
 
     // Test negative positions
-    t = new Ns2MobilityHelperTest ("test negative positions", Seconds (10));
+    t = new Ns2MobilityHelperTest ("test negative positions", Seconds (10), 1, window);
     t->SetTrace ("$node_(0) set X_ -1.0\n"
                  "$node_(0) set Y_ 0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 0 0 1\"\n"
@@ -460,7 +674,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Sqare setdest with values in the form 1.0e+2
-    t = new Ns2MobilityHelperTest ("Foalt numbers in 1.0e+2 format", Seconds (6));
+    t = new Ns2MobilityHelperTest ("Foalt numbers in 1.0e+2 format", Seconds (6), 1, window);
     t->SetTrace ("$node_(0) set X_ 0.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 1.0e+2  0       1.0e+2\"\n"
@@ -478,7 +692,7 @@ public:
     t->AddReferencePoint ("0", 4, Vector (0, 100, 0), Vector (0, -100, 0));
     t->AddReferencePoint ("0", 5, Vector (0, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
-    t = new Ns2MobilityHelperTest ("Bug 1219 testcase", Seconds (16));
+    t = new Ns2MobilityHelperTest ("Bug 1219 testcase", Seconds (16), 1, window);
     t->SetTrace ("$node_(0) set X_ 0.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 0  10       1\"\n"
@@ -490,14 +704,14 @@ public:
     t->AddReferencePoint ("0", 6, Vector (0, 5, 0), Vector (0,  -1, 0));
     t->AddReferencePoint ("0", 16, Vector (0, -10, 0), Vector (0, 0, 0));
     AddTestCase (t, TestCase::QUICK);
-    t = new Ns2MobilityHelperTest ("Bug 1059 testcase", Seconds (16));
+    t = new Ns2MobilityHelperTest ("Bug 1059 testcase", Seconds (16), 1, window);
     t->SetTrace ("$node_(0) set X_ 10.0\r\n"
                  "$node_(0) set Y_ 0.0\r\n"
                  );
     //                     id  t  position         velocity
     t->AddReferencePoint ("0", 0, Vector (10, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
-    t = new Ns2MobilityHelperTest ("Bug 1301 testcase", Seconds (16));
+    t = new Ns2MobilityHelperTest ("Bug 1301 testcase", Seconds (16), 1, window);
     t->SetTrace ("$node_(0) set X_ 10.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 10  0       1\"\n"
@@ -508,7 +722,7 @@ public:
     t->AddReferencePoint ("0", 0, Vector (10, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
 
-    t = new Ns2MobilityHelperTest ("Bug 1316 testcase", Seconds (1000));
+    t = new Ns2MobilityHelperTest ("Bug 1316 testcase", Seconds (1000), 1, window);
     t->SetTrace ("$node_(0) set X_ 350.00000000000000\n"
                  "$node_(0) set Y_ 50.00000000000000\n"
                  "$ns_ at 50.00000000000000  \"$node_(0) setdest 400.00000000000000 50.00000000000000 1.00000000000000\"\n"
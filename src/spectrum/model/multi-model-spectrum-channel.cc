@@ -26,6 +26,7 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/uinteger.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -36,6 +37,7 @@
 #include <ns3/angles.h>
 #include <iostream>
 #include <utility>
+#include <vector>
 #include "multi-model-spectrum-channel.h"
 
 
@@ -82,6 +84,7 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_numWorkerThreads (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -92,6 +95,7 @@ MultiModelSpectrumChannel::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_workerPool = 0;
   SpectrumChannel::DoDispose ();
 }
 
@@ -102,11 +106,44 @@ MultiModelSpectrumChannel::GetTypeId (void)
     .SetParent<SpectrumChannel> ()
     .SetGroupName ("Spectrum")
     .AddConstructor<MultiModelSpectrumChannel> ()
-
+    .AddAttribute ("NumWorkerThreads",
+                   "The number of threads used to compute the signals received "
+                   "by the receivers of a transmission. The path loss, the "
+                   "propagation delay and anything that draws random numbers "
+                   "are always evaluated by the simulation thread, in the same "
+                   "order, so that the results do not depend on this value. "
+                   "Only the SpectrumPropagationLossModels that support it "
+                   "offload part of their computations to the other threads. "
+                   "0 or 1 disable the worker threads.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultiModelSpectrumChannel::SetNumWorkerThreads,
+                                         &MultiModelSpectrumChannel::GetNumWorkerThreads),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
+void
+MultiModelSpectrumChannel::SetNumWorkerThreads (uint32_t numThreads)
+{
+  NS_LOG_FUNCTION (this << numThreads);
+  m_numWorkerThreads = numThreads;
+  if (numThreads > 1)
+    {
+      m_workerPool = Create<SpectrumWorkerPool> (numThreads);
+    }
+  else
+    {
+      m_workerPool = 0;
+    }
+}
+
+uint32_t
+MultiModelSpectrumChannel::GetNumWorkerThreads (void) const
+{
+  return m_numWorkerThreads;
+}
+
 
 
 void
@@ -271,6 +308,24 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
 
 
+      // the signals that reach the receivers of this SpectrumModel. The
+      // spectrum propagation loss is computed for all of them at once, so
+      // that it can share the computations that only depend on the sender
+      std::vector<Ptr<SpectrumSignalParameters> > rxParamsList;
+      std::vector<Ptr<SpectrumPhy> > rxPhyList;
+      std::vector<Ptr<MobilityModel> > rxMobilityList;
+      std::vector<Ptr<SpectrumValue> > batchPsds;
+      std::vector<Ptr<const MobilityModel> > batchMobilities;
+
+      // the parameters copied for each receiver, with the PSD converted to
+      // the SpectrumModel of the receivers, so that each copy copies the PSD once
+      Ptr<SpectrumSignalParameters> convertedTxParams = txParams;
+      if (convertedTxPowerSpectrum != txParams->psd)
+        {
+          convertedTxParams = txParams->Copy ();
+          convertedTxParams->psd = convertedTxPowerSpectrum;
+        }
+
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
            ++rxPhyIterator)
@@ -280,10 +335,10 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
+              NS_LOG_LOGIC (" copying signal parameters " << convertedTxParams);
+              // the copy of the parameters includes a copy of the PSD, to
+              // which the losses are applied in place
+              Ptr<SpectrumSignalParameters> rxParams = convertedTxParams->Copy ();
 
               Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
 
@@ -321,31 +376,61 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
                   *(rxParams->psd) *= pathGainLinear;              
 
-                  if (m_spectrumPropagationLoss)
+                  if ((*rxPhyIterator)->CanNeglectRx ())
                     {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+                      double maxGainDb = 0;
+                      if (m_spectrumPropagationLoss)
+                        {
+                          maxGainDb = m_spectrumPropagationLoss->GetMaxGainDb (txMobility, receiverMobility);
+                        }
+                      if ((*rxPhyIterator)->IsNegligibleRx (rxParams, maxGainDb))
+                        {
+                          // the signal cannot affect the receiver, thus neither
+                          // its spectrum propagation loss nor its reception are computed
+                          NS_LOG_LOGIC ("negligible signal, maxGainDb = " << maxGainDb << " dB");
+                          continue;
+                        }
                     }
 
-                  if (m_propagationDelay)
+                  if (m_spectrumPropagationLoss)
                     {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+                      batchPsds.push_back (rxParams->psd);
+                      batchMobilities.push_back (receiverMobility);
                     }
                 }
 
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+              rxParamsList.push_back (rxParams);
+              rxPhyList.push_back (*rxPhyIterator);
+              rxMobilityList.push_back (receiverMobility);
+            }
+        }
+
+      if (!batchPsds.empty ())
+        {
+          m_spectrumPropagationLoss->CalcRxPowerSpectralDensityBatch (batchPsds, txMobility, batchMobilities, m_workerPool);
+        }
+
+      for (size_t i = 0; i < rxParamsList.size (); ++i)
+        {
+          Time delay = MicroSeconds (0);
+          if (txMobility && rxMobilityList[i] && m_propagationDelay)
+            {
+              delay = m_propagationDelay->GetDelay (txMobility, rxMobilityList[i]);
+            }
+
+          Ptr<NetDevice> netDev = rxPhyList[i]->GetDevice ();
+          if (netDev)
+            {
+              // the receiver has a NetDevice, so we expect that it is attached to a Node
+              uint32_t dstNode =  netDev->GetNode ()->GetId ();
+              Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                              rxParamsList[i], rxPhyList[i]);
+            }
+          else
+            {
+              // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+              Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                                   rxParamsList[i], rxPhyList[i]);
             }
         }
 
@@ -27,6 +27,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/spectrum-worker-pool.h>
 #include <map>
 #include <set>
 
@@ -124,6 +125,19 @@ public:
   virtual std::size_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
+  /**
+   * Set the number of threads used to process the receivers of a
+   * transmission, see the NumWorkerThreads attribute
+   *
+   * \param numThreads the number of threads, 0 or 1 to disable the workers
+   */
+  void SetNumWorkerThreads (uint32_t numThreads);
+
+  /**
+   * \return the number of threads used to process the receivers of a transmission
+   */
+  uint32_t GetNumWorkerThreads (void) const;
+
 
 protected:
   void DoDispose ();
@@ -169,6 +183,9 @@ private:
    */
   std::size_t m_numDevices;
 
+  uint32_t m_numWorkerThreads;         //!< value of the NumWorkerThreads attribute
+  Ptr<SpectrumWorkerPool> m_workerPool; //!< the worker threads, null if disabled
+
 };
 
 
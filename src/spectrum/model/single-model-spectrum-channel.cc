@@ -152,9 +152,25 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
               double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
               *(rxParams->psd) *= pathGainLinear;              
 
+              if ((*rxPhyIterator)->CanNeglectRx ())
+                {
+                  double maxGainDb = 0;
+                  if (m_spectrumPropagationLoss)
+                    {
+                      maxGainDb = m_spectrumPropagationLoss->GetMaxGainDb (senderMobility, receiverMobility);
+                    }
+                  if ((*rxPhyIterator)->IsNegligibleRx (rxParams, maxGainDb))
+                    {
+                      // the signal cannot affect the receiver, thus neither
+                      // its spectrum propagation loss nor its reception are computed
+                      NS_LOG_LOGIC ("negligible signal, maxGainDb = " << maxGainDb << " dB");
+                      continue;
+                    }
+                }
+
               if (m_spectrumPropagationLoss)
                 {
-                  rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, senderMobility, receiverMobility);
+                  m_spectrumPropagationLoss->CalcRxPowerSpectralDensityInPlace (rxParams->psd, senderMobility, receiverMobility);
                 }
 
               if (m_propagationDelay)
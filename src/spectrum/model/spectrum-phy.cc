@@ -52,5 +52,17 @@ SpectrumPhy::~SpectrumPhy ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+SpectrumPhy::IsNegligibleRx (Ptr<const SpectrumSignalParameters> params, double maxGainDb) const
+{
+  return false;
+}
+
+bool
+SpectrumPhy::CanNeglectRx (void) const
+{
+  return false;
+}
+
 
 } // namespace
@@ -112,6 +112,35 @@ public:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params) = 0;
 
+  /**
+   * Tell whether an incoming signal can be neglected, given an upper bound
+   * of its received power. The SpectrumChannel calls it before computing
+   * the spectrum propagation loss, and does not deliver the signals that
+   * can be neglected.
+   *
+   * The default implementation never neglects a signal.
+   *
+   * @param params the parameters of the signal, whose PSD includes the
+   * antenna gains and the propagation loss, but not the spectrum
+   * propagation loss
+   * @param maxGainDb an upper bound of the gain that the spectrum
+   * propagation loss can apply to any band of the PSD
+   *
+   * @return true if the signal can be neglected
+   */
+  virtual bool IsNegligibleRx (Ptr<const SpectrumSignalParameters> params, double maxGainDb) const;
+
+  /**
+   * Tell whether IsNegligibleRx may return true, so that the SpectrumChannel
+   * does not compute the bound of the received power of the signals that
+   * cannot be neglected anyway.
+   *
+   * The default implementation returns false.
+   *
+   * @return true if some incoming signals may be neglected
+   */
+  virtual bool CanNeglectRx (void) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -21,6 +21,7 @@
 
 #include "spectrum-propagation-loss-model.h"
 #include <ns3/log.h>
+#include <limits>
 
 namespace ns3 {
 
@@ -73,4 +74,73 @@ SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValu
   return rxPsd;
 }
 
+void
+SpectrumPropagationLossModel::CalcRxPowerSpectralDensityInPlace (Ptr<SpectrumValue> psd,
+                                                                 Ptr<const MobilityModel> a,
+                                                                 Ptr<const MobilityModel> b) const
+{
+  DoCalcRxPowerSpectralDensityInPlace (psd, a, b);
+  if (m_next != 0)
+    {
+      m_next->CalcRxPowerSpectralDensityInPlace (psd, a, b);
+    }
+}
+
+void
+SpectrumPropagationLossModel::CalcRxPowerSpectralDensityBatch (const std::vector<Ptr<SpectrumValue> > &psds,
+                                                               Ptr<const MobilityModel> a,
+                                                               const std::vector<Ptr<const MobilityModel> > &b,
+                                                               Ptr<SpectrumWorkerPool> pool) const
+{
+  NS_ASSERT (psds.size () == b.size ());
+  DoCalcRxPowerSpectralDensityBatch (psds, a, b, pool);
+  if (m_next != 0)
+    {
+      m_next->CalcRxPowerSpectralDensityBatch (psds, a, b, pool);
+    }
+}
+
+double
+SpectrumPropagationLossModel::GetMaxGainDb (Ptr<const MobilityModel> a,
+                                            Ptr<const MobilityModel> b) const
+{
+  double maxGainDb = DoGetMaxGainDb (a, b);
+  if (m_next != 0)
+    {
+      maxGainDb += m_next->GetMaxGainDb (a, b);
+    }
+  return maxGainDb;
+}
+
+void
+SpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityInPlace (Ptr<SpectrumValue> psd,
+                                                                   Ptr<const MobilityModel> a,
+                                                                   Ptr<const MobilityModel> b) const
+{
+  Ptr<SpectrumValue> rxPsd = DoCalcRxPowerSpectralDensity (psd, a, b);
+  if (rxPsd != psd)
+    {
+      *psd = *rxPsd;
+    }
+}
+
+void
+SpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityBatch (const std::vector<Ptr<SpectrumValue> > &psds,
+                                                                 Ptr<const MobilityModel> a,
+                                                                 const std::vector<Ptr<const MobilityModel> > &b,
+                                                                 Ptr<SpectrumWorkerPool> pool) const
+{
+  for (size_t i = 0; i < b.size (); ++i)
+    {
+      DoCalcRxPowerSpectralDensityInPlace (psds[i], a, b[i]);
+    }
+}
+
+double
+SpectrumPropagationLossModel::DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                              Ptr<const MobilityModel> b) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
 } // namespace ns3
@@ -25,6 +25,8 @@
 #include <ns3/object.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-value.h>
+#include <ns3/spectrum-worker-pool.h>
+#include <vector>
 
 namespace ns3 {
 
@@ -78,6 +80,54 @@ public:
                                                  Ptr<const MobilityModel> a,
                                                  Ptr<const MobilityModel> b) const;
 
+  /**
+   * Same as CalcRxPowerSpectralDensity, but the received PSD overwrites
+   * the PSD of the transmission, so that the models which support it do
+   * not need to copy the PSD
+   *
+   * @param psd the PSD of the transmission, replaced by the received PSD
+   * @param a sender mobility
+   * @param b receiver mobility
+   */
+  void CalcRxPowerSpectralDensityInPlace (Ptr<SpectrumValue> psd,
+                                          Ptr<const MobilityModel> a,
+                                          Ptr<const MobilityModel> b) const;
+
+  /**
+   * Calculate the received PSD of a single transmission at several
+   * receivers, in place. This is equivalent to calling
+   * CalcRxPowerSpectralDensityInPlace for each receiver, in order, but it
+   * allows the models to share the computations that only depend on the
+   * transmitter.
+   *
+   * @param psds the PSD of the transmission as seen by each receiver
+   * (e.g., after the pathloss has been applied), replaced by the received PSDs.
+   * Each receiver must have its own instance.
+   * @param a sender mobility
+   * @param b the mobility of each receiver
+   * @param pool if not null, the worker threads that the models can use
+   * for the computations that are independent for each receiver. The
+   * result does not depend on the number of threads of the pool.
+   */
+  void CalcRxPowerSpectralDensityBatch (const std::vector<Ptr<SpectrumValue> > &psds,
+                                        Ptr<const MobilityModel> a,
+                                        const std::vector<Ptr<const MobilityModel> > &b,
+                                        Ptr<SpectrumWorkerPool> pool = 0) const;
+
+  /**
+   * Get an upper bound of the gain that this model and the ones chained
+   * to it can apply to any band of the PSD of a transmission. It is meant
+   * to be cheap compared to the computation of the received PSD, so that
+   * the channel can use it to skip the signals that cannot be received.
+   *
+   * @param a sender mobility
+   * @param b receiver mobility
+   *
+   * @return the upper bound in dB, +infinity if no bound is known
+   */
+  double GetMaxGainDb (Ptr<const MobilityModel> a,
+                       Ptr<const MobilityModel> b) const;
+
 protected:
   virtual void DoDispose ();
 
@@ -97,6 +147,45 @@ private:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const = 0;
 
+  /**
+   * The default implementation copies the result of
+   * DoCalcRxPowerSpectralDensity into the PSD of the transmission.
+   *
+   * @param psd the PSD of the transmission, replaced by the received PSD
+   * @param a sender mobility
+   * @param b receiver mobility
+   */
+  virtual void DoCalcRxPowerSpectralDensityInPlace (Ptr<SpectrumValue> psd,
+                                                    Ptr<const MobilityModel> a,
+                                                    Ptr<const MobilityModel> b) const;
+
+  /**
+   * The default implementation calls DoCalcRxPowerSpectralDensityInPlace
+   * for each receiver, serially, since DoCalcRxPowerSpectralDensity is not
+   * required to be thread safe.
+   *
+   * @param psds the PSD of the transmission as seen by each receiver,
+   * replaced by the received PSDs
+   * @param a sender mobility
+   * @param b the mobility of each receiver
+   * @param pool the worker threads, can be null
+   */
+  virtual void DoCalcRxPowerSpectralDensityBatch (const std::vector<Ptr<SpectrumValue> > &psds,
+                                                  Ptr<const MobilityModel> a,
+                                                  const std::vector<Ptr<const MobilityModel> > &b,
+                                                  Ptr<SpectrumWorkerPool> pool) const;
+
+  /**
+   * The default implementation returns +infinity, i.e., no bound is known.
+   *
+   * @param a sender mobility
+   * @param b receiver mobility
+   *
+   * @return the upper bound of the gain of this model, in dB
+   */
+  virtual double DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                 Ptr<const MobilityModel> b) const;
+
   Ptr<SpectrumPropagationLossModel> m_next; //!< SpectrumPropagationLossModel chained to this one.
 };
 
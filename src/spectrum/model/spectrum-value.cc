@@ -22,6 +22,7 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -38,6 +39,95 @@ SpectrumValue::SpectrumValue (Ptr<const SpectrumModel> sof)
 
 }
 
+/*
+ * The released instances are kept in a free list per SpectrumModel, as
+ * Buffer does for its data. The free lists are created on demand, and they
+ * are not created again after the static destructor below has run, since
+ * instances can still be released by the destructors of other statics.
+ */
+static std::vector<std::vector<SpectrumValue *> > *g_freeLists = 0;
+static bool g_freeListsDestroyed = false;
+static const uint32_t MAX_FREE_VALUES = 1000; // per SpectrumModel
+
+/// Deletes the released instances at the end of the program
+struct SpectrumValueFreeListsDestructor
+{
+  ~SpectrumValueFreeListsDestructor ()
+  {
+    if (g_freeLists != 0)
+      {
+        for (size_t i = 0; i < g_freeLists->size (); i++)
+          {
+            for (size_t j = 0; j < (*g_freeLists)[i].size (); j++)
+              {
+                delete (*g_freeLists)[i][j];
+              }
+          }
+        delete g_freeLists;
+        g_freeLists = 0;
+      }
+    g_freeListsDestroyed = true;
+  }
+};
+static SpectrumValueFreeListsDestructor g_freeListsDestructor;
+
+/**
+ * \param uid the uid of a SpectrumModel
+ * \return an instance of the SpectrumModel released before, with a
+ * reference count of zero and values not initialized, or 0 if there is none
+ */
+static SpectrumValue *
+ReuseSpectrumValue (SpectrumModelUid_t uid)
+{
+  if (g_freeLists == 0 || uid >= g_freeLists->size () || (*g_freeLists)[uid].empty ())
+    {
+      return 0;
+    }
+  SpectrumValue *value = (*g_freeLists)[uid].back ();
+  (*g_freeLists)[uid].pop_back ();
+  return value;
+}
+
+void
+SpectrumValueDeleter::Delete (SpectrumValue *value)
+{
+  Ptr<const SpectrumModel> sm = value->GetSpectrumModel ();
+  if (sm == 0 || g_freeListsDestroyed)
+    {
+      delete value;
+      return;
+    }
+  if (g_freeLists == 0)
+    {
+      g_freeLists = new std::vector<std::vector<SpectrumValue *> > ();
+    }
+  SpectrumModelUid_t uid = sm->GetUid ();
+  if (uid >= g_freeLists->size ())
+    {
+      g_freeLists->resize (uid + 1);
+    }
+  if ((*g_freeLists)[uid].size () < MAX_FREE_VALUES)
+    {
+      (*g_freeLists)[uid].push_back (value);
+    }
+  else
+    {
+      delete value;
+    }
+}
+
+Ptr<SpectrumValue>
+SpectrumValue::Allocate (Ptr<const SpectrumModel> sm)
+{
+  SpectrumValue *value = ReuseSpectrumValue (sm->GetUid ());
+  if (value == 0)
+    {
+      return Create<SpectrumValue> (sm);
+    }
+  std::fill (value->m_values.begin (), value->m_values.end (), 0.0);
+  return Ptr<SpectrumValue> (value);
+}
+
 double&
 SpectrumValue::operator[] (size_t index)
 {
@@ -408,11 +498,18 @@ Integral (const SpectrumValue& arg)
 Ptr<SpectrumValue>
 SpectrumValue::Copy () const
 {
-  Ptr<SpectrumValue> p = Create<SpectrumValue> (m_spectrumModel);
-  *p = *this;
-  return p;
-
-  //  return Copy<SpectrumValue> (*this)
+  SpectrumValue *value = 0;
+  if (m_spectrumModel != 0)
+    {
+      value = ReuseSpectrumValue (m_spectrumModel->GetUid ());
+    }
+  if (value == 0)
+    {
+      return Ptr<SpectrumValue> (new SpectrumValue (*this), false);
+    }
+  // same SpectrumModel, thus the values are copied without allocations
+  value->m_values = m_values;
+  return Ptr<SpectrumValue> (value);
 }
 
 
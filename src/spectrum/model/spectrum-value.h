@@ -33,6 +33,24 @@ namespace ns3 {
 /// Container for element values
 typedef std::vector<double> Values;
 
+class SpectrumValue;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Deleter of the SpectrumValue instances, which keeps the
+ * released instances in a free list per SpectrumModel, so that
+ * SpectrumValue::Allocate and SpectrumValue::Copy can reuse them together
+ * with their values.
+ */
+struct SpectrumValueDeleter
+{
+  /**
+   * \param value the instance whose reference count reached zero
+   */
+  static void Delete (SpectrumValue *value);
+};
+
 /**
  * \ingroup spectrum
  *
@@ -55,7 +73,7 @@ typedef std::vector<double> Values;
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
  */
-class SpectrumValue : public SimpleRefCount<SpectrumValue>
+class SpectrumValue : public SimpleRefCount<SpectrumValue, empty, SpectrumValueDeleter>
 {
 public:
   /**
@@ -80,6 +98,17 @@ public:
 
   SpectrumValue ();
 
+  /**
+   * Create a SpectrumValue with all the values set to zero, like
+   * Create<SpectrumValue> (sm), but reusing an instance of the same
+   * SpectrumModel released before, if any.
+   *
+   * @param sm the SpectrumModel of the values
+   *
+   * @return the new instance
+   */
+  static Ptr<SpectrumValue> Allocate (Ptr<const SpectrumModel> sm);
+
 
   /**
    * Access value at given frequency index
@@ -498,6 +527,7 @@ public:
   friend double Integral (const SpectrumValue&  arg);
 
   /**
+   * The copy reuses an instance released before, if any (see Allocate)
    *
    * @return a Ptr to a copy of this instance
    */
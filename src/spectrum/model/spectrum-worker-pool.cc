@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spectrum-worker-pool.h"
+#include <ns3/core-config.h>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumWorkerPool");
+
+/**
+ * Process the partition of the items assigned to a thread
+ * \param task the task
+ * \param index the index of the thread
+ * \param numThreads the number of threads
+ * \param numItems the number of items
+ */
+static void
+RunPartition (const Callback<void, uint32_t> &task, uint32_t index, uint32_t numThreads, uint32_t numItems)
+{
+  uint32_t begin = (uint64_t) numItems * index / numThreads;
+  uint32_t end = (uint64_t) numItems * (index + 1) / numThreads;
+  for (uint32_t i = begin; i < end; ++i)
+    {
+      task (i);
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/**
+ * \ingroup spectrum
+ * The worker threads of a SpectrumWorkerPool. The thread calling Run
+ * processes partition 0, and worker i processes partition i + 1.
+ */
+class SpectrumWorkerPoolPrivate
+{
+public:
+  /**
+   * Start the workers
+   * \param numThreads the number of threads, including the caller of Run
+   */
+  SpectrumWorkerPoolPrivate (uint32_t numThreads);
+  ~SpectrumWorkerPoolPrivate ();
+
+  /**
+   * Run the task on all the items
+   * \param numItems the number of items
+   * \param task the task
+   */
+  void Run (uint32_t numItems, Callback<void, uint32_t> task);
+
+private:
+  /**
+   * The loop executed by each worker
+   * \param index the index of the partition processed by the worker
+   */
+  void Work (uint32_t index);
+
+  uint32_t m_numThreads;              //!< number of threads, including the caller of Run
+  std::vector<std::thread> m_threads; //!< the workers
+  std::mutex m_mutex;                 //!< protects the fields below
+  std::condition_variable m_start;    //!< notified when a new job is available
+  std::condition_variable m_done;     //!< notified when the last worker completes a job
+  uint64_t m_generation;              //!< incremented for each job
+  uint32_t m_pending;                 //!< number of workers that did not complete the job yet
+  bool m_stop;                        //!< true when the workers have to exit
+  Callback<void, uint32_t> m_task;    //!< the task of the current job
+  uint32_t m_numItems;                //!< the number of items of the current job
+};
+
+SpectrumWorkerPoolPrivate::SpectrumWorkerPoolPrivate (uint32_t numThreads)
+  : m_numThreads (numThreads),
+    m_generation (0),
+    m_pending (0),
+    m_stop (false),
+    m_numItems (0)
+{
+  for (uint32_t i = 1; i < m_numThreads; ++i)
+    {
+      m_threads.push_back (std::thread (&SpectrumWorkerPoolPrivate::Work, this, i));
+    }
+}
+
+SpectrumWorkerPoolPrivate::~SpectrumWorkerPoolPrivate ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_start.notify_all ();
+  for (std::vector<std::thread>::iterator it = m_threads.begin (); it != m_threads.end (); ++it)
+    {
+      it->join ();
+    }
+}
+
+void
+SpectrumWorkerPoolPrivate::Run (uint32_t numItems, Callback<void, uint32_t> task)
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_task = task;
+    m_numItems = numItems;
+    m_pending = m_threads.size ();
+    ++m_generation;
+  }
+  m_start.notify_all ();
+
+  RunPartition (m_task, 0, m_numThreads, numItems);
+
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (m_pending != 0)
+    {
+      m_done.wait (lock);
+    }
+  // the task is released by the calling thread only
+  m_task = Callback<void, uint32_t> ();
+}
+
+void
+SpectrumWorkerPoolPrivate::Work (uint32_t index)
+{
+  uint64_t generation = 0;
+  while (true)
+    {
+      uint32_t numItems;
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        while (!m_stop && m_generation == generation)
+          {
+            m_start.wait (lock);
+          }
+        if (m_stop)
+          {
+            return;
+          }
+        generation = m_generation;
+        numItems = m_numItems;
+      }
+
+      // m_task is not modified until all the workers have completed the job
+      RunPartition (m_task, index, m_numThreads, numItems);
+
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (--m_pending == 0)
+        {
+          m_done.notify_one ();
+        }
+    }
+}
+
+#else /* HAVE_PTHREAD_H */
+
+class SpectrumWorkerPoolPrivate
+{
+};
+
+#endif /* HAVE_PTHREAD_H */
+
+SpectrumWorkerPool::SpectrumWorkerPool (uint32_t numThreads)
+  : m_numThreads (numThreads),
+    m_priv (0)
+{
+  NS_LOG_FUNCTION (this << numThreads);
+  NS_ASSERT_MSG (numThreads > 0, "at least one thread is needed");
+#ifdef HAVE_PTHREAD_H
+  if (m_numThreads > 1)
+    {
+      m_priv = new SpectrumWorkerPoolPrivate (m_numThreads);
+    }
+#else
+  NS_LOG_WARN ("ns-3 was built without thread support, the items will be processed serially");
+  m_numThreads = 1;
+#endif
+}
+
+SpectrumWorkerPool::~SpectrumWorkerPool ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_priv;
+  m_priv = 0;
+}
+
+uint32_t
+SpectrumWorkerPool::GetNumThreads (void) const
+{
+  return m_numThreads;
+}
+
+void
+SpectrumWorkerPool::ParallelFor (uint32_t numItems, Callback<void, uint32_t> task)
+{
+  NS_LOG_FUNCTION (this << numItems);
+#ifdef HAVE_PTHREAD_H
+  if (m_priv != 0 && numItems > 1)
+    {
+      m_priv->Run (numItems, task);
+      return;
+    }
+#endif
+  RunPartition (task, 0, 1, numItems);
+}
+
+} // namespace ns3
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPECTRUM_WORKER_POOL_H
+#define SPECTRUM_WORKER_POOL_H
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/callback.h>
+#include <stdint.h>
+
+namespace ns3 {
+
+class SpectrumWorkerPoolPrivate;
+
+/**
+ * \ingroup spectrum
+ *
+ * A fixed set of worker threads which can be used by a SpectrumChannel
+ * and by its SpectrumPropagationLossModel to process the receivers of a
+ * transmission in parallel.
+ *
+ * The items of ParallelFor are statically partitioned among the threads,
+ * and the calling thread takes part in the computation. The tasks must only
+ * touch data that is private to their item: they must not schedule events,
+ * log, draw random numbers or create and release Ptr to shared objects.
+ *
+ * If ns-3 is built without thread support, the items are processed
+ * serially by the calling thread.
+ */
+class SpectrumWorkerPool : public SimpleRefCount<SpectrumWorkerPool>
+{
+public:
+  /**
+   * Create the pool
+   * \param numThreads the number of threads that process the items,
+   * including the one calling ParallelFor
+   */
+  SpectrumWorkerPool (uint32_t numThreads);
+  ~SpectrumWorkerPool ();
+
+  /**
+   * \return the number of threads that process the items
+   */
+  uint32_t GetNumThreads (void) const;
+
+  /**
+   * Call task (i) for i = 0, ..., numItems - 1, and return when all
+   * the calls have completed
+   * \param numItems the number of items
+   * \param task the task to be executed for each item
+   */
+  void ParallelFor (uint32_t numItems, Callback<void, uint32_t> task);
+
+private:
+  SpectrumWorkerPool (const SpectrumWorkerPool &);
+  SpectrumWorkerPool & operator = (const SpectrumWorkerPool &);
+
+  uint32_t m_numThreads; //!< number of threads, including the caller
+  SpectrumWorkerPoolPrivate *m_priv; //!< the worker threads, if threading is enabled
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_WORKER_POOL_H */
@@ -18,10 +18,13 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
+#include <cmath>
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -52,19 +55,56 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The distance (m) beyond which the frames are not delivered, "
+                   "also used as the size of the cells of the grid of the PHYs. "
+                   "It is not derived from the propagation loss model: it should be a distance "
+                   "at which the loss model gives a received power below the energy detection "
+                   "threshold of the PHYs. "
+                   "0 delivers the frames to all the PHYs on the channel of the sender.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("GridRebuildPeriod",
+                   "The grid is rebuilt with the current positions of the PHYs when it is older than this. "
+                   "Only used if MaxRange is not 0.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&YansWifiChannel::m_gridRebuildPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxSpeed",
+                   "Upper bound of the speed of the PHYs (m/s). Between two rebuilds of the grid, "
+                   "the cells within MaxRange plus the distance covered at this speed are searched. "
+                   "Only used if MaxRange is not 0.",
+                   DoubleValue (70),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxSpeed),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0),
+    m_maxSpeed (70),
+    m_gridsValid (false)
 {
   NS_LOG_FUNCTION (this);
+  m_courseChangeCallback = MakeCallback (&YansWifiChannel::CourseChanged, this);
 }
 
 YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_phyMobility.size (); i++)
+    {
+      if (m_phyMobility[i] != 0)
+        {
+          m_phyMobility[i]->TraceDisconnectWithoutContext ("CourseChange", m_courseChangeCallback);
+        }
+    }
+  m_phyMobility.clear ();
   m_phyList.clear ();
+  m_phyIndex.clear ();
+  m_grids.clear ();
 }
 
 void
@@ -87,23 +127,69 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  if (!m_gridsValid || (m_maxRange > 0 && Simulator::Now () - m_lastRebuild >= m_gridRebuildPeriod))
+    {
+      RebuildGrids ();
+    }
+
+  //For now don't account for inter channel interference nor channel bonding
+  std::map<uint8_t, Grid>::const_iterator grid = m_grids.find (sender->GetChannelNumber ());
+  if (grid == m_grids.end () || grid->second.empty ())
     {
-      if (sender != (*i))
+      return;
+    }
+
+  const std::vector<uint32_t> *candidates;
+  Vector senderPosition;
+  if (m_maxRange > 0)
+    {
+      // the PHYs may have moved towards the sender since the grid was built
+      senderPosition = senderMobility->GetPosition ();
+      double radius = m_maxRange + m_maxSpeed * (Simulator::Now () - m_lastRebuild).GetSeconds ();
+      int32_t xEnd = GetCell (senderPosition.x + radius);
+      int32_t yEnd = GetCell (senderPosition.y + radius);
+      m_candidates.clear ();
+      for (int32_t x = GetCell (senderPosition.x - radius); x <= xEnd; x++)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          for (int32_t y = GetCell (senderPosition.y - radius); y <= yEnd; y++)
+            {
+              Grid::const_iterator cell = grid->second.find (Cell (x, y));
+              if (cell != grid->second.end ())
+                {
+                  m_candidates.insert (m_candidates.end (), cell->second.begin (), cell->second.end ());
+                }
+            }
+        }
+      //Keep the order of m_phyList, in which the receptions are scheduled without the grid
+      std::sort (m_candidates.begin (), m_candidates.end ());
+      candidates = &m_candidates;
+    }
+  else
+    {
+      //A single cell holds all the PHYs of the channel
+      candidates = &grid->second.begin ()->second;
+    }
+
+  for (std::vector<uint32_t>::const_iterator i = candidates->begin (); i != candidates->end (); i++)
+    {
+      Ptr<YansWifiPhy> receiver = m_phyList[*i];
+      if (sender != receiver)
+        {
+          if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
             {
               continue;
             }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+          if (m_maxRange > 0 && CalculateDistance (senderPosition, receiverMobility->GetPosition ()) > m_maxRange)
+            {
+              continue;
+            }
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
+          Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
             {
@@ -116,16 +202,16 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+                                          receiver, packet, rxPowerDbm, duration);
         }
     }
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const Packet> packet, double rxPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (phy << packet << rxPowerDbm << duration.GetSeconds ());
-  phy->StartReceivePreambleAndHeader (packet, DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
+  phy->StartReceivePreambleAndHeader (packet->Copy (), DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
 }
 
 std::size_t
@@ -144,7 +230,89 @@ void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
+  m_phyIndex[phy] = m_phyList.size ();
   m_phyList.push_back (phy);
+  m_gridsValid = false;
+}
+
+void
+YansWifiChannel::NotifyChannelNumberChange (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy << +phy->GetChannelNumber ());
+  if (!m_gridsValid)
+    {
+      return;
+    }
+  std::map<Ptr<YansWifiPhy>, uint32_t>::const_iterator it = m_phyIndex.find (phy);
+  NS_ASSERT (it != m_phyIndex.end ());
+  uint32_t index = it->second;
+  uint8_t channelNumber = phy->GetChannelNumber ();
+  if (channelNumber == m_phyChannel[index])
+    {
+      return;
+    }
+  //Move the PHY to the same cell of the grid of its new channel
+  Grid &oldGrid = m_grids[m_phyChannel[index]];
+  std::vector<uint32_t> &oldCell = oldGrid[m_phyCell[index]];
+  std::vector<uint32_t>::iterator pos = std::lower_bound (oldCell.begin (), oldCell.end (), index);
+  NS_ASSERT (pos != oldCell.end () && *pos == index);
+  oldCell.erase (pos);
+  if (oldCell.empty ())
+    {
+      oldGrid.erase (m_phyCell[index]);
+    }
+  std::vector<uint32_t> &newCell = m_grids[channelNumber][m_phyCell[index]];
+  newCell.insert (std::upper_bound (newCell.begin (), newCell.end (), index), index);
+  m_phyChannel[index] = channelNumber;
+}
+
+void
+YansWifiChannel::RebuildGrids (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_grids.clear ();
+  m_phyChannel.resize (m_phyList.size ());
+  m_phyCell.resize (m_phyList.size ());
+  m_phyMobility.resize (m_phyList.size ());
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      Cell cell (0, 0);
+      if (m_maxRange > 0)
+        {
+          Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ();
+          NS_ASSERT (mobility != 0);
+          //The mobility of a PHY is only known once its device is installed on a node
+          if (mobility != m_phyMobility[i])
+            {
+              if (m_phyMobility[i] != 0)
+                {
+                  m_phyMobility[i]->TraceDisconnectWithoutContext ("CourseChange", m_courseChangeCallback);
+                }
+              mobility->TraceConnectWithoutContext ("CourseChange", m_courseChangeCallback);
+              m_phyMobility[i] = mobility;
+            }
+          Vector position = mobility->GetPosition ();
+          cell = Cell (GetCell (position.x), GetCell (position.y));
+        }
+      m_phyChannel[i] = m_phyList[i]->GetChannelNumber ();
+      m_phyCell[i] = cell;
+      m_grids[m_phyChannel[i]][cell].push_back (i);
+    }
+  m_lastRebuild = Simulator::Now ();
+  m_gridsValid = true;
+}
+
+int32_t
+YansWifiChannel::GetCell (double x) const
+{
+  return static_cast<int32_t> (std::floor (x / m_maxRange));
+}
+
+void
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  m_gridsValid = false;
 }
 
 int64_t
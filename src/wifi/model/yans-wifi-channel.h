@@ -21,13 +21,17 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <map>
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class MobilityModel;
 class YansWifiPhy;
 class Packet;
 class Time;
@@ -40,6 +44,22 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * The PHYs are grouped by channel number, so that a frame is only
+ * propagated to the PHYs tuned on the channel of the sender. For large
+ * fleets (e.g. 802.11p vehicles) the MaxRange attribute also bounds the
+ * distance at which a frame is delivered: the PHYs are then kept in a
+ * grid of MaxRange cells, rebuilt at most every GridRebuildPeriod, and
+ * only the PHYs of the cells around the sender are considered. A PHY that
+ * changes course (e.g. whose position is set) marks the grid to be
+ * rebuilt at the next frame, since it may have moved faster than MaxSpeed.
+ *
+ * MaxRange is a plain distance: it is not derived from the propagation
+ * loss model, which may be random and cannot be inverted in general. The
+ * user must choose a distance at which the loss model certainly gives a
+ * received power below the energy detection threshold of the PHYs, for
+ * the largest transmission power. The farther PHYs do not receive the
+ * frame, not even as interference, whatever the loss model would give.
  */
 class YansWifiChannel : public Channel
 {
@@ -86,6 +106,14 @@ public:
    */
   void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
 
+  /**
+   * \param phy the YansWifiPhy whose channel number has changed
+   *
+   * This method should not be invoked by normal users. It is invoked by
+   * YansWifiPhy to move the PHY to the group of its new channel number.
+   */
+  void NotifyChannelNumberChange (Ptr<YansWifiPhy> phy);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -104,21 +132,66 @@ private:
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
 
+  /**
+   * A cell of the grid, as the indices of the cell along x and y.
+   */
+  typedef std::pair<int32_t, int32_t> Cell;
+
+  /**
+   * The indices in m_phyList of the PHYs in each non-empty cell, in
+   * increasing order.
+   */
+  typedef std::map<Cell, std::vector<uint32_t> > Grid;
+
+  /**
+   * Put each PHY in the grid of its channel number, in the cell of its
+   * current position.
+   */
+  void RebuildGrids (void) const;
+
+  /**
+   * \param x the coordinate (m)
+   * \return the index of the cell along the axis
+   */
+  int32_t GetCell (double x) const;
+
+  /**
+   * Mark the grids to be rebuilt, since a PHY may have moved farther than
+   * MaxSpeed allows.
+   *
+   * \param mobility the mobility model of the PHY
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
-   * bit of the packet has arrived.
+   * bit of the packet has arrived. The packet is shared by all the
+   * receivers of a frame, and it is copied only here.
    *
    * \param receiver the device to which the packet is destined
    * \param packet the packet being sent
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    * \param duration the transmission duration associated with the packet being sent
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet, double txPowerDbm, Time duration);
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxRange;                   //!< Distance beyond which the frames are not delivered (m), 0 if unbounded
+  Time m_gridRebuildPeriod;            //!< Maximum age of the grids
+  double m_maxSpeed;                   //!< Upper bound of the speed of the PHYs (m/s)
+
+  std::map<Ptr<YansWifiPhy>, uint32_t> m_phyIndex; //!< Index of each PHY in m_phyList
+  mutable std::map<uint8_t, Grid> m_grids;         //!< Grid of the PHYs of each channel number
+  mutable std::vector<uint8_t> m_phyChannel;       //!< Channel number of each PHY in the grids
+  mutable std::vector<Cell> m_phyCell;             //!< Cell of each PHY in the grids
+  mutable std::vector<Ptr<MobilityModel> > m_phyMobility; //!< Mobility of each PHY, whose CourseChange is connected
+  Callback<void, Ptr<const MobilityModel> > m_courseChangeCallback; //!< Connected to the CourseChange of the PHYs
+  mutable bool m_gridsValid;                       //!< True if the grids hold all the PHYs
+  mutable Time m_lastRebuild;                      //!< Time of the last rebuild of the grids
+  mutable std::vector<uint32_t> m_candidates;      //!< Candidate receivers of the frame being sent
 };
 
 } //namespace ns3
@@ -74,6 +74,28 @@ YansWifiPhy::SetChannel (const Ptr<YansWifiChannel> channel)
   m_channel->Add (this);
 }
 
+void
+YansWifiPhy::SetChannelNumber (uint8_t nch)
+{
+  NS_LOG_FUNCTION (this << +nch);
+  WifiPhy::SetChannelNumber (nch);
+  if (m_channel != 0)
+    {
+      m_channel->NotifyChannelNumberChange (this);
+    }
+}
+
+void
+YansWifiPhy::SetFrequency (uint16_t freq)
+{
+  NS_LOG_FUNCTION (this << freq);
+  WifiPhy::SetFrequency (freq);
+  if (m_channel != 0)
+    {
+      m_channel->NotifyChannelNumberChange (this);
+    }
+}
+
 void
 YansWifiPhy::StartTx (Ptr<Packet> packet, WifiTxVector txVector, Time txDuration)
 {
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Convert the binary traces written by MmWaveBinaryTraceWriter (the
+ * BinaryOutput attribute of MmWavePhyRxTrace and MmWaveBearerStatsCalculator)
+ * to TSV or CSV, with the columns of the text output of the same traces, e.g.:
+ *
+ *   ./waf --run "mmwave-trace-converter --input=RxPacketTrace.bin --output=RxPacketTrace.txt"
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-binary-trace-writer.h"
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * Read all the records of a file and write them as text
+ * \param in the file, after the header
+ * \param os the output stream
+ * \param sep the field separator
+ * \param writeHeader the function writing the names of the fields, 0 if the text output has no header
+ * \param writeRecord the function writing a record
+ * \return the number of records
+ */
+template <class Record>
+static uint64_t
+Convert (FILE *in, std::ostream &os, const char *sep,
+         void (*writeHeader)(std::ostream &, const char *),
+         void (*writeRecord)(std::ostream &, const char *, const Record &))
+{
+  if (writeHeader != 0)
+    {
+      writeHeader (os, sep);
+    }
+  std::vector<Record> records (1 << 14);
+  uint64_t count = 0;
+  size_t n;
+  while ((n = fread (&records[0], sizeof (Record), records.size (), in)) > 0)
+    {
+      for (size_t i = 0; i < n; ++i)
+        {
+          writeRecord (os, sep, records[i]);
+        }
+      count += n;
+    }
+  return count;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+  std::string format = "tsv";
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "the binary trace file", input);
+  cmd.AddValue ("output", "the text file, the standard output if empty", output);
+  cmd.AddValue ("format", "tsv or csv", format);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "the input file is required" << std::endl;
+      return 1;
+    }
+  const char *sep;
+  if (format == "tsv")
+    {
+      sep = "\t";
+    }
+  else if (format == "csv")
+    {
+      sep = ",";
+    }
+  else
+    {
+      std::cerr << "unknown format " << format << std::endl;
+      return 1;
+    }
+
+  FILE *in = fopen (input.c_str (), "rb");
+  if (in == 0)
+    {
+      std::cerr << "could not open " << input << std::endl;
+      return 1;
+    }
+  MmWaveBinaryTraceHeader header;
+  if (fread (&header, sizeof (header), 1, in) != 1
+      || memcmp (header.m_magic, "MMWTRACE", sizeof (header.m_magic)) != 0)
+    {
+      std::cerr << input << " is not a binary mmWave trace" << std::endl;
+      fclose (in);
+      return 1;
+    }
+  if (header.m_version != MmWaveBinaryTraceWriter::VERSION)
+    {
+      std::cerr << "unsupported version " << header.m_version << std::endl;
+      fclose (in);
+      return 1;
+    }
+
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file.is_open ())
+        {
+          std::cerr << "could not open " << output << std::endl;
+          fclose (in);
+          return 1;
+        }
+    }
+  std::ostream &os = output.empty () ? std::cout : file;
+
+  uint64_t count = 0;
+  if (header.m_recordType == MmWaveBinaryTraceWriter::RX_PACKET_TRACE
+      && header.m_recordSize == sizeof (MmWaveRxPacketTraceRecord))
+    {
+      count = Convert<MmWaveRxPacketTraceRecord> (in, os, sep, &WriteRxPacketTraceHeader, &WriteRxPacketTraceRecord);
+    }
+  else if (header.m_recordType == MmWaveBinaryTraceWriter::BEARER_TRACE
+           && header.m_recordSize == sizeof (MmWaveBearerTraceRecord))
+    {
+      count = Convert<MmWaveBearerTraceRecord> (in, os, sep, 0, &WriteBearerTraceRecord);
+    }
+  else
+    {
+      std::cerr << "unknown record type " << header.m_recordType << " of size " << header.m_recordSize << std::endl;
+      fclose (in);
+      return 1;
+    }
+  fclose (in);
+  std::cerr << count << " records converted" << std::endl;
+  return 0;
+}